@@ -354,6 +354,16 @@ void PopAttributeFlag();
 // The attributes ids used here must match the ids used in Begin(Input|Output)Attribute function
 // calls. The order of start_attr and end_attr doesn't make a difference for rendering the link.
 void Link(int id, int start_attribute_id, int end_attribute_id);
+// Render a link as a polyline through path_count grid space corners, from start_attr to end_attr.
+// The link leaves and enters the pins horizontally: it goes from a pin to the corner at the same x
+// as the first (or last) corner before going through the path, so a path made of horizontal and
+// vertical segments stays orthogonal even if the pins are not exactly where the path expected.
+void Link(
+    int           id,
+    int           start_attribute_id,
+    int           end_attribute_id,
+    const ImVec2* path,
+    int           path_count);
 
 // Enable or disable the ability to click and drag a specific node.
 void SetNodeDraggable(int node_id, const bool draggable);
@@ -375,6 +385,10 @@ ImVec2 GetNodeScreenSpacePos(const int node_id);
 ImVec2 GetNodeEditorSpacePos(const int node_id);
 ImVec2 GetNodeGridSpacePos(const int node_id);
 
+// Returns false for a node that was neither submitted nor positioned yet, whose position the
+// functions above cannot return.
+bool IsNodeKnown(int node_id);
+
 // If ImNodesStyleFlags_GridSnapping is enabled, snap the specified node's origin to the grid.
 void SnapNodeToGrid(int node_id);
 
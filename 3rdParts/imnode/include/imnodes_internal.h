@@ -70,6 +70,101 @@ enum ImNodesLinkCreationType_
 
 // [SECTION] internal data structures
 
+// Maps object ids to pool indices. Same interface as the ImGuiStorage it replaces, but with linear
+// probing in a power of two table instead of a sorted vector, so inserting the ids of a large
+// graph in a single frame is not quadratic. Entries are never removed: setting an id to -1 marks
+// it as unmapped, which GetInt() then reports like a missing id.
+struct ImIdIndexMap
+{
+    struct Slot
+    {
+        ImGuiID Key;
+        int     Value; // INT_MIN for empty slots
+    };
+
+    ImVector<Slot> Slots;
+    int            Count;
+    int            HashShift; // 32 - log2(Slots.Size)
+
+    ImIdIndexMap() : Slots(), Count(0), HashShift(32) {}
+
+    // Fibonacci hashing spreads consecutive ids, the common case, across the table
+    inline int SlotIndex(const ImGuiID key) const
+    {
+        return static_cast<int>((key * 2654435769u) >> HashShift);
+    }
+
+    inline int GetInt(const ImGuiID key, const int default_val) const
+    {
+        if (Slots.empty())
+        {
+            return default_val;
+        }
+        for (int i = SlotIndex(key);; i = (i + 1) & (Slots.Size - 1))
+        {
+            const Slot& slot = Slots[i];
+            if (slot.Value == INT_MIN)
+            {
+                return default_val;
+            }
+            if (slot.Key == key)
+            {
+                return slot.Value;
+            }
+        }
+    }
+
+    inline void SetInt(const ImGuiID key, const int val)
+    {
+        IM_ASSERT(val != INT_MIN);
+        // Keep the load factor under one half
+        if ((Count + 1) * 2 > Slots.Size)
+        {
+            Rehash(Slots.Size == 0 ? 16 : Slots.Size * 2);
+        }
+        for (int i = SlotIndex(key);; i = (i + 1) & (Slots.Size - 1))
+        {
+            Slot& slot = Slots[i];
+            if (slot.Value == INT_MIN)
+            {
+                slot.Key = key;
+                slot.Value = val;
+                ++Count;
+                return;
+            }
+            if (slot.Key == key)
+            {
+                slot.Value = val;
+                return;
+            }
+        }
+    }
+
+    void Rehash(const int new_size)
+    {
+        ImVector<Slot> old_slots;
+        old_slots.swap(Slots);
+        Slots.resize(new_size);
+        HashShift = 32;
+        for (int size = new_size; size > 1; size >>= 1)
+        {
+            --HashShift;
+        }
+        for (int i = 0; i < new_size; ++i)
+        {
+            Slots[i].Value = INT_MIN;
+        }
+        Count = 0;
+        for (int i = 0; i < old_slots.Size; ++i)
+        {
+            if (old_slots[i].Value != INT_MIN)
+            {
+                SetInt(old_slots[i].Key, old_slots[i].Value);
+            }
+        }
+    }
+};
+
 // The object T must have the following interface:
 //
 // struct T
@@ -84,7 +179,7 @@ struct ImObjectPool
     ImVector<T>    Pool;
     ImVector<bool> InUse;
     ImVector<int>  FreeList;
-    ImGuiStorage   IdMap;
+    ImIdIndexMap   IdMap;
 
     ImObjectPool() : Pool(), InUse(), FreeList(), IdMap() {}
 };
@@ -189,13 +284,16 @@ struct ImLinkData
 {
     int Id;
     int StartPinIdx, EndPinIdx;
+    // Grid space corners the link passes through, from the start pin to the end pin. The link is
+    // drawn as a bezier curve when empty, and as a polyline otherwise.
+    ImVector<ImVec2> Path;
 
     struct
     {
         ImU32 Base, Hovered, Selected;
     } ColorStyle;
 
-    ImLinkData(const int link_id) : Id(link_id), StartPinIdx(), EndPinIdx(), ColorStyle() {}
+    ImLinkData(const int link_id) : Id(link_id), StartPinIdx(), EndPinIdx(), Path(), ColorStyle() {}
 };
 
 struct ImClickInteractionState
@@ -217,6 +315,69 @@ struct ImClickInteractionState
     ImClickInteractionState() : Type(ImNodesClickInteractionType_None) {}
 };
 
+// One level of an ImSpatialGrid. Object indices are stored per cell in a flat array,
+// CellStart[c]..CellStart[c + 1] being the range of cell c.
+struct ImSpatialGridLevel
+{
+    float         CellSize;
+    int           Cols, Rows;
+    ImVector<int> CellStart;
+    ImVector<int> Items;
+
+    ImSpatialGridLevel() : CellSize(1.f), Cols(0), Rows(0), CellStart(), Items() {}
+};
+
+// Hierarchical uniform grid. Cell size doubles from one level to the next and each rect is stored
+// in the first level whose cells are at least as large as the rect, so it covers at most 2x2
+// cells no matter how long it is.
+static const int IMNODES_SPATIAL_GRID_LEVELS = 12;
+
+struct ImSpatialGrid
+{
+    ImVec2             Origin; // Min corner of cell (0, 0) on every level
+    ImSpatialGridLevel Levels[IMNODES_SPATIAL_GRID_LEVELS];
+
+    ImSpatialGrid() : Origin(0.f, 0.f) {}
+};
+
+// Spatial index used by box selection. It is built in grid space when the box selection starts,
+// so panning does not invalidate it, and rebuilt only when a node rect leaves the rect it was
+// indexed with, a link leaves its bounds or the set of links changes. Link bounds are only
+// computed again for links whose pins moved.
+struct ImBoxSelectorIndex
+{
+    bool             Valid;
+    ImSpatialGrid    NodeGrid;
+    ImSpatialGrid    LinkGrid;
+    ImVector<ImRect> NodeRects; // Grid space, inverted for unused node slots
+    ImVector<int>    LinkPinIndices; // Start and end pin index per link slot, -1 when unused
+    ImVector<ImVec2> LinkPinPositions; // Grid space start and end pin positions per link slot
+    ImVector<ImRect> LinkRects;      // Grid space, inverted for unused link slots
+    ImBitVector      Visited;
+    ImVector<int>    Candidates;
+
+    ImBoxSelectorIndex() : Valid(false) {}
+};
+
+// Pin occlusion computed by EndNodeEditor(). A pin is occluded when a node above its parent in the
+// depth order covers it. The result only depends on the node rects in depth order and on the
+// position and parent of each pin, so it is kept until one of those changes. They are kept in grid
+// space, where panning and zooming do not move them.
+struct ImPinOcclusionCache
+{
+    ImBitVector      OccludedPins; // Bit i is set when pin i is occluded
+    ImSpatialGrid    NodeGrid;     // Items are depth order positions
+    ImVector<ImRect> NodeRects;    // Grid space, indexed by depth order position
+    ImVector<ImVec2> PinPositions; // Grid space
+    ImVector<int>    PinDepths; // Depth order position of the parent node, -1 for unused pins
+
+    // Scratch state for the current frame, swapped with the above when it differs
+    ImVector<ImRect> NextNodeRects;
+    ImVector<ImVec2> NextPinPositions;
+    ImVector<int>    NextPinDepths;
+    ImVector<int>    Candidates;
+};
+
 struct ImNodesColElement
 {
     ImU32      Color;
@@ -252,6 +413,11 @@ struct ImNodesEditorContext
 
     ImVector<int> NodeDepthOrder;
 
+    // Structure-of-arrays mirror of Pins.Pool[i].Pos, refreshed by BeginPinAttribute() and
+    // DrawPin(). Only slots of pins in use this frame are meaningful.
+    ImVector<float> PinPosX;
+    ImVector<float> PinPosY;
+
     // ui related fields
     float  ZoomScale;
     ImVec2 Panning;
@@ -269,6 +435,8 @@ struct ImNodesEditorContext
     ImVec2           PrimaryNodeOffset;
 
     ImClickInteractionState ClickInteraction;
+    ImBoxSelectorIndex      BoxSelectorIndex;
+    ImPinOcclusionCache     PinOcclusion;
 
     // Mini-map state set by MiniMap()
 
@@ -305,7 +473,7 @@ struct ImNodesContext
     ImGuiStorage  NodeIdxToSubmissionIdx;
     ImVector<int> NodeIdxSubmissionOrder;
     ImVector<int> NodeIndicesOverlappingWithMouse;
-    ImVector<int> OccludedPinIndices;
+    ImVector<ImVec2> LinkPolyline; // Scratch buffer for the screen space points of a link path
 
     // Canvas extents
     ImVec2 CanvasOriginalOrigin;
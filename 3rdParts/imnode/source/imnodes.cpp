@@ -61,25 +61,169 @@ inline ImVec2 EvalCubicBezier(
         b0 * P0.y + b1 * P1.y + b2 * P2.y + b3 * P3.y);
 }
 
+// Number of curve samples handled per batch by the vectorized helpers below. Kept small so the
+// SoA scratch buffers live on the stack.
+static const int BEZIER_BATCH_SIZE = 64;
+
+// Evaluates the curve at t = t_step * i for i in [first, first + count) and writes the results
+// into the SoA arrays out_x/out_y. Every lane performs the same operations in the same order as
+// EvalCubicBezier(), so the results are bit-identical to the scalar path.
+void EvalCubicBezierBatch(
+    const CubicBezier& cb,
+    const float        t_step,
+    const int          first,
+    const int          count,
+    float*             out_x,
+    float*             out_y)
+{
+    int i = 0;
+#if defined(IMGUI_ENABLE_SSE) && defined(__AVX2__)
+    {
+        const __m256 lane = _mm256_set_ps(7.f, 6.f, 5.f, 4.f, 3.f, 2.f, 1.f, 0.f);
+        const __m256 step = _mm256_set1_ps(t_step);
+        const __m256 one = _mm256_set1_ps(1.f);
+        const __m256 three = _mm256_set1_ps(3.f);
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m256 t =
+                _mm256_mul_ps(step, _mm256_add_ps(_mm256_set1_ps((float)(first + i)), lane));
+            const __m256 u = _mm256_sub_ps(one, t);
+            const __m256 b0 = _mm256_mul_ps(_mm256_mul_ps(u, u), u);
+            const __m256 b1 = _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(three, u), u), t);
+            const __m256 b2 = _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(three, u), t), t);
+            const __m256 b3 = _mm256_mul_ps(_mm256_mul_ps(t, t), t);
+            __m256 x = _mm256_mul_ps(b0, _mm256_set1_ps(cb.P0.x));
+            x = _mm256_add_ps(x, _mm256_mul_ps(b1, _mm256_set1_ps(cb.P1.x)));
+            x = _mm256_add_ps(x, _mm256_mul_ps(b2, _mm256_set1_ps(cb.P2.x)));
+            x = _mm256_add_ps(x, _mm256_mul_ps(b3, _mm256_set1_ps(cb.P3.x)));
+            __m256 y = _mm256_mul_ps(b0, _mm256_set1_ps(cb.P0.y));
+            y = _mm256_add_ps(y, _mm256_mul_ps(b1, _mm256_set1_ps(cb.P1.y)));
+            y = _mm256_add_ps(y, _mm256_mul_ps(b2, _mm256_set1_ps(cb.P2.y)));
+            y = _mm256_add_ps(y, _mm256_mul_ps(b3, _mm256_set1_ps(cb.P3.y)));
+            _mm256_storeu_ps(out_x + i, x);
+            _mm256_storeu_ps(out_y + i, y);
+        }
+    }
+#endif
+#if defined(IMGUI_ENABLE_SSE)
+    {
+        const __m128 lane = _mm_set_ps(3.f, 2.f, 1.f, 0.f);
+        const __m128 step = _mm_set1_ps(t_step);
+        const __m128 one = _mm_set1_ps(1.f);
+        const __m128 three = _mm_set1_ps(3.f);
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128 t = _mm_mul_ps(step, _mm_add_ps(_mm_set1_ps((float)(first + i)), lane));
+            const __m128 u = _mm_sub_ps(one, t);
+            const __m128 b0 = _mm_mul_ps(_mm_mul_ps(u, u), u);
+            const __m128 b1 = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(three, u), u), t);
+            const __m128 b2 = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(three, u), t), t);
+            const __m128 b3 = _mm_mul_ps(_mm_mul_ps(t, t), t);
+            __m128 x = _mm_mul_ps(b0, _mm_set1_ps(cb.P0.x));
+            x = _mm_add_ps(x, _mm_mul_ps(b1, _mm_set1_ps(cb.P1.x)));
+            x = _mm_add_ps(x, _mm_mul_ps(b2, _mm_set1_ps(cb.P2.x)));
+            x = _mm_add_ps(x, _mm_mul_ps(b3, _mm_set1_ps(cb.P3.x)));
+            __m128 y = _mm_mul_ps(b0, _mm_set1_ps(cb.P0.y));
+            y = _mm_add_ps(y, _mm_mul_ps(b1, _mm_set1_ps(cb.P1.y)));
+            y = _mm_add_ps(y, _mm_mul_ps(b2, _mm_set1_ps(cb.P2.y)));
+            y = _mm_add_ps(y, _mm_mul_ps(b3, _mm_set1_ps(cb.P3.y)));
+            _mm_storeu_ps(out_x + i, x);
+            _mm_storeu_ps(out_y + i, y);
+        }
+    }
+#endif
+    // Scalar fallback, also handles the tail of the vectorized loops
+    for (; i < count; ++i)
+    {
+        const ImVec2 p = EvalCubicBezier(t_step * (float)(first + i), cb.P0, cb.P1, cb.P2, cb.P3);
+        out_x[i] = p.x;
+        out_y[i] = p.y;
+    }
+}
+
+// For each segment (xs[k], ys[k]) -> (xs[k + 1], ys[k + 1]), k in [0, count), computes the point
+// on the segment closest to p and its squared distance to p. Mirrors ImLineClosestPoint().
+void ClosestPointOnSegmentsBatch(
+    const ImVec2& p,
+    const float*  xs,
+    const float*  ys,
+    const int     count,
+    float*        out_x,
+    float*        out_y,
+    float*        out_dist_sqr)
+{
+    int k = 0;
+#if defined(IMGUI_ENABLE_SSE)
+    {
+        const __m128 px = _mm_set1_ps(p.x);
+        const __m128 py = _mm_set1_ps(p.y);
+        const __m128 zero = _mm_setzero_ps();
+        for (; k + 4 <= count; k += 4)
+        {
+            const __m128 ax = _mm_loadu_ps(xs + k);
+            const __m128 ay = _mm_loadu_ps(ys + k);
+            const __m128 bx = _mm_loadu_ps(xs + k + 1);
+            const __m128 by = _mm_loadu_ps(ys + k + 1);
+            const __m128 ab_x = _mm_sub_ps(bx, ax);
+            const __m128 ab_y = _mm_sub_ps(by, ay);
+            const __m128 dot = _mm_add_ps(
+                _mm_mul_ps(_mm_sub_ps(px, ax), ab_x), _mm_mul_ps(_mm_sub_ps(py, ay), ab_y));
+            const __m128 len_sqr = _mm_add_ps(_mm_mul_ps(ab_x, ab_x), _mm_mul_ps(ab_y, ab_y));
+            __m128 cx = _mm_add_ps(ax, _mm_div_ps(_mm_mul_ps(ab_x, dot), len_sqr));
+            __m128 cy = _mm_add_ps(ay, _mm_div_ps(_mm_mul_ps(ab_y, dot), len_sqr));
+            // dot > len_sqr -> b, dot < 0 -> a (checked last so it takes precedence)
+            const __m128 past_end = _mm_cmpgt_ps(dot, len_sqr);
+            cx = _mm_or_ps(_mm_and_ps(past_end, bx), _mm_andnot_ps(past_end, cx));
+            cy = _mm_or_ps(_mm_and_ps(past_end, by), _mm_andnot_ps(past_end, cy));
+            const __m128 before_start = _mm_cmplt_ps(dot, zero);
+            cx = _mm_or_ps(_mm_and_ps(before_start, ax), _mm_andnot_ps(before_start, cx));
+            cy = _mm_or_ps(_mm_and_ps(before_start, ay), _mm_andnot_ps(before_start, cy));
+            const __m128 dx = _mm_sub_ps(px, cx);
+            const __m128 dy = _mm_sub_ps(py, cy);
+            _mm_storeu_ps(out_x + k, cx);
+            _mm_storeu_ps(out_y + k, cy);
+            _mm_storeu_ps(out_dist_sqr + k, _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+        }
+    }
+#endif
+    for (; k < count; ++k)
+    {
+        const ImVec2 closest =
+            ImLineClosestPoint(ImVec2(xs[k], ys[k]), ImVec2(xs[k + 1], ys[k + 1]), p);
+        out_x[k] = closest.x;
+        out_y[k] = closest.y;
+        out_dist_sqr[k] = ImLengthSqr(p - closest);
+    }
+}
+
 // Calculates the closest point along each bezier curve segment.
 ImVec2 GetClosestPointOnCubicBezier(const int num_segments, const ImVec2& p, const CubicBezier& cb)
 {
     IM_ASSERT(num_segments > 0);
-    ImVec2 p_last = cb.P0;
+    // Slot 0 of the sample buffers holds the last point of the previous batch
+    float  xs[BEZIER_BATCH_SIZE + 1], ys[BEZIER_BATCH_SIZE + 1];
+    float  closest_x[BEZIER_BATCH_SIZE], closest_y[BEZIER_BATCH_SIZE];
+    float  dist_sqr[BEZIER_BATCH_SIZE];
     ImVec2 p_closest;
     float  p_closest_dist = FLT_MAX;
     float  t_step = 1.0f / (float)num_segments;
-    for (int i = 1; i <= num_segments; ++i)
-    {
-        ImVec2 p_current = EvalCubicBezier(t_step * i, cb.P0, cb.P1, cb.P2, cb.P3);
-        ImVec2 p_line = ImLineClosestPoint(p_last, p_current, p);
-        float  dist = ImLengthSqr(p - p_line);
-        if (dist < p_closest_dist)
+    xs[0] = cb.P0.x;
+    ys[0] = cb.P0.y;
+    for (int first = 1; first <= num_segments; first += BEZIER_BATCH_SIZE)
+    {
+        const int count = ImMin(BEZIER_BATCH_SIZE, num_segments - first + 1);
+        EvalCubicBezierBatch(cb, t_step, first, count, xs + 1, ys + 1);
+        ClosestPointOnSegmentsBatch(p, xs, ys, count, closest_x, closest_y, dist_sqr);
+        for (int k = 0; k < count; ++k)
         {
-            p_closest = p_line;
-            p_closest_dist = dist;
+            if (dist_sqr[k] < p_closest_dist)
+            {
+                p_closest = ImVec2(closest_x[k], closest_y[k]);
+                p_closest_dist = dist_sqr[k];
+            }
         }
-        p_last = p_current;
+        xs[0] = xs[count];
+        ys[0] = ys[count];
     }
     return p_closest;
 }
@@ -95,16 +239,24 @@ inline float GetDistanceToCubicBezier(
     return ImSqrt(ImLengthSqr(to_curve));
 }
 
-inline ImRect GetContainingRectForCubicBezier(const CubicBezier& cb)
+// The curve lies inside the convex hull of its control points, so their bounds contain it.
+inline ImRect GetCubicBezierHull(const CubicBezier& cb)
 {
     const ImVec2 min = ImVec2(ImMin(cb.P0.x, cb.P3.x), ImMin(cb.P0.y, cb.P3.y));
     const ImVec2 max = ImVec2(ImMax(cb.P0.x, cb.P3.x), ImMax(cb.P0.y, cb.P3.y));
 
-    const float hover_distance = GImNodes->Style.LinkHoverDistance;
-
     ImRect rect(min, max);
     rect.Add(cb.P1);
     rect.Add(cb.P2);
+
+    return rect;
+}
+
+inline ImRect GetContainingRectForCubicBezier(const CubicBezier& cb)
+{
+    const float hover_distance = GImNodes->Style.LinkHoverDistance;
+
+    ImRect rect = GetCubicBezierHull(cb);
     rect.Expand(ImVec2(hover_distance, hover_distance));
 
     return rect;
@@ -192,22 +344,24 @@ inline bool RectangleOverlapsLineSegment(const ImRect& rect, const ImVec2& p1, c
 
 inline bool RectangleOverlapsBezier(const ImRect& rectangle, const CubicBezier& cubic_bezier)
 {
-    ImVec2 current =
-        EvalCubicBezier(0.f, cubic_bezier.P0, cubic_bezier.P1, cubic_bezier.P2, cubic_bezier.P3);
+    float xs[BEZIER_BATCH_SIZE + 1], ys[BEZIER_BATCH_SIZE + 1];
+    xs[0] = cubic_bezier.P0.x;
+    ys[0] = cubic_bezier.P0.y;
     const float dt = 1.0f / cubic_bezier.NumSegments;
-    for (int s = 0; s < cubic_bezier.NumSegments; ++s)
+    for (int first = 1; first <= cubic_bezier.NumSegments; first += BEZIER_BATCH_SIZE)
     {
-        ImVec2 next = EvalCubicBezier(
-            static_cast<float>((s + 1) * dt),
-            cubic_bezier.P0,
-            cubic_bezier.P1,
-            cubic_bezier.P2,
-            cubic_bezier.P3);
-        if (RectangleOverlapsLineSegment(rectangle, current, next))
+        const int count = ImMin(BEZIER_BATCH_SIZE, cubic_bezier.NumSegments - first + 1);
+        EvalCubicBezierBatch(cubic_bezier, dt, first, count, xs + 1, ys + 1);
+        for (int k = 0; k < count; ++k)
         {
-            return true;
+            if (RectangleOverlapsLineSegment(
+                    rectangle, ImVec2(xs[k], ys[k]), ImVec2(xs[k + 1], ys[k + 1])))
+            {
+                return true;
+            }
         }
-        current = next;
+        xs[0] = xs[count];
+        ys[0] = ys[count];
     }
     return false;
 }
@@ -303,6 +457,417 @@ inline ImRect ScreenSpaceToMiniMapSpace(const ImNodesEditorContext& editor, cons
         ScreenSpaceToMiniMapSpace(editor, r.Min), ScreenSpaceToMiniMapSpace(editor, r.Max));
 }
 
+// [SECTION] link path helpers
+
+// Screen space points of a link drawn through its path, see ImLinkData::Path. The pins are joined
+// to the path horizontally, consecutive duplicates are dropped so every segment has a length.
+inline void GetLinkPolyline(
+    const ImNodesEditorContext& editor,
+    const ImLinkData&           link,
+    const ImVec2&               start,
+    const ImVec2&               end,
+    ImVector<ImVec2>&           points)
+{
+    IM_ASSERT(!link.Path.empty());
+    points.resize(0);
+
+    const auto add_point = [&points](const ImVec2& point) {
+        if (points.empty() || points.back().x != point.x || points.back().y != point.y)
+        {
+            points.push_back(point);
+        }
+    };
+
+    add_point(start);
+    add_point(ImVec2(GridSpaceToScreenSpace(editor, link.Path.front()).x, start.y));
+    for (const ImVec2& corner : link.Path)
+    {
+        add_point(GridSpaceToScreenSpace(editor, corner));
+    }
+    add_point(ImVec2(points.back().x, end.y));
+    add_point(end);
+}
+
+inline ImRect GetPolylineBounds(const ImVector<ImVec2>& points)
+{
+    ImRect rect(points[0], points[0]);
+    for (const ImVec2& point : points)
+    {
+        rect.Add(point);
+    }
+    return rect;
+}
+
+inline ImRect GetContainingRectForPolyline(const ImVector<ImVec2>& points)
+{
+    ImRect      rect = GetPolylineBounds(points);
+    const float hover_distance = GImNodes->Style.LinkHoverDistance;
+    rect.Expand(ImVec2(hover_distance, hover_distance));
+    return rect;
+}
+
+inline float GetDistanceToPolyline(const ImVec2& p, const ImVector<ImVec2>& points)
+{
+    float smallest_distance_sqr = FLT_MAX;
+    for (int i = 1; i < points.Size; ++i)
+    {
+        const ImVec2 closest = ImLineClosestPoint(points[i - 1], points[i], p);
+        smallest_distance_sqr = ImMin(smallest_distance_sqr, ImLengthSqr(closest - p));
+    }
+    return ImSqrt(smallest_distance_sqr);
+}
+
+inline bool RectangleOverlapsPolyline(const ImRect& rectangle, const ImVector<ImVec2>& points)
+{
+    for (int i = 1; i < points.Size; ++i)
+    {
+        if (RectangleOverlapsLineSegment(rectangle, points[i - 1], points[i]))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// [SECTION] spatial index
+
+inline ImRect GetInvertedRect() { return ImRect(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX); }
+
+inline int SpatialGridCellX(const ImSpatialGrid& grid, const int level, const float x)
+{
+    const ImSpatialGridLevel& l = grid.Levels[level];
+    return ImClamp((int)((x - grid.Origin.x) / l.CellSize), 0, l.Cols - 1);
+}
+
+inline int SpatialGridCellY(const ImSpatialGrid& grid, const int level, const float y)
+{
+    const ImSpatialGridLevel& l = grid.Levels[level];
+    return ImClamp((int)((y - grid.Origin.y) / l.CellSize), 0, l.Rows - 1);
+}
+
+// Lowest level whose cells are at least as large as the rect.
+inline int SpatialGridLevelFor(const ImSpatialGrid& grid, const ImRect& r)
+{
+    const float extent = ImMax(r.GetWidth(), r.GetHeight());
+    int         level = 0;
+    while (level < IMNODES_SPATIAL_GRID_LEVELS - 1 && grid.Levels[level].CellSize < extent)
+    {
+        ++level;
+    }
+    return level;
+}
+
+// Buckets every non-inverted rect into the grid, using its index in `rects` as the item.
+void SpatialGridBuild(ImSpatialGrid& grid, const ImVector<ImRect>& rects)
+{
+    ImRect bounds = GetInvertedRect();
+    int    rect_count = 0;
+    for (int i = 0; i < rects.Size; ++i)
+    {
+        if (!rects[i].IsInverted())
+        {
+            bounds.Add(rects[i]);
+            ++rect_count;
+        }
+    }
+
+    for (int level = 0; level < IMNODES_SPATIAL_GRID_LEVELS; ++level)
+    {
+        ImSpatialGridLevel& l = grid.Levels[level];
+        l.Cols = l.Rows = 0;
+        l.CellStart.resize(0);
+        l.Items.resize(0);
+    }
+    if (rect_count == 0)
+    {
+        return;
+    }
+
+    // Aim for about one rect per finest cell, but never let the cell count grow far past the rect
+    // count
+    const ImVec2 size = ImMax(bounds.GetSize(), ImVec2(1.f, 1.f));
+    float        cell_size = ImMax(ImSqrt(size.x * size.y / (float)rect_count), 1.f);
+    while (((ImS64)(size.x / cell_size) + 1) * ((ImS64)(size.y / cell_size) + 1) >
+           4 * (ImS64)rect_count + 16)
+    {
+        cell_size *= 2.f;
+    }
+
+    grid.Origin = bounds.Min;
+    for (int level = 0; level < IMNODES_SPATIAL_GRID_LEVELS; ++level)
+    {
+        ImSpatialGridLevel& l = grid.Levels[level];
+        l.CellSize = cell_size;
+        l.Cols = (int)(size.x / cell_size) + 1;
+        l.Rows = (int)(size.y / cell_size) + 1;
+        l.CellStart.resize(l.Cols * l.Rows + 1);
+        memset(l.CellStart.Data, 0, l.CellStart.size_in_bytes());
+        cell_size *= 2.f;
+    }
+
+    // Counting pass, then prefix sums turn the counts into cell offsets
+    for (int i = 0; i < rects.Size; ++i)
+    {
+        const ImRect& r = rects[i];
+        if (r.IsInverted())
+        {
+            continue;
+        }
+        const int           level = SpatialGridLevelFor(grid, r);
+        ImSpatialGridLevel& l = grid.Levels[level];
+        const int           x_max = SpatialGridCellX(grid, level, r.Max.x);
+        const int           y_max = SpatialGridCellY(grid, level, r.Max.y);
+        for (int y = SpatialGridCellY(grid, level, r.Min.y); y <= y_max; ++y)
+        {
+            for (int x = SpatialGridCellX(grid, level, r.Min.x); x <= x_max; ++x)
+            {
+                ++l.CellStart[y * l.Cols + x + 1];
+            }
+        }
+    }
+
+    ImVector<int> fill_offsets[IMNODES_SPATIAL_GRID_LEVELS];
+    for (int level = 0; level < IMNODES_SPATIAL_GRID_LEVELS; ++level)
+    {
+        ImSpatialGridLevel& l = grid.Levels[level];
+        for (int c = 0; c < l.Cols * l.Rows; ++c)
+        {
+            l.CellStart[c + 1] += l.CellStart[c];
+        }
+        l.Items.resize(l.CellStart.back());
+        fill_offsets[level] = l.CellStart;
+    }
+
+    for (int i = 0; i < rects.Size; ++i)
+    {
+        const ImRect& r = rects[i];
+        if (r.IsInverted())
+        {
+            continue;
+        }
+        const int           level = SpatialGridLevelFor(grid, r);
+        ImSpatialGridLevel& l = grid.Levels[level];
+        const int           x_max = SpatialGridCellX(grid, level, r.Max.x);
+        const int           y_max = SpatialGridCellY(grid, level, r.Max.y);
+        for (int y = SpatialGridCellY(grid, level, r.Min.y); y <= y_max; ++y)
+        {
+            for (int x = SpatialGridCellX(grid, level, r.Min.x); x <= x_max; ++x)
+            {
+                l.Items[fill_offsets[level][y * l.Cols + x]++] = i;
+            }
+        }
+    }
+}
+
+// Appends every item whose cells overlap `rect`. Items already flagged in `visited` are skipped,
+// so an item spanning several cells is reported once.
+void SpatialGridQuery(
+    const ImSpatialGrid& grid,
+    const ImRect&        rect,
+    ImBitVector&         visited,
+    ImVector<int>&       candidates)
+{
+    for (int level = 0; level < IMNODES_SPATIAL_GRID_LEVELS; ++level)
+    {
+        const ImSpatialGridLevel& l = grid.Levels[level];
+        if (l.Items.empty())
+        {
+            continue;
+        }
+
+        // Every indexed rect lies within the cells of the grid, so a query outside them has no
+        // candidates on this level
+        const ImRect extent(
+            grid.Origin, grid.Origin + ImVec2((float)l.Cols, (float)l.Rows) * l.CellSize);
+        if (rect.Max.x < extent.Min.x || rect.Min.x > extent.Max.x ||
+            rect.Max.y < extent.Min.y || rect.Min.y > extent.Max.y)
+        {
+            continue;
+        }
+
+        const int x_min = SpatialGridCellX(grid, level, rect.Min.x);
+        const int x_max = SpatialGridCellX(grid, level, rect.Max.x);
+        const int y_max = SpatialGridCellY(grid, level, rect.Max.y);
+        for (int y = SpatialGridCellY(grid, level, rect.Min.y); y <= y_max; ++y)
+        {
+            for (int x = x_min; x <= x_max; ++x)
+            {
+                const int cell = y * l.Cols + x;
+                for (int i = l.CellStart[cell]; i < l.CellStart[cell + 1]; ++i)
+                {
+                    const int item = l.Items[i];
+                    if (!visited.TestBit(item))
+                    {
+                        visited.SetBit(item);
+                        candidates.push_back(item);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Appends every item stored in a cell containing `pos`. Each item lives in a single level, so no
+// item is reported twice.
+void SpatialGridQueryPoint(const ImSpatialGrid& grid, const ImVec2& pos, ImVector<int>& candidates)
+{
+    for (int level = 0; level < IMNODES_SPATIAL_GRID_LEVELS; ++level)
+    {
+        const ImSpatialGridLevel& l = grid.Levels[level];
+        if (l.Items.empty())
+        {
+            continue;
+        }
+
+        const int cell =
+            SpatialGridCellY(grid, level, pos.y) * l.Cols + SpatialGridCellX(grid, level, pos.x);
+        for (int i = l.CellStart[cell]; i < l.CellStart[cell + 1]; ++i)
+        {
+            candidates.push_back(l.Items[i]);
+        }
+    }
+}
+
+// Node rects are indexed with a small margin so float noise from panning does not count as a move.
+static const float BOX_SELECTOR_INDEX_MARGIN = 1.0f;
+// A link whose pins moved less than this since it was indexed is still inside its margin.
+static const float BOX_SELECTOR_PIN_TOLERANCE = 1.f / 16.f;
+
+ImVec2 GetScreenSpacePinCoordinates(const ImNodesEditorContext& editor, const ImPinData& pin);
+
+// Screen space bounds of a link: the hull of its curve's control points, or the bounds of its
+// path.
+inline ImRect GetLinkBounds(const ImNodesEditorContext& editor, const ImLinkData& link)
+{
+    const ImPinData& pin_start = editor.Pins.Pool[link.StartPinIdx];
+    const ImVec2     start = GetScreenSpacePinCoordinates(editor, pin_start);
+    const ImVec2     end = GetScreenSpacePinCoordinates(editor, editor.Pins.Pool[link.EndPinIdx]);
+    if (link.Path.empty())
+    {
+        return GetCubicBezierHull(GetCubicBezier(
+            start, end, pin_start.Type, GImNodes->Style.LinkLineSegmentsPerLength));
+    }
+    GetLinkPolyline(editor, link, start, end, GImNodes->LinkPolyline);
+    return GetPolylineBounds(GImNodes->LinkPolyline);
+}
+
+inline ImVec2 GetGridSpacePinCoordinates(const ImNodesEditorContext& editor, const int pin_idx)
+{
+    return ScreenSpaceToGridSpace(
+        editor, GetScreenSpacePinCoordinates(editor, editor.Pins.Pool[pin_idx]));
+}
+
+void BoxSelectorIndexBuild(ImNodesEditorContext& editor)
+{
+    ImBoxSelectorIndex& index = editor.BoxSelectorIndex;
+
+    index.NodeRects.resize(editor.Nodes.Pool.Size);
+    for (int node_idx = 0; node_idx < editor.Nodes.Pool.Size; ++node_idx)
+    {
+        if (editor.Nodes.InUse[node_idx])
+        {
+            ImRect rect = ScreenSpaceToGridSpace(editor, editor.Nodes.Pool[node_idx].Rect);
+            rect.Expand(BOX_SELECTOR_INDEX_MARGIN);
+            index.NodeRects[node_idx] = rect;
+        }
+        else
+        {
+            index.NodeRects[node_idx] = GetInvertedRect();
+        }
+    }
+    SpatialGridBuild(index.NodeGrid, index.NodeRects);
+
+    // Links are indexed with the bounds of their curve or path, checked again when they are
+    // submitted.
+    ImVector<ImRect>& link_rects = index.LinkRects;
+    link_rects.resize(editor.Links.Pool.Size);
+    index.LinkPinIndices.resize(editor.Links.Pool.Size * 2);
+    index.LinkPinPositions.resize(editor.Links.Pool.Size * 2);
+    for (int link_idx = 0; link_idx < editor.Links.Pool.Size; ++link_idx)
+    {
+        if (!editor.Links.InUse[link_idx])
+        {
+            link_rects[link_idx] = GetInvertedRect();
+            index.LinkPinIndices[link_idx * 2] = -1;
+            index.LinkPinIndices[link_idx * 2 + 1] = -1;
+            continue;
+        }
+
+        const ImLinkData& link = editor.Links.Pool[link_idx];
+        ImRect            rect = ScreenSpaceToGridSpace(editor, GetLinkBounds(editor, link));
+        rect.Expand(BOX_SELECTOR_INDEX_MARGIN);
+        link_rects[link_idx] = rect;
+        index.LinkPinIndices[link_idx * 2] = link.StartPinIdx;
+        index.LinkPinIndices[link_idx * 2 + 1] = link.EndPinIdx;
+        index.LinkPinPositions[link_idx * 2] = GetGridSpacePinCoordinates(editor, link.StartPinIdx);
+        index.LinkPinPositions[link_idx * 2 + 1] =
+            GetGridSpacePinCoordinates(editor, link.EndPinIdx);
+    }
+    SpatialGridBuild(index.LinkGrid, link_rects);
+
+    index.Valid = true;
+}
+
+// Called while box selecting, after the node's rect has been computed for this frame.
+inline void BoxSelectorIndexCheckNode(ImNodesEditorContext& editor, const int node_idx)
+{
+    ImBoxSelectorIndex& index = editor.BoxSelectorIndex;
+    if (index.Valid &&
+        (node_idx >= index.NodeRects.Size ||
+         !index.NodeRects[node_idx].Contains(
+             ScreenSpaceToGridSpace(editor, editor.Nodes.Pool[node_idx].Rect))))
+    {
+        index.Valid = false;
+    }
+}
+
+inline bool BoxSelectorPinStayed(const ImVec2& indexed, const ImVec2& pos)
+{
+    return ImFabs(indexed.x - pos.x) <= BOX_SELECTOR_PIN_TOLERANCE &&
+           ImFabs(indexed.y - pos.y) <= BOX_SELECTOR_PIN_TOLERANCE;
+}
+
+// Called while box selecting, whenever a link is submitted. The curve of a link only depends on
+// its pins, so its bounds are only computed again once one of them moved. Path corners are in grid
+// space already and are checked as they are.
+inline void BoxSelectorIndexCheckLink(ImNodesEditorContext& editor, const int link_idx)
+{
+    ImBoxSelectorIndex& index = editor.BoxSelectorIndex;
+    const ImLinkData&   link = editor.Links.Pool[link_idx];
+    if (!index.Valid)
+    {
+        return;
+    }
+    if (link_idx * 2 >= index.LinkPinIndices.Size ||
+        index.LinkPinIndices[link_idx * 2] != link.StartPinIdx ||
+        index.LinkPinIndices[link_idx * 2 + 1] != link.EndPinIdx)
+    {
+        index.Valid = false;
+        return;
+    }
+
+    const ImRect& rect = index.LinkRects[link_idx];
+    if (!BoxSelectorPinStayed(
+            index.LinkPinPositions[link_idx * 2],
+            GetGridSpacePinCoordinates(editor, link.StartPinIdx)) ||
+        !BoxSelectorPinStayed(
+            index.LinkPinPositions[link_idx * 2 + 1],
+            GetGridSpacePinCoordinates(editor, link.EndPinIdx)))
+    {
+        index.Valid =
+            rect.Contains(ScreenSpaceToGridSpace(editor, GetLinkBounds(editor, link)));
+        return;
+    }
+    for (int i = 0; i < link.Path.Size; ++i)
+    {
+        if (!rect.Contains(link.Path[i]))
+        {
+            index.Valid = false;
+            return;
+        }
+    }
+}
+
 // [SECTION] draw list helper
 
 void ImDrawListGrowChannels(ImDrawList* draw_list, const int num_channels)
@@ -561,6 +1126,18 @@ ImVec2 GetScreenSpacePinCoordinates(const ImNodesEditorContext& editor, const Im
     return GetScreenSpacePinCoordinates(parent_node_rect, pin.AttributeRect, pin.Type);
 }
 
+// Copies the pin's current position into the editor's SoA mirror, growing it with the pool.
+inline void SyncPinPosMirror(ImNodesEditorContext& editor, const int pin_idx)
+{
+    if (editor.PinPosX.Size < editor.Pins.Pool.Size)
+    {
+        editor.PinPosX.resize(editor.Pins.Pool.Size);
+        editor.PinPosY.resize(editor.Pins.Pool.Size);
+    }
+    editor.PinPosX[pin_idx] = editor.Pins.Pool[pin_idx].Pos.x;
+    editor.PinPosY[pin_idx] = editor.Pins.Pool[pin_idx].Pos.y;
+}
+
 bool MouseInCanvas()
 {
     return GImNodes->IsHovered;
@@ -738,9 +1315,15 @@ void BeginCanvasInteraction(ImNodesEditorContext& editor)
         editor.ClickInteraction.Type = ImNodesClickInteractionType_BoxSelection;
         editor.ClickInteraction.BoxSelector.Rect.Min =
             ScreenSpaceToGridSpace(editor, GImNodes->MousePos);
+        editor.BoxSelectorIndex.Valid = false;
     }
 }
 
+int CompareInts(const void* lhs, const void* rhs)
+{
+    return *static_cast<const int*>(lhs) - *static_cast<const int*>(rhs);
+}
+
 void BoxSelectorUpdateSelection(ImNodesEditorContext& editor, ImRect box_rect)
 {
     // Invert box selector coordinates as needed
@@ -755,15 +1338,33 @@ void BoxSelectorUpdateSelection(ImNodesEditorContext& editor, ImRect box_rect)
         ImSwap(box_rect.Min.y, box_rect.Max.y);
     }
 
+    ImBoxSelectorIndex& index = editor.BoxSelectorIndex;
+    if (!index.Valid)
+    {
+        BoxSelectorIndexBuild(editor);
+    }
+
+    // Node rects were computed before any auto-panning applied this frame, so widen the query by
+    // the panning step to stay conservative.
+    ImRect query_rect = ScreenSpaceToGridSpace(editor, box_rect);
+    query_rect.Expand(ImVec2(ImFabs(editor.AutoPanningDelta.x), ImFabs(editor.AutoPanningDelta.y)));
+
     // Update node selection
 
     editor.SelectedNodeIndices.clear();
 
-    // Test for overlap against node rectangles
+    // Test for overlap against the rectangles of nearby nodes. Candidates are sorted so the
+    // selection keeps pool order.
 
-    for (int node_idx = 0; node_idx < editor.Nodes.Pool.size(); ++node_idx)
+    index.Candidates.resize(0);
+    index.Visited.Create(editor.Nodes.Pool.Size);
+    SpatialGridQuery(index.NodeGrid, query_rect, index.Visited, index.Candidates);
+    ImQsort(index.Candidates.Data, (size_t)index.Candidates.Size, sizeof(int), CompareInts);
+
+    for (int i = 0; i < index.Candidates.Size; ++i)
     {
-        if (editor.Nodes.InUse[node_idx])
+        const int node_idx = index.Candidates[i];
+        if (node_idx < editor.Nodes.Pool.Size && editor.Nodes.InUse[node_idx])
         {
             ImNodeData& node = editor.Nodes.Pool[node_idx];
             if (box_rect.Overlaps(node.Rect))
@@ -777,11 +1378,17 @@ void BoxSelectorUpdateSelection(ImNodesEditorContext& editor, ImRect box_rect)
 
     editor.SelectedLinkIndices.clear();
 
-    // Test for overlap against links
+    // Test for overlap against nearby links
 
-    for (int link_idx = 0; link_idx < editor.Links.Pool.size(); ++link_idx)
+    index.Candidates.resize(0);
+    index.Visited.Create(editor.Links.Pool.Size);
+    SpatialGridQuery(index.LinkGrid, query_rect, index.Visited, index.Candidates);
+    ImQsort(index.Candidates.Data, (size_t)index.Candidates.Size, sizeof(int), CompareInts);
+
+    for (int i = 0; i < index.Candidates.Size; ++i)
     {
-        if (editor.Links.InUse[link_idx])
+        const int link_idx = index.Candidates[i];
+        if (link_idx < editor.Links.Pool.Size && editor.Links.InUse[link_idx])
         {
             const ImLinkData& link = editor.Links.Pool[link_idx];
 
@@ -795,8 +1402,22 @@ void BoxSelectorUpdateSelection(ImNodesEditorContext& editor, ImRect box_rect)
             const ImVec2 end =
                 GetScreenSpacePinCoordinates(node_end_rect, pin_end.AttributeRect, pin_end.Type);
 
-            // Test
-            if (RectangleOverlapsLink(box_rect, start, end, pin_start.Type))
+            // Test, links whose bounds lie inside the box need no exact test
+            bool overlaps = false;
+            if (link.Path.empty())
+            {
+                const CubicBezier cubic_bezier = GetCubicBezier(
+                    start, end, pin_start.Type, GImNodes->Style.LinkLineSegmentsPerLength);
+                overlaps = box_rect.Contains(GetCubicBezierHull(cubic_bezier)) ||
+                           RectangleOverlapsLink(box_rect, start, end, pin_start.Type);
+            }
+            else
+            {
+                GetLinkPolyline(editor, link, start, end, GImNodes->LinkPolyline);
+                overlaps = box_rect.Contains(GetPolylineBounds(GImNodes->LinkPolyline)) ||
+                           RectangleOverlapsPolyline(box_rect, GImNodes->LinkPolyline);
+            }
+            if (overlaps)
             {
                 editor.SelectedLinkIndices.push_back(link_idx);
             }
@@ -1120,71 +1741,215 @@ void ClickInteractionUpdate(ImNodesEditorContext& editor)
     }
 }
 
-void ResolveOccludedPins(const ImNodesEditorContext& editor, ImVector<int>& occluded_pin_indices)
+template<typename T>
+inline bool VectorContentsEqual(const ImVector<T>& lhs, const ImVector<T>& rhs)
+{
+    return lhs.Size == rhs.Size && memcmp(lhs.Data, rhs.Data, lhs.size_in_bytes()) == 0;
+}
+
+// Grid space positions worked out from screen space pick up a rounding error that changes from
+// one pan to the next. It is far below anything that decides whether a pin is covered.
+static const float PIN_OCCLUSION_TOLERANCE = 1.f / 16.f;
+
+inline bool NearlyEqual(const ImVec2& lhs, const ImVec2& rhs)
+{
+    return ImFabs(lhs.x - rhs.x) <= PIN_OCCLUSION_TOLERANCE &&
+           ImFabs(lhs.y - rhs.y) <= PIN_OCCLUSION_TOLERANCE;
+}
+
+inline bool NearlyEqual(const ImRect& lhs, const ImRect& rhs)
+{
+    return NearlyEqual(lhs.Min, rhs.Min) && NearlyEqual(lhs.Max, rhs.Max);
+}
+
+template<typename T>
+inline bool VectorContentsNearlyEqual(const ImVector<T>& lhs, const ImVector<T>& rhs)
+{
+    if (lhs.Size != rhs.Size)
+    {
+        return false;
+    }
+    for (int i = 0; i < lhs.Size; ++i)
+    {
+        if (!NearlyEqual(lhs[i], rhs[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+const ImBitVector& ResolveOccludedPins(ImNodesEditorContext& editor)
 {
     const ImVector<int>& depth_stack = editor.NodeDepthOrder;
+    ImPinOcclusionCache& cache = editor.PinOcclusion;
+
+    cache.NextNodeRects.resize(depth_stack.Size);
+    cache.NextPinDepths.resize(editor.Pins.Pool.Size);
+    cache.NextPinPositions.resize(editor.Pins.Pool.Size);
+    for (int pin_idx = 0; pin_idx < editor.Pins.Pool.Size; ++pin_idx)
+    {
+        cache.NextPinDepths[pin_idx] = -1;
+        cache.NextPinPositions[pin_idx] = ImVec2(0.f, 0.f);
+    }
+
+    for (int depth_idx = 0; depth_idx < depth_stack.Size; ++depth_idx)
+    {
+        // Compared in grid space, a pan or a zoom moves every rect and pin alike and keeps the
+        // result
+        const ImNodeData& node = editor.Nodes.Pool[depth_stack[depth_idx]];
+        cache.NextNodeRects[depth_idx] = ScreenSpaceToGridSpace(editor, node.Rect);
+        for (int idx = 0; idx < node.PinIndices.Size; ++idx)
+        {
+            const int pin_idx = node.PinIndices[idx];
+            cache.NextPinDepths[pin_idx] = depth_idx;
+            cache.NextPinPositions[pin_idx] =
+                ScreenSpaceToGridSpace(editor, editor.Pins.Pool[pin_idx].Pos);
+        }
+    }
+
+    // The cache keeps the positions it was computed for, so that small changes do not add up
+    if (VectorContentsEqual(cache.NextPinDepths, cache.PinDepths) &&
+        VectorContentsNearlyEqual(cache.NextNodeRects, cache.NodeRects) &&
+        VectorContentsNearlyEqual(cache.NextPinPositions, cache.PinPositions))
+    {
+        return cache.OccludedPins;
+    }
 
-    occluded_pin_indices.resize(0);
+    cache.NodeRects.swap(cache.NextNodeRects);
+    cache.PinDepths.swap(cache.NextPinDepths);
+    cache.PinPositions.swap(cache.NextPinPositions);
 
+    cache.OccludedPins.Create(editor.Pins.Pool.Size);
     if (depth_stack.Size < 2)
     {
-        return;
+        return cache.OccludedPins;
     }
 
-    // For each node in the depth stack
-    for (int depth_idx = 0; depth_idx < (depth_stack.Size - 1); ++depth_idx)
-    {
-        const ImNodeData& node_below = editor.Nodes.Pool[depth_stack[depth_idx]];
+    SpatialGridBuild(cache.NodeGrid, cache.NodeRects);
 
-        // Iterate over the rest of the depth stack to find nodes overlapping the pins
-        for (int next_depth_idx = depth_idx + 1; next_depth_idx < depth_stack.Size;
-             ++next_depth_idx)
+    // Each pin is only tested against the nodes bucketed in the cells under it
+    for (int pin_idx = 0; pin_idx < editor.Pins.Pool.Size; ++pin_idx)
+    {
+        const int depth_idx = cache.PinDepths[pin_idx];
+        if (depth_idx < 0)
         {
-            const ImRect& rect_above = editor.Nodes.Pool[depth_stack[next_depth_idx]].Rect;
+            continue;
+        }
 
-            // Iterate over each pin
-            for (int idx = 0; idx < node_below.PinIndices.Size; ++idx)
+        const ImVec2& pin_pos = cache.PinPositions[pin_idx];
+        cache.Candidates.resize(0);
+        SpatialGridQueryPoint(cache.NodeGrid, pin_pos, cache.Candidates);
+        for (int i = 0; i < cache.Candidates.Size; ++i)
+        {
+            const int depth_above = cache.Candidates[i];
+            if (depth_above > depth_idx && cache.NodeRects[depth_above].Contains(pin_pos))
             {
-                const int     pin_idx = node_below.PinIndices[idx];
-                const ImVec2& pin_pos = editor.Pins.Pool[pin_idx].Pos;
-
-                if (rect_above.Contains(pin_pos))
-                {
-                    occluded_pin_indices.push_back(pin_idx);
-                }
+                cache.OccludedPins.SetBit(pin_idx);
+                break;
             }
         }
     }
+
+    return cache.OccludedPins;
 }
 
-ImOptionalIndex ResolveHoveredPin(
+// Pins are hoverable when they are in use this frame and not occluded by another node. Returns
+// one bit per pin for the four pins starting at first_idx.
+inline ImU32 GetHoverablePinMask4(
     const ImObjectPool<ImPinData>& pins,
-    const ImVector<int>&           occluded_pin_indices)
+    const ImBitVector&             occluded_pins,
+    const int                      first_idx)
+{
+    const bool* in_use = pins.InUse.Data + first_idx;
+    const ImU32 in_use_mask =
+        ImU32(in_use[0]) | ImU32(in_use[1]) << 1 | ImU32(in_use[2]) << 2 | ImU32(in_use[3]) << 3;
+    const ImU32 occluded_mask = (occluded_pins.Storage[first_idx >> 5] >> (first_idx & 31)) & 0xF;
+    return in_use_mask & ~occluded_mask;
+}
+
+ImOptionalIndex ResolveHoveredPin(
+    const ImNodesEditorContext& editor,
+    const ImBitVector&          occluded_pins)
 {
+    const ImObjectPool<ImPinData>& pins = editor.Pins;
+    IM_ASSERT(editor.PinPosX.Size >= pins.Pool.Size && editor.PinPosY.Size >= pins.Pool.Size);
+
     float           smallest_distance = FLT_MAX;
     ImOptionalIndex pin_idx_with_smallest_distance;
 
+    // TODO: GImNodes->Style.PinHoverRadius needs to be copied into pin data and the pin-local
+    // value used here. This is no longer called in BeginAttribute/EndAttribute scope and the
+    // detected pin might have a different hover radius than what the user had when calling
+    // BeginAttribute/EndAttribute.
     const float hover_radius_sqr = GImNodes->Style.PinHoverRadius * GImNodes->Style.PinHoverRadius;
 
-    for (int idx = 0; idx < pins.Pool.Size; ++idx)
-    {
-        if (!pins.InUse[idx])
+    int idx = 0;
+#if defined(IMGUI_ENABLE_SSE)
+    {
+        // Lane masks indexed by a 4-bit hoverable mask
+        alignas(16) static const ImU32 lane_masks[16][4] = {
+            {0, 0, 0, 0}, {~0u, 0, 0, 0}, {0, ~0u, 0, 0}, {~0u, ~0u, 0, 0},
+            {0, 0, ~0u, 0}, {~0u, 0, ~0u, 0}, {0, ~0u, ~0u, 0}, {~0u, ~0u, ~0u, 0},
+            {0, 0, 0, ~0u}, {~0u, 0, 0, ~0u}, {0, ~0u, 0, ~0u}, {~0u, ~0u, 0, ~0u},
+            {0, 0, ~0u, ~0u}, {~0u, 0, ~0u, ~0u}, {0, ~0u, ~0u, ~0u}, {~0u, ~0u, ~0u, ~0u}};
+
+        // Pin indices are tracked as floats, which are exact up to 2^24
+        IM_ASSERT(pins.Pool.Size <= (1 << 24));
+
+        const __m128 mouse_x = _mm_set1_ps(GImNodes->MousePos.x);
+        const __m128 mouse_y = _mm_set1_ps(GImNodes->MousePos.y);
+        const __m128 radius_sqr = _mm_set1_ps(hover_radius_sqr);
+        const __m128 flt_max = _mm_set1_ps(FLT_MAX);
+        const __m128 lane = _mm_set_ps(3.f, 2.f, 1.f, 0.f);
+        __m128       best_dist = flt_max;
+        __m128       best_idx = _mm_setzero_ps();
+        for (; idx + 4 <= pins.Pool.Size; idx += 4)
         {
-            continue;
+            const __m128 hoverable = _mm_load_ps(reinterpret_cast<const float*>(
+                lane_masks[GetHoverablePinMask4(pins, occluded_pins, idx)]));
+            const __m128 dx = _mm_sub_ps(_mm_loadu_ps(editor.PinPosX.Data + idx), mouse_x);
+            const __m128 dy = _mm_sub_ps(_mm_loadu_ps(editor.PinPosY.Data + idx), mouse_y);
+            const __m128 dist = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+            // Strict comparison keeps the lowest index on ties, like the scalar loop
+            const __m128 closer = _mm_and_ps(
+                _mm_and_ps(hoverable, _mm_cmplt_ps(dist, radius_sqr)),
+                _mm_cmplt_ps(dist, best_dist));
+            best_dist = _mm_or_ps(_mm_and_ps(closer, dist), _mm_andnot_ps(closer, best_dist));
+            best_idx = _mm_or_ps(
+                _mm_and_ps(closer, _mm_add_ps(_mm_set1_ps((float)idx), lane)),
+                _mm_andnot_ps(closer, best_idx));
         }
 
-        if (occluded_pin_indices.contains(idx))
+        alignas(16) float lane_dist[4];
+        alignas(16) float lane_idx[4];
+        _mm_store_ps(lane_dist, best_dist);
+        _mm_store_ps(lane_idx, best_idx);
+        for (int l = 0; l < 4; ++l)
+        {
+            const int candidate_idx = (int)lane_idx[l];
+            if (lane_dist[l] < smallest_distance ||
+                (lane_dist[l] == smallest_distance && lane_dist[l] < FLT_MAX &&
+                 candidate_idx < pin_idx_with_smallest_distance.Value()))
+            {
+                smallest_distance = lane_dist[l];
+                pin_idx_with_smallest_distance = candidate_idx;
+            }
+        }
+    }
+#endif
+
+    for (; idx < pins.Pool.Size; ++idx)
+    {
+        if (!pins.InUse[idx] || occluded_pins.TestBit(idx))
         {
             continue;
         }
 
-        const ImVec2& pin_pos = pins.Pool[idx].Pos;
-        const float   distance_sqr = ImLengthSqr(pin_pos - GImNodes->MousePos);
+        const float dx = editor.PinPosX[idx] - GImNodes->MousePos.x;
+        const float dy = editor.PinPosY[idx] - GImNodes->MousePos.y;
+        const float distance_sqr = dx * dx + dy * dy;
 
-        // TODO: GImNodes->Style.PinHoverRadius needs to be copied into pin data and the pin-local
-        // value used here. This is no longer called in BeginAttribute/EndAttribute scope and the
-        // detected pin might have a different hover radius than what the user had when calling
-        // BeginAttribute/EndAttribute.
         if (distance_sqr < hover_radius_sqr && distance_sqr < smallest_distance)
         {
             smallest_distance = distance_sqr;
@@ -1264,6 +2029,23 @@ ImOptionalIndex ResolveHoveredLink(
             continue;
         }
 
+        if (!link.Path.empty())
+        {
+            GetLinkPolyline(
+                EditorContextGet(), link, start_pin.Pos, end_pin.Pos, GImNodes->LinkPolyline);
+            if (GetContainingRectForPolyline(GImNodes->LinkPolyline).Contains(GImNodes->MousePos))
+            {
+                const float distance =
+                    GetDistanceToPolyline(GImNodes->MousePos, GImNodes->LinkPolyline);
+                if (distance < GImNodes->Style.LinkHoverDistance && distance < smallest_distance)
+                {
+                    smallest_distance = distance;
+                    link_idx_with_smallest_distance = idx;
+                }
+            }
+            continue;
+        }
+
         // TODO: the calculated CubicBeziers could be cached since we generate them again when
         // rendering the links
 
@@ -1531,6 +2313,7 @@ void DrawPin(ImNodesEditorContext& editor, const int pin_idx)
     const ImRect& parent_node_rect = editor.Nodes.Pool[pin.ParentNodeIdx].Rect;
 
     pin.Pos = GetScreenSpacePinCoordinates(parent_node_rect, pin.AttributeRect, pin.Type);
+    SyncPinPosMirror(editor, pin_idx);
 
     ImU32 pin_color = pin.ColorStyle.Background;
 
@@ -1667,9 +2450,6 @@ void DrawLink(ImNodesEditorContext& editor, const int link_idx)
     const ImPinData&  start_pin = editor.Pins.Pool[link.StartPinIdx];
     const ImPinData&  end_pin = editor.Pins.Pool[link.EndPinIdx];
 
-    const CubicBezier cubic_bezier = GetCubicBezier(
-        start_pin.Pos, end_pin.Pos, start_pin.Type, GImNodes->Style.LinkLineSegmentsPerLength);
-
     const bool link_hovered =
         GImNodes->HoveredLinkIdx == link_idx &&
         editor.ClickInteraction.Type != ImNodesClickInteractionType_BoxSelection;
@@ -1716,6 +2496,21 @@ void DrawLink(ImNodesEditorContext& editor, const int link_idx)
         }
     }
 
+    if (!link.Path.empty())
+    {
+        GetLinkPolyline(editor, link, start_pin.Pos, end_pin.Pos, GImNodes->LinkPolyline);
+        GImNodes->CanvasDrawList->AddPolyline(
+            GImNodes->LinkPolyline.Data,
+            GImNodes->LinkPolyline.Size,
+            link_color,
+            ImDrawFlags_None,
+            GImNodes->Style.LinkThickness / editor.ZoomScale);
+        return;
+    }
+
+    const CubicBezier cubic_bezier = GetCubicBezier(
+        start_pin.Pos, end_pin.Pos, start_pin.Type, GImNodes->Style.LinkLineSegmentsPerLength);
+
 #if IMGUI_VERSION_NUM < 18000
     GImNodes->CanvasDrawList->AddBezierCurve(
 #else
@@ -1760,6 +2555,7 @@ void BeginPinAttribute(
     pin.ColorStyle.Background = GImNodes->Style.Colors[ImNodesCol_Pin];
     pin.ColorStyle.Hovered = GImNodes->Style.Colors[ImNodesCol_PinHovered];
     pin.CusDrawData = cusDrawData;
+    SyncPinPosMirror(editor, pin_idx);
 }
 
 void EndPinAttribute()
@@ -1937,12 +2733,6 @@ static void MiniMapDrawLink(ImNodesEditorContext& editor, const int link_idx)
     const ImPinData&  start_pin = editor.Pins.Pool[link.StartPinIdx];
     const ImPinData&  end_pin = editor.Pins.Pool[link.EndPinIdx];
 
-    const CubicBezier cubic_bezier = GetCubicBezier(
-        ScreenSpaceToMiniMapSpace(editor, start_pin.Pos),
-        ScreenSpaceToMiniMapSpace(editor, end_pin.Pos),
-        start_pin.Type,
-        GImNodes->Style.LinkLineSegmentsPerLength / editor.MiniMapScaling);
-
     // It's possible for a link to be deleted in begin_link_interaction. A user
     // may detach a link, resulting in the link wire snapping to the mouse
     // position.
@@ -1958,6 +2748,29 @@ static void MiniMapDrawLink(ImNodesEditorContext& editor, const int link_idx)
             [editor.SelectedLinkIndices.contains(link_idx) ? ImNodesCol_MiniMapLinkSelected
                                                            : ImNodesCol_MiniMapLink];
 
+    if (!link.Path.empty())
+    {
+        ImVector<ImVec2>& points = GImNodes->LinkPolyline;
+        GetLinkPolyline(editor, link, start_pin.Pos, end_pin.Pos, points);
+        for (ImVec2& point : points)
+        {
+            point = ScreenSpaceToMiniMapSpace(editor, point);
+        }
+        GImNodes->CanvasDrawList->AddPolyline(
+            points.Data,
+            points.Size,
+            link_color,
+            ImDrawFlags_None,
+            GImNodes->Style.LinkThickness * editor.MiniMapScaling / editor.ZoomScale);
+        return;
+    }
+
+    const CubicBezier cubic_bezier = GetCubicBezier(
+        ScreenSpaceToMiniMapSpace(editor, start_pin.Pos),
+        ScreenSpaceToMiniMapSpace(editor, end_pin.Pos),
+        start_pin.Type,
+        GImNodes->Style.LinkLineSegmentsPerLength / editor.MiniMapScaling);
+
 #if IMGUI_VERSION_NUM < 18000
     GImNodes->CanvasDrawList->AddBezierCurve(
 #else
@@ -2518,9 +3331,9 @@ void EndNodeEditor()
     {
         // Pins needs some special care. We need to check the depth stack to see which pins are
         // being occluded by other nodes.
-        ResolveOccludedPins(editor, GImNodes->OccludedPinIndices);
+        const ImBitVector& occluded_pins = ResolveOccludedPins(editor);
 
-        GImNodes->HoveredPinIdx = ResolveHoveredPin(editor.Pins, GImNodes->OccludedPinIndices);
+        GImNodes->HoveredPinIdx = ResolveHoveredPin(editor, occluded_pins);
 
         if (!GImNodes->HoveredPinIdx.HasValue())
         {
@@ -2739,6 +3552,11 @@ void EndNode()
     editor.GridContentBounds.Add(node.Origin);
     editor.GridContentBounds.Add(node.Origin + node.Rect.GetSize());
 
+    if (editor.ClickInteraction.Type == ImNodesClickInteractionType_BoxSelection)
+    {
+        BoxSelectorIndexCheckNode(editor, GImNodes->CurrentNodeIdx);
+    }
+
     if (node.Rect.Contains(GImNodes->MousePos))
     {
         GImNodes->NodeIndicesOverlappingWithMouse.push_back(GImNodes->CurrentNodeIdx);
@@ -2852,14 +3670,37 @@ void PopAttributeFlag()
 }
 
 void Link(const int id, const int start_attr_id, const int end_attr_id)
+{
+    Link(id, start_attr_id, end_attr_id, NULL, 0);
+}
+
+void Link(
+    const int     id,
+    const int     start_attr_id,
+    const int     end_attr_id,
+    const ImVec2* path,
+    const int     path_count)
 {
     IM_ASSERT(GImNodes->CurrentScope == ImNodesScope_Editor);
+    IM_ASSERT(path_count >= 0 && (path != NULL || path_count == 0));
 
     ImNodesEditorContext& editor = EditorContextGet();
     ImLinkData&           link = ObjectPoolFindOrCreateObject(editor.Links, id);
     link.Id = id;
     link.StartPinIdx = ObjectPoolFindOrCreateIndex(editor.Pins, start_attr_id);
     link.EndPinIdx = ObjectPoolFindOrCreateIndex(editor.Pins, end_attr_id);
+    link.Path.resize(path_count);
+    if (path_count > 0)
+    {
+        memcpy(link.Path.Data, path, sizeof(ImVec2) * path_count);
+    }
+    SyncPinPosMirror(editor, link.StartPinIdx);
+    SyncPinPosMirror(editor, link.EndPinIdx);
+
+    if (editor.ClickInteraction.Type == ImNodesClickInteractionType_BoxSelection)
+    {
+        BoxSelectorIndexCheckLink(editor, ObjectPoolFind(editor.Links, id));
+    }
     link.ColorStyle.Base = GImNodes->Style.Colors[ImNodesCol_Link];
     link.ColorStyle.Hovered = GImNodes->Style.Colors[ImNodesCol_LinkHovered];
     link.ColorStyle.Selected = GImNodes->Style.Colors[ImNodesCol_LinkSelected];
@@ -3041,6 +3882,11 @@ ImVec2 GetNodeGridSpacePos(const int node_id)
     return node.Origin;
 }
 
+bool IsNodeKnown(const int node_id)
+{
+    return ObjectPoolFind(EditorContextGet().Nodes, node_id) != -1;
+}
+
 void SnapNodeToGrid(int node_id)
 {
     ImNodesEditorContext& editor = EditorContextGet();
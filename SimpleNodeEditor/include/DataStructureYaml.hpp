@@ -1,7 +1,11 @@
 #ifndef DATASTRUCTUREYAML_H
 #define DATASTRUCTUREYAML_H
 
+#include <cstdint>
+#include <cstring>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 namespace SimpleNodeEditor
 {
@@ -23,12 +27,76 @@ struct YamlNodeProperty
     std::string m_propertyValue;
 };
 
+// The properties of a node. Those read from a file stay packed in one buffer until they are
+// first edited, a node can carry hundreds of them and most are only ever written back.
+class YamlNodeProperties
+{
+public:
+    YamlNodeProperties() : m_packed(), m_packedCount(0), m_decoded(), m_isDecoded(false) {}
+
+    size_t size() const { return m_isDecoded ? m_decoded.size() : m_packedCount; }
+    bool   empty() const { return size() == 0; }
+
+    void Add(std::string_view name, int32_t id, std::string_view value);
+    // the properties as records that can be edited, decoded on the first call
+    std::vector<YamlNodeProperty>& Decode();
+
+    // visit(name, id, value) for every property in order, packed ones are not decoded
+    template <typename Visit>
+    void ForEach(Visit&& visit) const
+    {
+        if (m_isDecoded)
+        {
+            for (const YamlNodeProperty& property : m_decoded)
+            {
+                visit(std::string_view(property.m_propertyName), property.m_propertyId,
+                      std::string_view(property.m_propertyValue));
+            }
+            return;
+        }
+        size_t offset = 0;
+        for (uint32_t index = 0; index < m_packedCount; ++index)
+        {
+            const std::string_view name = ReadPacked(offset);
+            int32_t                id   = 0;
+            std::memcpy(&id, m_packed.data() + offset, sizeof(id));
+            offset += sizeof(id);
+            const std::string_view value = ReadPacked(offset);
+            visit(name, id, value);
+        }
+    }
+
+private:
+    std::string_view ReadPacked(size_t& offset) const
+    {
+        uint32_t size = 0;
+        std::memcpy(&size, m_packed.data() + offset, sizeof(size));
+        offset += sizeof(size);
+        const std::string_view text(m_packed.data() + offset, size);
+        offset += size;
+        return text;
+    }
+
+    // the size and characters of the name, the id, the size and characters of the value
+    std::string                   m_packed;
+    uint32_t                      m_packedCount;
+    std::vector<YamlNodeProperty> m_decoded;
+    bool                          m_isDecoded;
+};
+
 struct YamlPruningRule
 {
     std::string m_Group;
     std::string m_Type;
 };
 
+// grid space position of the top left corner of a node, as laid out when the pipeline was saved
+struct YamlNodePosition
+{
+    float m_x;
+    float m_y;
+};
+
 struct YamlNode
 {
     using NodeYamlId = int32_t;
@@ -39,15 +107,17 @@ struct YamlNode
           m_isSrcNode(false),
           m_nodeYamlType(-1),
           m_Properties(),
-          m_PruningRules()
+          m_PruningRules(),
+          m_position()
     {
     }
     std::string                   m_nodeName;
     NodeYamlId                    m_nodeYamlId;
     int                           m_isSrcNode;
     YamlNodeType                  m_nodeYamlType;
-    std::vector<YamlNodeProperty> m_Properties;
+    YamlNodeProperties            m_Properties;
     std::vector<YamlPruningRule>  m_PruningRules;
+    std::optional<YamlNodePosition> m_position; // optional in pipeline files
 };
 
 struct YamlPort
@@ -0,0 +1,111 @@
+#ifndef EDITJOURNAL_H
+#define EDITJOURNAL_H
+
+#include <cstdint>
+#include <cstdio>
+#include <future>
+#include <optional>
+#include <string>
+#include <vector>
+#include "DataStructureYaml.hpp"
+
+namespace SimpleNodeEditor
+{
+
+// An append only file of the edits made since the pipeline was last saved or loaded, so that they
+// can be recovered after a crash without writing the whole pipeline out after every edit.
+// An entry holds the state an edit left a node or a link in, in the terms of the pipeline file,
+// yaml ids and ports, not the command itself, whose uids only mean something to the running
+// editor. Replaying the entries in order on top of the file the journal was restarted for gives
+// the pipeline as it was at the last entry.
+// Entries are queued by the UI thread and written, and synced to the disk, in batches on a
+// background thread, so editing never waits for the disk. Every entry carries a hash of itself,
+// the torn entry a crash can leave at the end of the file is dropped when it is read back.
+class EditJournal
+{
+public:
+    struct Entry
+    {
+        enum class Type : uint8_t
+        {
+            PutNode,          // m_node was added or changed
+            RemoveNode,       // the node with the yaml id of m_node
+            PutEdge,          // m_edge was added or changed
+            RemoveEdge,       // the link between the ports of m_edge
+            SetPipelineName,  // to m_first
+            AddPruningRule,   // group m_first, type m_second
+            ChangePruningRule // the current type of group m_first to m_second
+        };
+
+        static Entry ForNode(Type type, const YamlNode& node)
+        {
+            Entry entry;
+            entry.m_type = type;
+            entry.m_node = node;
+            return entry;
+        }
+        static Entry ForEdge(Type type, const YamlEdge& edge)
+        {
+            Entry entry;
+            entry.m_type = type;
+            entry.m_edge = edge;
+            return entry;
+        }
+        static Entry ForNames(Type type, const std::string& first, const std::string& second = "")
+        {
+            Entry entry;
+            entry.m_type   = type;
+            entry.m_first  = first;
+            entry.m_second = second;
+            return entry;
+        }
+
+        Type        m_type = Type::PutNode;
+        YamlNode    m_node;
+        YamlEdge    m_edge;
+        std::string m_first;
+        std::string m_second;
+    };
+
+    // what the journal of an earlier run holds
+    struct Recovered
+    {
+        std::string        m_baseTarget; // see Restart
+        std::vector<Entry> m_entries;
+    };
+
+    EditJournal();
+    ~EditJournal(); // writes what is still queued
+
+    EditJournal(const EditJournal&)            = delete;
+    EditJournal& operator=(const EditJournal&) = delete;
+
+    // an empty path turns the journal off. Returns the entries an earlier run left behind, they
+    // are kept in the file until the next Restart
+    std::optional<Recovered> Open(const std::string& path);
+    bool                     IsEnabled() const { return m_file != nullptr; }
+    // drop all entries, the pipeline is now the one saved in baseTarget, a file as named by
+    // FileDialog::GetResultTarget, or in no file at all when it is empty
+    void Restart(const std::string& baseTarget);
+    void Append(const Entry& entry);
+    // starts writing what was queued once the last batch is on the disk, call once per frame
+    void Update();
+
+    // replays the node, link and pipeline name entries on top of the records of the base file.
+    // Pruning entries are left to the caller
+    static void Apply(const std::vector<Entry>& entries, std::string& pipelineName,
+                      std::vector<YamlNode>& nodes, std::vector<YamlEdge>& edges);
+
+private:
+    void Launch();
+    void Wait();
+
+    std::string       m_path;
+    std::FILE*        m_file;
+    std::string       m_queued; // entries waiting for the running batch
+    std::future<void> m_writing;
+};
+
+} // namespace SimpleNodeEditor
+
+#endif // EDITJOURNAL_H
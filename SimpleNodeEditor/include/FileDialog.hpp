@@ -58,8 +58,12 @@ public:
     void                                SetFileName(const std::string name) { m_fileName = name; }
     void                                SetDefaultDirectoryPath(const std::filesystem::path& dir) { m_directoryPath = dir; }
     FS::Path                            GetResultPath() const { return m_resultPath; }
-    std::unique_ptr<std::ostream>       GetResultOutStream(); 
-    std::unique_ptr<std::istream>       GetResultInStream(); 
+    std::unique_ptr<std::ostream>       GetResultOutStream(std::ios_base::openmode mode = std::ios_base::trunc);
+    std::string                         GetResultTarget() const; // the result path and the file system it is on
+    std::unique_ptr<std::istream>       GetResultInStream(std::ios_base::openmode mode = std::ios_base::in);
+    std::time_t                         GetResultModifiedTime() const; // 0 when it is not known
+    int64_t                             GetResultFileSize() const;     // -1 when it is not known
+    std::unique_ptr<FS::MappedFile>     GetResultMappedFile(); // nullptr if it cannot be mapped
     auto                                GetFileName() const { return m_fileName; }
     auto                                GetFileFormat() const { return m_fileFormat; }
     Type                                GetType() const { return m_type; }
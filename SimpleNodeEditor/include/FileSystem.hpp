@@ -4,7 +4,7 @@
 // [SECTION2] draw list helper
 // [SECTION3] declearations of IFileSystem 、LocalFileSystem、SshFileSystem and other components in the following order: 
 //          [SECTION3.1] IFileSystem
-//          [SECTION3.2] LocalFileSystem
+//          [SECTION3.2] LocalFileSystem and MappedFile
 //          [SECTION3.3] SShFileSystem
 //          [SECTION3.4] SShFileSystem Input&Output streambuffer
 
@@ -12,11 +12,13 @@
 #define FILESYSTEM_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <cstdint>
 #include <ctime>
 #include <memory>
 #include <filesystem>
+#include <mutex>
 #include "Common.hpp"
 
 namespace stdfs = std::filesystem;
@@ -105,6 +107,30 @@ struct FileEntry {
 	std::time_t m_modified = 0;
 };
 
+// A read-only memory mapping of a whole local file. Pages are read in by the kernel when they are
+// first touched, nothing is copied up front.
+class MappedFile
+{
+public:
+    // returns nullptr if the file cannot be opened or mapped
+    static std::unique_ptr<MappedFile> Open(const Path& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::string_view GetView() const { return std::string_view(m_data, m_size); }
+
+private:
+    MappedFile() = default;
+
+    const char* m_data = nullptr; // nullptr for an empty file
+    size_t      m_size = 0;
+#ifdef _WIN32
+    void*       m_mapping = nullptr; // HANDLE of the file mapping
+#endif
+};
+
 enum class FileSystemType
 {
     Local,
@@ -124,6 +150,12 @@ public:
 
     virtual std::unique_ptr<std::istream> createInputStream(std::ios_base::openmode mode, const Path& path) = 0;
     virtual std::unique_ptr<std::ostream> createOutputStream(std::ios_base::openmode mode, const Path& path) = 0;
+    // returns nullptr where files cannot be mapped, read them through createInputStream then
+    virtual std::unique_ptr<MappedFile> MapFile([[maybe_unused]] const Path& path) { return nullptr; }
+    // 0 when it is not known
+    virtual std::time_t GetModifiedTime([[maybe_unused]] const Path& path) { return 0; }
+    // -1 when it is not known
+    virtual int64_t GetFileSize([[maybe_unused]] const Path& path) { return -1; }
 
 protected:
     FileSystemType m_type;
@@ -140,6 +172,9 @@ public:
 	virtual std::vector<FileEntry> List(const Path& path) override;
     virtual std::unique_ptr<std::istream> createInputStream(std::ios_base::openmode mode, const Path& path);
     virtual std::unique_ptr<std::ostream> createOutputStream(std::ios_base::openmode mode, const Path& path);
+    virtual std::unique_ptr<MappedFile> MapFile(const Path& path) override;
+    virtual std::time_t GetModifiedTime(const Path& path) override;
+    virtual int64_t GetFileSize(const Path& path) override;
 };
 
 struct SshConnectionInfo
@@ -175,8 +210,12 @@ public:
     virtual std::vector<FileEntry> List(const Path& path) override;
     virtual std::unique_ptr<std::istream> createInputStream(std::ios_base::openmode mode, const Path& path);
     virtual std::unique_ptr<std::ostream> createOutputStream(std::ios_base::openmode mode, const Path& path);
+    virtual std::time_t GetModifiedTime(const Path& path) override;
+    virtual int64_t GetFileSize(const Path& path) override;
     void*   GetSshSessionHandle(){ return m_session;}
     void*   GetSftpSessionHandle(){ return m_sftpSession;}
+    // libssh2 sessions are not thread safe, every session/sftp call must hold this lock
+    std::recursive_mutex& GetSessionMutex(){ return m_sessionMutex;}
 
     bool IsConnected() const;
 
@@ -197,6 +236,7 @@ private:
     std::int64_t m_socket;
     void*        m_session;      // SSH session handle
     void*        m_sftpSession; // SFTP session handle
+    std::recursive_mutex m_sessionMutex;
 };
 
 class SshInputStreamBuffer : public std::streambuf
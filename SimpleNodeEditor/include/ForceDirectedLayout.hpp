@@ -0,0 +1,114 @@
+#ifndef FORCEDIRECTEDLAYOUT_H
+#define FORCEDIRECTEDLAYOUT_H
+
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <imgui.h>
+#include "Helpers.hpp"
+
+namespace SimpleNodeEditor
+{
+
+// Force directed layout (Fruchterman-Reingold) for graphs where a layered layout wastes space,
+// e.g. pipelines made of many parallel branches:
+//  - every pair of nodes pushes each other away, approximated with a Barnes-Hut quadtree so that an
+//    iteration costs O(n log n) instead of O(n^2), the forces on each node are summed in parallel
+//  - linked nodes pull each other together, and a weak gravity keeps unlinked parts close
+//  - all nodes move by the same step along their force, the step adapts to whether the total
+//    energy goes down, until it gets small enough for the nodes to be settled. The step can keep
+//    growing and shrinking when nodes swing between two spots, so the layout also counts as
+//    settled after m_maxIterations
+// It runs a few iterations at a time within a time budget, so it can be stepped once per frame.
+// Pinned nodes keep their position but still push and pull the others.
+class ForceDirectedLayout
+{
+public:
+    struct Options
+    {
+        float  m_edgeLength        = 120.f; // preferred gap between linked nodes, on top of their size
+        float  m_theta             = 1.2f;  // cells seen under a smaller ratio of size / distance are
+                                            // approximated by their center of mass
+        float  m_repulsion         = 0.2f;  // strength of repulsion against attraction
+        float  m_gravity           = 0.02f;
+        float  m_cooling           = 0.9f;  // step factor applied when an iteration raises the energy
+        float  m_tolerance         = 0.01f; // settled once the step is below this part of an edge
+        size_t m_maxIterations     = 1000;  // or once this many iterations ran since Reset()
+        size_t m_parallelThreshold = 1000;  // node count from which forces are summed in parallel
+    };
+
+    ForceDirectedLayout() = default;
+    explicit ForceDirectedLayout(const Options& options);
+
+    // positions and sizes of the nodes, positions are top left in grid space. edges: (source,
+    // destination) pairs, edges between unknown nodes are ignored
+    void Reset(const std::unordered_map<NodeUniqueId, ImVec2>&           positions,
+               const std::unordered_map<NodeUniqueId, ImVec2>&           nodeSizes,
+               const std::vector<std::pair<NodeUniqueId, NodeUniqueId>>& edges);
+    // the node stays at position (top left, grid space) until the next Reset()
+    void Pin(NodeUniqueId nodeUid, const ImVec2& position);
+
+    // runs iterations until the budget is spent or the layout settles, return true once settled
+    bool Step(std::chrono::microseconds budget);
+    bool IsSettled() const
+    {
+        return m_temperature < m_options.m_tolerance * m_idealDistance ||
+               m_iterations >= m_options.m_maxIterations;
+    }
+    size_t GetIterationCount() const { return m_iterations; }
+
+    size_t       GetNodeCount() const { return m_nodeUids.size(); }
+    NodeUniqueId GetNodeUid(size_t index) const { return m_nodeUids[index]; }
+    bool         IsPinned(size_t index) const { return m_pinned[index] != 0; }
+    // top left, grid space
+    ImVec2       GetPosition(size_t index) const;
+
+private:
+    // cells of the quadtree, the four children of a cell are stored next to each other. Every cell
+    // covers a range of m_bodies, which is sorted so that the bodies of a cell are contiguous.
+    struct Cell
+    {
+        double m_minX       = 0.0;
+        double m_minY       = 0.0;
+        double m_size       = 0.0;
+        double m_mass       = 0.0; // number of bodies
+        double m_centerX    = 0.0; // center of mass
+        double m_centerY    = 0.0;
+        int    m_firstChild = -1;  // -1 for leaves
+        int    m_begin      = 0;
+        int    m_end        = 0;
+    };
+
+    void Iterate();
+    void BuildTree();
+    void BuildCell(int cellIndex, int depth);
+    void AccumulateRepulsion(size_t begin, size_t end);
+    void AccumulateAttraction();
+
+    Options m_options;
+
+    std::vector<NodeUniqueId>             m_nodeUids;
+    std::unordered_map<NodeUniqueId, int> m_indexOfNode;
+    std::vector<double>                   m_x; // centers
+    std::vector<double>                   m_y;
+    std::vector<ImVec2>                   m_sizes;
+    std::vector<char>                     m_pinned;
+    std::vector<std::pair<int, int>>      m_edges;
+    std::vector<double>                   m_forceX;
+    std::vector<double>                   m_forceY;
+
+    std::vector<Cell> m_cells;
+    std::vector<int>  m_bodies;
+
+    double m_idealDistance = 0.0;
+    double m_temperature   = 0.0; // current step length
+    double m_energy        = 0.0; // sum of the squared forces of the last iteration
+    int    m_progress      = 0;   // iterations in a row that lowered the energy
+    size_t m_iterations    = 0;   // since Reset()
+};
+
+} // namespace SimpleNodeEditor
+
+#endif // FORCEDIRECTEDLAYOUT_H
@@ -1,5 +1,10 @@
 #ifndef HELPERS_H
 #define HELPERS_H
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <span>
+#include <thread>
 #include <vector>
 #include <unordered_map>
 #include <unordered_set>
@@ -121,10 +126,202 @@ inline void DumpEdge(const Edge& edge)
                 edge.GetYamlEdge().m_yamlDstPort.m_portName);
 }
 
+// Tarjan's algorithm, iterative so that long chains do not overflow the stack. Runs in
+// O(nodes + edges). Components come out in reverse topological order of the condensed graph, i.e.
+// a component is emitted after every component it has an edge to.
+inline std::vector<std::vector<NodeUniqueId>> StronglyConnectedComponents(
+    const std::unordered_map<NodeUniqueId, Node>& nodesMap,
+    const std::unordered_map<EdgeUniqueId, Edge>& edgesMap)
+{
+    // work on dense indices, the maps are only read while building the adjacency
+    std::vector<NodeUniqueId>             nodeUids;
+    std::unordered_map<NodeUniqueId, int> indexOfNode;
+    nodeUids.reserve(nodesMap.size());
+    indexOfNode.reserve(nodesMap.size());
+    for (const auto& [nodeUid, _] : nodesMap)
+    {
+        indexOfNode.emplace(nodeUid, static_cast<int>(nodeUids.size()));
+        nodeUids.push_back(nodeUid);
+    }
+
+    const int                     nodeCount = static_cast<int>(nodeUids.size());
+    std::vector<std::vector<int>> successors(nodeCount);
+    for (const auto& [_, edge] : edgesMap)
+    {
+        auto srcIter = indexOfNode.find(edge.GetSourceNodeUid());
+        auto dstIter = indexOfNode.find(edge.GetDestinationNodeUid());
+        if (srcIter == indexOfNode.end() || dstIter == indexOfNode.end())
+        {
+            SNELOG_ERROR("edge[{}] links unknown nodes", edge.GetEdgeUniqueId());
+            continue;
+        }
+        successors[srcIter->second].push_back(dstIter->second);
+    }
+
+    std::vector<std::vector<NodeUniqueId>> components;
+    std::vector<int>                       discovery(nodeCount, -1);
+    std::vector<int>                       lowLink(nodeCount, 0);
+    std::vector<char>                      onStack(nodeCount, 0);
+    std::vector<int>                       componentStack;
+    std::vector<std::pair<int, size_t>>    callStack; // node, next successor to visit
+    int                                    nextDiscovery = 0;
+
+    for (int root = 0; root < nodeCount; ++root)
+    {
+        if (discovery[root] != -1)
+        {
+            continue;
+        }
+
+        callStack.emplace_back(root, 0);
+        while (!callStack.empty())
+        {
+            auto& [node, nextSucc] = callStack.back();
+            if (nextSucc == 0)
+            {
+                discovery[node] = lowLink[node] = nextDiscovery++;
+                componentStack.push_back(node);
+                onStack[node] = 1;
+            }
+
+            bool descended = false;
+            while (nextSucc < successors[node].size())
+            {
+                const int succ = successors[node][nextSucc++];
+                if (discovery[succ] == -1)
+                {
+                    callStack.emplace_back(succ, 0);
+                    descended = true;
+                    break;
+                }
+                if (onStack[succ])
+                {
+                    lowLink[node] = std::min(lowLink[node], discovery[succ]);
+                }
+            }
+            if (descended)
+            {
+                continue;
+            }
+
+            const int finished = node;
+            callStack.pop_back();
+            if (!callStack.empty())
+            {
+                const int parent = callStack.back().first;
+                lowLink[parent]  = std::min(lowLink[parent], lowLink[finished]);
+            }
+
+            if (lowLink[finished] == discovery[finished])
+            {
+                std::vector<NodeUniqueId> component;
+                int                       member;
+                do
+                {
+                    member = componentStack.back();
+                    componentStack.pop_back();
+                    onStack[member] = 0;
+                    component.push_back(nodeUids[member]);
+                } while (member != finished);
+                components.push_back(std::move(component));
+            }
+        }
+    }
+    return components;
+}
+
+// Every cycle of the graph, one entry per strongly connected component with more than one node or
+// with an edge looping on its only node
+inline std::vector<std::vector<NodeUniqueId>> FindCycles(
+    const std::unordered_map<NodeUniqueId, Node>& nodesMap,
+    const std::unordered_map<EdgeUniqueId, Edge>& edgesMap)
+{
+    std::unordered_set<NodeUniqueId> selfLooped;
+    for (const auto& [_, edge] : edgesMap)
+    {
+        if (edge.GetSourceNodeUid() == edge.GetDestinationNodeUid())
+        {
+            selfLooped.insert(edge.GetSourceNodeUid());
+        }
+    }
+
+    std::vector<std::vector<NodeUniqueId>> cycles;
+    for (auto& component : StronglyConnectedComponents(nodesMap, edgesMap))
+    {
+        if (component.size() > 1 || selfLooped.contains(component.front()))
+        {
+            cycles.push_back(std::move(component));
+        }
+    }
+    return cycles;
+}
+
+// Topological levels of the condensed graph: every strongly connected component is collapsed into
+// a single node, so all the nodes of a cycle share a level and the graph left is acyclic.
+// On an acyclic graph this gives the same levels as TopologicalSort and FlatTopologicalSort.
+inline std::vector<std::vector<NodeUniqueId>> CondensedTopologicalSort(
+    const std::unordered_map<NodeUniqueId, Node>& nodesMap,
+    const std::unordered_map<EdgeUniqueId, Edge>& edgesMap)
+{
+    const std::vector<std::vector<NodeUniqueId>> components =
+        StronglyConnectedComponents(nodesMap, edgesMap);
+
+    std::unordered_map<NodeUniqueId, int> componentOfNode;
+    componentOfNode.reserve(nodesMap.size());
+    for (size_t component = 0; component < components.size(); ++component)
+    {
+        for (NodeUniqueId nodeUid : components[component])
+        {
+            componentOfNode.emplace(nodeUid, static_cast<int>(component));
+        }
+    }
+
+    // components come in reverse topological order, so walking them backwards settles the level of
+    // a component before any of its successors is looked at
+    std::vector<int> componentLevels(components.size(), 0);
+    int              maxLevel = 0;
+    for (size_t component = components.size(); component-- > 0;)
+    {
+        const int level = componentLevels[component];
+        maxLevel        = std::max(maxLevel, level);
+        for (NodeUniqueId nodeUid : components[component])
+        {
+            for (const OutputPort& outPort : nodesMap.at(nodeUid).GetOutputPorts())
+            {
+                for (const EdgeUniqueId outEdgeUid : outPort.GetEdgeUids())
+                {
+                    auto edgeIter = edgesMap.find(outEdgeUid);
+                    if (edgeIter == edgesMap.end())
+                    {
+                        continue;
+                    }
+                    auto dstIter = componentOfNode.find(edgeIter->second.GetDestinationNodeUid());
+                    if (dstIter == componentOfNode.end() ||
+                        dstIter->second == static_cast<int>(component))
+                    {
+                        continue;
+                    }
+                    componentLevels[dstIter->second] =
+                        std::max(componentLevels[dstIter->second], level + 1);
+                }
+            }
+        }
+    }
+
+    std::vector<std::vector<NodeUniqueId>> result(components.empty() ? 0 : maxLevel + 1);
+    for (size_t component = components.size(); component-- > 0;)
+    {
+        auto& levelNodes = result[componentLevels[component]];
+        levelNodes.insert(levelNodes.end(), components[component].begin(),
+                          components[component].end());
+    }
+    return result;
+}
+
 // must be a inline function to avoid vialation of OneDefinitionRule
 inline std::vector<std::vector<NodeUniqueId>> TopologicalSort(
-    std::unordered_map<NodeUniqueId, Node>& nodesMap,
-    std::unordered_map<EdgeUniqueId, Edge>& edgesMap)
+    const std::unordered_map<NodeUniqueId, Node>& nodesMap,
+    const std::unordered_map<EdgeUniqueId, Edge>& edgesMap)
 {
     if (nodesMap.size() == 0)
     {
@@ -157,11 +354,11 @@ inline std::vector<std::vector<NodeUniqueId>> TopologicalSort(
         ++degrees.at(edge.GetDestinationNodeUid());
     }
 
-    // collect zero degree node
+    // collect zero degree node, in the order of nodesMap like FlatTopologicalSort does
     std::vector<NodeUniqueId> zeroDegreeNodes;
-    for (const auto& [nodeUid, degree] : degrees)
+    for (const auto& [nodeUid, _] : nodesMap)
     {
-        if (!degree)
+        if (!degrees.at(nodeUid))
         {
             zeroDegreeNodes.push_back(nodeUid);
         }
@@ -190,18 +387,217 @@ inline std::vector<std::vector<NodeUniqueId>> TopologicalSort(
         zeroDegreeNodes.swap(newZeroDegreeNodes);
     }
 
-    // finally, all nodes' degree must be zero
+    // nodes left with a non zero degree sit on a cycle or behind one
     bool allNodeDegreeZero = true;
     for (const auto& [nodeUid, degree] : degrees)
     {
         if (degree != 0)
         {
-            SNELOG_ERROR("toposort done, but node[{}] has degree[{}]", nodeUid, degree);
             allNodeDegreeZero = false;
+            break;
+        }
+    }
+    if (!allNodeDegreeZero)
+    {
+        SNELOG_WARN("the graph has cycles, each strongly connected component gets a single level");
+        return CondensedTopologicalSort(nodesMap, edgesMap);
+    }
+
+    return result;
+}
+
+// Levels of a topological sort stored back to back in a single buffer
+struct TopologicalLevels
+{
+    std::vector<NodeUniqueId> m_nodes;
+    std::vector<size_t>       m_offsets{0}; // level i is m_nodes[m_offsets[i], m_offsets[i + 1])
+
+    size_t GetLevelCount() const { return m_offsets.size() - 1; }
+    std::span<const NodeUniqueId> GetLevel(size_t level) const
+    {
+        return std::span<const NodeUniqueId>(m_nodes.data() + m_offsets[level],
+                                             m_offsets[level + 1] - m_offsets[level]);
+    }
+};
+
+// Same levels as TopologicalSort, in the same order inside each level, without a vector per level
+// and without hashing node uids while sorting: nodes are given dense indices, successors are kept
+// in one array and in-degrees in an array of atomics.
+// The successors of a large level are visited on several threads. A node may then reach a zero
+// in-degree on any thread, so the nodes of the next level are put back in the order a single
+// thread would have found them in, i.e. by the position of the last edge reaching them.
+inline TopologicalLevels FlatTopologicalSort(const std::unordered_map<NodeUniqueId, Node>& nodesMap,
+                                             const std::unordered_map<EdgeUniqueId, Edge>& edgesMap)
+{
+    // below this many nodes in a level, starting threads costs more than it saves
+    constexpr size_t parallelLevelThreshold = 8192;
+
+    TopologicalLevels result;
+    if (nodesMap.size() == 0)
+    {
+        SNELOG_WARN("nodesMap size == 0");
+        return result;
+    }
+
+    const int                             nodeCount = static_cast<int>(nodesMap.size());
+    std::vector<NodeUniqueId>             nodeUids;
+    std::vector<const Node*>              nodes;
+    std::unordered_map<NodeUniqueId, int> indexOfNode;
+    nodeUids.reserve(nodeCount);
+    nodes.reserve(nodeCount);
+    indexOfNode.reserve(nodeCount);
+    for (const auto& [nodeUid, node] : nodesMap)
+    {
+        indexOfNode.emplace(nodeUid, static_cast<int>(nodeUids.size()));
+        nodeUids.push_back(nodeUid);
+        nodes.push_back(&node);
+    }
+
+    // successors of node i are successors[successorOffsets[i], successorOffsets[i + 1]), in the
+    // order of the output ports and of their edges, as TopologicalSort visits them
+    std::vector<int>              successorOffsets(nodeCount + 1, 0);
+    std::vector<int>              successors;
+    std::vector<std::atomic<int>> inDegrees(nodeCount);
+    successors.reserve(edgesMap.size());
+    for (int node = 0; node < nodeCount; ++node)
+    {
+        successorOffsets[node] = static_cast<int>(successors.size());
+        for (const OutputPort& outPort : nodes[node]->GetOutputPorts())
+        {
+            for (const EdgeUniqueId outEdgeUid : outPort.GetEdgeUids())
+            {
+                auto edgeIter = edgesMap.find(outEdgeUid);
+                if (edgeIter == edgesMap.end())
+                {
+                    continue;
+                }
+                auto dstIter = indexOfNode.find(edgeIter->second.GetDestinationNodeUid());
+                if (dstIter == indexOfNode.end())
+                {
+                    SNELOG_ERROR("error dstnodeuid [{}]", edgeIter->second.GetDestinationNodeUid());
+                    continue;
+                }
+                successors.push_back(dstIter->second);
+                inDegrees[dstIter->second].fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+    successorOffsets[nodeCount] = static_cast<int>(successors.size());
+
+    // dense indices in level order, levels are delimited by result.m_offsets
+    std::vector<int> order;
+    order.reserve(nodeCount);
+    for (int node = 0; node < nodeCount; ++node)
+    {
+        if (inDegrees[node].load(std::memory_order_relaxed) == 0)
+        {
+            order.push_back(node);
         }
     }
-    SNE_ASSERT(allNodeDegreeZero, "Not All NodeDegrees are zero, checkit");
 
+    // (position in order of the source, rank of the edge among its successors) of the last edge
+    // visited towards each node, only filled by levels visited on several threads
+    std::vector<std::atomic<uint64_t>> lastEdges;
+    const size_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    size_t levelBegin = 0;
+    while (levelBegin < order.size())
+    {
+        const size_t levelEnd = order.size();
+        result.m_offsets.push_back(levelEnd);
+
+        const size_t threadCount =
+            levelEnd - levelBegin < parallelLevelThreshold ? 1 : hardwareThreads;
+        if (threadCount <= 1)
+        {
+            for (size_t pos = levelBegin; pos < levelEnd; ++pos)
+            {
+                const int node = order[pos];
+                for (int edge = successorOffsets[node]; edge < successorOffsets[node + 1]; ++edge)
+                {
+                    if (inDegrees[successors[edge]].fetch_sub(1, std::memory_order_relaxed) == 1)
+                    {
+                        order.push_back(successors[edge]);
+                    }
+                }
+            }
+            levelBegin = levelEnd;
+            continue;
+        }
+
+        if (lastEdges.empty())
+        {
+            lastEdges = std::vector<std::atomic<uint64_t>>(nodeCount);
+        }
+        std::vector<std::future<std::vector<int>>> partials;
+        const size_t chunkSize = (levelEnd - levelBegin + threadCount - 1) / threadCount;
+        for (size_t chunkBegin = levelBegin; chunkBegin < levelEnd; chunkBegin += chunkSize)
+        {
+            const size_t chunkEnd = std::min(chunkBegin + chunkSize, levelEnd);
+            partials.push_back(std::async(
+                std::launch::async,
+                [&, chunkBegin, chunkEnd]()
+                {
+                    std::vector<int> ready;
+                    for (size_t pos = chunkBegin; pos < chunkEnd; ++pos)
+                    {
+                        const int node = order[pos];
+                        for (int edge = successorOffsets[node]; edge < successorOffsets[node + 1];
+                             ++edge)
+                        {
+                            const int      succ = successors[edge];
+                            const uint64_t key  = (static_cast<uint64_t>(pos) << 32) |
+                                                  static_cast<uint64_t>(edge - successorOffsets[node]);
+                            uint64_t       last = lastEdges[succ].load(std::memory_order_relaxed);
+                            while (last < key &&
+                                   !lastEdges[succ].compare_exchange_weak(last, key,
+                                                                          std::memory_order_relaxed))
+                            {
+                            }
+                            if (inDegrees[succ].fetch_sub(1, std::memory_order_relaxed) == 1)
+                            {
+                                ready.push_back(succ);
+                            }
+                        }
+                    }
+                    return ready;
+                }));
+        }
+
+        std::vector<int> nextLevel;
+        for (std::future<std::vector<int>>& partial : partials)
+        {
+            std::vector<int> ready = partial.get();
+            nextLevel.insert(nextLevel.end(), ready.begin(), ready.end());
+        }
+        std::sort(nextLevel.begin(), nextLevel.end(),
+                  [&lastEdges](int lhs, int rhs)
+                  {
+                      return lastEdges[lhs].load(std::memory_order_relaxed) <
+                             lastEdges[rhs].load(std::memory_order_relaxed);
+                  });
+        order.insert(order.end(), nextLevel.begin(), nextLevel.end());
+        levelBegin = levelEnd;
+    }
+
+    // nodes never reached sit on a cycle or behind one
+    if (order.size() != nodesMap.size())
+    {
+        SNELOG_WARN("the graph has cycles, each strongly connected component gets a single level");
+        result.m_offsets.assign(1, 0);
+        for (const std::vector<NodeUniqueId>& level : CondensedTopologicalSort(nodesMap, edgesMap))
+        {
+            result.m_nodes.insert(result.m_nodes.end(), level.begin(), level.end());
+            result.m_offsets.push_back(result.m_nodes.size());
+        }
+        return result;
+    }
+
+    result.m_nodes.resize(order.size());
+    for (size_t pos = 0; pos < order.size(); ++pos)
+    {
+        result.m_nodes[pos] = nodeUids[order[pos]];
+    }
     return result;
 }
 
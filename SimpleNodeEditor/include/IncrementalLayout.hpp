@@ -0,0 +1,59 @@
+#ifndef INCREMENTALLAYOUT_H
+#define INCREMENTALLAYOUT_H
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <imgui.h>
+#include "Helpers.hpp"
+
+namespace SimpleNodeEditor
+{
+
+// Places a few nodes into an existing layered layout and leaves every other node where it is, so
+// that a small edit does not cost a LayeredLayout of the whole graph.
+//  1. the column of a layer is where its fixed nodes already are, layers without fixed nodes are
+//     put next to their neighbour layers
+//  2. free nodes are placed layer after layer, each at the median height of its placed neighbours
+//  3. a free node that would overlap a placed node takes the closest free gap of its column
+// Its cost only depends on the nodes it is given, i.e. the free nodes and the layers around them.
+// It only works on the snapshot it is given and does not touch ImNodes.
+class IncrementalLayout
+{
+public:
+    struct Options
+    {
+        float m_layerSpacing = 100.f; // horizontal gap between two layers
+        float m_nodeSpacing  = 20.f;  // vertical gap between two nodes of a layer
+    };
+
+    struct Snapshot
+    {
+        std::vector<NodeUniqueId>                m_freeNodes;      // nodes to place
+        std::unordered_map<NodeUniqueId, ImVec2> m_fixedPositions; // top left, staying in place
+        // layer and size of every free or fixed node
+        std::unordered_map<NodeUniqueId, int>    m_layers;
+        std::unordered_map<NodeUniqueId, ImVec2> m_sizes;
+        // (source, destination) pairs of the edges of the free nodes
+        std::vector<std::pair<NodeUniqueId, NodeUniqueId>> m_edges;
+    };
+
+    IncrementalLayout() = default;
+    explicit IncrementalLayout(const Options& options);
+
+    // Returns the top left grid space position of every free node
+    std::unordered_map<NodeUniqueId, ImVec2> Compute(const Snapshot& snapshot) const;
+
+private:
+    // x of the left side of every layer from minLayer on
+    std::vector<float> PlaceLayers(const Snapshot& snapshot, int minLayer, int maxLayer) const;
+    // top of the free vertical span of height closest to top, between the spans taken
+    float FindFreeTop(std::vector<std::pair<float, float>>& takenSpans, float top,
+                      float height) const;
+
+    Options m_options;
+};
+
+} // namespace SimpleNodeEditor
+
+#endif // INCREMENTALLAYOUT_H
@@ -0,0 +1,87 @@
+#ifndef LAYEREDLAYOUT_H
+#define LAYEREDLAYOUT_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include <imgui.h>
+#include "Helpers.hpp"
+
+namespace SimpleNodeEditor
+{
+
+// Sugiyama style layered layout, flowing from left to right:
+//  1. layers are given by the caller, usually the longest-path levels of TopologicalOrder
+//  2. edges spanning several layers are split by dummy nodes, one per crossed layer
+//  3. the order inside each layer is improved by barycenter sweeps, keeping the order with the
+//     fewest crossings
+//  4. vertical coordinates are assigned with Brandes-Koepf, i.e. the balanced median of four
+//     alignments, so that long edges run straight and nodes sit next to their neighbours
+// It only works on the snapshot it is given and does not touch ImNodes.
+class LayeredLayout
+{
+public:
+    struct Options
+    {
+        float m_layerSpacing = 100.f; // horizontal gap between two layers
+        float m_nodeSpacing  = 20.f;  // vertical gap between two nodes of a layer
+        float m_edgeSpacing  = 10.f;  // vertical gap between edges passing through a layer
+        int   m_maxSweeps    = 24;
+    };
+
+    LayeredLayout() = default;
+    explicit LayeredLayout(const Options& options);
+
+    // layers: node uids grouped by layer, in initial order. edges: (source, destination) pairs, an
+    // edge must go from a lower layer to a higher one, other edges are ignored.
+    // Returns the top left grid space position of every node in layers.
+    std::unordered_map<NodeUniqueId, ImVec2> Compute(
+        const std::vector<std::vector<NodeUniqueId>>&            layers,
+        const std::vector<std::pair<NodeUniqueId, NodeUniqueId>>& edges,
+        const std::unordered_map<NodeUniqueId, ImVec2>&           nodeSizes);
+
+    // edge crossings left by the last Compute(), counted between dummy-split edges
+    size_t GetCrossingCount() const { return m_crossingCount; }
+
+private:
+    struct Alignment
+    {
+        std::vector<int>    m_root;
+        std::vector<int>    m_align;
+        std::vector<double> m_coords;
+    };
+
+    int    AddVertex(int layer, NodeUniqueId nodeUid, const ImVec2& size);
+    void   BuildGraph(const std::vector<std::vector<NodeUniqueId>>&            layers,
+                      const std::vector<std::pair<NodeUniqueId, NodeUniqueId>>& edges,
+                      const std::unordered_map<NodeUniqueId, ImVec2>&           nodeSizes);
+    void   ReduceCrossings();
+    void   SweepLayer(size_t layer, bool downward);
+    size_t CountCrossings() const;
+    size_t CountCrossingsBetween(size_t northLayer) const;
+
+    void      MarkTypeOneConflicts();
+    bool      HasConflict(int v, int w) const;
+    Alignment AlignVertically(bool downward, bool rightToLeft) const;
+    double    Separation(int v, int w) const;
+    std::vector<double> AssignCoordinates();
+
+    Options m_options;
+
+    // vertices are the real nodes followed by the dummy nodes
+    std::vector<NodeUniqueId>     m_nodeUids; // -1 for dummy nodes
+    std::vector<int>              m_layerOf;
+    std::vector<int>              m_posInLayer;
+    std::vector<ImVec2>           m_sizes;
+    std::vector<std::vector<int>> m_predecessors;
+    std::vector<std::vector<int>> m_successors;
+    std::vector<std::vector<int>> m_layers;
+    std::unordered_set<int64_t>   m_conflicts;
+    size_t                        m_crossingCount = 0;
+};
+
+} // namespace SimpleNodeEditor
+
+#endif // LAYEREDLAYOUT_H
@@ -0,0 +1,61 @@
+#ifndef LAYOUTWORKER_H
+#define LAYOUTWORKER_H
+
+#include <cstdint>
+#include <future>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <imgui.h>
+#include "Helpers.hpp"
+
+namespace SimpleNodeEditor
+{
+
+// Runs LayeredLayout on a background thread. The UI thread hands over a snapshot of the graph and
+// polls for the result once per frame, so it never waits for a layout to finish.
+// At most one layout runs at a time: a request made while one is running waits for it, and only
+// the latest waiting request is kept.
+class LayoutWorker
+{
+public:
+    struct Snapshot
+    {
+        uint64_t                                           m_revision = 0; // graph revision it was taken at
+        std::vector<std::vector<NodeUniqueId>>             m_layers;
+        std::vector<std::pair<NodeUniqueId, NodeUniqueId>> m_edges;
+        std::unordered_map<NodeUniqueId, ImVec2>           m_nodeSizes;
+    };
+
+    struct Result
+    {
+        uint64_t                                 m_revision = 0;
+        std::unordered_map<NodeUniqueId, ImVec2> m_positions; // top left, in grid space
+        size_t                                   m_crossingCount = 0;
+    };
+
+    LayoutWorker() = default;
+    ~LayoutWorker() = default; // waits for the running layout, if any
+
+    LayoutWorker(const LayoutWorker&) = delete;
+    LayoutWorker& operator=(const LayoutWorker&) = delete;
+
+    void Request(Snapshot snapshot);
+    // returns the finished layout, if any, and starts the waiting request
+    std::optional<Result> Poll();
+    // forget the waiting request, the running one still completes but its result is dropped
+    void Cancel();
+    bool IsBusy() const;
+
+private:
+    void Launch(Snapshot snapshot);
+
+    std::future<Result>     m_running;
+    std::optional<Snapshot> m_pending;
+    bool                    m_dropRunning = false;
+};
+
+} // namespace SimpleNodeEditor
+
+#endif // LAYOUTWORKER_H
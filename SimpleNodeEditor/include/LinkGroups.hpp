@@ -0,0 +1,39 @@
+#ifndef LINKGROUPS_H
+#define LINKGROUPS_H
+
+#include <map>
+#include <vector>
+#include "DataStructureEditor.hpp"
+
+namespace SimpleNodeEditor
+{
+
+// The edges of the graph grouped by their source port, as they are written to the LinkList of a
+// pipeline file, one entry per source port. Kept up to date on every edge insertion or deletion so
+// that saving walks the groups instead of grouping the edges by their yaml ports.
+// Groups are ordered by source port uid and the edges of a group by when they were added, so the
+// same graph is always written the same way.
+class LinkGroups
+{
+public:
+    using Groups = std::map<PortUniqueId, std::vector<EdgeUniqueId>>;
+
+    LinkGroups();
+    ~LinkGroups() = default;
+
+    LinkGroups(const LinkGroups&)            = delete;
+    LinkGroups& operator=(const LinkGroups&) = delete;
+
+    void AddEdge(PortUniqueId srcPortUid, EdgeUniqueId edgeUid);
+    void RemoveEdge(PortUniqueId srcPortUid, EdgeUniqueId edgeUid);
+    void Clear();
+
+    const Groups& GetGroups() const { return m_groups; }
+
+private:
+    Groups m_groups;
+};
+
+} // namespace SimpleNodeEditor
+
+#endif // LINKGROUPS_H
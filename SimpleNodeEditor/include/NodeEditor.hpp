@@ -4,9 +4,19 @@
 #include "DataStructureYaml.hpp"
 #include "Helpers.hpp"
 #include "YamlParser.hpp"
+#include "PipelineLoader.hpp"
+#include "PipelineFileLayout.hpp"
+#include "EditJournal.hpp"
 #include "YamlEmitter.hpp"
 #include "FileDialog.hpp"
 #include "GraphPruningPolicy.hpp"
+#include "TopologicalOrder.hpp"
+#include "LinkGroups.hpp"
+#include "LayoutWorker.hpp"
+#include "ForceDirectedLayout.hpp"
+#include "IncrementalLayout.hpp"
+#include "NodeSizeEstimator.hpp"
+#include "RouteWorker.hpp"
 #include <unordered_set>
 #include "imnodes.h"
 #include <set>
@@ -30,8 +40,9 @@ public:
     void NodeEditorInitialize();
     void NodeEditorShow();
     void NodeEditorDestroy();
-    bool LoadPipeline(const std::string& filePath);
-    bool LoadPipeline(std::unique_ptr<std::istream> inputStream);
+    // the pipeline is read on a background thread and replaces the current one once it is parsed
+    void LoadPipeline(const std::string& filePath);
+    void LoadPipeline(std::unique_ptr<std::istream> inputStream);
     void SetNodePos(NodeUniqueId nodeUid, const ImVec2 pos);
 
 public: // TODO: private
@@ -65,9 +76,31 @@ public: // TODO: private
     void               DeleteEdge(EdgeUniqueId edgeUid, bool shouldUnregisterUid);
     void               DeleteEdgesBeforDeleteNode(NodeUniqueId nodeUid, bool shouldUnregisterUid);
     void               DeleteEdgeUidFromPort(EdgeUniqueId edgeUid);
-    // handle nodes layout afer toposorted
+    // handle nodes layout afer toposorted, the layout itself runs in m_layoutWorker
     void RearrangeNodesLayout(const std::vector<std::vector<NodeUniqueId>>& topologicalOrder,
                               const std::unordered_map<NodeUniqueId, Node>& nodesMap);
+    void ApplyLayoutResult();
+    // place only the nodes added or moved to another level since the last layout, return false when
+    // a full layout is needed instead
+    bool RelayoutEditedNodes();
+    // force directed layout, stepped a little on every frame until it settles
+    void StartForceDirectedLayout();
+    void StepForceDirectedLayout();
+    // place the nodes where the pipeline file says, return false if some node has no position
+    bool ApplySavedNodePositions(
+        const std::vector<YamlNode>&                                  yamlNodes,
+        const std::unordered_map<YamlNode::NodeYamlId, NodeUniqueId>& yamlNodeId2NodeUidMap);
+    // copy the current positions into the yaml nodes, so that they are saved
+    void StoreNodePositions();
+    // find the nodes sitting on a cycle, and tell the user about them if notify is set
+    void UpdateCyclicNodes(bool notify);
+    // hand the nodes and edges that changed since the last frame to m_routeWorker, and collect the
+    // routes it finished
+    void UpdateEdgeRoutes();
+    void UpdateRoutedEdge(EdgeUniqueId edgeUid, const Edge& edge,
+                          const NodeSizeEstimator& sizeEstimator, OrthogonalRouter::Changes& changes);
+    // m_sizeEstimator, made again when the font or the styles changed
+    NodeSizeEstimator& GetSizeEstimator();
 
     // handle user interactions
     void HandleNodeInfoEditing();
@@ -76,14 +109,23 @@ public: // TODO: private
     void HandleOtherUserInputs();
 
     void               SaveToFile(const std::string& fileName); 
-    void               SaveToFile(std::unique_ptr<std::ostream> outputStream);
-    [[nodiscard]] bool LoadPipelineFromFile(const std::string& filePath);
-    [[nodiscard]] bool LoadPipelineFromStream(std::unique_ptr<std::istream> inputStream);
+    // to the file chosen in the dialog, only what changed is written when it was saved to last
+    void               SaveToDialogFile();
+    // install a finished load and draw the progress of the running one
+    void               HandlePipelineLoading();
+    // start loading the file the edits left in the journal by the last run were made on, they
+    // are replayed on top of it once it is in, see HandlePipelineLoading
+    void               RecoverJournaledEdits();
+    // replace the current pipeline with the loaded one, unless the loaded one is invalid
+    [[nodiscard]] bool InstallPipeline(const PipelineLoader::Result& result);
     void               ClearCurrentPipeLine();
 
     void               ExecuteCommand(std::unique_ptr<ICommand> cmd);
     bool               Undo();
     bool               Redo();
+    // write the nodes and edges a command touched, as they are after it, to m_editJournal
+    void               JournalTouchedRecords();
+    void               JournalNode(const Node& node);
 
     // Snapshot and restore methods for undo/redo
     void               RestoreEdge(const Edge& edgeSnapshot);
@@ -109,17 +151,66 @@ private:
     // should held by nodeeditor?
     std::vector<NodeDescription> m_nodeDescriptions;
 
-    bool m_needTopoSort;
-    // TODO : may hold the latest toposort res
+    enum class LayoutMode
+    {
+        Layered,
+        ForceDirected
+    };
+
+    bool             m_needTopoSort;
+    LayoutMode       m_layoutMode;
+    bool             m_incrementalLayout; // layered layouts keep the nodes that were not edited
+    // nodes added since the last layout, the nodes moved to another level are taken from
+    // m_topologicalOrder when needed
+    std::unordered_set<NodeUniqueId> m_editedNodes;
+    TopologicalOrder m_topologicalOrder; // updated on every node/edge edit
+    LinkGroups       m_linkGroups;       // edges by source port, for saving
+    LayoutWorker     m_layoutWorker;
+    NodeSizeEstimator m_sizeEstimator; // see GetSizeEstimator
+    // nodes moving from their position before the layout to the one computed by it
+    std::unordered_map<NodeUniqueId, std::pair<ImVec2, ImVec2>> m_layoutTransitions;
+    float                                                       m_layoutTransitionTime;
+    // of the graph editor window, the panning is reset to its middle when nodes are placed anew
+    float               m_editorWindowHeight;
+    ForceDirectedLayout m_forceLayout;
+    bool                m_forceLayoutRunning;
+    uint64_t            m_forceLayoutRevision; // graph revision the running layout started from
+    // where the force directed layout last put each node, a node found elsewhere was moved by hand
+    std::unordered_map<NodeUniqueId, ImVec2> m_forceLayoutPositions;
+    std::unordered_set<NodeUniqueId>         m_pinnedNodes; // kept in place by the force layout
+    // nodes on a cycle, highlighted on canvas. Recomputed once per frame after edge edits while
+    // the graph has cycles
+    std::unordered_set<NodeUniqueId> m_cyclicNodes;
+    bool                             m_cyclesDirty;
+    // edges drawn as polylines routed around the nodes by m_routeWorker instead of as beziers
+    bool                                                  m_orthogonalEdges;
+    RouteWorker                                           m_routeWorker;
+    std::unordered_map<EdgeUniqueId, std::vector<ImVec2>> m_edgeRoutes; // grid space
+    // what m_routeWorker was last told, so that only changes are handed to it
+    std::unordered_map<NodeUniqueId, ImRect>                     m_routedNodeRects;
+    std::unordered_map<EdgeUniqueId, OrthogonalRouter::EdgeEnds> m_routedEdgeEnds;
+    uint64_t                                                     m_routedRevision;
+    bool                                                         m_routedHideUnlinkedPorts;
 
     std::string m_currentPipeLineName;
 
     ImNodesStyle* m_nodeStyle;
 
-    // serilizer and deserializer
-    // should held by nodeeditor instance?
-    PipelineEmitter m_pipelineEimtter;
-    PipelineParser  m_pipeLineParser;
+    // deserializer, pipelines are serialized by a PipelineEmitter on the output stream of each save
+    PipelineLoader  m_pipelineLoader;
+    // of the file saved to last, see SaveToDialogFile
+    PipelineFileLayout m_savedFileLayout;
+    // the file system and path of the pipeline being loaded, see FileDialog::GetResultTarget
+    std::string        m_loadingTarget;
+
+    // edits since the last save or load, replayed after a crash
+    EditJournal        m_editJournal;
+    // set while a command runs, the node and edge primitives then note what they touch
+    bool               m_journalingCommand;
+    std::unordered_set<NodeUniqueId> m_journalNodes;
+    std::unordered_set<EdgeUniqueId> m_journalEdges;
+    // left by the last run, waiting for the file it was made on to be loaded
+    std::optional<EditJournal::Recovered> m_journalRecovery;
 
     FileDialog      m_fileDialog;
 
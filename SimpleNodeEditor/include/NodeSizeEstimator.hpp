@@ -0,0 +1,80 @@
+#ifndef NODESIZEESTIMATOR_H
+#define NODESIZEESTIMATOR_H
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <imgui.h>
+#include "DataStructureEditor.hpp"
+#include "DataStructureYaml.hpp"
+
+namespace SimpleNodeEditor
+{
+
+// Predicts the rect NodeEditor::ShowNodes gives a node, without submitting it to ImNodes, so that
+// layouts can run before the first frame, on another thread or without any ui at all.
+// The node is laid out as in ShowNodes: a one line title bar, then one row per port pair, with the
+// input labels in a left column and the output labels right aligned in a right column. Label widths
+// come from a text measuring function and are cached, since the same port names show up on many
+// nodes.
+class NodeSizeEstimator
+{
+public:
+    struct Metrics
+    {
+        float  m_fontSize    = 13.f;           // also the height of a line of text
+        ImVec2 m_itemSpacing = ImVec2(8.f, 4.f); // ImGuiStyle::ItemSpacing
+        ImVec2 m_nodePadding = ImVec2(8.f, 8.f); // ImNodesStyle::NodePadding
+    };
+    using TextWidthFunction = std::function<float(std::string_view)>;
+
+    // horizontal gap between the input and the output column of a node, shared with ShowNodes
+    static constexpr float s_portColumnGap = 8.f;
+
+    // default metrics and a monospace approximation of text widths, for when no font is loaded
+    NodeSizeEstimator();
+    NodeSizeEstimator(const Metrics& metrics, TextWidthFunction textWidth);
+
+    // metrics of the current ImGui font and styles. Must be called on the ui thread, the result can
+    // then be used anywhere as long as the font atlas lives.
+    static NodeSizeEstimator FromCurrentStyle();
+    // false once the font or the styles FromCurrentStyle read have changed, the cached label
+    // widths are stale then
+    bool IsCurrent() const;
+
+    ImVec2 Estimate(std::string_view title, const std::vector<std::string_view>& inputLabels,
+                    const std::vector<std::string_view>& outputLabels);
+    // a node as ShowNodes draws it, hideUnlinkedPorts as in NodeEditor
+    ImVec2 Estimate(const Node& node, bool hideUnlinkedPorts);
+    // a new node of this description, all ports shown
+    ImVec2 Estimate(const NodeDescription& nodeDesc, std::string_view title);
+
+    // from the top of a node to the pins of its row-th row of visible ports
+    float GetPortRowCenterY(size_t row) const;
+
+    const Metrics& GetMetrics() const { return m_metrics; }
+
+private:
+    // labels are looked up by string_view, without building a string
+    struct LabelHash
+    {
+        using is_transparent = void;
+        size_t operator()(std::string_view label) const
+        {
+            return std::hash<std::string_view>{}(label);
+        }
+    };
+
+    float LabelWidth(std::string_view label);
+
+    Metrics           m_metrics;
+    TextWidthFunction m_textWidth;
+    const ImFont*     m_font; // nullptr when not made from the current style
+    std::unordered_map<std::string, float, LabelHash, std::equal_to<>> m_labelWidths;
+};
+
+} // namespace SimpleNodeEditor
+
+#endif // NODESIZEESTIMATOR_H
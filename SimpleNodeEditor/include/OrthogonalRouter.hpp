@@ -0,0 +1,131 @@
+#ifndef ORTHOGONALROUTER_H
+#define ORTHOGONALROUTER_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <imgui.h>
+#include <imgui_internal.h>
+#include "Helpers.hpp"
+
+namespace SimpleNodeEditor
+{
+
+// Routes edges around nodes with horizontal and vertical segments only.
+// The nodes are stamped into a grid of cells which counts, for every cell, the nodes covering it.
+// Edges are routed with A* on that grid, a move costs one cell, a turn and a cell covered by a node
+// cost more, so routes avoid nodes when they can and go through them when they cannot.
+// The grid and the routes are kept between calls to Apply(): moving a node only restamps the cells
+// it left and entered, and only the edges of the moved nodes and the edges whose route goes
+// through their new place are routed again.
+class OrthogonalRouter
+{
+public:
+    struct Options
+    {
+        float  m_cellSize          = 10.f;
+        float  m_clearance         = 10.f; // space kept free around nodes
+        float  m_stubLength        = 24.f; // straight part of a route next to its pins
+        int    m_bendCost          = 4;    // in cells
+        int    m_obstacleCost      = 40;   // in cells, for every cell covered by a node
+        int    m_searchMargin      = 30;   // cells searched around the bounding box of the ends
+        size_t m_maxSearchCells    = 1 << 20; // larger searches take a route through the middle
+        size_t m_parallelThreshold = 64;   // edge count from which edges are routed in parallel
+    };
+
+    // pins of an edge in grid space, the route leaves start to the right and enters end from the
+    // left, as links do
+    struct EdgeEnds
+    {
+        NodeUniqueId m_sourceNodeUid      = -1;
+        NodeUniqueId m_destinationNodeUid = -1;
+        ImVec2       m_start;
+        ImVec2       m_end;
+
+        bool operator==(const EdgeEnds& other) const;
+    };
+
+    // what changed since the last call to Apply()
+    struct Changes
+    {
+        std::unordered_map<NodeUniqueId, ImRect>   m_nodes; // added or moved, grid space
+        std::vector<NodeUniqueId>                  m_removedNodes;
+        std::unordered_map<EdgeUniqueId, EdgeEnds> m_edges; // added or with moved pins
+        std::vector<EdgeUniqueId>                  m_removedEdges;
+
+        bool Empty() const;
+        // folds later changes into these ones
+        void Merge(Changes&& later);
+    };
+
+    OrthogonalRouter() = default;
+    explicit OrthogonalRouter(const Options& options);
+
+    // returns the edges that were routed again
+    std::vector<EdgeUniqueId> Apply(const Changes& changes);
+    void                      Clear();
+
+    // points of the route in grid space, from the start to the end, nullptr for unknown edges
+    const std::vector<ImVec2>* GetRoute(EdgeUniqueId edgeUid) const;
+
+private:
+    struct Route
+    {
+        EdgeEnds            m_ends;
+        std::vector<ImVec2> m_points; // empty until routed
+        ImRect              m_bounds;
+    };
+
+    // cells from (m_minX, m_minY) to (m_maxX, m_maxY) included
+    struct CellBox
+    {
+        int m_minX = 0;
+        int m_minY = 0;
+        int m_maxX = -1;
+        int m_maxY = -1;
+    };
+
+    // A search state is a cell of the search window and the direction the route enters it with
+    struct OpenState
+    {
+        int32_t  m_score; // cost so far plus estimate
+        int32_t  m_estimate;
+        uint32_t m_order; // push order
+        int32_t  m_state;
+    };
+
+    // A* state reused between searches, one per thread. A state is only valid in the search whose
+    // id it is stamped with, so the buffers never need to be cleared.
+    struct SearchBuffers
+    {
+        std::vector<uint32_t>  m_visit;
+        std::vector<int32_t>   m_cost;
+        std::vector<int32_t>   m_parent;
+        std::vector<OpenState> m_open; // heap
+        uint32_t               m_searchId = 0;
+    };
+
+    ImRect  Inflate(const ImRect& rect) const; // rect with the clearance around it
+    CellBox CellsOf(const ImRect& rect) const;
+    void    Stamp(const ImRect& rect, int delta);
+    void    GrowGrid(const CellBox& cells);
+    int     Occupancy(int cellX, int cellY) const;
+    void    RouteEdges(const std::vector<EdgeUniqueId>& edgeUids, size_t begin, size_t end,
+                       SearchBuffers& buffers);
+    std::vector<ImVec2> FindRoute(const EdgeEnds& ends, SearchBuffers& buffers) const;
+
+    Options m_options;
+
+    std::unordered_map<NodeUniqueId, ImRect> m_nodeRects;
+    std::unordered_map<EdgeUniqueId, Route>  m_routes;
+
+    // node count per cell, row after row
+    std::vector<uint16_t> m_occupancy;
+    CellBox               m_gridCells;
+
+    std::vector<SearchBuffers> m_buffers; // one per thread routing edges
+};
+
+} // namespace SimpleNodeEditor
+
+#endif // ORTHOGONALROUTER_H
@@ -0,0 +1,49 @@
+#ifndef PIPELINECACHE_H
+#define PIPELINECACHE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "DataStructureYaml.hpp"
+
+namespace SimpleNodeEditor
+{
+
+// Binary snapshots of parsed pipeline files, so that opening the same large file again skips the
+// yaml parsing.
+// A snapshot holds a table of the distinct strings of the pipeline and flat arrays of node,
+// property, pruning rule, port and edge records that refer to each other and to the strings by
+// index. It is mapped into memory when loaded and the records are copied out as they are, nothing
+// is parsed.
+// Snapshots live in the cache directory, one per pipeline file, named after a hash of its path.
+// A snapshot is only used while the size, the modification time and a hash of the content of the
+// file are the ones it was written for. The format follows the memory layout of the machine, a
+// snapshot written elsewhere is rejected like a stale one.
+class PipelineCache
+{
+public:
+    // an empty directory turns the cache off
+    explicit PipelineCache(const std::string& cacheDirectory);
+
+    bool IsEnabled() const { return !m_cacheDirectory.empty(); }
+
+    // contentHash is HashContent of the text of the pipeline file at filePath. Returns false when
+    // there is no fresh snapshot for it
+    bool Load(const std::string& filePath, uint64_t contentHash, std::string& pipelineName,
+              std::vector<YamlNode>& nodes, std::vector<YamlEdge>& edges) const;
+    void Store(const std::string& filePath, uint64_t contentHash, const std::string& pipelineName,
+               const std::vector<YamlNode>& nodes, const std::vector<YamlEdge>& edges) const;
+
+    static uint64_t HashContent(std::string_view content);
+
+private:
+    std::filesystem::path GetSnapshotPath(const std::string& filePath) const;
+
+    std::filesystem::path m_cacheDirectory;
+};
+
+} // namespace SimpleNodeEditor
+
+#endif // PIPELINECACHE_H
@@ -0,0 +1,143 @@
+#ifndef PIPELINEEVENTHANDLER_H
+#define PIPELINEEVENTHANDLER_H
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include <yaml-cpp/eventhandler.h>
+#include <yaml-cpp/mark.h>
+#include "DataStructureYaml.hpp"
+
+namespace SimpleNodeEditor
+{
+
+// Reads a pipeline file from the events of YAML::Parser and builds the YamlNode and YamlEdge
+// records as it goes, without the YAML::Node tree of the whole file.
+// Besides the records, it only holds the containers it is inside of and the entry being read, so
+// the memory used does not grow with the file. Only the first pipeline of the file is read, keys
+// it does not know are skipped along with everything under them.
+class PipelineEventHandler : public YAML::EventHandler
+{
+public:
+    struct Result
+    {
+        bool                       m_hasPipeline = false; // "Pipeline" holds a map
+        std::optional<std::string> m_pipelineName;
+        bool                       m_hasNodeList = false; // "NodeList" is a sequence
+        size_t                     m_nodeListSize = 0;    // entries in it, valid or not
+        bool                       m_hasLinkList = false;
+        size_t                     m_linkListSize = 0;
+        std::vector<YamlNode>      m_nodes;
+        std::vector<YamlEdge>      m_edges; // one per destination port of every link
+        // for the user, the handler runs off the UI thread and cannot show them itself
+        std::vector<std::string>   m_errors;
+    };
+
+    // thrown out of the parser once the cancel flag is set
+    struct Cancelled
+    {
+    };
+
+    // what the parsed text holds
+    enum class Fragment
+    {
+        Document, // a whole pipeline file
+        NodeList, // entries of a NodeList sequence, cut out of a file
+        LinkList
+    };
+
+    PipelineEventHandler() = default;
+    // lineOffset is the line of the file the fragment starts at, for error messages
+    explicit PipelineEventHandler(const std::atomic<bool>* cancelled,
+                                  Fragment fragment = Fragment::Document, int lineOffset = 0)
+        : m_cancelled(cancelled), m_fragment(fragment), m_lineOffset(lineOffset)
+    {
+    }
+
+    Result& GetResult() { return m_result; }
+
+    void OnDocumentStart(const YAML::Mark& mark) override;
+    void OnDocumentEnd() override;
+    void OnNull(const YAML::Mark& mark, YAML::anchor_t anchor) override;
+    void OnAlias(const YAML::Mark& mark, YAML::anchor_t anchor) override;
+    void OnScalar(const YAML::Mark& mark, const std::string& tag, YAML::anchor_t anchor,
+                  const std::string& value) override;
+    void OnSequenceStart(const YAML::Mark& mark, const std::string& tag, YAML::anchor_t anchor,
+                         YAML::EmitterStyle::value style) override;
+    void OnSequenceEnd() override;
+    void OnMapStart(const YAML::Mark& mark, const std::string& tag, YAML::anchor_t anchor,
+                    YAML::EmitterStyle::value style) override;
+    void OnMapEnd() override;
+
+private:
+    // what a container holds, given by where it sits in the file
+    enum class Role
+    {
+        Skip,
+        Root,
+        PipelineList,
+        Pipeline,
+        NodeList,
+        Node,
+        NodeProperties,
+        NodeProperty,
+        NodePruneRules,
+        PortPruneRules,
+        PruneRule,
+        Position,
+        LinkList,
+        Link,
+        SrcPort,
+        DstPorts,
+        DstPort
+    };
+
+    struct Frame
+    {
+        Role        m_role;
+        bool        m_isMap;
+        bool        m_hasKey;   // maps only, the key is read and its value is expected
+        std::string m_key;
+        size_t      m_children; // values read so far
+        int         m_line;     // where the container starts, for error messages
+    };
+
+    Role ChildRole(bool isMap) const;
+    void BeginContainer(const YAML::Mark& mark, bool isMap);
+    void EndContainer();
+    // return true if the scalar is the key of the next value of the top map
+    bool ReadKey(const std::string& key);
+    void OnScalarValue(const YAML::Mark& mark, const std::string& value);
+    // a value of the top container was read, whatever it was
+    void EndValue();
+
+    template <typename T>
+    void ParseNumber(const YAML::Mark& mark, const std::string& value, T& number);
+
+    const std::atomic<bool>* m_cancelled = nullptr; // checked on every map or sequence
+    Fragment                 m_fragment  = Fragment::Document;
+    int                      m_lineOffset = 0;
+    Result                   m_result;
+    std::vector<Frame>       m_frames;
+
+    // entries being read, only one of each kind can be open at a time
+    YamlNode              m_node;
+    uint32_t              m_nodeKeys = 0; // required keys seen, one bit each
+    std::vector<float>    m_position;
+    bool                  m_hasPosition = false;
+    std::string           m_propertyName;
+    std::string           m_propertyValue;
+    uint32_t              m_propertyKeys = 0;
+    YamlPruningRule       m_pruneRule;
+    uint32_t              m_pruneRuleKeys = 0;
+    YamlPort              m_port;
+    uint32_t              m_portKeys = 0;
+    std::optional<YamlPort> m_srcPort;
+    std::optional<std::vector<YamlPort>> m_dstPorts;
+};
+
+} // namespace SimpleNodeEditor
+
+#endif // PIPELINEEVENTHANDLER_H
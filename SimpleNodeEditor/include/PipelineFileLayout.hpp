@@ -0,0 +1,94 @@
+#ifndef PIPELINEFILELAYOUT_H
+#define PIPELINEFILELAYOUT_H
+
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "YamlEmitter.hpp"
+
+namespace SimpleNodeEditor
+{
+
+// Remembers where every node and link entry of the last saved pipeline file lies, so that the next
+// save to the same file only writes the entries that changed since.
+// Every entry of the file owns a slot, the bytes it was written to. An entry whose text is the
+// same as the one in its slot is left alone, a changed or new one is written over a free slot of
+// its list that is large enough, padded with spaces, or appended to the file under a new
+// "NodeListPatch<n>" or "LinkListPatch<n>" key, which the parser reads as more entries of the
+// list. The slots of removed entries are blanked with spaces.
+// When the text around the entries changes, e.g. the pipeline name, or too much of the file would
+// be blank or patches, the caller saves the whole file again instead. So it does when the file is
+// not the one last saved any more, i.e. its modification time or size changed or a slot about to
+// be overwritten does not hold what was written to it. Only those slots are read back.
+class PipelineFileLayout
+{
+public:
+    using EmitFunction = std::function<void(PipelineEmitter&)>;
+
+    // the writes that bring the last saved file up to date, see PlanChanges
+    struct Patch
+    {
+        struct Write
+        {
+            size_t      m_slot; // index in the slots of the file as it is
+            size_t      m_offset;
+            std::string m_text;
+        };
+        struct Slot
+        {
+            PipelineEmitter::RecordList m_list;
+            size_t                      m_offset;
+            size_t                      m_capacity;
+            size_t                      m_length; // of the text in it, 0 for a free slot
+            uint64_t                    m_hash;
+        };
+
+        std::vector<Write> m_writes;   // in place, in the file as it is
+        std::string        m_appended; // at its end
+        std::vector<Slot>  m_slots;    // of the file once written
+        size_t             m_fileSize;
+        int                m_patchSections;
+    };
+
+    PipelineFileLayout();
+
+    // target names the file, and the file system it is on, the layout was recorded for
+    bool IsFor(const std::string& target) const;
+    void Reset();
+
+    // writes the whole pipeline emitted by emit to output and records where its entries are.
+    // Returns false when it could not be written
+    bool WriteAll(const std::string& target, std::ostream& output, const EmitFunction& emit);
+    // emits the pipeline through emit without writing it and works out the writes that turn the
+    // last saved file into it. Returns nothing when the whole file is better written again
+    std::optional<Patch> PlanChanges(const EmitFunction& emit) const;
+    // the modification time of the file once written and closed, 0 when it is not known
+    void SetModifiedTime(std::time_t modifiedTime) { m_modifiedTime = modifiedTime; }
+    // saved is the file of the last save opened for reading, modifiedTime and fileSize what the
+    // file system tells of it, and output the same file opened for writing without truncating it.
+    // Returns false, and forgets the layout, when the file is not the one last saved or the writes
+    // failed
+    bool ApplyChanges(Patch patch, std::time_t modifiedTime, int64_t fileSize, std::istream& saved,
+                      std::ostream& output);
+
+private:
+    // whether the bytes of slot in saved are still the ones written to it
+    bool SlotHoldsSaved(const Patch::Slot& slot, std::istream& saved) const;
+
+    std::string              m_target; // empty when there is no layout
+    std::vector<Patch::Slot> m_slots;
+    size_t                   m_fileSize;
+    std::time_t              m_modifiedTime;
+    uint64_t                 m_surroundingHash; // of the text that is not in an entry
+    std::string              m_keyIndent;       // of the NodeList and LinkList keys
+    int                      m_patchSections;
+};
+
+} // namespace SimpleNodeEditor
+
+#endif // PIPELINEFILELAYOUT_H
@@ -0,0 +1,94 @@
+#ifndef PIPELINELOADER_H
+#define PIPELINELOADER_H
+
+#include <atomic>
+#include <future>
+#include <istream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "DataStructureYaml.hpp"
+#include "FileSystem.hpp"
+
+namespace SimpleNodeEditor
+{
+
+// Reads and parses pipeline files on a background thread, so that the window keeps running while a
+// large file loads. The UI thread polls for the parsed records once per frame and builds the graph
+// from them itself.
+// At most one load runs at a time: a load requested while one is running cancels it, and only the
+// latest waiting request is kept.
+class PipelineLoader
+{
+public:
+    struct Result
+    {
+        bool                  m_succeeded = false;
+        std::string           m_sourceName; // what was loaded, for messages
+        std::string           m_pipelineName;
+        std::vector<YamlNode> m_nodes;
+        std::vector<YamlEdge> m_edges;
+        // for the user, shown by whoever polls the result
+        std::vector<std::string> m_errors;
+        std::vector<std::string> m_warnings;
+    };
+
+    PipelineLoader() = default;
+    ~PipelineLoader(); // cancels the running load and waits for it
+
+    PipelineLoader(const PipelineLoader&) = delete;
+    PipelineLoader& operator=(const PipelineLoader&) = delete;
+
+    void Load(const std::string& filePath);
+    void Load(std::unique_ptr<std::istream> inputStream, const std::string& sourceName);
+    // filePath is where mappedFile comes from
+    void Load(std::unique_ptr<FS::MappedFile> mappedFile, const std::string& filePath);
+    // returns the finished load, if any, and starts the waiting request. Cancelled loads return
+    // nothing.
+    std::optional<Result> Poll();
+    // cancel the running load and forget the waiting one
+    void Cancel();
+    bool IsBusy() const;
+    // where snapshots of loaded files are kept, see PipelineCache. Empty turns them off
+    void SetCacheDirectory(const std::string& cacheDirectory) { m_cacheDirectory = cacheDirectory; }
+
+    // of the running load
+    const std::string& GetSourceName() const { return m_runningSourceName; }
+    // bytes read so far and in total, the total is 0 when the size of the input is unknown
+    std::pair<size_t, size_t> GetProgress() const;
+
+private:
+    struct Request
+    {
+        // the first one set is read, m_filePath also keys the cache
+        std::string                     m_filePath;
+        std::unique_ptr<FS::MappedFile> m_mappedFile;
+        std::unique_ptr<std::istream>   m_inputStream;
+        std::string                     m_sourceName;
+        std::string                     m_cacheDirectory;
+    };
+
+    // shared with the running task
+    struct Progress
+    {
+        std::atomic<size_t> m_bytesRead{0};
+        std::atomic<size_t> m_bytesTotal{0};
+        std::atomic<bool>   m_cancelled{false};
+    };
+
+    void          Enqueue(Request request);
+    void          Launch(Request request);
+    static Result Run(Request request, Progress& progress);
+
+    std::future<Result>       m_running;
+    std::shared_ptr<Progress> m_progress;
+    std::string               m_runningSourceName;
+    std::optional<Request>    m_pending;
+    std::string               m_cacheDirectory;
+};
+
+} // namespace SimpleNodeEditor
+
+#endif // PIPELINELOADER_H
@@ -0,0 +1,54 @@
+#ifndef ROUTEWORKER_H
+#define ROUTEWORKER_H
+
+#include <future>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <imgui.h>
+#include "OrthogonalRouter.hpp"
+
+namespace SimpleNodeEditor
+{
+
+// Runs OrthogonalRouter on a background thread. The router, with its obstacle grid and its routes,
+// is moved into the running task and comes back with the result, so nothing is shared with the UI
+// thread. Changes requested while a task runs are merged and handed over together afterwards.
+class RouteWorker
+{
+public:
+    struct Result
+    {
+        std::vector<EdgeUniqueId> m_removedEdges; // to apply before m_routes
+        std::unordered_map<EdgeUniqueId, std::vector<ImVec2>> m_routes; // edges routed again
+    };
+
+    RouteWorker();
+    ~RouteWorker() = default; // waits for the running task, if any
+
+    RouteWorker(const RouteWorker&) = delete;
+    RouteWorker& operator=(const RouteWorker&) = delete;
+
+    void Request(OrthogonalRouter::Changes changes);
+    // returns the finished routes, if any, and starts the waiting changes
+    std::optional<Result> Poll();
+    // forget every node and route, the running task still completes but its result is dropped
+    void Reset();
+    bool IsBusy() const;
+
+private:
+    using Task = std::pair<std::unique_ptr<OrthogonalRouter>, Result>;
+
+    void Launch(OrthogonalRouter::Changes changes);
+
+    std::unique_ptr<OrthogonalRouter>        m_router; // null while a task owns it
+    std::future<Task>                        m_running;
+    std::optional<OrthogonalRouter::Changes> m_pending;
+    bool                                     m_dropRunning = false;
+};
+
+} // namespace SimpleNodeEditor
+
+#endif // ROUTEWORKER_H
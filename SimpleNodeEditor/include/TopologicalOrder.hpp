@@ -0,0 +1,122 @@
+#ifndef TOPOLOGICALORDER_H
+#define TOPOLOGICALORDER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "DataStructureEditor.hpp"
+#include "Helpers.hpp"
+
+namespace SimpleNodeEditor
+{
+
+// Dynamic topological order of the node graph (Pearce-Kelly), kept up to date on every node and
+// edge insertion or deletion instead of being recomputed from scratch.
+// Besides the order, every node keeps its level, i.e. the length of the longest path reaching it
+// from a node without inputs, which is the column TopologicalSort would put it in.
+// Edges that would close a cycle are rejected and leave the order untouched. Cycles can still come
+// in with a loaded pipeline: the edges inside them are kept aside, untracked, and tracked again as
+// soon as removing an edge breaks their cycle. Levels only follow the tracked edges, so once the
+// graph is edited the nodes of a cycle may stop sharing the level the rebuild gave them, edges
+// between cycles still go up a level.
+class TopologicalOrder
+{
+public:
+    TopologicalOrder();
+    ~TopologicalOrder() = default;
+
+    TopologicalOrder(const TopologicalOrder&) = delete;
+    TopologicalOrder& operator=(const TopologicalOrder&) = delete;
+
+    void AddNode(NodeUniqueId nodeUid);
+    // all edges of the node must have been removed before
+    void RemoveNode(NodeUniqueId nodeUid);
+    // return false if the edge would create a cycle, the edge is not added in that case
+    bool AddEdge(NodeUniqueId srcNodeUid, NodeUniqueId dstNodeUid);
+    // for edges that were in the graph before, e.g. brought back by undo: an edge closing a cycle
+    // is kept untracked like the cycles of a loaded pipeline. Return false in that case.
+    bool RestoreEdge(NodeUniqueId srcNodeUid, NodeUniqueId dstNodeUid);
+    void RemoveEdge(NodeUniqueId srcNodeUid, NodeUniqueId dstNodeUid);
+
+    // -1 for unknown nodes
+    int GetLevel(NodeUniqueId nodeUid) const;
+    // nodes grouped by level, each group in topological order
+    std::vector<std::vector<NodeUniqueId>> GetLevels() const;
+    // visit the nodes of the levels [firstLevel, lastLevel], in no particular order
+    template <typename Visit>
+    void ForEachNodeInLevels(int firstLevel, int lastLevel, Visit visit) const
+    {
+        const int levelCount = static_cast<int>(m_slotsOfLevel.size());
+        for (int level = std::max(firstLevel, 0); level <= lastLevel && level < levelCount; ++level)
+        {
+            for (int slot : m_slotsOfLevel[level])
+            {
+                visit(m_nodeOfSlot[slot]);
+            }
+        }
+    }
+    // true while some edges sit on a cycle and are not tracked
+    bool HasCycles() const { return !m_untrackedEdges.empty(); }
+    // bumped by every change to the tracked graph, never goes back
+    uint64_t GetRevision() const { return m_revision; }
+    // nodes whose level changed since the last call, each once. Rebuilding the order forgets them.
+    std::vector<NodeUniqueId> TakeRelevelledNodes();
+
+    // while batch updating (e.g. loading a pipeline), edges are not tracked one by one, the order
+    // is rebuilt from the whole graph at the end instead
+    void BeginBatchUpdate();
+    void EndBatchUpdate(const std::unordered_map<NodeUniqueId, Node>& nodesMap,
+                        const std::unordered_map<EdgeUniqueId, Edge>& edgesMap);
+    void Rebuild(const std::unordered_map<NodeUniqueId, Node>& nodesMap,
+                 const std::unordered_map<EdgeUniqueId, Edge>& edgesMap);
+
+    void Clear();
+
+private:
+    int  FindSlot(NodeUniqueId nodeUid) const;
+    int  AllocSlot(NodeUniqueId nodeUid);
+    bool TrackEdge(int srcSlot, int dstSlot);
+    void KeepUntracked(int srcSlot, int dstSlot);
+    bool ReachesThroughUntracked(int startSlot, int targetSlot);
+    bool CollectForward(int startSlot, int upperBound);
+    void CollectBackward(int startSlot, int lowerBound);
+    void Reorder();
+    void SetLevel(int slot, int level);
+    void MoveToLevel(int slot, int level);
+    void UnlinkFromLevel(int slot);
+    void RaiseLevels(int startSlot);
+    void LowerLevels(std::span<const int> startSlots);
+    void RetrackEdges();
+
+    std::unordered_map<NodeUniqueId, int> m_slotOfNode;
+    std::vector<NodeUniqueId>             m_nodeOfSlot; // -1 for free slots
+    std::vector<int>                      m_order;      // topological position of each slot
+    std::vector<int>                      m_levels;
+    std::vector<std::vector<int>>         m_slotsOfLevel; // slots of the nodes on each level
+    std::vector<int>                      m_indexInLevel; // index of each slot in m_slotsOfLevel
+    // one entry per edge, so nodes linked by several edges show up several times
+    std::vector<std::vector<int>>         m_successors;
+    std::vector<std::vector<int>>         m_predecessors;
+    std::vector<int>                      m_freeSlots;
+    std::vector<std::pair<int, int>>      m_untrackedEdges; // src slot, dst slot
+    std::vector<std::vector<int>>         m_untrackedSuccessors; // the same edges, per src slot
+    int                                   m_nextOrder;
+    bool                                  m_batchUpdating;
+    uint64_t                              m_revision;
+    std::vector<char>                     m_relevelled; // per slot, set while in m_relevelledSlots
+    std::vector<int>                      m_relevelledSlots;
+
+    // scratch buffers, kept to avoid allocations on every edit
+    std::vector<char> m_visited;
+    std::vector<int>  m_forward;
+    std::vector<int>  m_backward;
+    std::vector<int>  m_stack;
+    std::vector<int>  m_positions;
+};
+
+} // namespace SimpleNodeEditor
+
+#endif // TOPOLOGICALORDER_H
@@ -3,6 +3,7 @@
 #include "yaml-cpp/yaml.h"
 #include "DataStructureEditor.hpp"
 #include "DataStructureYaml.hpp"
+#include "LinkGroups.hpp"
 namespace SimpleNodeEditor
 {
 
@@ -10,6 +11,8 @@ class YamlEmitter
 {
 public:
     YamlEmitter();
+    // the text goes straight to the stream as it is emitted, instead of into a string
+    explicit YamlEmitter(std::ostream& stream);
     YamlEmitter(const YamlEmitter&)            = delete;
     YamlEmitter& operator=(const YamlEmitter&) = delete;
     ~YamlEmitter()                             = default;
@@ -44,38 +47,65 @@ protected:
     }
 
 private:
+    std::ostream*                  m_stream; // nullptr when emitting into a string
     std::unique_ptr<YAML::Emitter> m_Emitter;
 };
 
 class PipelineEmitter : public YamlEmitter
 {
 public:
+    enum class RecordList
+    {
+        NodeList,
+        LinkList
+    };
+
+    // told where each node and link entry begins and ends in the emitted text, as offsets from
+    // the start of it
+    class RecordObserver
+    {
+    public:
+        virtual ~RecordObserver()                                        = default;
+        virtual void OnRecord(RecordList list, size_t begin, size_t end) = 0;
+    };
+
     PipelineEmitter();
     explicit PipelineEmitter(std::ostream& stream);
     PipelineEmitter(const PipelineEmitter&)            = delete;
     PipelineEmitter& operator=(const PipelineEmitter&) = delete;
     ~PipelineEmitter()                                 = default;
+    void SetRecordObserver(RecordObserver* observer) { m_recordObserver = observer; }
+    // return the text emitted, or an empty view for an emitter on a stream, whose text is in the
+    // stream already
     std::string_view EmitPipeline(const std::string&                            pipelineName,
                       const std::unordered_map<NodeUniqueId, Node>& nodesMap,
                       const std::unordered_map<NodeUniqueId, Node>& prunedNodesMap,
                       const std::unordered_map<EdgeUniqueId, Edge>& egesMap,
-                      const std::unordered_map<NodeUniqueId, Edge>& prunedEdgesMap);
+                      const std::unordered_map<NodeUniqueId, Edge>& prunedEdgesMap,
+                      const LinkGroups&                             linkGroups);
 
+    // linkGroups holds the edges of egesMap, and of prunedEdgesMap, by source port
     std::string_view EmitPipeline(const std::string& pipelineName,
                                    const std::unordered_map<NodeUniqueId, Node>& nodesMap,
-                                   const std::unordered_map<EdgeUniqueId, Edge>& egesMap);
+                                   const std::unordered_map<EdgeUniqueId, Edge>& egesMap,
+                                   const LinkGroups&                             linkGroups);
 
 private:
     void EmitNodeList(const std::unordered_map<NodeUniqueId, Node>& nodesMap);
     void EmitNodeList(const std::unordered_map<NodeUniqueId, Node>& nodesMap,
                       const std::unordered_map<NodeUniqueId, Node>& prunedNodesMap);
 
-    void EmitLinkList(const std::unordered_map<EdgeUniqueId, Edge>& edgesMap);
-    void EmitLinkList(const std::unordered_map<EdgeUniqueId, Edge>& edgesMap,
-                      const std::unordered_map<EdgeUniqueId, Edge>& prunedEdgesMap);
+    // edges of a group found in neither map are skipped
+    void EmitLinkList(const LinkGroups& linkGroups,
+                      const std::unordered_map<EdgeUniqueId, Edge>& edgesMap,
+                      const std::unordered_map<EdgeUniqueId, Edge>* prunedEdgesMap = nullptr);
 
     void EmitYamlNode(const YamlNode& yamlNode);
-    void EmitYamlEdge(const YamlPort& srcPort, const std::vector<YamlPort>& dstPortVec);
+    void EmitYamlEdge(const YamlPort& srcPort, const std::vector<const YamlPort*>& dstPortVec);
+    void NotifyRecord(RecordList list, size_t begin);
+
+    RecordObserver*              m_recordObserver;
+    std::vector<const YamlPort*> m_dstPorts; // of the link being emitted
 };
 
 } // namespace SimpleNodeEditor
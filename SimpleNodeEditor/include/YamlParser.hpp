@@ -8,6 +8,7 @@
 #include "DataStructureYaml.hpp"
 #include "FileSystem.hpp"
 #include "Common.hpp"
+#include "PipelineEventHandler.hpp"
 namespace YAML
 {
 
@@ -123,6 +124,12 @@ struct convert<SimpleNodeEditor::YamlNode>
             node["PruneRule"].push_back(pruneRule);
         }
 
+        if (rhs.m_position)
+        {
+            node["Position"].push_back(rhs.m_position->m_x);
+            node["Position"].push_back(rhs.m_position->m_y);
+        }
+
         return node;
     }
 
@@ -168,10 +175,22 @@ struct convert<SimpleNodeEditor::YamlNode>
         std::string nodePropertyKey = "NodeProperty";
         if (isValidKey(node, nodePropertyKey))
         {
+            // packed as they are, see YamlNodeProperties
             for (YAML::const_iterator iter = node[nodePropertyKey].begin();
                  iter != node[nodePropertyKey].end(); ++iter)
             {
-                rhs.m_Properties.push_back(iter->as<SimpleNodeEditor::YamlNodeProperty>());
+                const Node& property = *iter;
+                if (property.IsMap() && isValidKey(property, "NodePropertyName") &&
+                    isValidKey(property, "NodePropertyValue"))
+                {
+                    rhs.m_Properties.Add(property["NodePropertyName"].Scalar(), 0,
+                                         property["NodePropertyValue"].Scalar());
+                }
+                else
+                {
+                    SNELOG_WARN("invalid NodeProperty of node[{}], it is skipped",
+                                rhs.m_nodeYamlId);
+                }
             }
         }
         else
@@ -179,6 +198,22 @@ struct convert<SimpleNodeEditor::YamlNode>
             SNELOG_WARN("invalide nodeproperty key {}", nodePropertyKey);
         }
 
+        // position is optional, older files do not have it
+        std::string positionKey = "Position";
+        if (isValidKey(node, positionKey))
+        {
+            const Node& positionNode = node[positionKey];
+            if (positionNode.IsSequence() && positionNode.size() == 2)
+            {
+                rhs.m_position = SimpleNodeEditor::YamlNodePosition{positionNode[0].as<float>(),
+                                                                    positionNode[1].as<float>()};
+            }
+            else
+            {
+                SNELOG_WARN("invalid node position of node[{}], expecting [x, y]", rhs.m_nodeYamlId);
+            }
+        }
+
         SNELOG_INFO(
             "decode yamlnode done, nodename = [{}], nodeYamlId[{}], issourcenode[{}], "
             "yamlNodeType[{}]",
@@ -300,22 +335,38 @@ public:
     std::vector<NodeDescription> ParseNodeDescriptions();
 };
 
+// Pipeline files are read in a single pass over the parser events, see PipelineEventHandler,
+// instead of being loaded into a YAML::Node tree first
 class PipelineParser : public YamlParser
 {
 public:
     PipelineParser();
+    // hand over what the last load read, a second call returns nothing
     std::vector<YamlNode> ParseNodes();
     std::vector<YamlEdge> ParseEdges();
     const std::string&    GetPipelineName();
+    // what the last load has to tell the user, the loads may run off the UI thread, which shows them
+    std::vector<std::string> TakeErrors() { return std::move(m_errors); }
+    std::vector<std::string> TakeWarnings() { return std::move(m_warnings); }
+    // threads the NodeList and LinkList of large texts are parsed on, 0 is one per hardware
+    // thread, 1 parses every text on the calling thread
+    void SetThreadCount(size_t threadCount);
 
     [[nodiscard]] virtual bool LoadFile(const std::string& filePath);
-    [[nodiscard]] bool LoadStream(std::istream& inputStream);
+    // a load stops early and fails once *cancelled is set
+    [[nodiscard]] bool LoadStream(std::istream&            inputStream,
+                                  const std::atomic<bool>* cancelled = nullptr);
+    // parse a text in memory, e.g. a mapped file, without copying it
+    [[nodiscard]] bool LoadText(std::string_view text, const std::atomic<bool>* cancelled = nullptr);
     virtual void               Clear() override;
 
 private:
-    std::string m_pipelineName;
-    YAML::Node  m_nodeListNode;
-    YAML::Node  m_edgeListNode;
+    std::string           m_pipelineName;
+    std::vector<YamlNode> m_yamlNodes;
+    std::vector<YamlEdge> m_yamlEdges;
+    std::vector<std::string> m_errors;
+    std::vector<std::string> m_warnings;
+    size_t                   m_threadCount;
 };
 
 } // namespace SimpleNodeEditor
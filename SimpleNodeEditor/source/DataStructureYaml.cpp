@@ -3,4 +3,36 @@
 namespace SimpleNodeEditor
 {
 
+void YamlNodeProperties::Add(std::string_view name, int32_t id, std::string_view value)
+{
+    if (m_isDecoded)
+    {
+        m_decoded.push_back(YamlNodeProperty{std::string(name), id, std::string(value)});
+        return;
+    }
+    const uint32_t nameSize  = static_cast<uint32_t>(name.size());
+    const uint32_t valueSize = static_cast<uint32_t>(value.size());
+    m_packed.append(reinterpret_cast<const char*>(&nameSize), sizeof(nameSize));
+    m_packed.append(name);
+    m_packed.append(reinterpret_cast<const char*>(&id), sizeof(id));
+    m_packed.append(reinterpret_cast<const char*>(&valueSize), sizeof(valueSize));
+    m_packed.append(value);
+    ++m_packedCount;
+}
+
+std::vector<YamlNodeProperty>& YamlNodeProperties::Decode()
+{
+    if (!m_isDecoded)
+    {
+        m_decoded.reserve(m_packedCount);
+        ForEach([this](std::string_view name, int32_t id, std::string_view value)
+                { m_decoded.push_back(YamlNodeProperty{std::string(name), id, std::string(value)}); });
+        m_packed.clear();
+        m_packed.shrink_to_fit();
+        m_packedCount = 0;
+        m_isDecoded   = true;
+    }
+    return m_decoded;
+}
+
 } // namespace SimpleNodeEditor
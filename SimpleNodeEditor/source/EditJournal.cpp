@@ -0,0 +1,554 @@
+#include "EditJournal.hpp"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <type_traits>
+#include <unordered_map>
+#include "Log.hpp"
+#include "PipelineCache.hpp"
+#ifdef _WIN32
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
+
+namespace SimpleNodeEditor
+{
+
+static constexpr char     s_journalMagic[8] = {'S', 'N', 'E', 'J', 'R', 'N', 'L', '\0'};
+static constexpr uint32_t s_journalVersion  = 1;
+
+// the file starts with the magic, the version and the base target, then come the entries, each
+// as its size, the hash of its bytes and the bytes
+
+// appends numbers as they are in memory and strings with their size before them
+class JournalWriter
+{
+public:
+    explicit JournalWriter(std::string& bytes) : m_bytes(bytes) {}
+
+    template <typename T>
+    void Write(T value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        m_bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void Write(const std::string& text)
+    {
+        Write(static_cast<uint32_t>(text.size()));
+        m_bytes.append(text);
+    }
+
+    void Write(const std::vector<YamlPruningRule>& rules)
+    {
+        Write(static_cast<uint32_t>(rules.size()));
+        for (const YamlPruningRule& rule : rules)
+        {
+            Write(rule.m_Group);
+            Write(rule.m_Type);
+        }
+    }
+
+    void Write(const YamlPort& port)
+    {
+        Write(port.m_nodeName);
+        Write(port.m_nodeYamlId);
+        Write(port.m_portName);
+        Write(port.m_portYamlId);
+        Write(port.m_PruningRules);
+    }
+
+    void Write(const YamlNode& node)
+    {
+        Write(node.m_nodeName);
+        Write(node.m_nodeYamlId);
+        Write(node.m_isSrcNode);
+        Write(node.m_nodeYamlType);
+        Write(static_cast<uint32_t>(node.m_Properties.size()));
+        node.m_Properties.ForEach(
+            [this](std::string_view name, int32_t id, std::string_view value)
+            {
+                Write(std::string(name));
+                Write(id);
+                Write(std::string(value));
+            });
+        Write(node.m_PruningRules);
+        Write(static_cast<uint8_t>(node.m_position.has_value()));
+        if (node.m_position)
+        {
+            Write(node.m_position->m_x);
+            Write(node.m_position->m_y);
+        }
+    }
+
+private:
+    std::string& m_bytes;
+};
+
+// the reverse of JournalWriter, every read is checked against the end of the bytes
+class JournalReader
+{
+public:
+    explicit JournalReader(std::string_view bytes) : m_bytes(bytes), m_offset(0) {}
+
+    bool AtEnd() const { return m_offset == m_bytes.size(); }
+
+    template <typename T>
+    bool Read(T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (m_bytes.size() - m_offset < sizeof(T))
+        {
+            return false;
+        }
+        std::memcpy(&value, m_bytes.data() + m_offset, sizeof(T));
+        m_offset += sizeof(T);
+        return true;
+    }
+
+    bool Read(std::string& text)
+    {
+        uint32_t size = 0;
+        if (!Read(size) || m_bytes.size() - m_offset < size)
+        {
+            return false;
+        }
+        text.assign(m_bytes.data() + m_offset, size);
+        m_offset += size;
+        return true;
+    }
+
+    bool Read(std::vector<YamlPruningRule>& rules)
+    {
+        uint32_t count = 0;
+        if (!Read(count) || m_bytes.size() - m_offset < count)
+        {
+            return false;
+        }
+        rules.resize(count);
+        for (YamlPruningRule& rule : rules)
+        {
+            if (!Read(rule.m_Group) || !Read(rule.m_Type))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool Read(YamlPort& port)
+    {
+        return Read(port.m_nodeName) && Read(port.m_nodeYamlId) && Read(port.m_portName) &&
+               Read(port.m_portYamlId) && Read(port.m_PruningRules);
+    }
+
+    bool Read(YamlNode& node)
+    {
+        uint32_t propertyCount = 0;
+        if (!Read(node.m_nodeName) || !Read(node.m_nodeYamlId) || !Read(node.m_isSrcNode) ||
+            !Read(node.m_nodeYamlType) || !Read(propertyCount) ||
+            m_bytes.size() - m_offset < propertyCount)
+        {
+            return false;
+        }
+        std::string name;
+        std::string value;
+        for (uint32_t index = 0; index < propertyCount; ++index)
+        {
+            int32_t id = 0;
+            if (!Read(name) || !Read(id) || !Read(value))
+            {
+                return false;
+            }
+            node.m_Properties.Add(name, id, value);
+        }
+        uint8_t hasPosition = 0;
+        if (!Read(node.m_PruningRules) || !Read(hasPosition))
+        {
+            return false;
+        }
+        if (hasPosition)
+        {
+            YamlNodePosition position{};
+            if (!Read(position.m_x) || !Read(position.m_y))
+            {
+                return false;
+            }
+            node.m_position = position;
+        }
+        return true;
+    }
+
+private:
+    std::string_view m_bytes;
+    size_t           m_offset;
+};
+
+static std::string SerializeEntry(const EditJournal::Entry& entry)
+{
+    using Type = EditJournal::Entry::Type;
+
+    std::string   payload;
+    JournalWriter writer(payload);
+    writer.Write(entry.m_type);
+    switch (entry.m_type)
+    {
+    case Type::PutNode:
+    case Type::RemoveNode:
+        writer.Write(entry.m_node);
+        break;
+    case Type::PutEdge:
+    case Type::RemoveEdge:
+        writer.Write(entry.m_edge.m_yamlSrcPort);
+        writer.Write(entry.m_edge.m_yamlDstPort);
+        break;
+    default:
+        writer.Write(entry.m_first);
+        writer.Write(entry.m_second);
+        break;
+    }
+
+    std::string   bytes;
+    JournalWriter framer(bytes);
+    framer.Write(static_cast<uint32_t>(payload.size()));
+    framer.Write(PipelineCache::HashContent(payload));
+    bytes += payload;
+    return bytes;
+}
+
+static bool DeserializeEntry(std::string_view payload, EditJournal::Entry& entry)
+{
+    using Type = EditJournal::Entry::Type;
+
+    JournalReader reader(payload);
+    if (!reader.Read(entry.m_type))
+    {
+        return false;
+    }
+    bool succeeded = false;
+    switch (entry.m_type)
+    {
+    case Type::PutNode:
+    case Type::RemoveNode:
+        succeeded = reader.Read(entry.m_node);
+        break;
+    case Type::PutEdge:
+    case Type::RemoveEdge:
+        succeeded = reader.Read(entry.m_edge.m_yamlSrcPort) &&
+                    reader.Read(entry.m_edge.m_yamlDstPort);
+        entry.m_edge.m_isValid = true;
+        break;
+    case Type::SetPipelineName:
+    case Type::AddPruningRule:
+    case Type::ChangePruningRule:
+        succeeded = reader.Read(entry.m_first) && reader.Read(entry.m_second);
+        break;
+    default:
+        break;
+    }
+    return succeeded && reader.AtEnd();
+}
+
+// reads the base target and the entries of a journal, up to the first one that is torn or damaged.
+// Returns false if the file is not a journal at all. validSize is where the entries read end
+static bool ReadJournal(std::string_view bytes, EditJournal::Recovered& recovered, size_t& validSize)
+{
+    JournalReader reader(bytes);
+    char          magic[sizeof(s_journalMagic)];
+    uint32_t      version = 0;
+    if (!reader.Read(magic) || std::memcmp(magic, s_journalMagic, sizeof(magic)) != 0 ||
+        !reader.Read(version) || version != s_journalVersion ||
+        !reader.Read(recovered.m_baseTarget))
+    {
+        return false;
+    }
+
+    size_t offset =
+        sizeof(magic) + sizeof(version) + sizeof(uint32_t) + recovered.m_baseTarget.size();
+    validSize = offset;
+    while (bytes.size() - offset >= sizeof(uint32_t) + sizeof(uint64_t))
+    {
+        uint32_t size = 0;
+        uint64_t hash = 0;
+        std::memcpy(&size, bytes.data() + offset, sizeof(size));
+        std::memcpy(&hash, bytes.data() + offset + sizeof(size), sizeof(hash));
+        const size_t payloadOffset = offset + sizeof(size) + sizeof(hash);
+        if (bytes.size() - payloadOffset < size)
+        {
+            break;
+        }
+        const std::string_view payload = bytes.substr(payloadOffset, size);
+        EditJournal::Entry     entry;
+        if (PipelineCache::HashContent(payload) != hash || !DeserializeEntry(payload, entry))
+        {
+            break;
+        }
+        recovered.m_entries.push_back(std::move(entry));
+        offset    = payloadOffset + size;
+        validSize = offset;
+    }
+    return true;
+}
+
+EditJournal::EditJournal() : m_path(), m_file(nullptr), m_queued(), m_writing() {}
+
+EditJournal::~EditJournal()
+{
+    Wait();
+    if (m_file)
+    {
+        Launch();
+        Wait();
+        std::fclose(m_file);
+    }
+}
+
+std::optional<EditJournal::Recovered> EditJournal::Open(const std::string& path)
+{
+    m_path = path;
+    if (m_path.empty())
+    {
+        return std::nullopt;
+    }
+
+    std::optional<Recovered> recovered;
+    size_t                   validSize = 0;
+    {
+        std::ifstream inputFile(m_path, std::ios::binary);
+        if (inputFile.is_open())
+        {
+            std::stringstream content;
+            content << inputFile.rdbuf();
+            Recovered journal;
+            if (ReadJournal(content.str(), journal, validSize) && !journal.m_entries.empty())
+            {
+                recovered = std::move(journal);
+            }
+        }
+    }
+    if (!recovered)
+    {
+        Restart("");
+        return std::nullopt;
+    }
+
+    // new entries go after the last whole one
+    std::error_code errorCode;
+    std::filesystem::resize_file(m_path, validSize, errorCode);
+    m_file = errorCode ? nullptr : std::fopen(m_path.c_str(), "ab");
+    if (!m_file)
+    {
+        SNELOG_ERROR("cannot open edit journal [{}], edits are not recorded", m_path);
+    }
+    SNELOG_INFO("edit journal [{}] holds [{}] edits on top of [{}]", m_path,
+                recovered->m_entries.size(), recovered->m_baseTarget);
+    return recovered;
+}
+
+void EditJournal::Restart(const std::string& baseTarget)
+{
+    if (m_path.empty())
+    {
+        return;
+    }
+    Wait();
+    m_queued.clear();
+    if (m_file)
+    {
+        std::fclose(m_file);
+    }
+
+    std::error_code errorCode;
+    std::filesystem::create_directories(std::filesystem::path(m_path).parent_path(), errorCode);
+    m_file = std::fopen(m_path.c_str(), "wb");
+    if (!m_file)
+    {
+        SNELOG_ERROR("cannot open edit journal [{}], edits are not recorded", m_path);
+        return;
+    }
+
+    m_queued.append(s_journalMagic, sizeof(s_journalMagic));
+    JournalWriter writer(m_queued);
+    writer.Write(s_journalVersion);
+    writer.Write(baseTarget);
+    Launch();
+}
+
+void EditJournal::Append(const Entry& entry)
+{
+    if (!m_file)
+    {
+        return;
+    }
+    m_queued += SerializeEntry(entry);
+    Update();
+}
+
+void EditJournal::Update()
+{
+    if (m_writing.valid() &&
+        m_writing.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    {
+        return;
+    }
+    Launch();
+}
+
+void EditJournal::Launch()
+{
+    if (m_writing.valid())
+    {
+        m_writing.get();
+    }
+    if (m_queued.empty() || !m_file)
+    {
+        return;
+    }
+    m_writing = std::async(std::launch::async,
+                           [file = m_file, batch = std::move(m_queued), path = m_path]()
+                           {
+                               const bool written =
+                                   std::fwrite(batch.data(), 1, batch.size(), file) ==
+                                       batch.size() &&
+                                   std::fflush(file) == 0;
+#ifdef _WIN32
+                               const bool synced = _commit(_fileno(file)) == 0;
+#else
+                               const bool synced = fsync(fileno(file)) == 0;
+#endif
+                               if (!written || !synced)
+                               {
+                                   SNELOG_ERROR("failed to write edit journal [{}]", path);
+                               }
+                           });
+    m_queued.clear();
+}
+
+void EditJournal::Wait()
+{
+    if (m_writing.valid())
+    {
+        m_writing.get();
+    }
+}
+
+struct EdgeKey
+{
+    YamlNode::NodeYamlId m_srcNode;
+    YamlPort::PortYamlId m_srcPort;
+    YamlNode::NodeYamlId m_dstNode;
+    YamlPort::PortYamlId m_dstPort;
+
+    explicit EdgeKey(const YamlEdge& edge)
+        : m_srcNode(edge.m_yamlSrcPort.m_nodeYamlId)
+        , m_srcPort(edge.m_yamlSrcPort.m_portYamlId)
+        , m_dstNode(edge.m_yamlDstPort.m_nodeYamlId)
+        , m_dstPort(edge.m_yamlDstPort.m_portYamlId)
+    {
+    }
+
+    bool operator==(const EdgeKey&) const = default;
+};
+
+struct EdgeKeyHash
+{
+    size_t operator()(const EdgeKey& key) const
+    {
+        const uint64_t src = (static_cast<uint64_t>(static_cast<uint32_t>(key.m_srcNode)) << 32) |
+                             static_cast<uint32_t>(key.m_srcPort);
+        const uint64_t dst = (static_cast<uint64_t>(static_cast<uint32_t>(key.m_dstNode)) << 32) |
+                             static_cast<uint32_t>(key.m_dstPort);
+        return std::hash<uint64_t>()(src) ^ (std::hash<uint64_t>()(dst) << 1);
+    }
+};
+
+void EditJournal::Apply(const std::vector<Entry>& entries, std::string& pipelineName,
+                        std::vector<YamlNode>& nodes, std::vector<YamlEdge>& edges)
+{
+    // removed records are left empty until the end, so that the indices stay valid
+    std::vector<std::optional<YamlNode>>             nodeSlots(nodes.size());
+    std::unordered_map<YamlNode::NodeYamlId, size_t> nodeIndices;
+    std::vector<std::optional<YamlEdge>>             edgeSlots(edges.size());
+    std::unordered_map<EdgeKey, size_t, EdgeKeyHash> edgeIndices;
+    for (size_t index = 0; index < nodes.size(); ++index)
+    {
+        nodeIndices[nodes[index].m_nodeYamlId] = index;
+        nodeSlots[index]                       = std::move(nodes[index]);
+    }
+    for (size_t index = 0; index < edges.size(); ++index)
+    {
+        edgeIndices[EdgeKey(edges[index])] = index;
+        edgeSlots[index]                   = std::move(edges[index]);
+    }
+
+    for (const Entry& entry : entries)
+    {
+        switch (entry.m_type)
+        {
+        case Entry::Type::PutNode:
+        {
+            auto [iter, inserted] = nodeIndices.try_emplace(entry.m_node.m_nodeYamlId,
+                                                            nodeSlots.size());
+            if (inserted)
+            {
+                nodeSlots.emplace_back();
+            }
+            nodeSlots[iter->second] = entry.m_node;
+            break;
+        }
+        case Entry::Type::RemoveNode:
+            if (auto iter = nodeIndices.find(entry.m_node.m_nodeYamlId); iter != nodeIndices.end())
+            {
+                nodeSlots[iter->second].reset();
+                nodeIndices.erase(iter);
+            }
+            break;
+        case Entry::Type::PutEdge:
+        {
+            auto [iter, inserted] = edgeIndices.try_emplace(EdgeKey(entry.m_edge), edgeSlots.size());
+            if (inserted)
+            {
+                edgeSlots.emplace_back();
+            }
+            edgeSlots[iter->second] = entry.m_edge;
+            break;
+        }
+        case Entry::Type::RemoveEdge:
+            if (auto iter = edgeIndices.find(EdgeKey(entry.m_edge)); iter != edgeIndices.end())
+            {
+                edgeSlots[iter->second].reset();
+                edgeIndices.erase(iter);
+            }
+            break;
+        case Entry::Type::SetPipelineName:
+            pipelineName = entry.m_first;
+            break;
+        default:
+            break;
+        }
+    }
+
+    nodes.clear();
+    for (std::optional<YamlNode>& node : nodeSlots)
+    {
+        if (node)
+        {
+            nodes.push_back(std::move(*node));
+        }
+    }
+    // links of removed nodes go with them
+    edges.clear();
+    for (std::optional<YamlEdge>& edge : edgeSlots)
+    {
+        if (edge && nodeIndices.contains(edge->m_yamlSrcPort.m_nodeYamlId) &&
+            nodeIndices.contains(edge->m_yamlDstPort.m_nodeYamlId))
+        {
+            edges.push_back(std::move(*edge));
+        }
+    }
+}
+
+} // namespace SimpleNodeEditor
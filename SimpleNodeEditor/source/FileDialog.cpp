@@ -328,11 +328,11 @@ bool FileDialog::Draw()
     return done;
 }
 
-std::unique_ptr<std::ostream> FileDialog::GetResultOutStream()
+std::unique_ptr<std::ostream> FileDialog::GetResultOutStream(std::ios_base::openmode mode)
 {
     if (m_type == Type::SAVE)
     {
-        return m_fs->createOutputStream(std::ios_base::trunc, GetResultPath());
+        return m_fs->createOutputStream(mode, GetResultPath());
     }
     else 
     {
@@ -341,12 +341,34 @@ std::unique_ptr<std::ostream> FileDialog::GetResultOutStream()
     }
 }
 
-std::unique_ptr<std::istream> FileDialog::GetResultInStream()
+std::string FileDialog::GetResultTarget() const
 {
+    const std::string fileSystem =
+        m_fs->GetFileSystemType() == FS::FileSystemType::Local ? "local:" : "ssh:";
+    return fileSystem + GetResultPath().String();
+}
+
+std::unique_ptr<std::istream> FileDialog::GetResultInStream(std::ios_base::openmode mode)
+{
+    // a file saved to is read as well, to check the entries about to be overwritten are still there
+    return m_fs->createInputStream(mode, GetResultPath());
+}
 
+std::time_t FileDialog::GetResultModifiedTime() const
+{
+    return m_fs->GetModifiedTime(GetResultPath());
+}
+
+int64_t FileDialog::GetResultFileSize() const
+{
+    return m_fs->GetFileSize(GetResultPath());
+}
+
+std::unique_ptr<FS::MappedFile> FileDialog::GetResultMappedFile()
+{
     if (m_type == Type::OPEN)
     {
-        return m_fs->createInputStream(std::ios_base::in, GetResultPath());
+        return m_fs->MapFile(GetResultPath());
     }
     else
     {
@@ -8,7 +8,11 @@
 #define NOMINMAX
     #include <winsock2.h>
     #include <ws2tcpip.h>
+    #include <windows.h>
 #else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
     #include <sys/socket.h>
     #include <netinet/in.h>
     #include <arpa/inet.h>
@@ -71,6 +75,120 @@ std::unique_ptr<std::ostream> LocalFileSystem::createOutputStream(std::ios_base:
     return std::unique_ptr<std::ostream>(new std::ofstream(path.String(), mode));
 }
 
+std::time_t LocalFileSystem::GetModifiedTime(const Path& path)
+{
+    std::error_code ec;
+    const auto modified = stdfs::last_write_time(path.m_pathimpl, ec);
+    if (ec) return 0;
+    return std::chrono::system_clock::to_time_t(
+        std::chrono::time_point_cast<std::chrono::system_clock::duration>(
+            std::chrono::file_clock::to_sys(modified)));
+}
+
+int64_t LocalFileSystem::GetFileSize(const Path& path)
+{
+    std::error_code ec;
+    const auto size = stdfs::file_size(path.m_pathimpl, ec);
+    if (ec) return -1;
+    return static_cast<int64_t>(size);
+}
+
+std::unique_ptr<MappedFile> LocalFileSystem::MapFile(const Path& path)
+{
+    return MappedFile::Open(path);
+}
+
+// ----------------- MappedFile implementation -----------------
+std::unique_ptr<MappedFile> MappedFile::Open(const Path& path)
+{
+    std::unique_ptr<MappedFile> mappedFile(new MappedFile());
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.m_pathimpl.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        SNELOG_ERROR("open file [{}] for mapping failed", path.String());
+        return nullptr;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize))
+    {
+        CloseHandle(file);
+        SNELOG_ERROR("get size of file [{}] failed", path.String());
+        return nullptr;
+    }
+    if (fileSize.QuadPart > 0)
+    {
+        // the mapping keeps the file open, the handle is not needed anymore
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        const void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (!data)
+        {
+            if (mapping)
+            {
+                CloseHandle(mapping);
+            }
+            SNELOG_ERROR("map file [{}] failed", path.String());
+            return nullptr;
+        }
+        mappedFile->m_mapping = mapping;
+        mappedFile->m_data    = static_cast<const char*>(data);
+        mappedFile->m_size    = static_cast<size_t>(fileSize.QuadPart);
+    }
+    else
+    {
+        CloseHandle(file);
+    }
+#else
+    const int file = open(path.m_pathimpl.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0)
+    {
+        SNELOG_ERROR("open file [{}] for mapping failed, {}", path.String(), strerror(errno));
+        return nullptr;
+    }
+    struct stat fileStat;
+    if (fstat(file, &fileStat) != 0 || !S_ISREG(fileStat.st_mode))
+    {
+        close(file);
+        SNELOG_ERROR("[{}] is not a regular file", path.String());
+        return nullptr;
+    }
+    if (fileStat.st_size > 0)
+    {
+        // the mapping keeps the file open, the descriptor is not needed anymore
+        void* data = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE,
+                          file, 0);
+        close(file);
+        if (data == MAP_FAILED)
+        {
+            SNELOG_ERROR("map file [{}] failed, {}", path.String(), strerror(errno));
+            return nullptr;
+        }
+        mappedFile->m_data = static_cast<const char*>(data);
+        mappedFile->m_size = static_cast<size_t>(fileStat.st_size);
+    }
+    else
+    {
+        close(file);
+    }
+#endif
+    return mappedFile;
+}
+
+MappedFile::~MappedFile()
+{
+    if (!m_data)
+    {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+    CloseHandle(m_mapping);
+#else
+    munmap(const_cast<char*>(m_data), m_size);
+#endif
+}
 
 // ----------------- SshFileSystem implementation -----------------
 SshFileSystem::SshFileSystem( const std::string & host, const std::string& port,
@@ -268,6 +386,7 @@ void SshFileSystem::Disconnect()
 
 bool SshFileSystem::Exists(const Path& path) 
 {
+    std::lock_guard<std::recursive_mutex> lock(m_sessionMutex);
     LIBSSH2_SFTP_ATTRIBUTES attrs;
     int rc = libssh2_sftp_stat(reinterpret_cast<LIBSSH2_SFTP*>(m_sftpSession), path.String().c_str(), &attrs);
     return rc == 0;
@@ -275,14 +394,32 @@ bool SshFileSystem::Exists(const Path& path)
 
 bool SshFileSystem::IsDirectory(const Path& path) 
 {
+    std::lock_guard<std::recursive_mutex> lock(m_sessionMutex);
     LIBSSH2_SFTP_ATTRIBUTES attrs;
     if (libssh2_sftp_stat(reinterpret_cast<LIBSSH2_SFTP*>(m_sftpSession), path.String().c_str(), &attrs) != 0) return false;
     return (attrs.flags & LIBSSH2_SFTP_ATTR_PERMISSIONS) && ((attrs.permissions & LIBSSH2_SFTP_S_IFMT) == LIBSSH2_SFTP_S_IFDIR);
 }
 
+std::time_t SshFileSystem::GetModifiedTime(const Path& path)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_sessionMutex);
+    LIBSSH2_SFTP_ATTRIBUTES attrs;
+    if (libssh2_sftp_stat(reinterpret_cast<LIBSSH2_SFTP*>(m_sftpSession), path.String().c_str(), &attrs) != 0) return 0;
+    return (attrs.flags & LIBSSH2_SFTP_ATTR_ACMODTIME) ? static_cast<std::time_t>(attrs.mtime) : 0;
+}
+
+int64_t SshFileSystem::GetFileSize(const Path& path)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_sessionMutex);
+    LIBSSH2_SFTP_ATTRIBUTES attrs;
+    if (libssh2_sftp_stat(reinterpret_cast<LIBSSH2_SFTP*>(m_sftpSession), path.String().c_str(), &attrs) != 0) return -1;
+    return (attrs.flags & LIBSSH2_SFTP_ATTR_SIZE) ? static_cast<int64_t>(attrs.filesize) : -1;
+}
+
 std::vector<FileEntry> SshFileSystem::List(const Path& path)
 {
     std::vector<FileEntry> out;
+    std::lock_guard<std::recursive_mutex> lock(m_sessionMutex);
     LIBSSH2_SFTP* sftp = reinterpret_cast<LIBSSH2_SFTP*>(m_sftpSession);
     LIBSSH2_SFTP_HANDLE* handle = libssh2_sftp_opendir(sftp, path.String().c_str());
     if (!handle) 
@@ -358,6 +495,7 @@ SshInputStreamBuffer::SshInputStreamBuffer(std::shared_ptr<SshFileSystem> fs, co
         return;
     }
 
+    std::lock_guard<std::recursive_mutex> lock(m_fs->GetSessionMutex());
     m_file = (void *)libssh2_sftp_open((LIBSSH2_SFTP *)m_fs->GetSftpSessionHandle(), m_path.String().c_str(), LIBSSH2_FXF_READ, 0);
     if (m_file)
     {
@@ -376,6 +514,7 @@ SshInputStreamBuffer::~SshInputStreamBuffer()
 {
     if (m_file)
     {
+        std::lock_guard<std::recursive_mutex> lock(m_fs->GetSessionMutex());
         libssh2_sftp_close((LIBSSH2_SFTP_HANDLE *)m_file);
     }
 }
@@ -406,6 +545,7 @@ std::streambuf::int_type SshInputStreamBuffer::underflow()
 
     // Refill buffer
     size_t size = m_buffer.size() - (start - base);
+    std::lock_guard<std::recursive_mutex> lock(m_fs->GetSessionMutex());
     ssize_t n = libssh2_sftp_read((LIBSSH2_SFTP_HANDLE *)m_file, start, size);
 
     if (n == 0)
@@ -422,6 +562,7 @@ std::streambuf::int_type SshInputStreamBuffer::underflow()
 
 SshInputStreamBuffer::pos_type SshInputStreamBuffer::seekoff(off_type off, std::ios_base::seekdir way, std::ios_base::openmode which)
 {
+    std::lock_guard<std::recursive_mutex> lock(m_fs->GetSessionMutex());
     if (way == std::ios_base::beg)
     {
         return seekpos((pos_type)off, which);
@@ -458,7 +599,10 @@ SshInputStreamBuffer::pos_type SshInputStreamBuffer::seekpos(pos_type pos, std::
     }
 
     // Set file position
-    libssh2_sftp_seek64((LIBSSH2_SFTP_HANDLE *)m_file, (libssh2_uint64_t)pos);
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_fs->GetSessionMutex());
+        libssh2_sftp_seek64((LIBSSH2_SFTP_HANDLE *)m_file, (libssh2_uint64_t)pos);
+    }
 
     // Reset read buffer
     char * end = &m_buffer.front() + m_buffer.size();
@@ -485,6 +629,7 @@ SshOutputStreamBuffer::SshOutputStreamBuffer(std::shared_ptr<SshFileSystem> fs,
     if (mode & std::ios::app)   flags |= LIBSSH2_FXF_APPEND;
     if (mode & std::ios::trunc) flags |= LIBSSH2_FXF_TRUNC;
 
+    std::lock_guard<std::recursive_mutex> lock(m_fs->GetSessionMutex());
     m_file = (void *)libssh2_sftp_open((LIBSSH2_SFTP *)m_fs->GetSftpSessionHandle(), m_path.String().c_str(), flags, 0);
 
     if (m_file)
@@ -507,6 +652,7 @@ SshOutputStreamBuffer::~SshOutputStreamBuffer()
     // Close file
     if (m_file)
     {
+        std::lock_guard<std::recursive_mutex> lock(m_fs->GetSessionMutex());
         pubsync();
         sync();
         libssh2_sftp_fsync((LIBSSH2_SFTP_HANDLE *)m_file);
@@ -547,6 +693,7 @@ int SshOutputStreamBuffer::sync()
     size_t size = pptr() - &m_buffer.front();
     if (size > 0)
     {
+        std::lock_guard<std::recursive_mutex> lock(m_fs->GetSessionMutex());
         auto res = libssh2_sftp_write((LIBSSH2_SFTP_HANDLE *)m_file, &m_buffer.front(), size);
 
         switch (res)
@@ -582,6 +729,12 @@ int SshOutputStreamBuffer::sync()
 
 SshOutputStreamBuffer::pos_type SshOutputStreamBuffer::seekoff(off_type off, std::ios_base::seekdir way, std::ios_base::openmode which)
 {
+    if (!m_file)
+    {
+        return (pos_type)(off_type)(-1);
+    }
+
+    std::lock_guard<std::recursive_mutex> lock(m_fs->GetSessionMutex());
     // Sync output first
     sync();
 
@@ -622,7 +775,10 @@ SshOutputStreamBuffer::pos_type SshOutputStreamBuffer::seekpos(pos_type pos, [[m
     }
 
     // Set file position
-    libssh2_sftp_seek64((LIBSSH2_SFTP_HANDLE *)m_file, (libssh2_uint64_t)pos);
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_fs->GetSessionMutex());
+        libssh2_sftp_seek64((LIBSSH2_SFTP_HANDLE *)m_file, (libssh2_uint64_t)pos);
+    }
 
     // Reset write buffer
     char * start = &m_buffer.front();
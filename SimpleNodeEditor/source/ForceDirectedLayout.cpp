@@ -0,0 +1,400 @@
+#include "ForceDirectedLayout.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <future>
+#include <limits>
+#include <thread>
+
+namespace SimpleNodeEditor
+{
+
+// a cell is not split further past this depth, its bodies are then handled one by one
+static constexpr int s_maxTreeDepth = 24;
+
+ForceDirectedLayout::ForceDirectedLayout(const Options& options) : m_options(options) {}
+
+void ForceDirectedLayout::Reset(const std::unordered_map<NodeUniqueId, ImVec2>&           positions,
+                                const std::unordered_map<NodeUniqueId, ImVec2>&           nodeSizes,
+                                const std::vector<std::pair<NodeUniqueId, NodeUniqueId>>& edges)
+{
+    m_nodeUids.clear();
+    m_indexOfNode.clear();
+    m_x.clear();
+    m_y.clear();
+    m_sizes.clear();
+    m_edges.clear();
+
+    m_nodeUids.reserve(positions.size());
+    m_indexOfNode.reserve(positions.size());
+    double extentSum = 0.0;
+    for (const auto& [nodeUid, position] : positions)
+    {
+        auto         sizeIter = nodeSizes.find(nodeUid);
+        const ImVec2 size     = sizeIter != nodeSizes.end() ? sizeIter->second : ImVec2(0.f, 0.f);
+        m_indexOfNode.emplace(nodeUid, static_cast<int>(m_nodeUids.size()));
+        m_nodeUids.push_back(nodeUid);
+        m_x.push_back(position.x + size.x * 0.5);
+        m_y.push_back(position.y + size.y * 0.5);
+        m_sizes.push_back(size);
+        extentSum += std::max(size.x, size.y);
+    }
+
+    for (const auto& [srcNodeUid, dstNodeUid] : edges)
+    {
+        auto srcIter = m_indexOfNode.find(srcNodeUid);
+        auto dstIter = m_indexOfNode.find(dstNodeUid);
+        if (srcIter != m_indexOfNode.end() && dstIter != m_indexOfNode.end() &&
+            srcIter->second != dstIter->second)
+        {
+            m_edges.emplace_back(srcIter->second, dstIter->second);
+        }
+    }
+
+    // nodes that were never placed all sit at the same spot, spread them on a small spiral so that
+    // they have a direction to move apart
+    std::unordered_map<uint64_t, int> nodesAtPosition;
+    nodesAtPosition.reserve(m_nodeUids.size());
+    for (size_t i = 0; i < m_nodeUids.size(); ++i)
+    {
+        const ImVec2   position = positions.at(m_nodeUids[i]);
+        const uint64_t key      = (static_cast<uint64_t>(std::bit_cast<uint32_t>(position.x)) << 32) |
+                             std::bit_cast<uint32_t>(position.y);
+        const int rank = nodesAtPosition[key]++;
+        if (rank > 0)
+        {
+            constexpr double goldenAngle = 2.399963229728653;
+            const double     radius      = 10.0 * std::sqrt(static_cast<double>(rank));
+            m_x[i] += radius * std::cos(rank * goldenAngle);
+            m_y[i] += radius * std::sin(rank * goldenAngle);
+        }
+    }
+
+    const size_t nodeCount = m_nodeUids.size();
+    m_pinned.assign(nodeCount, 0);
+    m_forceX.assign(nodeCount, 0.0);
+    m_forceY.assign(nodeCount, 0.0);
+
+    // linked nodes should end up about one node plus one edge length apart
+    const double meanExtent = nodeCount ? extentSum / static_cast<double>(nodeCount) : 0.0;
+    m_idealDistance         = meanExtent + m_options.m_edgeLength;
+    m_temperature = nodeCount > 1 ? m_idealDistance : 0.0;
+    m_energy      = std::numeric_limits<double>::max();
+    m_progress    = 0;
+    m_iterations  = 0;
+}
+
+void ForceDirectedLayout::Pin(NodeUniqueId nodeUid, const ImVec2& position)
+{
+    auto iter = m_indexOfNode.find(nodeUid);
+    if (iter == m_indexOfNode.end())
+    {
+        return;
+    }
+    const int index = iter->second;
+    m_pinned[index] = 1;
+    m_x[index]      = position.x + m_sizes[index].x * 0.5;
+    m_y[index]      = position.y + m_sizes[index].y * 0.5;
+}
+
+ImVec2 ForceDirectedLayout::GetPosition(size_t index) const
+{
+    return ImVec2(static_cast<float>(m_x[index] - m_sizes[index].x * 0.5),
+                  static_cast<float>(m_y[index] - m_sizes[index].y * 0.5));
+}
+
+bool ForceDirectedLayout::Step(std::chrono::microseconds budget)
+{
+    const auto start = std::chrono::steady_clock::now();
+    while (!IsSettled())
+    {
+        Iterate();
+        if (std::chrono::steady_clock::now() - start >= budget)
+        {
+            break;
+        }
+    }
+    return IsSettled();
+}
+
+void ForceDirectedLayout::Iterate()
+{
+    ++m_iterations;
+    const size_t nodeCount = m_nodeUids.size();
+    if (nodeCount < 2)
+    {
+        m_temperature = 0.0;
+        return;
+    }
+
+    BuildTree();
+
+    // every node only writes its own force, so ranges of nodes can be summed in parallel
+    const size_t threadCount =
+        nodeCount < m_options.m_parallelThreshold
+            ? 1
+            : std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), nodeCount);
+    if (threadCount <= 1)
+    {
+        AccumulateRepulsion(0, nodeCount);
+    }
+    else
+    {
+        std::vector<std::future<void>> partials;
+        const size_t                   chunk = (nodeCount + threadCount - 1) / threadCount;
+        for (size_t begin = 0; begin < nodeCount; begin += chunk)
+        {
+            const size_t end = std::min(begin + chunk, nodeCount);
+            partials.push_back(std::async(std::launch::async,
+                                          [this, begin, end]() { AccumulateRepulsion(begin, end); }));
+        }
+        for (auto& partial : partials)
+        {
+            partial.get();
+        }
+    }
+
+    AccumulateAttraction();
+
+    // gravity toward the center of the drawing
+    double centerX = 0.0;
+    double centerY = 0.0;
+    for (size_t i = 0; i < nodeCount; ++i)
+    {
+        centerX += m_x[i];
+        centerY += m_y[i];
+    }
+    centerX /= static_cast<double>(nodeCount);
+    centerY /= static_cast<double>(nodeCount);
+
+    double energy = 0.0;
+    for (size_t i = 0; i < nodeCount; ++i)
+    {
+        if (m_pinned[i])
+        {
+            continue;
+        }
+        const double forceX = m_forceX[i] - m_options.m_gravity * (m_x[i] - centerX);
+        const double forceY = m_forceY[i] - m_options.m_gravity * (m_y[i] - centerY);
+        const double length = std::sqrt(forceX * forceX + forceY * forceY);
+        if (length > 0.0)
+        {
+            // every node moves by the same step, only the direction comes from the force
+            m_x[i] += forceX / length * m_temperature;
+            m_y[i] += forceY / length * m_temperature;
+        }
+        energy += length * length;
+    }
+
+    // adaptive cooling (Hu): the step grows back after a few iterations lowering the energy, and
+    // shrinks as soon as one raises it, i.e. when nodes start to overshoot
+    if (energy < m_energy)
+    {
+        if (++m_progress >= 5)
+        {
+            m_progress = 0;
+            m_temperature /= m_options.m_cooling;
+        }
+    }
+    else
+    {
+        m_progress = 0;
+        m_temperature *= m_options.m_cooling;
+    }
+    m_energy = energy;
+}
+
+void ForceDirectedLayout::BuildTree()
+{
+    const size_t nodeCount = m_nodeUids.size();
+    m_bodies.resize(nodeCount);
+    for (size_t i = 0; i < nodeCount; ++i)
+    {
+        m_bodies[i] = static_cast<int>(i);
+    }
+
+    double minX = std::numeric_limits<double>::max();
+    double minY = std::numeric_limits<double>::max();
+    double maxX = std::numeric_limits<double>::lowest();
+    double maxY = std::numeric_limits<double>::lowest();
+    for (size_t i = 0; i < nodeCount; ++i)
+    {
+        minX = std::min(minX, m_x[i]);
+        minY = std::min(minY, m_y[i]);
+        maxX = std::max(maxX, m_x[i]);
+        maxY = std::max(maxY, m_y[i]);
+    }
+
+    m_cells.clear();
+    Cell root;
+    root.m_minX = minX;
+    root.m_minY = minY;
+    root.m_size = std::max({maxX - minX, maxY - minY, 1.0});
+    root.m_end  = static_cast<int>(nodeCount);
+    m_cells.push_back(root);
+    BuildCell(0, 0);
+}
+
+// Splits the bodies of the cell into its four quadrants, then computes the center of mass from the
+// children. Recursion depth is bounded by s_maxTreeDepth.
+void ForceDirectedLayout::BuildCell(int cellIndex, int depth)
+{
+    const Cell cell  = m_cells[cellIndex];
+    const int  count = cell.m_end - cell.m_begin;
+    if (count <= 1 || depth >= s_maxTreeDepth)
+    {
+        double sumX = 0.0;
+        double sumY = 0.0;
+        for (int i = cell.m_begin; i < cell.m_end; ++i)
+        {
+            sumX += m_x[m_bodies[i]];
+            sumY += m_y[m_bodies[i]];
+        }
+        Cell& leaf     = m_cells[cellIndex];
+        leaf.m_mass    = count;
+        leaf.m_centerX = count ? sumX / count : 0.0;
+        leaf.m_centerY = count ? sumY / count : 0.0;
+        return;
+    }
+
+    const double half    = cell.m_size * 0.5;
+    const double splitX  = cell.m_minX + half;
+    const double splitY  = cell.m_minY + half;
+    auto         bodies  = m_bodies.begin();
+    auto         isUpper = [this, splitY](int body) { return m_y[body] < splitY; };
+    auto         isLeft  = [this, splitX](int body) { return m_x[body] < splitX; };
+
+    const auto middle = std::partition(bodies + cell.m_begin, bodies + cell.m_end, isUpper);
+    const auto upperMiddle = std::partition(bodies + cell.m_begin, middle, isLeft);
+    const auto lowerMiddle = std::partition(middle, bodies + cell.m_end, isLeft);
+    const int  bounds[5]   = {cell.m_begin, static_cast<int>(upperMiddle - bodies),
+                              static_cast<int>(middle - bodies), static_cast<int>(lowerMiddle - bodies),
+                              cell.m_end};
+
+    const int firstChild = static_cast<int>(m_cells.size());
+    m_cells[cellIndex].m_firstChild = firstChild;
+    for (int quadrant = 0; quadrant < 4; ++quadrant)
+    {
+        Cell child;
+        child.m_minX  = cell.m_minX + ((quadrant % 2) ? half : 0.0);
+        child.m_minY  = cell.m_minY + ((quadrant / 2) ? half : 0.0);
+        child.m_size  = half;
+        child.m_begin = bounds[quadrant];
+        child.m_end   = bounds[quadrant + 1];
+        m_cells.push_back(child);
+    }
+
+    double mass = 0.0;
+    double sumX = 0.0;
+    double sumY = 0.0;
+    for (int quadrant = 0; quadrant < 4; ++quadrant)
+    {
+        BuildCell(firstChild + quadrant, depth + 1);
+        const Cell& child = m_cells[firstChild + quadrant];
+        mass += child.m_mass;
+        sumX += child.m_centerX * child.m_mass;
+        sumY += child.m_centerY * child.m_mass;
+    }
+    Cell& built     = m_cells[cellIndex];
+    built.m_mass    = mass;
+    built.m_centerX = sumX / mass;
+    built.m_centerY = sumY / mass;
+}
+
+void ForceDirectedLayout::AccumulateRepulsion(size_t begin, size_t end)
+{
+    const double     k2        = m_options.m_repulsion * m_idealDistance * m_idealDistance;
+    const double     theta2    = static_cast<double>(m_options.m_theta) * m_options.m_theta;
+    const double     minDistSq = 1.0;
+    std::vector<int> stack;
+
+    // coincident nodes are pushed apart in a direction derived from their indices
+    auto push = [&](size_t body, double dx, double dy, double mass, double& forceX, double& forceY,
+                    int other)
+    {
+        double distSq = dx * dx + dy * dy;
+        if (distSq < minDistSq)
+        {
+            const size_t seed  = body * 7919 + static_cast<size_t>(other + 1) * 104729;
+            const double angle = static_cast<double>(seed % 628) / 100.0;
+            dx     = std::cos(angle);
+            dy     = std::sin(angle);
+            distSq = minDistSq;
+        }
+        // magnitude C k^2 / d along (dx, dy) / d
+        const double scale = k2 * mass / distSq;
+        forceX += dx * scale;
+        forceY += dy * scale;
+    };
+
+    for (size_t body = begin; body < end; ++body)
+    {
+        double forceX = 0.0;
+        double forceY = 0.0;
+        stack.clear();
+        stack.push_back(0);
+        while (!stack.empty())
+        {
+            const Cell& cell = m_cells[stack.back()];
+            stack.pop_back();
+            if (cell.m_mass == 0.0)
+            {
+                continue;
+            }
+
+            const double dx     = m_x[body] - cell.m_centerX;
+            const double dy     = m_y[body] - cell.m_centerY;
+            const double distSq = dx * dx + dy * dy;
+            if (cell.m_firstChild == -1)
+            {
+                for (int i = cell.m_begin; i < cell.m_end; ++i)
+                {
+                    const int other = m_bodies[i];
+                    if (other != static_cast<int>(body))
+                    {
+                        push(body, m_x[body] - m_x[other], m_y[body] - m_y[other], 1.0, forceX,
+                             forceY, other);
+                    }
+                }
+            }
+            else if (cell.m_size * cell.m_size < theta2 * distSq &&
+                     !(m_x[body] >= cell.m_minX && m_x[body] <= cell.m_minX + cell.m_size &&
+                       m_y[body] >= cell.m_minY && m_y[body] <= cell.m_minY + cell.m_size))
+            {
+                // far enough, and the body is not part of the mass it is pushed by
+                push(body, dx, dy, cell.m_mass, forceX, forceY, -1);
+            }
+            else
+            {
+                for (int quadrant = 0; quadrant < 4; ++quadrant)
+                {
+                    stack.push_back(cell.m_firstChild + quadrant);
+                }
+            }
+        }
+        m_forceX[body] = forceX;
+        m_forceY[body] = forceY;
+    }
+}
+
+void ForceDirectedLayout::AccumulateAttraction()
+{
+    for (const auto& [src, dst] : m_edges)
+    {
+        const double dx   = m_x[dst] - m_x[src];
+        const double dy   = m_y[dst] - m_y[src];
+        const double dist = std::sqrt(dx * dx + dy * dy);
+        if (dist <= 0.0)
+        {
+            continue;
+        }
+        // magnitude d^2 / k along (dx, dy) / d
+        const double scale = dist / m_idealDistance;
+        m_forceX[src] += dx * scale;
+        m_forceY[src] += dy * scale;
+        m_forceX[dst] -= dx * scale;
+        m_forceY[dst] -= dy * scale;
+    }
+}
+
+} // namespace SimpleNodeEditor
@@ -0,0 +1,209 @@
+#include "IncrementalLayout.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace SimpleNodeEditor
+{
+
+IncrementalLayout::IncrementalLayout(const Options& options) : m_options(options) {}
+
+std::unordered_map<NodeUniqueId, ImVec2> IncrementalLayout::Compute(const Snapshot& snapshot) const
+{
+    std::unordered_map<NodeUniqueId, ImVec2> result;
+    if (snapshot.m_freeNodes.empty() || snapshot.m_layers.empty())
+    {
+        return result;
+    }
+
+    int minLayer = std::numeric_limits<int>::max();
+    int maxLayer = std::numeric_limits<int>::min();
+    for (const auto& [_, layer] : snapshot.m_layers)
+    {
+        minLayer = std::min(minLayer, layer);
+        maxLayer = std::max(maxLayer, layer);
+    }
+    const std::vector<float> layerX = PlaceLayers(snapshot, minLayer, maxLayer);
+
+    auto sizeOf = [&snapshot](NodeUniqueId nodeUid)
+    {
+        auto iter = snapshot.m_sizes.find(nodeUid);
+        return iter != snapshot.m_sizes.end() ? iter->second : ImVec2(0.f, 0.f);
+    };
+
+    // vertical spans taken in every layer, by the fixed nodes and by the free nodes once placed
+    std::vector<std::vector<std::pair<float, float>>> takenSpans(
+        static_cast<size_t>(maxLayer - minLayer + 1));
+    std::unordered_map<NodeUniqueId, ImVec2> placed = snapshot.m_fixedPositions;
+    for (const auto& [nodeUid, pos] : snapshot.m_fixedPositions)
+    {
+        auto layerIter = snapshot.m_layers.find(nodeUid);
+        if (layerIter != snapshot.m_layers.end())
+        {
+            takenSpans[layerIter->second - minLayer].emplace_back(pos.y, pos.y + sizeOf(nodeUid).y);
+        }
+    }
+
+    std::unordered_map<NodeUniqueId, std::vector<NodeUniqueId>> neighbours;
+    for (const auto& [srcNodeUid, dstNodeUid] : snapshot.m_edges)
+    {
+        if (srcNodeUid != dstNodeUid)
+        {
+            neighbours[srcNodeUid].push_back(dstNodeUid);
+            neighbours[dstNodeUid].push_back(srcNodeUid);
+        }
+    }
+
+    // layer after layer, so that the predecessors of a free node are placed before it
+    std::vector<NodeUniqueId> freeNodes;
+    freeNodes.reserve(snapshot.m_freeNodes.size());
+    for (NodeUniqueId nodeUid : snapshot.m_freeNodes)
+    {
+        if (snapshot.m_layers.contains(nodeUid))
+        {
+            freeNodes.push_back(nodeUid);
+        }
+    }
+    std::stable_sort(freeNodes.begin(), freeNodes.end(),
+                     [&snapshot](NodeUniqueId lhs, NodeUniqueId rhs)
+                     { return snapshot.m_layers.at(lhs) < snapshot.m_layers.at(rhs); });
+
+    std::vector<float> centers;
+    for (NodeUniqueId nodeUid : freeNodes)
+    {
+        const size_t layer = static_cast<size_t>(snapshot.m_layers.at(nodeUid) - minLayer);
+        const ImVec2 size  = sizeOf(nodeUid);
+        auto&        spans = takenSpans[layer];
+
+        centers.clear();
+        auto neighbourIter = neighbours.find(nodeUid);
+        if (neighbourIter != neighbours.end())
+        {
+            for (NodeUniqueId neighbourUid : neighbourIter->second)
+            {
+                auto placedIter = placed.find(neighbourUid);
+                if (placedIter != placed.end())
+                {
+                    centers.push_back(placedIter->second.y + sizeOf(neighbourUid).y * 0.5f);
+                }
+            }
+        }
+
+        float top = 0.f;
+        if (!centers.empty())
+        {
+            std::sort(centers.begin(), centers.end());
+            const float median =
+                (centers[(centers.size() - 1) / 2] + centers[centers.size() / 2]) * 0.5f;
+            top = median - size.y * 0.5f;
+        }
+        else if (!spans.empty())
+        {
+            // nothing to line up with, go below the layer
+            top = std::numeric_limits<float>::lowest();
+            for (const auto& span : spans)
+            {
+                top = std::max(top, span.second + m_options.m_nodeSpacing);
+            }
+        }
+        top = FindFreeTop(spans, top, size.y);
+
+        const ImVec2 pos(layerX[layer], top);
+        spans.emplace_back(top, top + size.y);
+        placed[nodeUid] = pos;
+        result.emplace(nodeUid, pos);
+    }
+    return result;
+}
+
+std::vector<float> IncrementalLayout::PlaceLayers(const Snapshot& snapshot, int minLayer,
+                                                  int maxLayer) const
+{
+    const size_t                    layerCount = static_cast<size_t>(maxLayer - minLayer + 1);
+    std::vector<float>              widths(layerCount, 0.f);
+    std::vector<std::vector<float>> fixedXs(layerCount);
+    for (const auto& [nodeUid, layer] : snapshot.m_layers)
+    {
+        const size_t index = static_cast<size_t>(layer - minLayer);
+        auto         sizeIter = snapshot.m_sizes.find(nodeUid);
+        if (sizeIter != snapshot.m_sizes.end())
+        {
+            widths[index] = std::max(widths[index], sizeIter->second.x);
+        }
+        auto posIter = snapshot.m_fixedPositions.find(nodeUid);
+        if (posIter != snapshot.m_fixedPositions.end())
+        {
+            fixedXs[index].push_back(posIter->second.x);
+        }
+    }
+
+    // the median resists the few nodes of a layer moved by hand
+    std::vector<float> layerX(layerCount, 0.f);
+    std::vector<char>  known(layerCount, 0);
+    for (size_t index = 0; index < layerCount; ++index)
+    {
+        std::vector<float>& xs = fixedXs[index];
+        if (!xs.empty())
+        {
+            std::nth_element(xs.begin(), xs.begin() + xs.size() / 2, xs.end());
+            layerX[index] = xs[xs.size() / 2];
+            known[index]  = 1;
+        }
+    }
+    if (std::find(known.begin(), known.end(), 1) == known.end())
+    {
+        known[0] = 1;
+    }
+
+    // layers without fixed nodes follow the closest known layer on their left, or on their right
+    for (size_t index = 1; index < layerCount; ++index)
+    {
+        if (!known[index] && known[index - 1])
+        {
+            layerX[index] = layerX[index - 1] + widths[index - 1] + m_options.m_layerSpacing;
+            known[index]  = 1;
+        }
+    }
+    for (size_t index = layerCount - 1; index > 0; --index)
+    {
+        if (!known[index - 1] && known[index])
+        {
+            layerX[index - 1] = layerX[index] - widths[index - 1] - m_options.m_layerSpacing;
+            known[index - 1]  = 1;
+        }
+    }
+    return layerX;
+}
+
+float IncrementalLayout::FindFreeTop(std::vector<std::pair<float, float>>& takenSpans, float top,
+                                     float height) const
+{
+    std::sort(takenSpans.begin(), takenSpans.end());
+
+    float bestTop      = top;
+    float bestDistance = std::numeric_limits<float>::max();
+    auto  consider     = [&](float candidate)
+    {
+        if (std::abs(candidate - top) < bestDistance)
+        {
+            bestDistance = std::abs(candidate - top);
+            bestTop      = candidate;
+        }
+    };
+
+    // walk the gaps between the taken spans, each span keeping the node spacing around it
+    float gapBegin = std::numeric_limits<float>::lowest();
+    for (const auto& [spanTop, spanBottom] : takenSpans)
+    {
+        const float gapEnd = spanTop - m_options.m_nodeSpacing;
+        if (gapEnd - height >= gapBegin)
+        {
+            consider(std::clamp(top, gapBegin, gapEnd - height));
+        }
+        gapBegin = std::max(gapBegin, spanBottom + m_options.m_nodeSpacing);
+    }
+    consider(std::max(top, gapBegin));
+    return bestTop;
+}
+
+} // namespace SimpleNodeEditor
@@ -0,0 +1,587 @@
+#include "LayeredLayout.hpp"
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <limits>
+#include <thread>
+
+namespace SimpleNodeEditor
+{
+
+// below this many vertices, spawning threads costs more than it saves
+static constexpr size_t s_parallelVertexThreshold = 2000;
+
+LayeredLayout::LayeredLayout(const Options& options) : m_options(options) {}
+
+std::unordered_map<NodeUniqueId, ImVec2> LayeredLayout::Compute(
+    const std::vector<std::vector<NodeUniqueId>>&            layers,
+    const std::vector<std::pair<NodeUniqueId, NodeUniqueId>>& edges,
+    const std::unordered_map<NodeUniqueId, ImVec2>&           nodeSizes)
+{
+    std::unordered_map<NodeUniqueId, ImVec2> positions;
+    m_crossingCount = 0;
+    if (layers.empty())
+    {
+        return positions;
+    }
+
+    BuildGraph(layers, edges, nodeSizes);
+    ReduceCrossings();
+    const std::vector<double> coords = AssignCoordinates();
+
+    // each layer is a column as wide as its widest node
+    std::vector<float> layerX(m_layers.size(), 0.f);
+    float              x = 0.f;
+    for (size_t layer = 0; layer < m_layers.size(); ++layer)
+    {
+        float layerWidth = 0.f;
+        for (int v : m_layers[layer])
+        {
+            layerWidth = std::max(layerWidth, m_sizes[v].x);
+        }
+        layerX[layer] = x;
+        x += layerWidth + m_options.m_layerSpacing;
+    }
+
+    // center the drawing vertically around 0
+    double top    = std::numeric_limits<double>::max();
+    double bottom = std::numeric_limits<double>::lowest();
+    for (size_t v = 0; v < m_nodeUids.size(); ++v)
+    {
+        if (m_nodeUids[v] != -1)
+        {
+            top    = std::min(top, coords[v] - m_sizes[v].y / 2.0);
+            bottom = std::max(bottom, coords[v] + m_sizes[v].y / 2.0);
+        }
+    }
+    const double center = (top + bottom) / 2.0;
+
+    positions.reserve(m_nodeUids.size());
+    for (size_t v = 0; v < m_nodeUids.size(); ++v)
+    {
+        if (m_nodeUids[v] != -1)
+        {
+            positions.emplace(m_nodeUids[v],
+                              ImVec2(layerX[m_layerOf[v]],
+                                     static_cast<float>(coords[v] - m_sizes[v].y / 2.0 - center)));
+        }
+    }
+    return positions;
+}
+
+int LayeredLayout::AddVertex(int layer, NodeUniqueId nodeUid, const ImVec2& size)
+{
+    const int v = static_cast<int>(m_nodeUids.size());
+    m_nodeUids.push_back(nodeUid);
+    m_layerOf.push_back(layer);
+    m_posInLayer.push_back(static_cast<int>(m_layers[layer].size()));
+    m_sizes.push_back(size);
+    m_predecessors.emplace_back();
+    m_successors.emplace_back();
+    m_layers[layer].push_back(v);
+    return v;
+}
+
+void LayeredLayout::BuildGraph(const std::vector<std::vector<NodeUniqueId>>&            layers,
+                               const std::vector<std::pair<NodeUniqueId, NodeUniqueId>>& edges,
+                               const std::unordered_map<NodeUniqueId, ImVec2>&           nodeSizes)
+{
+    m_nodeUids.clear();
+    m_layerOf.clear();
+    m_posInLayer.clear();
+    m_sizes.clear();
+    m_predecessors.clear();
+    m_successors.clear();
+    m_layers.assign(layers.size(), {});
+    m_conflicts.clear();
+
+    std::unordered_map<NodeUniqueId, int> vertexOf;
+    for (size_t layer = 0; layer < layers.size(); ++layer)
+    {
+        for (NodeUniqueId nodeUid : layers[layer])
+        {
+            auto         iter = nodeSizes.find(nodeUid);
+            const ImVec2 size = iter != nodeSizes.end() ? iter->second : ImVec2(0.f, 0.f);
+            vertexOf.emplace(nodeUid, AddVertex(static_cast<int>(layer), nodeUid, size));
+        }
+    }
+
+    for (const auto& [srcNodeUid, dstNodeUid] : edges)
+    {
+        auto srcIter = vertexOf.find(srcNodeUid);
+        auto dstIter = vertexOf.find(dstNodeUid);
+        if (srcIter == vertexOf.end() || dstIter == vertexOf.end() ||
+            m_layerOf[srcIter->second] >= m_layerOf[dstIter->second])
+        {
+            continue;
+        }
+
+        int prev = srcIter->second;
+        for (int layer = m_layerOf[prev] + 1; layer < m_layerOf[dstIter->second]; ++layer)
+        {
+            const int dummy = AddVertex(layer, -1, ImVec2(0.f, 0.f));
+            m_successors[prev].push_back(dummy);
+            m_predecessors[dummy].push_back(prev);
+            prev = dummy;
+        }
+        m_successors[prev].push_back(dstIter->second);
+        m_predecessors[dstIter->second].push_back(prev);
+    }
+}
+
+// Alternate downward and upward barycenter sweeps, stopping after a few sweeps without progress
+void LayeredLayout::ReduceCrossings()
+{
+    std::vector<std::vector<int>> bestLayers = m_layers;
+    size_t                        bestCrossings = CountCrossings();
+    int                           sweepsWithoutProgress = 0;
+
+    for (int sweep = 0; sweep < m_options.m_maxSweeps && bestCrossings > 0; ++sweep)
+    {
+        const bool downward = (sweep % 2) == 0;
+        if (downward)
+        {
+            for (size_t layer = 1; layer < m_layers.size(); ++layer)
+            {
+                SweepLayer(layer, true);
+            }
+        }
+        else
+        {
+            for (size_t layer = m_layers.size() - 1; layer-- > 0;)
+            {
+                SweepLayer(layer, false);
+            }
+        }
+
+        const size_t crossings = CountCrossings();
+        if (crossings < bestCrossings)
+        {
+            bestCrossings         = crossings;
+            bestLayers            = m_layers;
+            sweepsWithoutProgress = 0;
+        }
+        else if (++sweepsWithoutProgress >= 4)
+        {
+            break;
+        }
+    }
+
+    m_layers = std::move(bestLayers);
+    for (const std::vector<int>& layer : m_layers)
+    {
+        for (size_t pos = 0; pos < layer.size(); ++pos)
+        {
+            m_posInLayer[layer[pos]] = static_cast<int>(pos);
+        }
+    }
+    m_crossingCount = bestCrossings;
+}
+
+// Sort a layer by the mean position of its neighbours in the layer swept from. Vertices without
+// such neighbours keep their current position as key.
+void LayeredLayout::SweepLayer(size_t layer, bool downward)
+{
+    std::vector<int>&                  vertices = m_layers[layer];
+    std::vector<std::pair<double, int>> keyed;
+    keyed.reserve(vertices.size());
+    for (int v : vertices)
+    {
+        const std::vector<int>& neighbours = downward ? m_predecessors[v] : m_successors[v];
+        double                  key = m_posInLayer[v];
+        if (!neighbours.empty())
+        {
+            double sum = 0.0;
+            for (int w : neighbours)
+            {
+                sum += m_posInLayer[w];
+            }
+            key = sum / static_cast<double>(neighbours.size());
+        }
+        keyed.emplace_back(key, v);
+    }
+    std::stable_sort(keyed.begin(), keyed.end(),
+                     [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+
+    for (size_t pos = 0; pos < keyed.size(); ++pos)
+    {
+        vertices[pos]              = keyed[pos].second;
+        m_posInLayer[vertices[pos]] = static_cast<int>(pos);
+    }
+}
+
+// Layer pairs are independent, so big graphs count them on several threads
+size_t LayeredLayout::CountCrossings() const
+{
+    const size_t layerPairs = m_layers.size() > 0 ? m_layers.size() - 1 : 0;
+    const size_t threadCount =
+        m_nodeUids.size() < s_parallelVertexThreshold
+            ? 1
+            : std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), layerPairs);
+    if (threadCount <= 1)
+    {
+        size_t crossings = 0;
+        for (size_t layer = 0; layer < layerPairs; ++layer)
+        {
+            crossings += CountCrossingsBetween(layer);
+        }
+        return crossings;
+    }
+
+    std::vector<std::future<size_t>> partials;
+    for (size_t thread = 0; thread < threadCount; ++thread)
+    {
+        partials.push_back(std::async(std::launch::async,
+                                      [this, thread, threadCount, layerPairs]()
+                                      {
+                                          size_t crossings = 0;
+                                          for (size_t layer = thread; layer < layerPairs;
+                                               layer += threadCount)
+                                          {
+                                              crossings += CountCrossingsBetween(layer);
+                                          }
+                                          return crossings;
+                                      }));
+    }
+
+    size_t crossings = 0;
+    for (std::future<size_t>& partial : partials)
+    {
+        crossings += partial.get();
+    }
+    return crossings;
+}
+
+// Barth, Juenger and Mutzel: with edges sorted by north then south position, crossings are the
+// inversions among south positions, counted with an accumulator tree in O(E log V).
+size_t LayeredLayout::CountCrossingsBetween(size_t northLayer) const
+{
+    const std::vector<int>& south = m_layers[northLayer + 1];
+    if (south.empty())
+    {
+        return 0;
+    }
+
+    std::vector<int> southPositions;
+    std::vector<int> successorPositions;
+    for (int v : m_layers[northLayer])
+    {
+        successorPositions.clear();
+        for (int w : m_successors[v])
+        {
+            successorPositions.push_back(m_posInLayer[w]);
+        }
+        std::sort(successorPositions.begin(), successorPositions.end());
+        southPositions.insert(southPositions.end(), successorPositions.begin(),
+                              successorPositions.end());
+    }
+
+    size_t firstIndex = 1;
+    while (firstIndex < south.size())
+    {
+        firstIndex <<= 1;
+    }
+    std::vector<size_t> tree(2 * firstIndex - 1, 0);
+    --firstIndex;
+
+    size_t crossings = 0;
+    for (int pos : southPositions)
+    {
+        size_t index = static_cast<size_t>(pos) + firstIndex;
+        ++tree[index];
+        while (index > 0)
+        {
+            if (index % 2 == 1)
+            {
+                crossings += tree[index + 1];
+            }
+            index = (index - 1) / 2;
+            ++tree[index];
+        }
+    }
+    return crossings;
+}
+
+// Type 1 conflicts are edges crossing an inner segment (an edge between two dummy nodes). They are
+// never aligned, so long edges get to run straight.
+void LayeredLayout::MarkTypeOneConflicts()
+{
+    m_conflicts.clear();
+    for (size_t layer = 1; layer < m_layers.size(); ++layer)
+    {
+        const std::vector<int>& vertices   = m_layers[layer];
+        const int               prevLength = static_cast<int>(m_layers[layer - 1].size());
+        int                     k0         = 0;
+        size_t                  scanPos    = 0;
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            const int v     = vertices[i];
+            int       inner = -1;
+            if (m_nodeUids[v] == -1)
+            {
+                for (int w : m_predecessors[v])
+                {
+                    if (m_nodeUids[w] == -1)
+                    {
+                        inner = w;
+                        break;
+                    }
+                }
+            }
+
+            if (inner == -1 && i + 1 != vertices.size())
+            {
+                continue;
+            }
+
+            const int k1 = inner != -1 ? m_posInLayer[inner] : prevLength;
+            for (; scanPos <= i; ++scanPos)
+            {
+                const int u = vertices[scanPos];
+                for (int w : m_predecessors[u])
+                {
+                    const int wPos = m_posInLayer[w];
+                    if ((wPos < k0 || k1 < wPos) && !(m_nodeUids[w] == -1 && m_nodeUids[u] == -1))
+                    {
+                        m_conflicts.insert(static_cast<int64_t>(std::min(u, w)) << 32 |
+                                           static_cast<int64_t>(std::max(u, w)));
+                    }
+                }
+            }
+            k0 = k1;
+        }
+    }
+}
+
+bool LayeredLayout::HasConflict(int v, int w) const
+{
+    return m_conflicts.contains(static_cast<int64_t>(std::min(v, w)) << 32 |
+                                static_cast<int64_t>(std::max(v, w)));
+}
+
+double LayeredLayout::Separation(int v, int w) const
+{
+    const double vSpacing = m_nodeUids[v] == -1 ? m_options.m_edgeSpacing : m_options.m_nodeSpacing;
+    const double wSpacing = m_nodeUids[w] == -1 ? m_options.m_edgeSpacing : m_options.m_nodeSpacing;
+    return (m_sizes[v].y + m_sizes[w].y) / 2.0 + (vSpacing + wSpacing) / 2.0;
+}
+
+// One of the four Brandes-Koepf alignments: vertices are aligned with the median neighbour in the
+// previously visited layer, then blocks of aligned vertices are packed along the layers.
+LayeredLayout::Alignment LayeredLayout::AlignVertically(bool downward, bool rightToLeft) const
+{
+    const size_t vertexCount = m_nodeUids.size();
+
+    std::vector<std::vector<int>> layering = m_layers;
+    if (!downward)
+    {
+        std::reverse(layering.begin(), layering.end());
+    }
+    std::vector<int> pos(vertexCount, 0);
+    for (std::vector<int>& layer : layering)
+    {
+        if (rightToLeft)
+        {
+            std::reverse(layer.begin(), layer.end());
+        }
+        for (size_t i = 0; i < layer.size(); ++i)
+        {
+            pos[layer[i]] = static_cast<int>(i);
+        }
+    }
+
+    Alignment alignment;
+    alignment.m_root.resize(vertexCount);
+    alignment.m_align.resize(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        alignment.m_root[v]  = static_cast<int>(v);
+        alignment.m_align[v] = static_cast<int>(v);
+    }
+    std::vector<int>& root  = alignment.m_root;
+    std::vector<int>& align = alignment.m_align;
+
+    std::vector<int> neighbours;
+    for (const std::vector<int>& layer : layering)
+    {
+        int prevIdx = -1;
+        for (int v : layer)
+        {
+            neighbours = downward ? m_predecessors[v] : m_successors[v];
+            if (neighbours.empty())
+            {
+                continue;
+            }
+            std::sort(neighbours.begin(), neighbours.end(),
+                      [&pos](int lhs, int rhs) { return pos[lhs] < pos[rhs]; });
+
+            const size_t lowMedian  = (neighbours.size() - 1) / 2;
+            const size_t highMedian = neighbours.size() / 2;
+            for (size_t i = lowMedian; i <= highMedian; ++i)
+            {
+                const int w = neighbours[i];
+                if (align[v] == v && prevIdx < pos[w] && !HasConflict(v, w))
+                {
+                    align[w] = v;
+                    align[v] = root[v] = root[w];
+                    prevIdx            = pos[w];
+                }
+            }
+        }
+    }
+
+    // Horizontal compaction over the block graph: each block is placed as close as possible after
+    // the blocks before it, then pulled back towards the blocks after it.
+    std::vector<std::vector<std::pair<int, double>>> blockPreds(vertexCount);
+    std::vector<std::vector<std::pair<int, double>>> blockSuccs(vertexCount);
+    std::vector<int>                                 inDegree(vertexCount, 0);
+    for (const std::vector<int>& layer : layering)
+    {
+        for (size_t i = 1; i < layer.size(); ++i)
+        {
+            const int    u          = root[layer[i - 1]];
+            const int    v          = root[layer[i]];
+            const double separation = Separation(layer[i - 1], layer[i]);
+            blockPreds[v].emplace_back(u, separation);
+            blockSuccs[u].emplace_back(v, separation);
+            ++inDegree[v];
+        }
+    }
+
+    std::vector<int> blockOrder;
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        if (root[v] == static_cast<int>(v) && inDegree[v] == 0)
+        {
+            blockOrder.push_back(static_cast<int>(v));
+        }
+    }
+    for (size_t i = 0; i < blockOrder.size(); ++i)
+    {
+        for (const auto& [succ, _] : blockSuccs[blockOrder[i]])
+        {
+            if (--inDegree[succ] == 0)
+            {
+                blockOrder.push_back(succ);
+            }
+        }
+    }
+
+    std::vector<double>& coords = alignment.m_coords;
+    coords.assign(vertexCount, 0.0);
+    for (int block : blockOrder)
+    {
+        for (const auto& [pred, separation] : blockPreds[block])
+        {
+            coords[block] = std::max(coords[block], coords[pred] + separation);
+        }
+    }
+    for (size_t i = blockOrder.size(); i-- > 0;)
+    {
+        const int block = blockOrder[i];
+        double    limit = std::numeric_limits<double>::max();
+        for (const auto& [succ, separation] : blockSuccs[block])
+        {
+            limit = std::min(limit, coords[succ] - separation);
+        }
+        if (limit != std::numeric_limits<double>::max())
+        {
+            coords[block] = std::max(coords[block], limit);
+        }
+    }
+
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        coords[v] = coords[root[v]];
+        if (rightToLeft)
+        {
+            coords[v] = -coords[v];
+        }
+    }
+    return alignment;
+}
+
+// The four alignments are independent and computed concurrently, then shifted onto the narrowest
+// one and balanced by taking the average of the two median coordinates of each vertex.
+std::vector<double> LayeredLayout::AssignCoordinates()
+{
+    MarkTypeOneConflicts();
+
+    const bool             parallel = m_nodeUids.size() >= s_parallelVertexThreshold;
+    const std::launch      policy   = parallel ? std::launch::async : std::launch::deferred;
+    std::future<Alignment> futures[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        const bool downward    = i < 2;
+        const bool rightToLeft = (i % 2) == 1;
+        futures[i] = std::async(policy, [this, downward, rightToLeft]()
+                                { return AlignVertically(downward, rightToLeft); });
+    }
+    Alignment alignments[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        alignments[i] = futures[i].get();
+    }
+
+    const size_t vertexCount = m_nodeUids.size();
+    double       minCoord[4];
+    double       maxCoord[4];
+    int          narrowest     = 0;
+    double       narrowestSize = std::numeric_limits<double>::max();
+    for (int i = 0; i < 4; ++i)
+    {
+        minCoord[i]   = std::numeric_limits<double>::max();
+        maxCoord[i]   = std::numeric_limits<double>::lowest();
+        double top    = std::numeric_limits<double>::max();
+        double bottom = std::numeric_limits<double>::lowest();
+        for (size_t v = 0; v < vertexCount; ++v)
+        {
+            const double coord = alignments[i].m_coords[v];
+            minCoord[i]        = std::min(minCoord[i], coord);
+            maxCoord[i]        = std::max(maxCoord[i], coord);
+            top                = std::min(top, coord - m_sizes[v].y / 2.0);
+            bottom             = std::max(bottom, coord + m_sizes[v].y / 2.0);
+        }
+        if (bottom - top < narrowestSize)
+        {
+            narrowestSize = bottom - top;
+            narrowest     = i;
+        }
+    }
+
+    for (int i = 0; i < 4; ++i)
+    {
+        const bool   rightToLeft = (i % 2) == 1;
+        const double delta       = rightToLeft ? maxCoord[narrowest] - maxCoord[i]
+                                               : minCoord[narrowest] - minCoord[i];
+        for (double& coord : alignments[i].m_coords)
+        {
+            coord += delta;
+        }
+    }
+
+    std::vector<double> coords(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        double candidates[4];
+        for (int i = 0; i < 4; ++i)
+        {
+            candidates[i] = alignments[i].m_coords[v];
+        }
+        std::sort(candidates, candidates + 4);
+        coords[v] = (candidates[1] + candidates[2]) / 2.0;
+    }
+
+    // balancing can bring two vertices of a layer closer than their separation, push them apart
+    for (const std::vector<int>& layer : m_layers)
+    {
+        for (size_t i = 1; i < layer.size(); ++i)
+        {
+            coords[layer[i]] = std::max(coords[layer[i]],
+                                        coords[layer[i - 1]] + Separation(layer[i - 1], layer[i]));
+        }
+    }
+    return coords;
+}
+
+} // namespace SimpleNodeEditor
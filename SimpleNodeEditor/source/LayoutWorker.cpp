@@ -0,0 +1,68 @@
+#include "LayoutWorker.hpp"
+#include "LayeredLayout.hpp"
+#include <chrono>
+
+namespace SimpleNodeEditor
+{
+
+void LayoutWorker::Request(Snapshot snapshot)
+{
+    if (IsBusy())
+    {
+        m_pending = std::move(snapshot);
+        return;
+    }
+    Launch(std::move(snapshot));
+}
+
+std::optional<LayoutWorker::Result> LayoutWorker::Poll()
+{
+    if (!m_running.valid() ||
+        m_running.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    {
+        return std::nullopt;
+    }
+
+    std::optional<Result> result = m_running.get();
+    if (m_dropRunning)
+    {
+        result.reset();
+        m_dropRunning = false;
+    }
+
+    if (m_pending)
+    {
+        Launch(std::move(*m_pending));
+        m_pending.reset();
+    }
+    return result;
+}
+
+void LayoutWorker::Cancel()
+{
+    m_pending.reset();
+    m_dropRunning = m_running.valid();
+}
+
+bool LayoutWorker::IsBusy() const
+{
+    return m_running.valid();
+}
+
+void LayoutWorker::Launch(Snapshot snapshot)
+{
+    // the snapshot is moved into the task, nothing else is shared with the UI thread
+    m_running = std::async(std::launch::async,
+                           [snapshot = std::move(snapshot)]()
+                           {
+                               LayeredLayout layout;
+                               Result        result;
+                               result.m_revision  = snapshot.m_revision;
+                               result.m_positions = layout.Compute(
+                                   snapshot.m_layers, snapshot.m_edges, snapshot.m_nodeSizes);
+                               result.m_crossingCount = layout.GetCrossingCount();
+                               return result;
+                           });
+}
+
+} // namespace SimpleNodeEditor
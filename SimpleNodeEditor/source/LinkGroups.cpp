@@ -0,0 +1,39 @@
+#include "LinkGroups.hpp"
+#include <algorithm>
+#include "Log.hpp"
+
+namespace SimpleNodeEditor
+{
+
+LinkGroups::LinkGroups() : m_groups() {}
+
+void LinkGroups::AddEdge(PortUniqueId srcPortUid, EdgeUniqueId edgeUid)
+{
+    m_groups[srcPortUid].push_back(edgeUid);
+}
+
+void LinkGroups::RemoveEdge(PortUniqueId srcPortUid, EdgeUniqueId edgeUid)
+{
+    auto groupIter = m_groups.find(srcPortUid);
+    if (groupIter == m_groups.end())
+    {
+        SNELOG_WARN("removing edge [{}] of source port [{}] that has no edges", edgeUid,
+                    srcPortUid);
+        return;
+    }
+
+    // a source port has a handful of edges, the order of them is kept
+    std::vector<EdgeUniqueId>& edges = groupIter->second;
+    edges.erase(std::remove(edges.begin(), edges.end(), edgeUid), edges.end());
+    if (edges.empty())
+    {
+        m_groups.erase(groupIter);
+    }
+}
+
+void LinkGroups::Clear()
+{
+    m_groups.clear();
+}
+
+} // namespace SimpleNodeEditor
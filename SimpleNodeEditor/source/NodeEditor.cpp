@@ -7,11 +7,14 @@
 #include "Common.hpp"
 #include "Notify.hpp"
 #include "FileDialog.hpp"
+#include "SNEConfig.hpp"
 #include <cstdint>
 #include <unordered_set>
 #include <set>
 #include <algorithm>
+#include <cmath>
 #include <numeric>
+#include <limits>
 #include <fstream>
 #include <optional>
 
@@ -54,6 +57,27 @@ void DegbugDrawCircle(const ImVec2& center, float radius)
 static std::unordered_map<std::string, NodeDescription>  s_nodeDescriptionsNameDesMap;
 static std::unordered_map<YamlNodeType, NodeDescription> s_nodeDescriptionsTypeDesMap;
 
+// row of a port among the ports ShowNodes() draws for its node, nullopt if the port is hidden
+template <typename PortType>
+static std::optional<size_t> GetVisiblePortRow(const std::vector<PortType>& ports,
+                                               PortUniqueId portUid, bool hideUnlinkedPorts)
+{
+    size_t row = 0;
+    for (const PortType& port : ports)
+    {
+        if (hideUnlinkedPorts && port.HasNoEdgeLinked())
+        {
+            continue;
+        }
+        if (port.GetPortUniqueId() == portUid)
+        {
+            return row;
+        }
+        ++row;
+    }
+    return std::nullopt;
+}
+
 NodeEditor::NodeEditor()
     : m_nodes(),
       m_edges(),
@@ -65,9 +89,40 @@ NodeEditor::NodeEditor()
       m_yamlNodeUidGenerator("yamlNodeUidAllocator"),
       m_minimap_location(ImNodesMiniMapLocation_TopRight),
       m_needTopoSort(false),
+      m_layoutMode(LayoutMode::Layered),
+      m_incrementalLayout(false),
+      m_editedNodes(),
+      m_topologicalOrder(),
+      m_linkGroups(),
+      m_layoutWorker(),
+      m_sizeEstimator(),
+      m_layoutTransitions(),
+      m_layoutTransitionTime(0.f),
+      m_editorWindowHeight(0.f),
+      m_forceLayout(),
+      m_forceLayoutRunning(false),
+      m_forceLayoutRevision(0),
+      m_forceLayoutPositions(),
+      m_pinnedNodes(),
+      m_cyclicNodes(),
+      m_cyclesDirty(false),
+      m_orthogonalEdges(false),
+      m_routeWorker(),
+      m_edgeRoutes(),
+      m_routedNodeRects(),
+      m_routedEdgeEnds(),
+      m_routedRevision(0),
+      m_routedHideUnlinkedPorts(false),
       m_currentPipeLineName(),
       m_nodeStyle(&ImNodes::GetStyle()),
-      m_pipeLineParser(),
+      m_pipelineLoader(),
+      m_savedFileLayout(),
+      m_loadingTarget(),
+      m_editJournal(),
+      m_journalingCommand(false),
+      m_journalNodes(),
+      m_journalEdges(),
+      m_journalRecovery(),
       m_fileDialog(),
       m_commandQueue(),
       m_pruningPolicy(),
@@ -83,6 +138,12 @@ NodeEditor::NodeEditor()
         s_nodeDescriptionsNameDesMap.emplace(nodeD.m_nodeName, nodeD);
     }
 
+    m_pipelineLoader.SetCacheDirectory(
+        SNEConfig::GetInstance().GetConfigValue<std::string>("PipelineCacheDirectory"));
+
+    m_journalRecovery = m_editJournal.Open(
+        SNEConfig::GetInstance().GetConfigValue<std::string>("EditJournalFile"));
+    RecoverJournaledEdits();
 }
 
 void NodeEditor::NodeEditorInitialize()
@@ -97,12 +158,21 @@ void NodeEditor::DrawFileDialog()
     {
         if (m_fileDialog.GetType() == FileDialog::Type::OPEN)
         {
-            ClearCurrentPipeLine(); // should let user confirm to do this ? 
-            LoadPipeline(m_fileDialog.GetResultInStream());
+            // local files are mapped, remote ones are read through a stream
+            if (std::unique_ptr<FS::MappedFile> mappedFile = m_fileDialog.GetResultMappedFile())
+            {
+                m_loadingTarget = m_fileDialog.GetResultTarget();
+                m_journalRecovery.reset();
+                m_pipelineLoader.Load(std::move(mappedFile), m_fileDialog.GetResultPath().String());
+            }
+            else
+            {
+                LoadPipeline(m_fileDialog.GetResultInStream());
+            }
         }else if (m_fileDialog.GetType() == FileDialog::Type::SAVE)
         {
             SNELOG_INFO("save pipeline file to {}", m_fileDialog.GetFileName().String());
-            SaveToFile(m_fileDialog.GetResultOutStream());
+            SaveToDialogFile();
         }
     }
 }
@@ -115,6 +185,8 @@ void NodeEditor::NodeEditorShow()
     ShowPruningRuleEditWinddow(mainWindowDisplaySize);
     Notifier::Draw();
     DrawFileDialog();
+    HandlePipelineLoading();
+    m_editJournal.Update();
 }
 
 void NodeEditor::NodeEditorDestroy() {}
@@ -153,6 +225,7 @@ void NodeEditor::DrawFileMenu()
         if (ImGui::MenuItem("Clear", "Ctrl + l", false, true))
         {
             ClearCurrentPipeLine();
+            m_editJournal.Restart("");
         }
 
         ImGui::EndMenu();
@@ -168,6 +241,48 @@ void NodeEditor::DrawConfig()
         {
             ImGui::SetTooltip("Toggle between showing all ports and hiding unlinked ports");
         }
+
+        int layoutMode = static_cast<int>(m_layoutMode);
+        if (ImGui::Combo("Layout", &layoutMode, "Layered\0Force Directed\0"))
+        {
+            m_layoutMode   = static_cast<LayoutMode>(layoutMode);
+            m_needTopoSort = true;
+        }
+        if (ImGui::IsItemHovered())
+        {
+            ImGui::SetTooltip("Layered suits deep pipelines, force directed suits parallel branches. "
+                              "Nodes moved by hand stay in place in force directed layouts");
+        }
+
+        ImGui::BeginDisabled(m_layoutMode != LayoutMode::Layered);
+        ImGui::Checkbox("Incremental Layout", &m_incrementalLayout);
+        ImGui::EndDisabled();
+        if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled))
+        {
+            ImGui::SetTooltip("S only places the nodes added or moved to another level since the "
+                              "last layout, the other nodes stay where they are");
+        }
+
+        if (ImGui::Checkbox("Orthogonal Edges", &m_orthogonalEdges) && !m_orthogonalEdges)
+        {
+            // routed again from scratch when turned back on
+            m_routeWorker.Reset();
+            m_edgeRoutes.clear();
+            m_routedNodeRects.clear();
+            m_routedEdgeEnds.clear();
+        }
+        if (ImGui::IsItemHovered())
+        {
+            ImGui::SetTooltip("Route edges around nodes with horizontal and vertical segments");
+        }
+
+        if (ImGui::MenuItem("Unpin All Nodes", nullptr, false, !m_pinnedNodes.empty()))
+        {
+            m_pinnedNodes.clear();
+            // forget where nodes were, so that none is taken as moved by hand
+            m_forceLayoutPositions.clear();
+            m_needTopoSort = m_needTopoSort || m_layoutMode == LayoutMode::ForceDirected;
+        }
         ImGui::EndMenu();
     }
 }
@@ -202,6 +317,15 @@ void NodeEditor::ShowNodes()
                                     ImNodesCol_BoxSelectorOutline,
                                     ImGuiCol_Text);
 
+        const bool isCyclic = m_cyclicNodes.contains(nodeUid);
+        if (isCyclic)
+        {
+            ImNodes::PushColorStyle(ImNodesCol_NodeOutline, COLOR_RED_U32);
+            ImNodes::PushColorStyle(ImNodesCol_TitleBar, IM_COL32(160, 30, 30, 255));
+            ImNodes::PushColorStyle(ImNodesCol_TitleBarHovered, IM_COL32(200, 40, 40, 255));
+            ImNodes::PushColorStyle(ImNodesCol_TitleBarSelected, IM_COL32(220, 50, 50, 255));
+        }
+
         ImNodes::BeginNode(nodeUid);
         ImNodes::BeginNodeTitleBar();
         ImGui::TextUnformatted(node.GetNodeTitle().data());
@@ -263,12 +387,9 @@ void NodeEditor::ShowNodes()
                 std::max(maxOutLabelWidth, ImGui::CalcTextSize(n.data(), n.data() + n.size()).x);
         }
 
-        // small gap between columns
-        const float innerGap = 8.0f;
-
         // remember the starting X of the content area so we can compute column X positions
         const float baseX      = ImGui::GetCursorPosX();
-        const float outColumnX = baseX + maxInLabelWidth + innerGap;
+        const float outColumnX = baseX + maxInLabelWidth + NodeSizeEstimator::s_portColumnGap;
 
         for (size_t row = 0; row < rows; ++row)
         {
@@ -316,6 +437,11 @@ void NodeEditor::ShowNodes()
             }
         }
         ImNodes::EndNode();
+
+        if (isCyclic)
+        {
+            IMNODES_POP_STYLE_COL(4);
+        }
     }
 }
 
@@ -328,7 +454,19 @@ void NodeEditor::ShowEdges()
                                     ImNodesCol_LinkHovered,
                                     ImNodesCol_LinkSelected);
 
-        ImNodes::Link(edgeUid, edge.GetSourcePortUid(), edge.GetDestinationPortUid());
+        auto routeIter = m_orthogonalEdges ? m_edgeRoutes.find(edgeUid) : m_edgeRoutes.end();
+        if (routeIter != m_edgeRoutes.end())
+        {
+            ImNodes::Link(edgeUid,
+                          edge.GetSourcePortUid(),
+                          edge.GetDestinationPortUid(),
+                          routeIter->second.data(),
+                          static_cast<int>(routeIter->second.size()));
+        }
+        else
+        {
+            ImNodes::Link(edgeUid, edge.GetSourcePortUid(), edge.GetDestinationPortUid());
+        }
     }
 }
 
@@ -376,6 +514,8 @@ void NodeEditor::ShowPipelineName()
         if (ImGui::SmallButton("Done"))
         {
             m_currentPipeLineName = newPipeLineName;
+            m_editJournal.Append(EditJournal::Entry::ForNames(
+                EditJournal::Entry::Type::SetPipelineName, m_currentPipeLineName));
             ImGui::CloseCurrentPopup();
         }
         ImGui::EndPopup();
@@ -393,20 +533,39 @@ void NodeEditor::ShowGrapghEditWindow(const ImVec2& mainWindowDisplaySize)
 
     // The node editor window
     ImGui::Begin("SimpleNodeEditor", nullptr, flags);
+    m_editorWindowHeight = ImGui::GetWindowHeight();
     ImNodes::GetIO().EmulateThreeButtonMouse.Modifier = &ImGui::GetIO().KeyAlt;
 
     DrawMenu();
 
+    if (m_cyclesDirty)
+    {
+        UpdateCyclicNodes(false);
+    }
+
     ImNodes::BeginNodeEditor();
     ShowNodes();
-    // only afer calling ImNodes::EndNode in the ShowNodes() function can we get the rect of nodeUi,
-    // and then we do toposort
+    // node sizes are estimated, but the force directed layout starts from the positions ImNodes
+    // gives to the nodes, which only exist once ShowNodes() has submitted them
     if (m_needTopoSort)
     {            
-        const auto& topoSortRes = TopologicalSort(m_nodes, m_edges);
-        RearrangeNodesLayout(topoSortRes, m_nodes);
+        if (m_layoutMode == LayoutMode::ForceDirected)
+        {
+            StartForceDirectedLayout();
+        }
+        else
+        {
+            m_forceLayoutRunning = false;
+            if (!m_incrementalLayout || !RelayoutEditedNodes())
+            {
+                RearrangeNodesLayout(m_topologicalOrder.GetLevels(), m_nodes);
+            }
+        }
         m_needTopoSort = false;
     }            
+    ApplyLayoutResult();
+    StepForceDirectedLayout();
+    UpdateEdgeRoutes();
     ShowEdges(); 
     ImNodes::MiniMap(0.2f, m_minimap_location);
     ImNodes::EndNodeEditor();
@@ -478,6 +637,9 @@ void NodeEditor::ShowPruningRuleEditWinddow(const ImVec2& mainWindowDisplaySize)
                         std::string originType{currentPruningRule.at(group)};
                         if (m_pruningPolicy.ChangePruningRule(m_nodes, m_edges, group, types[iterIndex]))
                         {
+                            m_editJournal.Append(EditJournal::Entry::ForNames(
+                                EditJournal::Entry::Type::ChangePruningRule, group,
+                                types[iterIndex]));
 
                             SNELOG_INFO("ChangePruning rule success, group {}, newtype {}", group, types[iterIndex]);
                         }
@@ -514,6 +676,11 @@ void NodeEditor::ShowPruningRuleEditWinddow(const ImVec2& mainWindowDisplaySize)
             {
                 SNELOG_ERROR("pruning policy add new pruning rule failed");
             }
+            else
+            {
+                m_editJournal.Append(EditJournal::Entry::ForNames(
+                    EditJournal::Entry::Type::AddPruningRule, newPruneGroup, newPruneType));
+            }
             editing = false;
             newPruneGroup.clear();
             newPruneType.clear();
@@ -650,6 +817,13 @@ NodeUniqueId NodeEditor::AddNewNodes(const NodeDescription& nodeDesc, const Yaml
         return -1;
     }
 
+    m_topologicalOrder.AddNode(ret);
+    m_editedNodes.insert(ret);
+    if (m_journalingCommand)
+    {
+        m_journalNodes.insert(ret);
+    }
+
     // Now populate port lookups with valid pointers to ports in the stored node
     Node& storedNode = m_nodes.at(ret);
     for (const auto& port : storedNode.GetInputPorts())
@@ -691,8 +865,18 @@ void NodeEditor::DeleteNode(NodeUniqueId nodeUid, bool shouldUnregisterUid)
         SNELOG_ERROR("deleting a nonexisting node, check it! nodeUid = {}", nodeUid);
         return;
     }
+    if (m_journalingCommand)
+    {
+        m_editJournal.Append(EditJournal::Entry::ForNode(EditJournal::Entry::Type::RemoveNode,
+                                                         m_nodes.at(nodeUid).GetYamlNode()));
+    }
     // before we erase the node, we need delete the linked edge first
     DeleteEdgesBeforDeleteNode(nodeUid, shouldUnregisterUid);
+    m_topologicalOrder.RemoveNode(nodeUid);
+    m_editedNodes.erase(nodeUid);
+    m_cyclicNodes.erase(nodeUid);
+    m_pinnedNodes.erase(nodeUid);
+    m_forceLayoutPositions.erase(nodeUid);
 
     // erase pointer in m_inportPorts and m_outportPorts
     auto erasePointersInMember =
@@ -772,6 +956,17 @@ EdgeUniqueId NodeEditor::AddNewEdge(PortUniqueId srcPortUid, PortUniqueId dstPor
         return -1;
     }
 
+    // reject edges closing a cycle, the topological order is updated otherwise
+    if (m_outportPorts.contains(srcPortUid) && m_inportPorts.contains(dstPortUid) &&
+        !m_topologicalOrder.AddEdge(m_outportPorts.at(srcPortUid)->GetOwnedNodeUid(),
+                                    m_inportPorts.at(dstPortUid)->GetOwnedNodeUid()))
+    {
+        SNELOG_WARN("edge from outportUid[{}] to inportUid[{}] would create a cycle, rejected",
+                    srcPortUid, dstPortUid);
+        Notifier::Add(Message(Message::Type::WARNING, "", "This edge would create a cycle"));
+        return -1;
+    }
+
     Edge newEdge(srcPortUid, dstPortUid, m_edgeUidGenerator.AllocUniqueID(), yamlEdge);
 
     // set inportport's edgeid
@@ -816,6 +1011,11 @@ EdgeUniqueId NodeEditor::AddNewEdge(PortUniqueId srcPortUid, PortUniqueId dstPor
     DumpEdge(newEdge);
     newEdge.GetYamlEdge().m_isValid = true;
     m_edges.emplace(newEdge.GetEdgeUniqueId(), (newEdge));
+    m_linkGroups.AddEdge(srcPortUid, newEdge.GetEdgeUniqueId());
+    if (m_journalingCommand)
+    {
+        m_journalEdges.insert(newEdge.GetEdgeUniqueId());
+    }
     if (m_pruningPolicy.ApplyCurrentPruningRule(m_nodes, m_edges))
     {
         SNELOG_INFO( "AddNew Edge and apply pruning rule successfully");
@@ -889,6 +1089,15 @@ void NodeEditor::DeleteEdge(EdgeUniqueId edgeUid, bool shouldUnregisterUid)
         return;
     }
     DeleteEdgeUidFromPort(edgeUid);
+    const Edge& edge = m_edges.at(edgeUid);
+    if (m_journalingCommand)
+    {
+        m_editJournal.Append(EditJournal::Entry::ForEdge(EditJournal::Entry::Type::RemoveEdge,
+                                                         edge.GetYamlEdge()));
+    }
+    m_topologicalOrder.RemoveEdge(edge.GetSourceNodeUid(), edge.GetDestinationNodeUid());
+    m_linkGroups.RemoveEdge(edge.GetSourcePortUid(), edgeUid);
+    m_cyclesDirty = m_cyclesDirty || !m_cyclicNodes.empty();
 
     if (shouldUnregisterUid)
     {
@@ -981,46 +1190,529 @@ void NodeEditor::RearrangeNodesLayout(
         return;
     }
 
-    float verticalPadding   = 20.f;
-    float horizontalPadding = 100.f;
+    // every node gets placed, whatever was edited before
+    m_editedNodes.clear();
+    m_topologicalOrder.TakeRelevelledNodes();
 
-    // put collections of nodes belonging to the same topological priority in a single colum
-    std::vector<float> columWidths;
-    std::vector<float> columHeights;
-    // calc each colum's width and height using rect of NodeUi
+    // the worker gets a copy of everything it needs, node sizes included
+    LayoutWorker::Snapshot snapshot;
+    snapshot.m_revision = m_topologicalOrder.GetRevision();
+    snapshot.m_layers   = topologicalOrder;
+    snapshot.m_nodeSizes.reserve(nodesMap.size());
+    NodeSizeEstimator& sizeEstimator = GetSizeEstimator();
     for (const auto& nodeUIdVec : topologicalOrder)
     {
-        float columWidth  = 0.f; // equal to the max of nodes' width in the same priority
-        float columHeight = 0.f;
         for (NodeUniqueId nodeUid : nodeUIdVec)
         {
-            columWidth = std::max(ImNodes::GetNodeRect(nodeUid).GetWidth(), columWidth);
-            SNELOG_INFO("nodeuid[{}], nodewidth[{}]", nodeUid,
-                        ImNodes::GetNodeRect(nodeUid).GetWidth());
-            columHeight += (ImNodes::GetNodeRect(nodeUid).GetHeight() + verticalPadding);
+            auto nodeIter = nodesMap.find(nodeUid);
+            if (nodeIter != nodesMap.end())
+            {
+                snapshot.m_nodeSizes.emplace(
+                    nodeUid, sizeEstimator.Estimate(nodeIter->second, m_hideUnlinkedPorts));
+            }
+        }
+    }
+    snapshot.m_edges.reserve(m_edges.size());
+    for (const auto& [_, edge] : m_edges)
+    {
+        snapshot.m_edges.emplace_back(edge.GetSourceNodeUid(), edge.GetDestinationNodeUid());
+    }
+
+    m_layoutWorker.Request(std::move(snapshot));
+}
+
+void NodeEditor::ApplyLayoutResult()
+{
+    // duration of the move from the old positions to the new ones
+    constexpr float transitionDuration = 0.3f;
+
+    if (std::optional<LayoutWorker::Result> result = m_layoutWorker.Poll())
+    {
+        if (result->m_revision != m_topologicalOrder.GetRevision())
+        {
+            // the graph changed while the layout was running, lay out the current graph instead
+            SNELOG_INFO("discard stale layout of revision[{}], current revision[{}]",
+                        result->m_revision, m_topologicalOrder.GetRevision());
+            RearrangeNodesLayout(m_topologicalOrder.GetLevels(), m_nodes);
+        }
+        else
+        {
+            SNELOG_INFO("layered layout done, nodes[{}] edge crossings[{}]",
+                        result->m_positions.size(), result->m_crossingCount);
+            m_layoutTransitions.clear();
+            for (const auto& [nodeUid, pos] : result->m_positions)
+            {
+                m_layoutTransitions.emplace(
+                    nodeUid, std::make_pair(ImNodes::GetNodeGridSpacePos(nodeUid), pos));
+            }
+            m_layoutTransitionTime = 0.f;
+            // positions left by a force directed layout no longer tell which nodes were moved
+            m_forceLayoutPositions.clear();
+            // set editor panning
+            ImNodes::EditorContextResetPanning(ImVec2{0, m_editorWindowHeight / 2.0f});
+        }
+    }
+
+    if (m_layoutTransitions.empty())
+    {
+        return;
+    }
+
+    m_layoutTransitionTime += ImGui::GetIO().DeltaTime;
+    const float t     = std::min(m_layoutTransitionTime / transitionDuration, 1.f);
+    const float eased = 1.f - (1.f - t) * (1.f - t) * (1.f - t);
+    for (const auto& [nodeUid, transition] : m_layoutTransitions)
+    {
+        // nodes may have been deleted during the transition
+        if (m_nodes.contains(nodeUid))
+        {
+            const auto& [from, to] = transition;
+            ImNodes::SetNodeGridSpacePos(nodeUid, ImVec2(from.x + (to.x - from.x) * eased,
+                                                         from.y + (to.y - from.y) * eased));
+        }
+    }
+    if (t >= 1.f)
+    {
+        m_layoutTransitions.clear();
+    }
+}
+
+bool NodeEditor::RelayoutEditedNodes()
+{
+    for (NodeUniqueId nodeUid : m_topologicalOrder.TakeRelevelledNodes())
+    {
+        m_editedNodes.insert(nodeUid);
+    }
+    // nothing to place, or so much that laying out everything is better and not much slower
+    if (m_editedNodes.empty() || m_editedNodes.size() * 2 > m_nodes.size() ||
+        m_layoutWorker.IsBusy())
+    {
+        return false;
+    }
+
+    // the running transition ends where it was going, so the fixed nodes are read at their place
+    for (const auto& [nodeUid, transition] : m_layoutTransitions)
+    {
+        if (m_nodes.contains(nodeUid))
+        {
+            ImNodes::SetNodeGridSpacePos(nodeUid, transition.second);
         }
-        columWidths.push_back(columWidth);
-        columHeights.push_back(columHeight);
     }
+    m_layoutTransitions.clear();
 
-    SNE_ASSERT(topologicalOrder.size() == columWidths.size() &&
-               topologicalOrder.size() == columHeights.size());
+    IncrementalLayout::Snapshot snapshot;
+    NodeSizeEstimator&          sizeEstimator = GetSizeEstimator();
+    auto addNode = [&](NodeUniqueId nodeUid, const Node& node)
+    {
+        snapshot.m_layers.emplace(nodeUid, m_topologicalOrder.GetLevel(nodeUid));
+        snapshot.m_sizes.emplace(nodeUid, sizeEstimator.Estimate(node, m_hideUnlinkedPorts));
+    };
 
-    float gridSpaceX = 0.f;
-    for (size_t columIndex = 0; columIndex < topologicalOrder.size(); ++columIndex)
+    int minLevel = std::numeric_limits<int>::max();
+    int maxLevel = -1;
+    for (NodeUniqueId nodeUid : m_editedNodes)
     {
-        float gridSpaceY = -columHeights[columIndex] / 2.0f;
-        for (const NodeUniqueId nodeUid : topologicalOrder[columIndex])
+        const Node& node = m_nodes.at(nodeUid);
+        snapshot.m_freeNodes.push_back(nodeUid);
+        addNode(nodeUid, node);
+        minLevel = std::min(minLevel, snapshot.m_layers.at(nodeUid));
+        maxLevel = std::max(maxLevel, snapshot.m_layers.at(nodeUid));
+
+        for (EdgeUniqueId edgeUid : node.GetAllEdgeUids())
         {
-            ImNodes::SetNodeGridSpacePos(nodeUid, ImVec2{gridSpaceX, gridSpaceY});
-            gridSpaceY += (ImNodes::GetNodeRect(nodeUid).GetHeight() + verticalPadding);
+            auto edgeIter = m_edges.find(edgeUid);
+            if (edgeIter == m_edges.end())
+            {
+                continue;
+            }
+            const Edge& edge = edgeIter->second;
+            snapshot.m_edges.emplace_back(edge.GetSourceNodeUid(), edge.GetDestinationNodeUid());
+            const NodeUniqueId neighbourUid = edge.GetSourceNodeUid() == nodeUid
+                                                  ? edge.GetDestinationNodeUid()
+                                                  : edge.GetSourceNodeUid();
+            if (!m_editedNodes.contains(neighbourUid) && !snapshot.m_layers.contains(neighbourUid))
+            {
+                addNode(neighbourUid, m_nodes.at(neighbourUid));
+                snapshot.m_fixedPositions.emplace(neighbourUid,
+                                                  ImNodes::GetNodeGridSpacePos(neighbourUid));
+            }
+        }
+    }
+
+    // the layers of the edited nodes, and the one before them which the first one is put next to,
+    // are the only ones the edited nodes can collide with. Only their nodes get sized.
+    m_topologicalOrder.ForEachNodeInLevels(minLevel - 1, maxLevel, [&](NodeUniqueId nodeUid)
+    {
+        if (!snapshot.m_layers.contains(nodeUid))
+        {
+            addNode(nodeUid, m_nodes.at(nodeUid));
+            snapshot.m_fixedPositions.emplace(nodeUid, ImNodes::GetNodeGridSpacePos(nodeUid));
+        }
+    });
+
+    const std::unordered_map<NodeUniqueId, ImVec2> positions =
+        IncrementalLayout().Compute(snapshot);
+    for (const auto& [nodeUid, pos] : positions)
+    {
+        m_layoutTransitions.emplace(nodeUid,
+                                    std::make_pair(ImNodes::GetNodeGridSpacePos(nodeUid), pos));
+    }
+    m_layoutTransitionTime = 0.f;
+    SNELOG_INFO("incremental layout done, placed nodes[{}] around fixed nodes[{}]",
+                positions.size(), snapshot.m_fixedPositions.size());
+    m_editedNodes.clear();
+    return true;
+}
+
+void NodeEditor::StartForceDirectedLayout()
+{
+    // only one layout moves the nodes at a time
+    m_layoutWorker.Cancel();
+    m_layoutTransitions.clear();
+
+    std::unordered_map<NodeUniqueId, ImVec2> positions;
+    std::unordered_map<NodeUniqueId, ImVec2> nodeSizes;
+    positions.reserve(m_nodes.size());
+    nodeSizes.reserve(m_nodes.size());
+    NodeSizeEstimator& sizeEstimator = GetSizeEstimator();
+    for (const auto& [nodeUid, node] : m_nodes)
+    {
+        const ImVec2 pos = ImNodes::GetNodeGridSpacePos(nodeUid);
+        positions.emplace(nodeUid, pos);
+        nodeSizes.emplace(nodeUid, sizeEstimator.Estimate(node, m_hideUnlinkedPorts));
+
+        // moved by hand since the last force directed layout
+        auto lastIter = m_forceLayoutPositions.find(nodeUid);
+        if (lastIter != m_forceLayoutPositions.end() &&
+            (std::abs(lastIter->second.x - pos.x) > 0.5f || std::abs(lastIter->second.y - pos.y) > 0.5f))
+        {
+            m_pinnedNodes.insert(nodeUid);
         }
-        gridSpaceX += (columWidths[columIndex] + horizontalPadding);
     }
-    // set editor panning
-    ImNodes::EditorContextResetPanning(ImVec2{0, ImGui::GetWindowHeight() / 2.0f});
+
+    std::vector<std::pair<NodeUniqueId, NodeUniqueId>> edges;
+    edges.reserve(m_edges.size());
+    for (const auto& [_, edge] : m_edges)
+    {
+        edges.emplace_back(edge.GetSourceNodeUid(), edge.GetDestinationNodeUid());
+    }
+
+    m_forceLayout.Reset(positions, nodeSizes, edges);
+    for (NodeUniqueId nodeUid : m_pinnedNodes)
+    {
+        m_forceLayout.Pin(nodeUid, positions.at(nodeUid));
+    }
+    m_forceLayoutPositions = std::move(positions);
+    m_forceLayoutRevision  = m_topologicalOrder.GetRevision();
+    m_forceLayoutRunning   = true;
+    SNELOG_INFO("force directed layout started, nodes[{}] edges[{}] pinned[{}]", m_nodes.size(),
+                edges.size(), m_pinnedNodes.size());
 }
 
+void NodeEditor::StepForceDirectedLayout()
+{
+    // time spent on the layout per frame, the rest of the frame stays responsive
+    constexpr std::chrono::microseconds frameBudget(4000);
+
+    if (!m_forceLayoutRunning)
+    {
+        return;
+    }
+    if (m_forceLayoutRevision != m_topologicalOrder.GetRevision())
+    {
+        // the graph was edited, carry on from where the nodes are now
+        StartForceDirectedLayout();
+    }
+
+    // nodes dragged since the last step are pinned where the user left them, pinned nodes follow
+    // the user while being dragged
+    for (size_t index = 0; index < m_forceLayout.GetNodeCount(); ++index)
+    {
+        const NodeUniqueId nodeUid = m_forceLayout.GetNodeUid(index);
+        const ImVec2       pos     = ImNodes::GetNodeGridSpacePos(nodeUid);
+        ImVec2&            last    = m_forceLayoutPositions.at(nodeUid);
+        if (std::abs(last.x - pos.x) > 0.5f || std::abs(last.y - pos.y) > 0.5f)
+        {
+            m_pinnedNodes.insert(nodeUid);
+            m_forceLayout.Pin(nodeUid, pos);
+            last = pos;
+        }
+    }
+
+    const bool settled = m_forceLayout.Step(frameBudget);
+    for (size_t index = 0; index < m_forceLayout.GetNodeCount(); ++index)
+    {
+        if (!m_forceLayout.IsPinned(index))
+        {
+            const NodeUniqueId nodeUid = m_forceLayout.GetNodeUid(index);
+            const ImVec2       pos     = m_forceLayout.GetPosition(index);
+            ImNodes::SetNodeGridSpacePos(nodeUid, pos);
+            m_forceLayoutPositions[nodeUid] = pos;
+        }
+    }
+
+    if (settled)
+    {
+        m_forceLayoutRunning = false;
+        SNELOG_INFO("force directed layout settled, nodes[{}]", m_forceLayout.GetNodeCount());
+    }
+}
+
+bool NodeEditor::ApplySavedNodePositions(
+    const std::vector<YamlNode>&                                  yamlNodes,
+    const std::unordered_map<YamlNode::NodeYamlId, NodeUniqueId>& yamlNodeId2NodeUidMap)
+{
+    // a partial layout is not worth keeping, the missing nodes would land anywhere
+    const bool allPositioned = std::all_of(yamlNodes.begin(), yamlNodes.end(),
+                                           [](const YamlNode& yamlNode)
+                                           { return yamlNode.m_position.has_value(); });
+    if (yamlNodes.empty() || !allPositioned)
+    {
+        return false;
+    }
+
+    for (const YamlNode& yamlNode : yamlNodes)
+    {
+        auto iter = yamlNodeId2NodeUidMap.find(yamlNode.m_nodeYamlId);
+        if (iter != yamlNodeId2NodeUidMap.end())
+        {
+            ImNodes::SetNodeGridSpacePos(iter->second,
+                                         ImVec2(yamlNode.m_position->m_x, yamlNode.m_position->m_y));
+        }
+    }
+    // same panning as after a layout
+    ImNodes::EditorContextResetPanning(ImVec2{0, m_editorWindowHeight / 2.0f});
+    SNELOG_INFO("restored saved positions of [{}] nodes, skip layout", yamlNodes.size());
+    return true;
+}
+
+void NodeEditor::StoreNodePositions()
+{
+    for (auto& [nodeUid, node] : m_nodes)
+    {
+        // the destination of a running layout transition is where the node is going to stay
+        auto transitionIter = m_layoutTransitions.find(nodeUid);
+        if (transitionIter == m_layoutTransitions.end() && !ImNodes::IsNodeKnown(nodeUid))
+        {
+            // not shown yet, it keeps the position it came with
+            continue;
+        }
+        const ImVec2 pos = transitionIter != m_layoutTransitions.end()
+                               ? transitionIter->second.second
+                               : ImNodes::GetNodeGridSpacePos(nodeUid);
+        node.GetYamlNode().m_position = YamlNodePosition{pos.x, pos.y};
+    }
+}
+
+void NodeEditor::UpdateCyclicNodes(bool notify)
+{
+    m_cyclesDirty = false;
+    m_cyclicNodes.clear();
+    if (!m_topologicalOrder.HasCycles())
+    {
+        return;
+    }
+
+    const std::vector<std::vector<NodeUniqueId>> cycles = FindCycles(m_nodes, m_edges);
+    std::string                                  description;
+    for (size_t index = 0; index < cycles.size(); ++index)
+    {
+        m_cyclicNodes.insert(cycles[index].begin(), cycles[index].end());
+
+        // a handful of cycles is enough for a notification, the canvas shows all of them
+        constexpr size_t kMaxDescribedCycles = 5;
+        if (index == kMaxDescribedCycles)
+        {
+            description += " and " + std::to_string(cycles.size() - index) + " more";
+        }
+        if (index >= kMaxDescribedCycles)
+        {
+            continue;
+        }
+
+        description += index == 0 ? "{" : ", {";
+        for (size_t member = 0; member < cycles[index].size(); ++member)
+        {
+            description += member == 0 ? "" : ", ";
+            description += m_nodes.at(cycles[index][member]).GetNodeTitle();
+        }
+        description += "}";
+    }
+
+    SNELOG_WARN("pipeline has [{}] cycle(s) over [{}] nodes: {}", cycles.size(),
+                m_cyclicNodes.size(), description);
+    if (notify)
+    {
+        Notifier::Add(Message(Message::Type::WARNING, "",
+                              "Pipeline has " + std::to_string(cycles.size()) +
+                                  " cycle(s), highlighted in red: " + description));
+    }
+}
+
+void NodeEditor::UpdateEdgeRoutes()
+{
+    if (!m_orthogonalEdges)
+    {
+        return;
+    }
+
+    if (std::optional<RouteWorker::Result> result = m_routeWorker.Poll())
+    {
+        for (EdgeUniqueId edgeUid : result->m_removedEdges)
+        {
+            m_edgeRoutes.erase(edgeUid);
+        }
+        for (auto& [edgeUid, route] : result->m_routes)
+        {
+            m_edgeRoutes.insert_or_assign(edgeUid, std::move(route));
+        }
+    }
+
+    // nodes moved by a layout are routed once they stop, the old routes still end on the pins
+    if (!m_layoutTransitions.empty() || m_forceLayoutRunning)
+    {
+        return;
+    }
+
+    // nodes, edges and shown ports only change with the graph revision or when unlinked ports get
+    // hidden, otherwise only moved nodes and their edges need a look
+    const bool graphChanged = m_routedNodeRects.empty() ||
+                              m_routedRevision != m_topologicalOrder.GetRevision() ||
+                              m_routedHideUnlinkedPorts != m_hideUnlinkedPorts;
+    m_routedRevision          = m_topologicalOrder.GetRevision();
+    m_routedHideUnlinkedPorts = m_hideUnlinkedPorts;
+
+    NodeSizeEstimator&        sizeEstimator = GetSizeEstimator();
+    OrthogonalRouter::Changes changes;
+    std::vector<NodeUniqueId> movedNodes;
+    for (const auto& [nodeUid, node] : m_nodes)
+    {
+        const ImVec2 pos      = ImNodes::GetNodeGridSpacePos(nodeUid);
+        auto         rectIter = m_routedNodeRects.find(nodeUid);
+        if (!graphChanged && rectIter != m_routedNodeRects.end() &&
+            rectIter->second.Min.x == pos.x && rectIter->second.Min.y == pos.y)
+        {
+            continue;
+        }
+
+        const ImVec2 size = sizeEstimator.Estimate(node, m_hideUnlinkedPorts);
+        const ImRect rect(pos, ImVec2(pos.x + size.x, pos.y + size.y));
+        if (rectIter != m_routedNodeRects.end() && rectIter->second.Min.x == rect.Min.x &&
+            rectIter->second.Min.y == rect.Min.y && rectIter->second.Max.x == rect.Max.x &&
+            rectIter->second.Max.y == rect.Max.y)
+        {
+            continue;
+        }
+        m_routedNodeRects.insert_or_assign(nodeUid, rect);
+        changes.m_nodes.emplace(nodeUid, rect);
+        movedNodes.push_back(nodeUid);
+    }
+
+    if (graphChanged)
+    {
+        for (auto iter = m_routedNodeRects.begin(); iter != m_routedNodeRects.end();)
+        {
+            if (m_nodes.contains(iter->first))
+            {
+                ++iter;
+                continue;
+            }
+            changes.m_removedNodes.push_back(iter->first);
+            iter = m_routedNodeRects.erase(iter);
+        }
+        for (auto iter = m_routedEdgeEnds.begin(); iter != m_routedEdgeEnds.end();)
+        {
+            if (m_edges.contains(iter->first))
+            {
+                ++iter;
+                continue;
+            }
+            changes.m_removedEdges.push_back(iter->first);
+            iter = m_routedEdgeEnds.erase(iter);
+        }
+        for (const auto& [edgeUid, edge] : m_edges)
+        {
+            UpdateRoutedEdge(edgeUid, edge, sizeEstimator, changes);
+        }
+    }
+    else
+    {
+        for (NodeUniqueId nodeUid : movedNodes)
+        {
+            for (EdgeUniqueId edgeUid : m_nodes.at(nodeUid).GetAllEdgeUids())
+            {
+                auto edgeIter = m_edges.find(edgeUid);
+                if (edgeIter != m_edges.end())
+                {
+                    UpdateRoutedEdge(edgeUid, edgeIter->second, sizeEstimator, changes);
+                }
+            }
+        }
+    }
+
+    if (!changes.Empty())
+    {
+        m_routeWorker.Request(std::move(changes));
+    }
+}
+
+NodeSizeEstimator& NodeEditor::GetSizeEstimator()
+{
+    // kept across frames for its cache of label widths, until the font or the styles change
+    if (!m_sizeEstimator.IsCurrent())
+    {
+        m_sizeEstimator = NodeSizeEstimator::FromCurrentStyle();
+    }
+    return m_sizeEstimator;
+}
+
+void NodeEditor::UpdateRoutedEdge(EdgeUniqueId edgeUid, const Edge& edge,
+                                  const NodeSizeEstimator& sizeEstimator,
+                                  OrthogonalRouter::Changes& changes)
+{
+    auto sourceNodeIter      = m_nodes.find(edge.GetSourceNodeUid());
+    auto destinationNodeIter = m_nodes.find(edge.GetDestinationNodeUid());
+    auto sourceRectIter      = m_routedNodeRects.find(edge.GetSourceNodeUid());
+    auto destinationRectIter = m_routedNodeRects.find(edge.GetDestinationNodeUid());
+    if (sourceNodeIter == m_nodes.end() || destinationNodeIter == m_nodes.end() ||
+        sourceRectIter == m_routedNodeRects.end() ||
+        destinationRectIter == m_routedNodeRects.end())
+    {
+        return;
+    }
+
+    const std::optional<size_t> sourceRow = GetVisiblePortRow(
+        sourceNodeIter->second.GetOutputPorts(), edge.GetSourcePortUid(), m_hideUnlinkedPorts);
+    const std::optional<size_t> destinationRow =
+        GetVisiblePortRow(destinationNodeIter->second.GetInputPorts(),
+                          edge.GetDestinationPortUid(),
+                          m_hideUnlinkedPorts);
+    if (!sourceRow || !destinationRow)
+    {
+        return;
+    }
+
+    // pins sit on the sides of the node rects, pushed out by the pin offset
+    const float   pinOffset       = ImNodes::GetStyle().PinOffset;
+    const ImRect& sourceRect      = sourceRectIter->second;
+    const ImRect& destinationRect = destinationRectIter->second;
+
+    OrthogonalRouter::EdgeEnds ends;
+    ends.m_sourceNodeUid      = edge.GetSourceNodeUid();
+    ends.m_destinationNodeUid = edge.GetDestinationNodeUid();
+    ends.m_start.x            = sourceRect.Max.x + pinOffset;
+    ends.m_start.y            = sourceRect.Min.y + sizeEstimator.GetPortRowCenterY(*sourceRow);
+    ends.m_end.x              = destinationRect.Min.x - pinOffset;
+    ends.m_end.y = destinationRect.Min.y + sizeEstimator.GetPortRowCenterY(*destinationRow);
+
+    auto endsIter = m_routedEdgeEnds.find(edgeUid);
+    if (endsIter != m_routedEdgeEnds.end() && endsIter->second == ends)
+    {
+        return;
+    }
+    m_routedEdgeEnds.insert_or_assign(edgeUid, ends);
+    changes.m_edges.insert_or_assign(edgeUid, ends);
+}
 
 void NodeEditor::HandleNodeInfoEditing()
 {
@@ -1074,8 +1766,9 @@ void NodeEditor::HandleNodeInfoEditing()
             ImGui::OpenPopup("AddNodeProperty");
             SNELOG_INFO("Add New Node Property, open popup...");
         }
-        // show node property
-        if (!popUpYamlNode.m_Properties.empty())
+        // show node property, they are decoded once the popup shows them
+        std::vector<YamlNodeProperty>& properties = popUpYamlNode.m_Properties.Decode();
+        if (!properties.empty())
         {
             if (ImGui::BeginTable("PropertiesTable", 3,
                                   ImGuiTableFlags_Resizable | ImGuiTableFlags_NoSavedSettings |
@@ -1086,26 +1779,26 @@ void NodeEditor::HandleNodeInfoEditing()
                 ImGui::TableSetupColumn("Value", ImGuiTableColumnFlags_WidthStretch);
                 ImGui::TableHeadersRow();
 
-                for (size_t i = 0; i < popUpYamlNode.m_Properties.size(); ++i)
+                for (size_t i = 0; i < properties.size(); ++i)
                 {
                     ImGui::TableNextRow();
                     ImGui::TableSetColumnIndex(0);
                     const std::string prop_name_label = std::string("##prop_name_") + std::to_string(i);
                     ImGui::SetNextItemWidth(-FLT_MIN);
                     ImGui::InputText(prop_name_label.c_str(),
-                                     &popUpYamlNode.m_Properties[i].m_propertyName,
+                                     &properties[i].m_propertyName,
                                      ImGuiInputTextFlags_CharsNoBlank);
 
                     ImGui::TableSetColumnIndex(1);
                     const std::string prop_id_label = std::string("##prop_id_") + std::to_string(i);
                     ImGui::SetNextItemWidth(-FLT_MIN);
-                    ImGui::InputInt(prop_id_label.c_str(), &popUpYamlNode.m_Properties[i].m_propertyId);
+                    ImGui::InputInt(prop_id_label.c_str(), &properties[i].m_propertyId);
 
                     ImGui::TableSetColumnIndex(2);
                     const std::string prop_value_label = std::string("##prop_val_") + std::to_string(i);
                     ImGui::SetNextItemWidth(-FLT_MIN);
                     ImGui::InputText(prop_value_label.c_str(),
-                                     &popUpYamlNode.m_Properties[i].m_propertyValue);
+                                     &properties[i].m_propertyValue);
                 }
                 ImGui::EndTable();
             }
@@ -1132,7 +1825,7 @@ void NodeEditor::HandleNodeInfoEditing()
             ImGui::PushItemWidth(50.f);
             if (ImGui::Button("Done"))
             {
-                popUpYamlNode.m_Properties.push_back(std::move(newProperty));
+                properties.push_back(std::move(newProperty));
                 ImGui::CloseCurrentPopup();
             }
             ImGui::SameLine();
@@ -1277,6 +1970,7 @@ void NodeEditor::HandleNodeInfoEditing()
                 m_nodes.at(nodeUidToBePoped)
                     .SetNodeTitle(popUpYamlNode.m_nodeName + "_" +
                                   std::to_string(popUpYamlNode.m_nodeYamlId));
+                JournalNode(m_nodes.at(nodeUidToBePoped));
                 // sync pruning rule between node and edges
                 m_pruningPolicy.SyncPruningRules(m_nodes.at(nodeUidToBePoped), m_edges);
                 if (m_pruningPolicy.ApplyCurrentPruningRule(m_nodes, m_edges))
@@ -1495,7 +2189,13 @@ void NodeEditor::HandleEdgeInfoEditing()
                 // Commit edited values back into the edge's YamlEdge
                 if (m_edges.contains(edgeUidToBePoped))
                 {
+                    // the ports may have been changed, which makes it another link to the file
+                    m_editJournal.Append(EditJournal::Entry::ForEdge(
+                        EditJournal::Entry::Type::RemoveEdge,
+                        m_edges.at(edgeUidToBePoped).GetYamlEdge()));
                     m_edges.at(edgeUidToBePoped).GetYamlEdge() = popUpYamlEdge;
+                    m_editJournal.Append(EditJournal::Entry::ForEdge(
+                        EditJournal::Entry::Type::PutEdge, popUpYamlEdge));
                 }
                 ImGui::CloseCurrentPopup();
             }
@@ -1571,6 +2271,7 @@ void NodeEditor::HandleOtherUserInputs()
         if (ImGui::IsKeyPressed(ImGuiKey_L) && io.KeyCtrl)
         {
             ClearCurrentPipeLine();
+            m_editJournal.Restart("");
         }
 
         // S : toposort
@@ -1582,36 +2283,157 @@ void NodeEditor::HandleOtherUserInputs()
 }
 
 
-bool NodeEditor::LoadPipeline(const std::string& filePath)
+void NodeEditor::LoadPipeline(const std::string& filePath)
+{
+    // the current pipeline stays until the new one is parsed, see InstallPipeline
+    m_loadingTarget = "local:" + filePath;
+    m_journalRecovery.reset();
+    m_pipelineLoader.Load(filePath);
+}
+
+void NodeEditor::LoadPipeline(std::unique_ptr<std::istream> inputStream)
+{
+    if (!inputStream)
+    {
+        SNELOG_ERROR("LoadPipeline failed, invalid input stream");
+        return;
+    }
+    m_loadingTarget = m_fileDialog.GetResultTarget();
+    m_journalRecovery.reset();
+    m_pipelineLoader.Load(std::move(inputStream), m_fileDialog.GetFileName().String());
+}
+
+void NodeEditor::HandlePipelineLoading()
 {
-    ClearCurrentPipeLine(); // TODO: refine the logic
-    if (LoadPipelineFromFile(filePath))
+    std::optional<PipelineLoader::Result> result = m_pipelineLoader.Poll();
+    if (!result && m_journalRecovery && m_journalRecovery->m_baseTarget.empty())
     {
-        SNELOG_INFO("LoadPipeLineFromFile Success, filePath[{}]", filePath);
-        return true;
+        // the recovered edits were made on a pipeline that was in no file
+        result.emplace();
+        result->m_succeeded  = true;
+        result->m_sourceName = "the recovered edits";
+    }
+    if (result)
+    {
+        // the loader thread cannot show them, the same one is shown once
+        std::unordered_set<std::string> shownDiagnostics;
+        for (const std::string& error : result->m_errors)
+        {
+            if (shownDiagnostics.insert(error).second)
+            {
+                Notifier::Add(Message(Message::Type::ERR, "", error));
+            }
+        }
+        for (const std::string& warning : result->m_warnings)
+        {
+            if (shownDiagnostics.insert(warning).second)
+            {
+                Notifier::Add(Message(Message::Type::WARNING, "", warning));
+            }
+        }
+
+        if (m_journalRecovery && result->m_succeeded)
+        {
+            EditJournal::Apply(m_journalRecovery->m_entries, result->m_pipelineName,
+                               result->m_nodes, result->m_edges);
+        }
+        if (result->m_succeeded && InstallPipeline(*result))
+        {
+            SNELOG_INFO("LoadPipeline Success, source[{}]", result->m_sourceName);
+            if (m_journalRecovery)
+            {
+                // the pruning rules are not in the file, they are set up as the user left them.
+                // The journal is kept, the recovered edits are still not saved
+                for (const EditJournal::Entry& entry : m_journalRecovery->m_entries)
+                {
+                    if (entry.m_type == EditJournal::Entry::Type::AddPruningRule)
+                    {
+                        m_pruningPolicy.AddNewPruningRule(entry.m_first, entry.m_second);
+                    }
+                    else if (entry.m_type == EditJournal::Entry::Type::ChangePruningRule)
+                    {
+                        m_pruningPolicy.ChangePruningRule(m_nodes, m_edges, entry.m_first,
+                                                          entry.m_second);
+                    }
+                }
+                Notifier::Add(Message(Message::Type::INFO, "",
+                                      "Recovered " +
+                                          std::to_string(m_journalRecovery->m_entries.size()) +
+                                          " unsaved edits"));
+            }
+            else
+            {
+                m_editJournal.Restart(m_loadingTarget);
+            }
+        }
+        else
+        {
+            SNELOG_ERROR("LoadPipeline failed, source[{}]", result->m_sourceName);
+            Notifier::Add(Message(Message::Type::ERR, "",
+                                  "Failed to load " + result->m_sourceName +
+                                      ", the current pipeline is kept"));
+            if (m_journalRecovery)
+            {
+                m_editJournal.Restart("");
+            }
+        }
+        m_journalRecovery.reset();
+    }
+
+    if (!m_pipelineLoader.IsBusy())
+    {
+        return;
+    }
+
+    const ImGuiViewport* viewport = ImGui::GetMainViewport();
+    ImGui::SetNextWindowPos(viewport->GetCenter(), ImGuiCond_Always, ImVec2(0.5f, 0.5f));
+    ImGui::SetNextWindowSize(ImVec2(400.f, 0.f), ImGuiCond_Always);
+    ImGui::Begin("Loading Pipeline", nullptr,
+                 ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoCollapse |
+                     ImGuiWindowFlags_NoSavedSettings);
+    ImGui::TextUnformatted(m_pipelineLoader.GetSourceName().c_str());
+
+    const auto [bytesRead, bytesTotal] = m_pipelineLoader.GetProgress();
+    const std::string overlay          = std::to_string(bytesRead / 1024) + " KB";
+    if (bytesTotal > 0 && bytesRead < bytesTotal)
+    {
+        ImGui::ProgressBar(std::min(1.f, static_cast<float>(bytesRead) / bytesTotal),
+                           ImVec2(-1.f, 0.f), overlay.c_str());
     }
     else
     {
-        ClearCurrentPipeLine();
-        SNELOG_ERROR("LoadPipeLineFromFile failed, filePath[{}]", filePath);
-        return false;
+        // size unknown, or all read and being parsed, keep the bar moving
+        ImGui::ProgressBar(-1.f * static_cast<float>(ImGui::GetTime()), ImVec2(-1.f, 0.f),
+                           overlay.c_str());
     }
+    if (ImGui::Button("Cancel"))
+    {
+        m_pipelineLoader.Cancel();
+    }
+    ImGui::End();
 }
 
-bool NodeEditor::LoadPipeline(std::unique_ptr<std::istream> inputStream)
+void NodeEditor::RecoverJournaledEdits()
 {
-    ClearCurrentPipeLine();
-    if (LoadPipelineFromStream(std::move(inputStream)))
+    if (!m_journalRecovery || m_journalRecovery->m_baseTarget.empty())
     {
-        SNELOG_INFO("LoadPipelineFromStream Success");
-        return true;
+        return;
     }
-    else
+    const std::string& baseTarget = m_journalRecovery->m_baseTarget;
+    if (baseTarget.starts_with("local:"))
     {
-        ClearCurrentPipeLine();
-        SNELOG_ERROR("LoadPipelineFromStream failed");
-        return false;
+        SNELOG_INFO("recovering the unsaved edits on [{}]", baseTarget);
+        m_loadingTarget = baseTarget;
+        m_pipelineLoader.Load(baseTarget.substr(std::string_view("local:").size()));
+        return;
     }
+
+    // a remote file would need a connection before the editor is even up
+    SNELOG_WARN("unsaved edits on [{}] are not recovered", baseTarget);
+    Notifier::Add(Message(Message::Type::WARNING, "",
+                          "Unsaved edits on a remote pipeline could not be recovered"));
+    m_journalRecovery.reset();
+    m_editJournal.Restart("");
 }
 
 void NodeEditor::SetNodePos(NodeUniqueId nodeUid, const ImVec2 pos)
@@ -1619,26 +2441,28 @@ void NodeEditor::SetNodePos(NodeUniqueId nodeUid, const ImVec2 pos)
     ImNodes::SetNodeScreenSpacePos(nodeUid, pos);
 }
 
-void NodeEditor::SaveToFile(std::unique_ptr<std::ostream> outputStream)
-{
-    *outputStream << m_pipelineEimtter.EmitPipeline(m_currentPipeLineName, m_nodes, m_edges);
-    outputStream->flush();
-}
-
 void NodeEditor::SaveToFile(const std::string& fileName)
 {
 
+    StoreNodePositions();
     try
     {
         std::ofstream outFile(fileName);
         if (outFile.is_open())
         {
-            outFile << m_pipelineEimtter.EmitPipeline(m_currentPipeLineName, m_nodes,
-                                                       m_pruningPolicy.GetPrunedNodes(),
-                                                       m_edges,
-                                                       m_pruningPolicy.GetPrunedEdges());
-            SNELOG_INFO("Successfully saved pipeline to: {}", fileName);
+            PipelineEmitter pipelineEmitter(outFile);
+            pipelineEmitter.EmitPipeline(m_currentPipeLineName, m_nodes,
+                                         m_pruningPolicy.GetPrunedNodes(), m_edges,
+                                         m_pruningPolicy.GetPrunedEdges(), m_linkGroups);
             outFile.close();
+            if (pipelineEmitter.GetEmitter().good() && !outFile.fail())
+            {
+                SNELOG_INFO("Successfully saved pipeline to: {}", fileName);
+            }
+            else
+            {
+                SNELOG_ERROR("Failed to save pipeline to: {}", fileName);
+            }
         }
         else
         {
@@ -1651,197 +2475,244 @@ void NodeEditor::SaveToFile(const std::string& fileName)
     }
 }
 
-// TODO: remove redundant code by combining LoadPipelineFromStream and LoadPipelineFromFile logic
-bool NodeEditor::LoadPipelineFromStream(std::unique_ptr<std::istream> inputStream)
+void NodeEditor::SaveToDialogFile()
 {
-
-    bool ret = true;
-    if (m_pipeLineParser.LoadStream(*inputStream))
-    {
-        std::vector<YamlNode> yamlNodes = m_pipeLineParser.ParseNodes();
-        std::vector<YamlEdge> yamlEdges = m_pipeLineParser.ParseEdges();
-
-        // add node in Editor
-        std::unordered_map<YamlNode::NodeYamlId, NodeUniqueId> t_yamlNodeId2NodeUidMap;
-        for (const YamlNode& yamlNode : yamlNodes)
-        {
-            if (s_nodeDescriptionsTypeDesMap.contains(yamlNode.m_nodeYamlType))
+    StoreNodePositions();
+    const std::string target = m_fileDialog.GetResultTarget();
+    const PipelineFileLayout::EmitFunction emit = [this](PipelineEmitter& pipelineEmitter)
+    { pipelineEmitter.EmitPipeline(m_currentPipeLineName, m_nodes, m_edges, m_linkGroups); };
+
+    // the file is opened in binary mode, the offsets of its entries must not shift with line ends
+    if (m_savedFileLayout.IsFor(target))
+    {
+        std::optional<PipelineFileLayout::Patch> patch = m_savedFileLayout.PlanChanges(emit);
+        if (patch)
+        {
+            const std::time_t             modifiedTime = m_fileDialog.GetResultModifiedTime();
+            const int64_t                 fileSize     = m_fileDialog.GetResultFileSize();
+            std::unique_ptr<std::istream> savedStream =
+                m_fileDialog.GetResultInStream(std::ios_base::in | std::ios_base::binary);
+            std::unique_ptr<std::ostream> outputStream = m_fileDialog.GetResultOutStream(
+                std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+            if (savedStream && outputStream &&
+                m_savedFileLayout.ApplyChanges(std::move(*patch), modifiedTime, fileSize,
+                                               *savedStream, *outputStream))
             {
-                NodeUniqueId newNodeUid =
-                    AddNewNodes(s_nodeDescriptionsTypeDesMap.at(yamlNode.m_nodeYamlType), yamlNode);
-                t_yamlNodeId2NodeUidMap.emplace(yamlNode.m_nodeYamlId, newNodeUid);
-            }
-            else
-            {
-                ret = false;
-                Notifier::Add(Message(Message::Type::ERR, "", "Invalid NodeType" + std::to_string(yamlNode.m_nodeYamlId)));
-                SNE_ASSERT(false, "Invalid NodeType" + std::to_string(yamlNode.m_nodeYamlType));
-                break;
+                // the modification time is only final once the file is closed
+                outputStream.reset();
+                m_savedFileLayout.SetModifiedTime(m_fileDialog.GetResultModifiedTime());
+                m_editJournal.Restart(target);
+                return;
             }
         }
-
-        if (ret)
-        {
-            // add edges in editor
-            for (const YamlEdge& yamlEdge : yamlEdges)
-            {
-                NodeUniqueId ownedBySrcNodeUid =
-                    t_yamlNodeId2NodeUidMap.at(yamlEdge.m_yamlSrcPort.m_nodeYamlId);
-                NodeUniqueId ownedByDstNodeUid =
-                    t_yamlNodeId2NodeUidMap.at(yamlEdge.m_yamlDstPort.m_nodeYamlId);
-                const Node& srcNode = m_nodes.at(ownedBySrcNodeUid);
-                const Node& dstNode = m_nodes.at(ownedByDstNodeUid);
-                AddNewEdge(srcNode.FindPortUidAmongOutports(yamlEdge.m_yamlSrcPort.m_portYamlId),
-                        dstNode.FindPortUidAmongInports(yamlEdge.m_yamlDstPort.m_portYamlId),
-                        yamlEdge,
-                        false /*avoidMultipleInputLinks*/); // allow multiple edges there, multiple
-            }
-
-            m_pruningPolicy.CollectPruningRules(yamlNodes, yamlEdges);
-
-            if (m_pruningPolicy.ApplyCurrentPruningRule(m_nodes, m_edges))
-            {
-                for (const auto& [group, type] : m_pruningPolicy.GetCurrentPruningRule())
-                {
-                    SNELOG_INFO(
-                        "current pruning rule is : group[{}] type[{}], any node or edge that matches "
-                        "the "
-                        "group but not matches the type will be removed",
-                        group, type);
-                }
-            }
-            else
-            {
-                SNELOG_ERROR("ApplyPruningRule Fail!!");
-            }
-
-            m_needTopoSort        = true;
-
-            m_currentPipeLineName = m_pipeLineParser.GetPipelineName();
-            }
     }
-    else
+
+    std::unique_ptr<std::ostream> outputStream =
+        m_fileDialog.GetResultOutStream(std::ios_base::trunc | std::ios_base::binary);
+    if (!outputStream || !m_savedFileLayout.WriteAll(target, *outputStream, emit))
     {
-        SNELOG_ERROR("pipelineparser loadfile failed, , check it!");
-        ret = false;
+        Notifier::Add(Message(Message::Type::ERR, "", "Failed to save pipeline"));
+        return;
     }
-    return ret;
+    outputStream.reset();
+    m_savedFileLayout.SetModifiedTime(m_fileDialog.GetResultModifiedTime());
+    m_editJournal.Restart(target);
 }
 
-bool NodeEditor::LoadPipelineFromFile(const std::string& filePath)
+bool NodeEditor::InstallPipeline(const PipelineLoader::Result& result)
 {
-    bool ret = true;
+    const std::vector<YamlNode>& yamlNodes = result.m_nodes;
+    const std::vector<YamlEdge>& yamlEdges = result.m_edges;
 
-    if (m_pipeLineParser.LoadFile(filePath))
+    // check everything first, a pipeline that cannot be installed leaves the current one as it is
+    std::unordered_set<YamlNode::NodeYamlId> yamlNodeIds;
+    for (const YamlNode& yamlNode : yamlNodes)
     {
-        std::vector<YamlNode> yamlNodes = m_pipeLineParser.ParseNodes();
-        std::vector<YamlEdge> yamlEdges = m_pipeLineParser.ParseEdges();
-
-        // add node in Editor
-        std::unordered_map<YamlNode::NodeYamlId, NodeUniqueId> t_yamlNodeId2NodeUidMap;
-        for (const YamlNode& yamlNode : yamlNodes)
+        if (!s_nodeDescriptionsTypeDesMap.contains(yamlNode.m_nodeYamlType))
         {
-            if (s_nodeDescriptionsTypeDesMap.contains(yamlNode.m_nodeYamlType))
-            {
-                NodeUniqueId newNodeUid =
-                    AddNewNodes(s_nodeDescriptionsTypeDesMap.at(yamlNode.m_nodeYamlType), yamlNode);
-                t_yamlNodeId2NodeUidMap.emplace(yamlNode.m_nodeYamlId, newNodeUid);
-            }
-            else
-            {
-                ret = false;
-                Notifier::Add(Message(Message::Type::ERR, "", "Invalid NodeType" + std::to_string(yamlNode.m_nodeYamlId)));
-                SNE_ASSERT(false, "Invalid NodeType" + std::to_string(yamlNode.m_nodeYamlType));
-                break;
-            }
+            Notifier::Add(Message(Message::Type::ERR, "", "Invalid NodeType" + std::to_string(yamlNode.m_nodeYamlId)));
+            SNELOG_ERROR("Invalid NodeType [{}] of node [{}]", yamlNode.m_nodeYamlType,
+                         yamlNode.m_nodeYamlId);
+            return false;
         }
-
-        if (ret)
+        yamlNodeIds.insert(yamlNode.m_nodeYamlId);
+    }
+    for (const YamlEdge& yamlEdge : yamlEdges)
+    {
+        if (!yamlNodeIds.contains(yamlEdge.m_yamlSrcPort.m_nodeYamlId) ||
+            !yamlNodeIds.contains(yamlEdge.m_yamlDstPort.m_nodeYamlId))
         {
-            // add edges in editor
-            for (const YamlEdge& yamlEdge : yamlEdges)
-            {
-                NodeUniqueId ownedBySrcNodeUid =
-                    t_yamlNodeId2NodeUidMap.at(yamlEdge.m_yamlSrcPort.m_nodeYamlId);
-                NodeUniqueId ownedByDstNodeUid =
-                    t_yamlNodeId2NodeUidMap.at(yamlEdge.m_yamlDstPort.m_nodeYamlId);
-                const Node& srcNode = m_nodes.at(ownedBySrcNodeUid);
-                const Node& dstNode = m_nodes.at(ownedByDstNodeUid);
-                AddNewEdge(srcNode.FindPortUidAmongOutports(yamlEdge.m_yamlSrcPort.m_portYamlId),
-                        dstNode.FindPortUidAmongInports(yamlEdge.m_yamlDstPort.m_portYamlId),
-                        yamlEdge,
-                        false /*avoidMultipleInputLinks*/); // allow multiple edges there, multiple
-                // inportEdges will be pruned later
-            }
+            Notifier::Add(Message(Message::Type::ERR, "", "Invalid Link between nodes " +
+                                      std::to_string(yamlEdge.m_yamlSrcPort.m_nodeYamlId) + " and " +
+                                      std::to_string(yamlEdge.m_yamlDstPort.m_nodeYamlId)));
+            SNELOG_ERROR("Link from node [{}] to node [{}] refers to a node that does not exist",
+                         yamlEdge.m_yamlSrcPort.m_nodeYamlId, yamlEdge.m_yamlDstPort.m_nodeYamlId);
+            return false;
+        }
+    }
 
-            // collect pruning rules to m_allPruningRules
-            m_pruningPolicy.CollectPruningRules(yamlNodes, yamlEdges);
+    ClearCurrentPipeLine();
+    // the file saved to last may have been changed by whatever wrote the loaded one
+    m_savedFileLayout.Reset();
 
-            if (m_pruningPolicy.ApplyCurrentPruningRule(m_nodes, m_edges))
-            {
-                for (const auto& [group, type] : m_pruningPolicy.GetCurrentPruningRule())
-                {
-                    SNELOG_INFO(
-                        "current pruning rule is : group[{}] type[{}], any node or edge that matches "
-                        "the "
-                        "group but not matches the type will be removed",
-                        group, type);
-                }
-            }
-            else
-            {
-                SNELOG_ERROR("ApplyPruningRule Fail!!");
-            }
+    // the order is rebuilt once all nodes and edges are in, rather than edge by edge
+    m_topologicalOrder.BeginBatchUpdate();
 
-            m_needTopoSort        = true;
+    // add node in Editor
+    std::unordered_map<YamlNode::NodeYamlId, NodeUniqueId> t_yamlNodeId2NodeUidMap;
+    for (const YamlNode& yamlNode : yamlNodes)
+    {
+        NodeUniqueId newNodeUid =
+            AddNewNodes(s_nodeDescriptionsTypeDesMap.at(yamlNode.m_nodeYamlType), yamlNode);
+        t_yamlNodeId2NodeUidMap.emplace(yamlNode.m_nodeYamlId, newNodeUid);
+    }
 
-            m_currentPipeLineName = m_pipeLineParser.GetPipelineName();
+    // add edges in editor
+    for (const YamlEdge& yamlEdge : yamlEdges)
+    {
+        NodeUniqueId ownedBySrcNodeUid =
+            t_yamlNodeId2NodeUidMap.at(yamlEdge.m_yamlSrcPort.m_nodeYamlId);
+        NodeUniqueId ownedByDstNodeUid =
+            t_yamlNodeId2NodeUidMap.at(yamlEdge.m_yamlDstPort.m_nodeYamlId);
+        const Node& srcNode = m_nodes.at(ownedBySrcNodeUid);
+        const Node& dstNode = m_nodes.at(ownedByDstNodeUid);
+        AddNewEdge(srcNode.FindPortUidAmongOutports(yamlEdge.m_yamlSrcPort.m_portYamlId),
+                   dstNode.FindPortUidAmongInports(yamlEdge.m_yamlDstPort.m_portYamlId), yamlEdge,
+                   false /*avoidMultipleInputLinks*/); // allow multiple edges there, multiple
+        // inportEdges will be pruned later
+    }
+
+    // collect pruning rules to m_allPruningRules
+    m_pruningPolicy.CollectPruningRules(yamlNodes, yamlEdges);
+
+    if (m_pruningPolicy.ApplyCurrentPruningRule(m_nodes, m_edges))
+    {
+        for (const auto& [group, type] : m_pruningPolicy.GetCurrentPruningRule())
+        {
+            SNELOG_INFO(
+                "current pruning rule is : group[{}] type[{}], any node or edge that matches "
+                "the "
+                "group but not matches the type will be removed",
+                group, type);
         }
     }
     else
     {
-        SNELOG_ERROR("pipelineparser loadfile failed, filename is [{}], check it!", filePath);
-        ret = false;
+        SNELOG_ERROR("ApplyPruningRule Fail!!");
     }
-    return ret;
+
+    // pipelines saved by the editor carry node positions, no need to lay them out again
+    m_needTopoSort = !ApplySavedNodePositions(yamlNodes, t_yamlNodeId2NodeUidMap);
+
+    m_currentPipeLineName = result.m_pipelineName;
+
+    m_topologicalOrder.EndBatchUpdate(m_nodes, m_edges);
+    // a loaded pipeline is either laid out from scratch or placed where it was saved
+    m_editedNodes.clear();
+    UpdateCyclicNodes(true);
+    return true;
 }
 
 void NodeEditor::ClearCurrentPipeLine()
 {
     m_nodes.clear();
     m_edges.clear();
+    m_linkGroups.Clear();
     m_inportPorts.clear();
     m_outportPorts.clear();
     m_pruningPolicy.Clear();
+    m_topologicalOrder.Clear();
+    m_layoutWorker.Cancel();
+    m_layoutTransitions.clear();
+    m_forceLayoutRunning = false;
+    m_forceLayoutPositions.clear();
+    m_pinnedNodes.clear();
+    m_editedNodes.clear();
+    m_cyclicNodes.clear();
+    m_cyclesDirty = false;
     m_commandQueue.Clear();
     m_portUidGenerator.Clear();
     m_nodeUidGenerator.Clear();
     m_edgeUidGenerator.Clear();
-    m_pipeLineParser.Clear();
-    m_pipelineEimtter.Clear();
 }
 
 void NodeEditor::ExecuteCommand(std::unique_ptr<ICommand> cmd)
 {
+    m_journalingCommand = true;
     m_commandQueue.AddAndExecuteCommad(std::move(cmd));
+    JournalTouchedRecords();
     SPDLOG_INFO("ExecuteCommand done, commandqueue info: \n {}", m_commandQueue.ToString());
 }
 
 
 bool NodeEditor::Undo()
 {
+    m_journalingCommand = true;
     bool ret = m_commandQueue.Undo();
+    JournalTouchedRecords();
     SPDLOG_INFO("UndoCommand done, commandqueue info: \n {}", m_commandQueue.ToString());
     return ret; 
 }
 
 bool NodeEditor::Redo()
 {
+    m_journalingCommand = true;
     bool ret = m_commandQueue.Redo();
+    JournalTouchedRecords();
     SPDLOG_INFO("ReodCommand done, commandqueue info: \n {}", m_commandQueue.ToString());
     return ret;
 }
 
+void NodeEditor::JournalTouchedRecords()
+{
+    m_journalingCommand = false;
+    // a record removed again by the same command was journaled as removed already
+    for (NodeUniqueId nodeUid : m_journalNodes)
+    {
+        if (auto iter = m_nodes.find(nodeUid); iter != m_nodes.end())
+        {
+            JournalNode(iter->second);
+        }
+        else if (auto prunedIter = m_pruningPolicy.GetPrunedNodes().find(nodeUid);
+                 prunedIter != m_pruningPolicy.GetPrunedNodes().end())
+        {
+            JournalNode(prunedIter->second);
+        }
+    }
+    for (EdgeUniqueId edgeUid : m_journalEdges)
+    {
+        const Edge* edge = nullptr;
+        if (auto iter = m_edges.find(edgeUid); iter != m_edges.end())
+        {
+            edge = &iter->second;
+        }
+        else if (auto prunedIter = m_pruningPolicy.GetPrunedEdges().find(edgeUid);
+                 prunedIter != m_pruningPolicy.GetPrunedEdges().end())
+        {
+            edge = &prunedIter->second;
+        }
+        if (edge)
+        {
+            m_editJournal.Append(EditJournal::Entry::ForEdge(EditJournal::Entry::Type::PutEdge,
+                                                             edge->GetYamlEdge()));
+        }
+    }
+    m_journalNodes.clear();
+    m_journalEdges.clear();
+}
+
+void NodeEditor::JournalNode(const Node& node)
+{
+    EditJournal::Entry entry =
+        EditJournal::Entry::ForNode(EditJournal::Entry::Type::PutNode, node.GetYamlNode());
+    // a node not shown yet keeps the position it came with
+    if (ImNodes::IsNodeKnown(node.GetNodeUniqueId()))
+    {
+        const ImVec2 pos        = ImNodes::GetNodeGridSpacePos(node.GetNodeUniqueId());
+        entry.m_node.m_position = YamlNodePosition{pos.x, pos.y};
+    }
+    m_editJournal.Append(entry);
+}
 
 void NodeEditor::RestoreEdge(const Edge& edgeSnapshot)
 {
@@ -1859,12 +2730,24 @@ void NodeEditor::RestoreEdge(const Edge& edgeSnapshot)
         return;
     }
     
+    // the edge was there before, it may close a cycle that came with a loaded pipeline
+    if (!m_topologicalOrder.RestoreEdge(edgeSnapshot.GetSourceNodeUid(),
+                                        edgeSnapshot.GetDestinationNodeUid()))
+    {
+        m_cyclesDirty = true;
+    }
+
     OutputPort* startPort = startPortIt->second;
     InputPort* endPort = endPortIt->second;
     startPort->PushEdge(edgeUid);
     endPort->SetEdgeUid(edgeUid);
     
     m_edges.emplace(edgeUid, edgeSnapshot);
+    m_linkGroups.AddEdge(startPortUid, edgeUid);
+    if (m_journalingCommand)
+    {
+        m_journalEdges.insert(edgeUid);
+    }
     
     m_edgeUidGenerator.RegisterUniqueID(edgeUid);
 }
@@ -1883,6 +2766,12 @@ NodeUniqueId NodeEditor::RestoreNode(const Node& nodeSnapShot)
         return -1;
     }
 
+    m_topologicalOrder.AddNode(nodeUid);
+    if (m_journalingCommand)
+    {
+        m_journalNodes.insert(nodeUid);
+    }
+
     Node& restoredNode = m_nodes.at(nodeUid);
     auto& inputPorts = restoredNode.GetInputPorts();
     for (InputPort& port : inputPorts)
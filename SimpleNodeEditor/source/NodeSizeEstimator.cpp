@@ -0,0 +1,162 @@
+#include "NodeSizeEstimator.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <imnodes.h>
+
+namespace SimpleNodeEditor
+{
+
+// ImGui's default font is 13 pixels high with 7 pixels wide glyphs
+static constexpr float s_monospaceFontSize = 13.f;
+static constexpr float s_monospaceAdvance  = 7.f;
+
+NodeSizeEstimator::NodeSizeEstimator()
+    : m_metrics(),
+      m_textWidth(
+          [fontSize = m_metrics.m_fontSize](std::string_view text)
+          {
+              // divided last, 7/13 has no exact float and would round whole widths up a pixel
+              return std::ceil(static_cast<float>(text.size()) * fontSize * s_monospaceAdvance /
+                               s_monospaceFontSize);
+          }),
+      m_font(nullptr),
+      m_labelWidths()
+{
+}
+
+NodeSizeEstimator::NodeSizeEstimator(const Metrics& metrics, TextWidthFunction textWidth)
+    : m_metrics(metrics), m_textWidth(std::move(textWidth)), m_font(nullptr), m_labelWidths()
+{
+}
+
+NodeSizeEstimator NodeSizeEstimator::FromCurrentStyle()
+{
+    ImFont* font = ImGui::GetFont();
+    if (font == nullptr)
+    {
+        // no frame has started yet
+        return NodeSizeEstimator();
+    }
+
+    Metrics metrics;
+    metrics.m_fontSize    = ImGui::GetFontSize();
+    metrics.m_itemSpacing = ImGui::GetStyle().ItemSpacing;
+    metrics.m_nodePadding = ImNodes::GetStyle().NodePadding;
+
+    // same rounding as ImGui::CalcTextSize
+    NodeSizeEstimator estimator(metrics,
+                                [font, fontSize = metrics.m_fontSize](std::string_view text)
+                                {
+                                    const ImVec2 size =
+                                        font->CalcTextSizeA(fontSize, FLT_MAX, 0.f, text.data(),
+                                                            text.data() + text.size());
+                                    return std::floor(size.x + 0.99999f);
+                                });
+    estimator.m_font = font;
+    return estimator;
+}
+
+bool NodeSizeEstimator::IsCurrent() const
+{
+    const ImFont* font = ImGui::GetFont();
+    if (font == nullptr || font != m_font)
+    {
+        // an estimator with default metrics stays good until a font shows up
+        return font == m_font;
+    }
+    const ImVec2 itemSpacing = ImGui::GetStyle().ItemSpacing;
+    const ImVec2 nodePadding = ImNodes::GetStyle().NodePadding;
+    return ImGui::GetFontSize() == m_metrics.m_fontSize &&
+           itemSpacing.x == m_metrics.m_itemSpacing.x &&
+           itemSpacing.y == m_metrics.m_itemSpacing.y &&
+           nodePadding.x == m_metrics.m_nodePadding.x && nodePadding.y == m_metrics.m_nodePadding.y;
+}
+
+float NodeSizeEstimator::LabelWidth(std::string_view label)
+{
+    auto iter = m_labelWidths.find(label);
+    if (iter == m_labelWidths.end())
+    {
+        iter = m_labelWidths.emplace(std::string(label), m_textWidth(label)).first;
+    }
+    return iter->second;
+}
+
+ImVec2 NodeSizeEstimator::Estimate(std::string_view                     title,
+                                   const std::vector<std::string_view>& inputLabels,
+                                   const std::vector<std::string_view>& outputLabels)
+{
+    const float  lineHeight = m_metrics.m_fontSize;
+    const ImVec2 padding    = m_metrics.m_nodePadding;
+
+    float maxInLabelWidth = 0.f;
+    for (std::string_view label : inputLabels)
+    {
+        maxInLabelWidth = std::max(maxInLabelWidth, LabelWidth(label));
+    }
+    float maxOutLabelWidth = 0.f;
+    for (std::string_view label : outputLabels)
+    {
+        maxOutLabelWidth = std::max(maxOutLabelWidth, LabelWidth(label));
+    }
+
+    // the title is not cached, it is unique to the node
+    const float  titleWidth = m_textWidth(title);
+    const size_t rows       = std::max(inputLabels.size(), outputLabels.size());
+
+    float contentWidth  = 0.f;
+    float contentHeight = 0.f;
+    if (rows != 0)
+    {
+        contentWidth  = maxInLabelWidth + s_portColumnGap + maxOutLabelWidth;
+        contentHeight = rows * lineHeight + (rows - 1) * m_metrics.m_itemSpacing.y;
+    }
+
+    // the title bar is padded on both sides, the content starts one more padding below it, and the
+    // whole node is padded once more by ImNodes
+    return ImVec2(std::max(titleWidth, contentWidth) + 2.f * padding.x,
+                  lineHeight + 4.f * padding.y + contentHeight);
+}
+
+float NodeSizeEstimator::GetPortRowCenterY(size_t row) const
+{
+    // below the title bar and the padding under it, pins are centered on their label
+    const float lineHeight = m_metrics.m_fontSize;
+    return lineHeight + 3.f * m_metrics.m_nodePadding.y +
+           row * (lineHeight + m_metrics.m_itemSpacing.y) + 0.5f * lineHeight;
+}
+
+ImVec2 NodeSizeEstimator::Estimate(const Node& node, bool hideUnlinkedPorts)
+{
+    std::vector<std::string_view> inputLabels;
+    std::vector<std::string_view> outputLabels;
+    inputLabels.reserve(node.GetInputPorts().size());
+    outputLabels.reserve(node.GetOutputPorts().size());
+    for (const InputPort& inPort : node.GetInputPorts())
+    {
+        if (!hideUnlinkedPorts || !inPort.HasNoEdgeLinked())
+        {
+            inputLabels.push_back(inPort.GetPortname());
+        }
+    }
+    for (const OutputPort& outPort : node.GetOutputPorts())
+    {
+        if (!hideUnlinkedPorts || !outPort.HasNoEdgeLinked())
+        {
+            outputLabels.push_back(outPort.GetPortname());
+        }
+    }
+    return Estimate(node.GetNodeTitle(), inputLabels, outputLabels);
+}
+
+ImVec2 NodeSizeEstimator::Estimate(const NodeDescription& nodeDesc, std::string_view title)
+{
+    std::vector<std::string_view> inputLabels(nodeDesc.m_inputPortNames.begin(),
+                                              nodeDesc.m_inputPortNames.end());
+    std::vector<std::string_view> outputLabels(nodeDesc.m_outputPortNames.begin(),
+                                               nodeDesc.m_outputPortNames.end());
+    return Estimate(title, inputLabels, outputLabels);
+}
+
+} // namespace SimpleNodeEditor
@@ -0,0 +1,490 @@
+#include "OrthogonalRouter.hpp"
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <limits>
+#include <thread>
+
+namespace SimpleNodeEditor
+{
+
+// moves on the grid, a route starts and ends going east
+static constexpr int s_east     = 0;
+static constexpr int s_stepX[4] = {1, 0, -1, 0};
+static constexpr int s_stepY[4] = {0, 1, 0, -1};
+
+// cells added around the grid when it grows, so that dragging a node past its border does not
+// reallocate it every frame
+static constexpr int s_gridSlack = 64;
+
+bool OrthogonalRouter::EdgeEnds::operator==(const EdgeEnds& other) const
+{
+    return m_sourceNodeUid == other.m_sourceNodeUid &&
+           m_destinationNodeUid == other.m_destinationNodeUid && m_start.x == other.m_start.x &&
+           m_start.y == other.m_start.y && m_end.x == other.m_end.x && m_end.y == other.m_end.y;
+}
+
+bool OrthogonalRouter::Changes::Empty() const
+{
+    return m_nodes.empty() && m_removedNodes.empty() && m_edges.empty() && m_removedEdges.empty();
+}
+
+void OrthogonalRouter::Changes::Merge(Changes&& later)
+{
+    // Apply() removes before it adds, so an object removed then added again ends up added
+    for (NodeUniqueId nodeUid : later.m_removedNodes)
+    {
+        m_nodes.erase(nodeUid);
+        m_removedNodes.push_back(nodeUid);
+    }
+    for (auto& [nodeUid, rect] : later.m_nodes)
+    {
+        m_nodes.insert_or_assign(nodeUid, rect);
+    }
+    for (EdgeUniqueId edgeUid : later.m_removedEdges)
+    {
+        m_edges.erase(edgeUid);
+        m_removedEdges.push_back(edgeUid);
+    }
+    for (auto& [edgeUid, ends] : later.m_edges)
+    {
+        m_edges.insert_or_assign(edgeUid, ends);
+    }
+}
+
+OrthogonalRouter::OrthogonalRouter(const Options& options) : m_options(options) {}
+
+std::vector<EdgeUniqueId> OrthogonalRouter::Apply(const Changes& changes)
+{
+    for (EdgeUniqueId edgeUid : changes.m_removedEdges)
+    {
+        m_routes.erase(edgeUid);
+    }
+    for (NodeUniqueId nodeUid : changes.m_removedNodes)
+    {
+        auto iter = m_nodeRects.find(nodeUid);
+        if (iter != m_nodeRects.end())
+        {
+            Stamp(iter->second, -1);
+            m_nodeRects.erase(iter);
+        }
+    }
+
+    // places the changed nodes moved to, routes going through them need to go around now
+    std::vector<ImRect> enteredRects;
+    ImRect              enteredBounds(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (const auto& [nodeUid, rect] : changes.m_nodes)
+    {
+        auto iter = m_nodeRects.find(nodeUid);
+        if (iter != m_nodeRects.end())
+        {
+            const ImRect& old = iter->second;
+            if (old.Min.x == rect.Min.x && old.Min.y == rect.Min.y && old.Max.x == rect.Max.x &&
+                old.Max.y == rect.Max.y)
+            {
+                continue;
+            }
+            Stamp(iter->second, -1);
+            iter->second = rect;
+        }
+        else
+        {
+            m_nodeRects.emplace(nodeUid, rect);
+        }
+        Stamp(rect, 1);
+        enteredRects.push_back(Inflate(rect));
+        enteredBounds.Add(enteredRects.back());
+    }
+
+    std::vector<EdgeUniqueId> reroutedEdges;
+    for (const auto& [edgeUid, ends] : changes.m_edges)
+    {
+        Route& route = m_routes[edgeUid];
+        if (!route.m_points.empty() && route.m_ends == ends)
+        {
+            continue;
+        }
+        route.m_ends = ends;
+        route.m_points.clear();
+        reroutedEdges.push_back(edgeUid);
+    }
+
+    if (!enteredRects.empty())
+    {
+        for (auto& [edgeUid, route] : m_routes)
+        {
+            if (route.m_points.empty() || !route.m_bounds.Overlaps(enteredBounds))
+            {
+                continue;
+            }
+
+            bool blocked = false;
+            for (size_t i = 1; i < route.m_points.size() && !blocked; ++i)
+            {
+                // segments are horizontal or vertical, so their bounding box is the segment itself
+                const ImVec2 from = route.m_points[i - 1];
+                const ImVec2 to   = route.m_points[i];
+                const ImRect segment(ImMin(from, to), ImMax(from, to));
+                for (const ImRect& rect : enteredRects)
+                {
+                    if (rect.Overlaps(segment))
+                    {
+                        blocked = true;
+                        break;
+                    }
+                }
+            }
+            if (blocked)
+            {
+                route.m_points.clear();
+                reroutedEdges.push_back(edgeUid);
+            }
+        }
+    }
+
+    // every search only reads the grid and writes the route of its own edge, which already
+    // exists in m_routes, so ranges of edges can be routed in parallel
+    const size_t edgeCount = reroutedEdges.size();
+    const size_t threadCount =
+        edgeCount < m_options.m_parallelThreshold
+            ? 1
+            : std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), edgeCount);
+    if (m_buffers.size() < threadCount)
+    {
+        m_buffers.resize(threadCount);
+    }
+    if (threadCount <= 1)
+    {
+        RouteEdges(reroutedEdges, 0, edgeCount, m_buffers[0]);
+    }
+    else
+    {
+        std::vector<std::future<void>> partials;
+        const size_t                   chunk = (edgeCount + threadCount - 1) / threadCount;
+        for (size_t begin = 0, thread = 0; begin < edgeCount; begin += chunk, ++thread)
+        {
+            const size_t end = std::min(begin + chunk, edgeCount);
+            partials.push_back(std::async(
+                std::launch::async,
+                [this, &reroutedEdges, begin, end, thread]()
+                { RouteEdges(reroutedEdges, begin, end, m_buffers[thread]); }));
+        }
+        for (auto& partial : partials)
+        {
+            partial.get();
+        }
+    }
+    return reroutedEdges;
+}
+
+void OrthogonalRouter::Clear()
+{
+    m_nodeRects.clear();
+    m_routes.clear();
+    m_occupancy.clear();
+    m_gridCells = CellBox();
+}
+
+const std::vector<ImVec2>* OrthogonalRouter::GetRoute(EdgeUniqueId edgeUid) const
+{
+    auto iter = m_routes.find(edgeUid);
+    if (iter == m_routes.end() || iter->second.m_points.empty())
+    {
+        return nullptr;
+    }
+    return &iter->second.m_points;
+}
+
+ImRect OrthogonalRouter::Inflate(const ImRect& rect) const
+{
+    ImRect inflated = rect;
+    inflated.Expand(m_options.m_clearance);
+    return inflated;
+}
+
+OrthogonalRouter::CellBox OrthogonalRouter::CellsOf(const ImRect& rect) const
+{
+    const float cellSize = m_options.m_cellSize;
+    CellBox     cells;
+    cells.m_minX = static_cast<int>(std::floor(rect.Min.x / cellSize));
+    cells.m_minY = static_cast<int>(std::floor(rect.Min.y / cellSize));
+    cells.m_maxX = static_cast<int>(std::floor(rect.Max.x / cellSize));
+    cells.m_maxY = static_cast<int>(std::floor(rect.Max.y / cellSize));
+    return cells;
+}
+
+void OrthogonalRouter::Stamp(const ImRect& rect, int delta)
+{
+    const CellBox cells = CellsOf(Inflate(rect));
+    if (delta > 0)
+    {
+        GrowGrid(cells);
+    }
+
+    const int columns = m_gridCells.m_maxX - m_gridCells.m_minX + 1;
+    for (int y = cells.m_minY; y <= cells.m_maxY; ++y)
+    {
+        uint16_t* row = m_occupancy.data() + static_cast<size_t>(y - m_gridCells.m_minY) * columns;
+        for (int x = cells.m_minX - m_gridCells.m_minX; x <= cells.m_maxX - m_gridCells.m_minX; ++x)
+        {
+            row[x] = static_cast<uint16_t>(row[x] + delta);
+        }
+    }
+}
+
+void OrthogonalRouter::GrowGrid(const CellBox& cells)
+{
+    const CellBox& old = m_gridCells;
+    const bool     empty = old.m_maxX < old.m_minX;
+    if (!empty && cells.m_minX >= old.m_minX && cells.m_minY >= old.m_minY &&
+        cells.m_maxX <= old.m_maxX && cells.m_maxY <= old.m_maxY)
+    {
+        return;
+    }
+
+    CellBox grown;
+    grown.m_minX = (empty ? cells.m_minX : std::min(cells.m_minX, old.m_minX)) - s_gridSlack;
+    grown.m_minY = (empty ? cells.m_minY : std::min(cells.m_minY, old.m_minY)) - s_gridSlack;
+    grown.m_maxX = (empty ? cells.m_maxX : std::max(cells.m_maxX, old.m_maxX)) + s_gridSlack;
+    grown.m_maxY = (empty ? cells.m_maxY : std::max(cells.m_maxY, old.m_maxY)) + s_gridSlack;
+
+    const int             columns = grown.m_maxX - grown.m_minX + 1;
+    std::vector<uint16_t> occupancy(static_cast<size_t>(columns) * (grown.m_maxY - grown.m_minY + 1),
+                                    0);
+    if (!empty)
+    {
+        const int oldColumns = old.m_maxX - old.m_minX + 1;
+        for (int y = old.m_minY; y <= old.m_maxY; ++y)
+        {
+            std::copy_n(m_occupancy.data() + static_cast<size_t>(y - old.m_minY) * oldColumns,
+                        oldColumns,
+                        occupancy.data() + static_cast<size_t>(y - grown.m_minY) * columns +
+                            (old.m_minX - grown.m_minX));
+        }
+    }
+    m_occupancy = std::move(occupancy);
+    m_gridCells = grown;
+}
+
+int OrthogonalRouter::Occupancy(int cellX, int cellY) const
+{
+    if (cellX < m_gridCells.m_minX || cellX > m_gridCells.m_maxX || cellY < m_gridCells.m_minY ||
+        cellY > m_gridCells.m_maxY)
+    {
+        return 0;
+    }
+    const int columns = m_gridCells.m_maxX - m_gridCells.m_minX + 1;
+    return m_occupancy[static_cast<size_t>(cellY - m_gridCells.m_minY) * columns +
+                       (cellX - m_gridCells.m_minX)];
+}
+
+void OrthogonalRouter::RouteEdges(const std::vector<EdgeUniqueId>& edgeUids, size_t begin,
+                                  size_t end, SearchBuffers& buffers)
+{
+    for (size_t i = begin; i < end; ++i)
+    {
+        Route& route   = m_routes.find(edgeUids[i])->second;
+        route.m_points = FindRoute(route.m_ends, buffers);
+
+        route.m_bounds = ImRect(route.m_points.front(), route.m_points.front());
+        for (const ImVec2& point : route.m_points)
+        {
+            route.m_bounds.Add(point);
+        }
+    }
+}
+
+std::vector<ImVec2> OrthogonalRouter::FindRoute(const EdgeEnds& ends, SearchBuffers& buffers) const
+{
+    const float  cellSize = m_options.m_cellSize;
+    const ImVec2 start(ends.m_start.x + m_options.m_stubLength, ends.m_start.y);
+    const ImVec2 end(ends.m_end.x - m_options.m_stubLength, ends.m_end.y);
+    const int    startX = static_cast<int>(std::floor(start.x / cellSize));
+    const int    startY = static_cast<int>(std::floor(start.y / cellSize));
+    const int    goalX  = static_cast<int>(std::floor(end.x / cellSize));
+    const int    goalY  = static_cast<int>(std::floor(end.y / cellSize));
+
+    // the search stays in a window around the ends, obstacles are only expensive so a route
+    // always exists in it
+    const int    margin = m_options.m_searchMargin;
+    const int    minX   = std::min(startX, goalX) - margin;
+    const int    minY   = std::min(startY, goalY) - margin;
+    const int    width  = std::abs(startX - goalX) + 2 * margin + 1;
+    const int    height = std::abs(startY - goalY) + 2 * margin + 1;
+    const size_t cellCount  = static_cast<size_t>(width) * height;
+    const size_t stateCount = cellCount * 4;
+    if (cellCount > m_options.m_maxSearchCells)
+    {
+        // too far apart to search, three segments through the middle
+        if (start.x <= end.x)
+        {
+            const float middleX = 0.5f * (start.x + end.x);
+            return {start, ImVec2(middleX, start.y), ImVec2(middleX, end.y), end};
+        }
+        const float middleY = 0.5f * (start.y + end.y);
+        return {start, ImVec2(start.x, middleY), ImVec2(end.x, middleY), end};
+    }
+
+    if (buffers.m_visit.size() < stateCount)
+    {
+        buffers.m_visit.resize(stateCount, 0);
+        buffers.m_cost.resize(stateCount);
+        buffers.m_parent.resize(stateCount);
+    }
+    if (++buffers.m_searchId == 0)
+    {
+        std::fill(buffers.m_visit.begin(), buffers.m_visit.end(), 0);
+        buffers.m_searchId = 1;
+    }
+    const uint32_t searchId = buffers.m_searchId;
+
+    const auto stateOf = [minX, minY, width](int x, int y, int direction)
+    { return ((y - minY) * width + (x - minX)) * 4 + direction; };
+
+    // distance to the goal plus the turns still needed to enter it going east, never more than
+    // the real cost
+    const int  bendCost = m_options.m_bendCost;
+    const auto estimate = [goalX, goalY, bendCost](int x, int y, int direction)
+    {
+        const int dx    = goalX - x;
+        const int dy    = goalY - y;
+        int       bends = 0;
+        if (direction == s_east)
+        {
+            bends = dy != 0 ? 2 : (dx < 0 ? 4 : 0);
+        }
+        else if (s_stepX[direction] == 0)
+        {
+            bends = (dx > 0 && dy * s_stepY[direction] >= 0) ? 1 : 3;
+        }
+        else
+        {
+            bends = 2;
+        }
+        return std::abs(dx) + std::abs(dy) + bends * bendCost;
+    };
+
+    // among states of the same score, the closest to the goal and then the last pushed go first,
+    // which follows one route down instead of spreading over all the equally good ones
+    const auto later = [](const OpenState& lhs, const OpenState& rhs)
+    {
+        if (lhs.m_score != rhs.m_score)
+        {
+            return lhs.m_score > rhs.m_score;
+        }
+        if (lhs.m_estimate != rhs.m_estimate)
+        {
+            return lhs.m_estimate > rhs.m_estimate;
+        }
+        return lhs.m_order < rhs.m_order;
+    };
+
+    std::vector<OpenState>& open  = buffers.m_open;
+    uint32_t                order = 0;
+    open.clear();
+
+    const int startState         = stateOf(startX, startY, s_east);
+    const int startEstimate      = estimate(startX, startY, s_east);
+    buffers.m_visit[startState]  = searchId;
+    buffers.m_cost[startState]   = 0;
+    buffers.m_parent[startState] = -1;
+    open.push_back({startEstimate, startEstimate, order++, startState});
+
+    int goalState = -1;
+    while (!open.empty())
+    {
+        std::pop_heap(open.begin(), open.end(), later);
+        const OpenState entry = open.back();
+        open.pop_back();
+
+        const int state     = entry.m_state;
+        const int direction = state % 4;
+        const int x         = (state / 4) % width + minX;
+        const int y         = (state / 4) / width + minY;
+        const int cost      = buffers.m_cost[state];
+        if (entry.m_score - entry.m_estimate != cost)
+        {
+            // a cheaper way to this state was found after this entry was pushed
+            continue;
+        }
+        if (x == goalX && y == goalY && direction == s_east)
+        {
+            goalState = state;
+            break;
+        }
+
+        // straight on, or a quarter turn either way
+        for (int turn : {0, 1, 3})
+        {
+            const int nextDirection = (direction + turn) % 4;
+            const int nextX         = x + s_stepX[nextDirection];
+            const int nextY         = y + s_stepY[nextDirection];
+            if (nextX < minX || nextX >= minX + width || nextY < minY || nextY >= minY + height)
+            {
+                continue;
+            }
+
+            int nextCost = cost + 1;
+            if (turn != 0)
+            {
+                nextCost += m_options.m_bendCost;
+            }
+            if (Occupancy(nextX, nextY) > 0)
+            {
+                nextCost += m_options.m_obstacleCost;
+            }
+
+            const int nextState = stateOf(nextX, nextY, nextDirection);
+            if (buffers.m_visit[nextState] != searchId || nextCost < buffers.m_cost[nextState])
+            {
+                buffers.m_visit[nextState]  = searchId;
+                buffers.m_cost[nextState]   = nextCost;
+                buffers.m_parent[nextState] = state;
+                const int nextEstimate = estimate(nextX, nextY, nextDirection);
+                open.push_back({nextCost + nextEstimate, nextEstimate, order++, nextState});
+                std::push_heap(open.begin(), open.end(), later);
+            }
+        }
+    }
+
+    // a turn happens in the cell before the first state entered with the new direction
+    std::vector<ImVec2> corners;
+    for (int state = goalState; state != -1 && buffers.m_parent[state] != -1;
+         state     = buffers.m_parent[state])
+    {
+        const int parent = buffers.m_parent[state];
+        if (parent % 4 != state % 4)
+        {
+            const int x = (parent / 4) % width + minX;
+            const int y = (parent / 4) / width + minY;
+            corners.emplace_back((x + 0.5f) * cellSize, (y + 0.5f) * cellSize);
+        }
+    }
+    std::reverse(corners.begin(), corners.end());
+
+    std::vector<ImVec2> points;
+    points.reserve(corners.size() + 4);
+    points.push_back(start);
+    if (corners.empty())
+    {
+        // start and end are on the same row of cells, but maybe not at the same height
+        if (start.y != end.y)
+        {
+            const float middleX = 0.5f * (start.x + end.x);
+            points.emplace_back(middleX, start.y);
+            points.emplace_back(middleX, end.y);
+        }
+    }
+    else
+    {
+        // the first and the last segments are horizontal, they follow the pins rather than the
+        // center of their row of cells
+        corners.front().y = start.y;
+        corners.back().y  = end.y;
+        points.insert(points.end(), corners.begin(), corners.end());
+    }
+    points.push_back(end);
+    return points;
+}
+
+} // namespace SimpleNodeEditor
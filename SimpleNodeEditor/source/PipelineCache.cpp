@@ -0,0 +1,554 @@
+#include "PipelineCache.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <type_traits>
+#include <unordered_map>
+#include "FileSystem.hpp"
+#include "Log.hpp"
+
+namespace SimpleNodeEditor
+{
+
+static constexpr char     s_snapshotMagic[8]  = {'S', 'N', 'E', 'P', 'I', 'P', 'E', '\0'};
+static constexpr uint32_t s_snapshotVersion   = 1;
+static constexpr size_t   s_snapshotAlignment = 8;
+
+// everything below is written as it is in memory
+
+struct SnapshotString
+{
+    uint32_t m_offset; // into the character blob
+    uint32_t m_size;
+};
+
+struct SnapshotRule
+{
+    uint32_t m_group; // string index
+    uint32_t m_type;
+};
+
+struct SnapshotProperty
+{
+    uint32_t m_name;
+    int32_t  m_id;
+    uint32_t m_value;
+};
+
+struct SnapshotNode
+{
+    uint32_t m_name;
+    int32_t  m_id;
+    int32_t  m_isSrcNode;
+    int32_t  m_type;
+    uint32_t m_firstProperty;
+    uint32_t m_propertyCount;
+    uint32_t m_firstRule;
+    uint32_t m_ruleCount;
+    uint32_t m_hasPosition;
+    float    m_x;
+    float    m_y;
+};
+
+struct SnapshotPort
+{
+    uint32_t m_nodeName;
+    int32_t  m_nodeId;
+    uint32_t m_portName;
+    int32_t  m_portId;
+    uint32_t m_firstRule;
+    uint32_t m_ruleCount;
+};
+
+struct SnapshotEdge
+{
+    uint32_t m_srcPort; // port index
+    uint32_t m_dstPort;
+    uint32_t m_isValid;
+};
+
+// where each array starts in the file and how many entries it has
+struct SnapshotSection
+{
+    uint64_t m_offset;
+    uint64_t m_count;
+};
+
+struct SnapshotHeader
+{
+    char     m_magic[8];
+    uint32_t m_version;
+    uint32_t m_headerSize; // with the record sizes, tells layouts of other machines apart
+    uint32_t m_recordSizes[6];
+    uint32_t m_pipelineName; // string index
+    uint64_t m_sourceSize;
+    int64_t  m_sourceModifiedTime;
+    uint64_t m_sourceHash;
+    uint64_t m_recordsHash; // of everything after the header
+
+    SnapshotSection m_strings;
+    SnapshotSection m_nodes;
+    SnapshotSection m_properties;
+    SnapshotSection m_rules;
+    SnapshotSection m_ports;
+    SnapshotSection m_edges;
+    SnapshotSection m_characters;
+};
+
+static_assert(std::is_trivially_copyable_v<SnapshotHeader> &&
+              std::is_trivially_copyable_v<SnapshotNode> &&
+              std::is_trivially_copyable_v<SnapshotEdge>);
+
+static constexpr uint32_t s_recordSizes[6] = {
+    sizeof(SnapshotString), sizeof(SnapshotRule), sizeof(SnapshotProperty),
+    sizeof(SnapshotNode),   sizeof(SnapshotPort), sizeof(SnapshotEdge)};
+
+// the size and modification time of a file, what a snapshot is checked against before the hash
+static bool GetSourceStamp(const std::string& filePath, uint64_t& size, int64_t& modifiedTime)
+{
+    std::error_code errorCode;
+    size = std::filesystem::file_size(filePath, errorCode);
+    if (errorCode)
+    {
+        return false;
+    }
+    modifiedTime = static_cast<int64_t>(
+        std::filesystem::last_write_time(filePath, errorCode).time_since_epoch().count());
+    return !errorCode;
+}
+
+// collects the records and the distinct strings while a snapshot is written
+class SnapshotBuilder
+{
+public:
+    uint32_t AddString(const std::string& value)
+    {
+        auto [iter, inserted] = m_stringIndices.try_emplace(value, 0);
+        if (inserted)
+        {
+            iter->second = static_cast<uint32_t>(m_strings.size());
+            m_strings.push_back(SnapshotString{static_cast<uint32_t>(m_characters.size()),
+                                               static_cast<uint32_t>(value.size())});
+            m_characters.append(value);
+        }
+        return iter->second;
+    }
+
+    void AddRules(const std::vector<YamlPruningRule>& rules, uint32_t& first, uint32_t& count)
+    {
+        first = static_cast<uint32_t>(m_rules.size());
+        count = static_cast<uint32_t>(rules.size());
+        for (const YamlPruningRule& rule : rules)
+        {
+            m_rules.push_back(SnapshotRule{AddString(rule.m_Group), AddString(rule.m_Type)});
+        }
+    }
+
+    uint32_t AddPort(const YamlPort& port)
+    {
+        SnapshotPort record{AddString(port.m_nodeName), port.m_nodeYamlId,
+                            AddString(port.m_portName), port.m_portYamlId, 0, 0};
+        AddRules(port.m_PruningRules, record.m_firstRule, record.m_ruleCount);
+        m_ports.push_back(record);
+        return static_cast<uint32_t>(m_ports.size() - 1);
+    }
+
+    void AddNode(const YamlNode& node)
+    {
+        SnapshotNode record{};
+        record.m_name          = AddString(node.m_nodeName);
+        record.m_id            = node.m_nodeYamlId;
+        record.m_isSrcNode     = node.m_isSrcNode;
+        record.m_type          = node.m_nodeYamlType;
+        record.m_firstProperty = static_cast<uint32_t>(m_properties.size());
+        record.m_propertyCount = static_cast<uint32_t>(node.m_Properties.size());
+        node.m_Properties.ForEach(
+            [this](std::string_view name, int32_t id, std::string_view value)
+            {
+                m_properties.push_back(SnapshotProperty{AddString(std::string(name)), id,
+                                                        AddString(std::string(value))});
+            });
+        AddRules(node.m_PruningRules, record.m_firstRule, record.m_ruleCount);
+        if (node.m_position)
+        {
+            record.m_hasPosition = 1;
+            record.m_x           = node.m_position->m_x;
+            record.m_y           = node.m_position->m_y;
+        }
+        m_nodes.push_back(record);
+    }
+
+    void AddEdge(const YamlEdge& edge)
+    {
+        const uint32_t srcPort = AddPort(edge.m_yamlSrcPort);
+        const uint32_t dstPort = AddPort(edge.m_yamlDstPort);
+        m_edges.push_back(SnapshotEdge{srcPort, dstPort, edge.m_isValid ? 1u : 0u});
+    }
+
+    // indices and string offsets are 32 bits wide
+    bool FitsInSnapshot() const
+    {
+        constexpr size_t maxSize = std::numeric_limits<uint32_t>::max();
+        return m_characters.size() <= maxSize && m_ports.size() <= maxSize &&
+               m_properties.size() <= maxSize && m_rules.size() <= maxSize;
+    }
+
+    bool Write(std::ostream& outputStream, SnapshotHeader& header) const
+    {
+        // the arrays follow the header in this order, each aligned for mapping
+        uint64_t offset  = sizeof(SnapshotHeader);
+        auto     section = [&offset](size_t count, size_t recordSize)
+        {
+            offset = (offset + s_snapshotAlignment - 1) / s_snapshotAlignment * s_snapshotAlignment;
+            SnapshotSection result{offset, count};
+            offset += count * recordSize;
+            return result;
+        };
+        header.m_strings    = section(m_strings.size(), sizeof(SnapshotString));
+        header.m_nodes      = section(m_nodes.size(), sizeof(SnapshotNode));
+        header.m_properties = section(m_properties.size(), sizeof(SnapshotProperty));
+        header.m_rules      = section(m_rules.size(), sizeof(SnapshotRule));
+        header.m_ports      = section(m_ports.size(), sizeof(SnapshotPort));
+        header.m_edges      = section(m_edges.size(), sizeof(SnapshotEdge));
+        header.m_characters = section(m_characters.size(), 1);
+
+        // the records are put together first, the header carries their hash
+        std::string records(offset - sizeof(SnapshotHeader), '\0');
+        auto        copySection = [&records](const SnapshotSection& where, const void* data,
+                                      size_t bytes)
+        {
+            if (bytes > 0)
+            {
+                std::memcpy(records.data() + (where.m_offset - sizeof(SnapshotHeader)), data, bytes);
+            }
+        };
+        copySection(header.m_strings, m_strings.data(), m_strings.size() * sizeof(SnapshotString));
+        copySection(header.m_nodes, m_nodes.data(), m_nodes.size() * sizeof(SnapshotNode));
+        copySection(header.m_properties, m_properties.data(),
+                    m_properties.size() * sizeof(SnapshotProperty));
+        copySection(header.m_rules, m_rules.data(), m_rules.size() * sizeof(SnapshotRule));
+        copySection(header.m_ports, m_ports.data(), m_ports.size() * sizeof(SnapshotPort));
+        copySection(header.m_edges, m_edges.data(), m_edges.size() * sizeof(SnapshotEdge));
+        copySection(header.m_characters, m_characters.data(), m_characters.size());
+        header.m_recordsHash = PipelineCache::HashContent(records);
+
+        outputStream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        outputStream.write(records.data(), static_cast<std::streamsize>(records.size()));
+        return static_cast<bool>(outputStream);
+    }
+
+private:
+    std::unordered_map<std::string, uint32_t> m_stringIndices;
+    std::vector<SnapshotString>               m_strings;
+    std::string                               m_characters;
+    std::vector<SnapshotNode>                 m_nodes;
+    std::vector<SnapshotProperty>             m_properties;
+    std::vector<SnapshotRule>                 m_rules;
+    std::vector<SnapshotPort>                 m_ports;
+    std::vector<SnapshotEdge>                 m_edges;
+};
+
+// reads the records of a mapped snapshot. Besides the hash of the records every index is checked,
+// a damaged file must not crash
+class SnapshotReader
+{
+public:
+    explicit SnapshotReader(std::string_view data) : m_data(data) {}
+
+    bool Open()
+    {
+        if (m_data.size() < sizeof(SnapshotHeader))
+        {
+            return false;
+        }
+        std::memcpy(&m_header, m_data.data(), sizeof(SnapshotHeader));
+        return std::memcmp(m_header.m_magic, s_snapshotMagic, sizeof(s_snapshotMagic)) == 0 &&
+               m_header.m_version == s_snapshotVersion &&
+               m_header.m_headerSize == sizeof(SnapshotHeader) &&
+               std::memcmp(m_header.m_recordSizes, s_recordSizes, sizeof(s_recordSizes)) == 0 &&
+               PipelineCache::HashContent(m_data.substr(sizeof(SnapshotHeader))) ==
+                   m_header.m_recordsHash &&
+               GetSection(m_header.m_strings, m_strings) &&
+               GetSection(m_header.m_nodes, m_nodes) &&
+               GetSection(m_header.m_properties, m_properties) &&
+               GetSection(m_header.m_rules, m_rules) && GetSection(m_header.m_ports, m_ports) &&
+               GetSection(m_header.m_edges, m_edges) &&
+               GetSection(m_header.m_characters, m_characters);
+    }
+
+    const SnapshotHeader& GetHeader() const { return m_header; }
+
+    bool Read(std::string& pipelineName, std::vector<YamlNode>& nodes,
+              std::vector<YamlEdge>& edges) const
+    {
+        if (!GetString(m_header.m_pipelineName, pipelineName))
+        {
+            return false;
+        }
+
+        nodes.resize(m_header.m_nodes.m_count);
+        std::string propertyName;
+        std::string propertyValue;
+        for (size_t index = 0; index < nodes.size(); ++index)
+        {
+            const SnapshotNode& record = m_nodes[index];
+            YamlNode&           node   = nodes[index];
+            node.m_nodeYamlId          = record.m_id;
+            node.m_isSrcNode           = record.m_isSrcNode;
+            node.m_nodeYamlType        = record.m_type;
+            if (!GetString(record.m_name, node.m_nodeName) ||
+                !InRange(record.m_firstProperty, record.m_propertyCount,
+                         m_header.m_properties.m_count) ||
+                !GetRules(record.m_firstRule, record.m_ruleCount, node.m_PruningRules))
+            {
+                return false;
+            }
+            for (uint32_t offset = 0; offset < record.m_propertyCount; ++offset)
+            {
+                const SnapshotProperty& property = m_properties[record.m_firstProperty + offset];
+                if (!GetString(property.m_name, propertyName) ||
+                    !GetString(property.m_value, propertyValue))
+                {
+                    return false;
+                }
+                node.m_Properties.Add(propertyName, property.m_id, propertyValue);
+            }
+            if (record.m_hasPosition)
+            {
+                node.m_position = YamlNodePosition{record.m_x, record.m_y};
+            }
+        }
+
+        edges.resize(m_header.m_edges.m_count);
+        for (size_t index = 0; index < edges.size(); ++index)
+        {
+            const SnapshotEdge& record = m_edges[index];
+            edges[index].m_isValid     = record.m_isValid != 0;
+            if (!GetPort(record.m_srcPort, edges[index].m_yamlSrcPort) ||
+                !GetPort(record.m_dstPort, edges[index].m_yamlDstPort))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    template <typename T>
+    bool GetSection(const SnapshotSection& section, const T*& records) const
+    {
+        if (section.m_offset % alignof(T) != 0 || section.m_offset > m_data.size() ||
+            section.m_count > (m_data.size() - section.m_offset) / sizeof(T))
+        {
+            return false;
+        }
+        records = reinterpret_cast<const T*>(m_data.data() + section.m_offset);
+        return true;
+    }
+
+    static bool InRange(uint64_t first, uint64_t count, uint64_t size)
+    {
+        return first <= size && count <= size - first;
+    }
+
+    bool GetString(uint32_t index, std::string& value) const
+    {
+        if (index >= m_header.m_strings.m_count)
+        {
+            return false;
+        }
+        const SnapshotString& record = m_strings[index];
+        if (!InRange(record.m_offset, record.m_size, m_header.m_characters.m_count))
+        {
+            return false;
+        }
+        value.assign(m_characters + record.m_offset, record.m_size);
+        return true;
+    }
+
+    bool GetRules(uint32_t first, uint32_t count, std::vector<YamlPruningRule>& rules) const
+    {
+        if (!InRange(first, count, m_header.m_rules.m_count))
+        {
+            return false;
+        }
+        rules.resize(count);
+        for (uint32_t offset = 0; offset < count; ++offset)
+        {
+            if (!GetString(m_rules[first + offset].m_group, rules[offset].m_Group) ||
+                !GetString(m_rules[first + offset].m_type, rules[offset].m_Type))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool GetPort(uint32_t index, YamlPort& port) const
+    {
+        if (index >= m_header.m_ports.m_count)
+        {
+            return false;
+        }
+        const SnapshotPort& record = m_ports[index];
+        port.m_nodeYamlId          = record.m_nodeId;
+        port.m_portYamlId          = record.m_portId;
+        return GetString(record.m_nodeName, port.m_nodeName) &&
+               GetString(record.m_portName, port.m_portName) &&
+               GetRules(record.m_firstRule, record.m_ruleCount, port.m_PruningRules);
+    }
+
+    std::string_view        m_data;
+    SnapshotHeader          m_header{};
+    const SnapshotString*   m_strings    = nullptr;
+    const SnapshotNode*     m_nodes      = nullptr;
+    const SnapshotProperty* m_properties = nullptr;
+    const SnapshotRule*     m_rules      = nullptr;
+    const SnapshotPort*     m_ports      = nullptr;
+    const SnapshotEdge*     m_edges      = nullptr;
+    const char*             m_characters = nullptr;
+};
+
+PipelineCache::PipelineCache(const std::string& cacheDirectory) : m_cacheDirectory(cacheDirectory)
+{
+}
+
+uint64_t PipelineCache::HashContent(std::string_view content)
+{
+    // FNV-1a, eight bytes at a time
+    constexpr uint64_t prime = 0x100000001b3ULL;
+    uint64_t           hash  = 0xcbf29ce484222325ULL;
+    size_t             index = 0;
+    for (; index + sizeof(uint64_t) <= content.size(); index += sizeof(uint64_t))
+    {
+        uint64_t word;
+        std::memcpy(&word, content.data() + index, sizeof(word));
+        hash = (hash ^ word) * prime;
+    }
+    for (; index < content.size(); ++index)
+    {
+        hash = (hash ^ static_cast<unsigned char>(content[index])) * prime;
+    }
+    return hash ^ content.size();
+}
+
+std::filesystem::path PipelineCache::GetSnapshotPath(const std::string& filePath) const
+{
+    std::error_code       errorCode;
+    std::filesystem::path absolutePath = std::filesystem::weakly_canonical(filePath, errorCode);
+    if (errorCode)
+    {
+        absolutePath = std::filesystem::absolute(filePath, errorCode);
+    }
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.snecache",
+                  static_cast<unsigned long long>(HashContent(absolutePath.generic_string())));
+    return m_cacheDirectory / name;
+}
+
+bool PipelineCache::Load(const std::string& filePath, uint64_t contentHash,
+                         std::string& pipelineName, std::vector<YamlNode>& nodes,
+                         std::vector<YamlEdge>& edges) const
+{
+    uint64_t sourceSize         = 0;
+    int64_t  sourceModifiedTime = 0;
+    if (!IsEnabled() || !GetSourceStamp(filePath, sourceSize, sourceModifiedTime))
+    {
+        return false;
+    }
+
+    const std::filesystem::path snapshotPath = GetSnapshotPath(filePath);
+    std::error_code             errorCode;
+    if (!std::filesystem::is_regular_file(snapshotPath, errorCode))
+    {
+        return false;
+    }
+    std::unique_ptr<FS::MappedFile> mappedFile = FS::MappedFile::Open(snapshotPath);
+    if (!mappedFile)
+    {
+        return false;
+    }
+
+    SnapshotReader reader(mappedFile->GetView());
+    if (!reader.Open())
+    {
+        SNELOG_WARN("pipeline cache [{}] is invalid, ignored", snapshotPath.string());
+        return false;
+    }
+    const SnapshotHeader& header = reader.GetHeader();
+    if (header.m_sourceSize != sourceSize || header.m_sourceModifiedTime != sourceModifiedTime ||
+        header.m_sourceHash != contentHash)
+    {
+        SNELOG_INFO("pipeline cache of [{}] is stale", filePath);
+        return false;
+    }
+    if (!reader.Read(pipelineName, nodes, edges))
+    {
+        SNELOG_WARN("pipeline cache [{}] is damaged, ignored", snapshotPath.string());
+        nodes.clear();
+        edges.clear();
+        return false;
+    }
+    SNELOG_INFO("loaded [{}] from pipeline cache [{}]", filePath, snapshotPath.string());
+    return true;
+}
+
+void PipelineCache::Store(const std::string& filePath, uint64_t contentHash,
+                          const std::string& pipelineName, const std::vector<YamlNode>& nodes,
+                          const std::vector<YamlEdge>& edges) const
+{
+    SnapshotHeader header{};
+    if (!IsEnabled() ||
+        !GetSourceStamp(filePath, header.m_sourceSize, header.m_sourceModifiedTime))
+    {
+        return;
+    }
+    std::memcpy(header.m_magic, s_snapshotMagic, sizeof(s_snapshotMagic));
+    header.m_version    = s_snapshotVersion;
+    header.m_headerSize = sizeof(SnapshotHeader);
+    std::memcpy(header.m_recordSizes, s_recordSizes, sizeof(s_recordSizes));
+    header.m_sourceHash = contentHash;
+
+    SnapshotBuilder builder;
+    header.m_pipelineName = builder.AddString(pipelineName);
+    for (const YamlNode& node : nodes)
+    {
+        builder.AddNode(node);
+    }
+    for (const YamlEdge& edge : edges)
+    {
+        builder.AddEdge(edge);
+    }
+    if (!builder.FitsInSnapshot())
+    {
+        SNELOG_WARN("[{}] is too large for the pipeline cache", filePath);
+        return;
+    }
+
+    std::error_code errorCode;
+    std::filesystem::create_directories(m_cacheDirectory, errorCode);
+    // written aside and renamed, a reader never sees half a snapshot
+    const std::filesystem::path snapshotPath = GetSnapshotPath(filePath);
+    std::filesystem::path       tempPath     = snapshotPath;
+    tempPath += ".tmp";
+    {
+        std::ofstream outputFile(tempPath, std::ios::binary | std::ios::trunc);
+        if (!outputFile.is_open() || !builder.Write(outputFile, header))
+        {
+            SNELOG_WARN("write pipeline cache [{}] failed", tempPath.string());
+            outputFile.close();
+            std::filesystem::remove(tempPath, errorCode);
+            return;
+        }
+    }
+    std::filesystem::rename(tempPath, snapshotPath, errorCode);
+    if (errorCode)
+    {
+        SNELOG_WARN("write pipeline cache [{}] failed, {}", snapshotPath.string(),
+                    errorCode.message());
+        std::filesystem::remove(tempPath, errorCode);
+    }
+}
+
+} // namespace SimpleNodeEditor
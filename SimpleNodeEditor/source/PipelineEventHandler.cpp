@@ -0,0 +1,463 @@
+#include "PipelineEventHandler.hpp"
+#include <charconv>
+#include <string_view>
+#include "Log.hpp"
+
+namespace SimpleNodeEditor
+{
+
+// required keys of the entries, one bit each
+static constexpr uint32_t s_allNodeKeys      = 0xF; // NodeName, NodeId, IsSrcNode, NodeType
+static constexpr uint32_t s_allPortKeys      = 0xF; // NodeName, NodeId, PortName, PortId
+static constexpr uint32_t s_allPropertyKeys  = 0x3; // NodePropertyName, NodePropertyValue
+static constexpr uint32_t s_allPruneRuleKeys = 0x3; // group, type
+
+template <typename T>
+void PipelineEventHandler::ParseNumber(const YAML::Mark& mark, const std::string& value, T& number)
+{
+    const char* begin = value.data();
+    const char* end   = begin + value.size();
+    // yaml allows a leading plus sign, from_chars does not
+    if (begin != end && *begin == '+')
+    {
+        ++begin;
+    }
+    const auto [ptr, ec] = std::from_chars(begin, end, number);
+    if (ec != std::errc() || ptr != end)
+    {
+        SNELOG_ERROR("invalid number [{}] at line {} of the pipeline file, check it!", value,
+                     m_lineOffset + mark.line + 1);
+        m_result.m_errors.push_back("parse pipeline file failed, invalid number");
+    }
+}
+
+void PipelineEventHandler::OnDocumentStart(const YAML::Mark& /*mark*/)
+{
+    m_frames.clear();
+}
+
+void PipelineEventHandler::OnDocumentEnd() {}
+
+void PipelineEventHandler::OnNull(const YAML::Mark& /*mark*/, YAML::anchor_t /*anchor*/)
+{
+    if (!ReadKey({}))
+    {
+        EndValue();
+    }
+}
+
+void PipelineEventHandler::OnAlias(const YAML::Mark& mark, YAML::anchor_t /*anchor*/)
+{
+    SNELOG_WARN("aliases are not supported in pipeline files, the one at line {} is skipped",
+                m_lineOffset + mark.line + 1);
+    if (!ReadKey({}))
+    {
+        EndValue();
+    }
+}
+
+void PipelineEventHandler::OnScalar(const YAML::Mark& mark, const std::string& /*tag*/,
+                                    YAML::anchor_t /*anchor*/, const std::string& value)
+{
+    if (m_frames.empty() || ReadKey(value))
+    {
+        return;
+    }
+    OnScalarValue(mark, value);
+    EndValue();
+}
+
+void PipelineEventHandler::OnSequenceStart(const YAML::Mark& mark, const std::string& /*tag*/,
+                                           YAML::anchor_t /*anchor*/,
+                                           YAML::EmitterStyle::value /*style*/)
+{
+    BeginContainer(mark, false);
+}
+
+void PipelineEventHandler::OnSequenceEnd()
+{
+    EndContainer();
+}
+
+void PipelineEventHandler::OnMapStart(const YAML::Mark& mark, const std::string& /*tag*/,
+                                      YAML::anchor_t /*anchor*/,
+                                      YAML::EmitterStyle::value /*style*/)
+{
+    BeginContainer(mark, true);
+}
+
+void PipelineEventHandler::OnMapEnd()
+{
+    EndContainer();
+}
+
+// entries saved after the list was written follow under "<list>Patch<n>" keys, they are more
+// entries of the same list, see PipelineFileLayout
+static bool IsListKey(const std::string& key, std::string_view list)
+{
+    return key.starts_with(list) &&
+           (key.size() == list.size() || key.compare(list.size(), 5, "Patch") == 0);
+}
+
+PipelineEventHandler::Role PipelineEventHandler::ChildRole(bool isMap) const
+{
+    if (m_frames.empty())
+    {
+        switch (m_fragment)
+        {
+        case Fragment::NodeList:
+            return isMap ? Role::Skip : Role::NodeList;
+        case Fragment::LinkList:
+            return isMap ? Role::Skip : Role::LinkList;
+        default:
+            return isMap ? Role::Root : Role::Skip;
+        }
+    }
+
+    const Frame& parent = m_frames.back();
+    if (parent.m_isMap && !parent.m_hasKey)
+    {
+        // a container used as a key
+        return Role::Skip;
+    }
+
+    const std::string& key = parent.m_key;
+    switch (parent.m_role)
+    {
+    case Role::Root:
+        return !isMap && key == "Pipeline" ? Role::PipelineList : Role::Skip;
+    case Role::PipelineList:
+        return isMap && parent.m_children == 0 ? Role::Pipeline : Role::Skip;
+    case Role::Pipeline:
+        if (!isMap && IsListKey(key, "NodeList"))
+        {
+            return Role::NodeList;
+        }
+        return !isMap && IsListKey(key, "LinkList") ? Role::LinkList : Role::Skip;
+    case Role::NodeList:
+        return isMap ? Role::Node : Role::Skip;
+    case Role::Node:
+        if (!isMap && key == "NodeProperty")
+        {
+            return Role::NodeProperties;
+        }
+        if (!isMap && key == "PruneRule")
+        {
+            return Role::NodePruneRules;
+        }
+        return !isMap && key == "Position" ? Role::Position : Role::Skip;
+    case Role::NodeProperties:
+        return isMap ? Role::NodeProperty : Role::Skip;
+    case Role::NodePruneRules:
+    case Role::PortPruneRules:
+        return isMap ? Role::PruneRule : Role::Skip;
+    case Role::LinkList:
+        return isMap ? Role::Link : Role::Skip;
+    case Role::Link:
+        if (isMap && key == "SrcPort")
+        {
+            return Role::SrcPort;
+        }
+        return !isMap && key == "DstPort" ? Role::DstPorts : Role::Skip;
+    case Role::SrcPort:
+    case Role::DstPort:
+        return !isMap && key == "PruneRule" ? Role::PortPruneRules : Role::Skip;
+    case Role::DstPorts:
+        return isMap ? Role::DstPort : Role::Skip;
+    default:
+        return Role::Skip;
+    }
+}
+
+void PipelineEventHandler::BeginContainer(const YAML::Mark& mark, bool isMap)
+{
+    if (m_cancelled && m_cancelled->load(std::memory_order_relaxed))
+    {
+        throw Cancelled();
+    }
+
+    const Role role = ChildRole(isMap);
+    switch (role)
+    {
+    case Role::Pipeline:
+        m_result.m_hasPipeline = true;
+        break;
+    case Role::NodeList:
+        m_result.m_hasNodeList = true;
+        break;
+    case Role::LinkList:
+        m_result.m_hasLinkList = true;
+        break;
+    case Role::Node:
+        m_node        = YamlNode();
+        m_nodeKeys    = 0;
+        m_hasPosition = false;
+        break;
+    case Role::NodeProperty:
+        m_propertyName.clear();
+        m_propertyValue.clear();
+        m_propertyKeys = 0;
+        break;
+    case Role::PruneRule:
+        m_pruneRule     = YamlPruningRule();
+        m_pruneRuleKeys = 0;
+        break;
+    case Role::Position:
+        m_position.clear();
+        m_hasPosition = true;
+        break;
+    case Role::Link:
+        m_srcPort.reset();
+        m_dstPorts.reset();
+        break;
+    case Role::SrcPort:
+    case Role::DstPort:
+        m_port     = YamlPort();
+        m_portKeys = 0;
+        break;
+    case Role::DstPorts:
+        m_dstPorts.emplace();
+        break;
+    default:
+        break;
+    }
+    m_frames.push_back(Frame{role, isMap, false, {}, 0, m_lineOffset + mark.line + 1});
+}
+
+void PipelineEventHandler::EndContainer()
+{
+    if (m_frames.empty())
+    {
+        return;
+    }
+    const Frame frame = std::move(m_frames.back());
+    m_frames.pop_back();
+
+    switch (frame.m_role)
+    {
+    case Role::NodeList:
+        m_result.m_nodeListSize += frame.m_children;
+        break;
+    case Role::LinkList:
+        m_result.m_linkListSize += frame.m_children;
+        break;
+    case Role::Node:
+        if (m_nodeKeys != s_allNodeKeys)
+        {
+            SNELOG_ERROR("invalid required key when parsing YamlNode at line {}, check it! "
+                         "NodeName, NodeId, IsSrcNode and NodeType are required",
+                         frame.m_line);
+            m_result.m_errors.push_back("parse pipeline file failed, parse node fail");
+        }
+        // position is optional, older files do not have it
+        if (m_hasPosition)
+        {
+            if (m_position.size() == 2)
+            {
+                m_node.m_position = YamlNodePosition{m_position[0], m_position[1]};
+            }
+            else
+            {
+                SNELOG_WARN("invalid node position of node[{}], expecting [x, y]",
+                            m_node.m_nodeYamlId);
+            }
+        }
+        m_result.m_nodes.push_back(std::move(m_node));
+        break;
+    case Role::NodeProperty:
+        if (m_propertyKeys != s_allPropertyKeys)
+        {
+            SNELOG_WARN("invalid key when parsing NodeProperty at line {}, it is skipped",
+                        frame.m_line);
+            break;
+        }
+        // packed into the node as they are, see YamlNodeProperties. The id is hard coded
+        m_node.m_Properties.Add(m_propertyName, 0, m_propertyValue);
+        break;
+    case Role::PruneRule:
+        if (m_pruneRuleKeys != s_allPruneRuleKeys)
+        {
+            SNELOG_WARN("invalid key when parsing PruneRule at line {}", frame.m_line);
+        }
+        if (!m_frames.empty() && m_frames.back().m_role == Role::NodePruneRules)
+        {
+            m_node.m_PruningRules.push_back(std::move(m_pruneRule));
+        }
+        else
+        {
+            m_port.m_PruningRules.push_back(std::move(m_pruneRule));
+        }
+        break;
+    case Role::Position:
+        if (frame.m_children != m_position.size())
+        {
+            // something else than numbers in it
+            m_position.clear();
+        }
+        break;
+    case Role::SrcPort:
+    case Role::DstPort:
+        if (m_portKeys != s_allPortKeys)
+        {
+            SNELOG_ERROR("invalid required key when parsing YamlPort at line {}, check it! "
+                         "NodeName, NodeId, PortName and PortId are required",
+                         frame.m_line);
+            m_result.m_errors.push_back("parse pipeline file failed, parse port fail");
+        }
+        if (frame.m_role == Role::SrcPort)
+        {
+            m_srcPort = std::move(m_port);
+        }
+        else
+        {
+            m_dstPorts->push_back(std::move(m_port));
+        }
+        break;
+    case Role::Link:
+        if (!m_srcPort)
+        {
+            SNELOG_ERROR("invalid link at line {}, it has no SrcPort map", frame.m_line);
+        }
+        else if (!m_dstPorts)
+        {
+            SNELOG_ERROR("invalid link at line {}, DstPort is missing or is not a sequence",
+                         frame.m_line);
+        }
+        else
+        {
+            for (const YamlPort& dstPort : *m_dstPorts)
+            {
+                m_result.m_edges.emplace_back(*m_srcPort, dstPort, true);
+            }
+        }
+        break;
+    default:
+        break;
+    }
+    EndValue();
+}
+
+bool PipelineEventHandler::ReadKey(const std::string& key)
+{
+    if (m_frames.empty() || !m_frames.back().m_isMap || m_frames.back().m_hasKey)
+    {
+        return false;
+    }
+    m_frames.back().m_key    = key;
+    m_frames.back().m_hasKey = true;
+    return true;
+}
+
+void PipelineEventHandler::EndValue()
+{
+    if (m_frames.empty())
+    {
+        return;
+    }
+    Frame& frame = m_frames.back();
+    if (frame.m_isMap && !frame.m_hasKey)
+    {
+        // the key was not a scalar, its value is skipped
+        frame.m_key.clear();
+        frame.m_hasKey = true;
+        return;
+    }
+    frame.m_key.clear();
+    frame.m_hasKey = false;
+    ++frame.m_children;
+}
+
+void PipelineEventHandler::OnScalarValue(const YAML::Mark& mark, const std::string& value)
+{
+    const Frame&       frame = m_frames.back();
+    const std::string& key   = frame.m_key;
+    switch (frame.m_role)
+    {
+    case Role::Pipeline:
+        if (key == "pipelinename")
+        {
+            m_result.m_pipelineName = value;
+        }
+        break;
+    case Role::Node:
+        if (key == "NodeName")
+        {
+            m_node.m_nodeName = value;
+            m_nodeKeys |= 1;
+        }
+        else if (key == "NodeId")
+        {
+            ParseNumber(mark, value, m_node.m_nodeYamlId);
+            m_nodeKeys |= 2;
+        }
+        else if (key == "IsSrcNode")
+        {
+            ParseNumber(mark, value, m_node.m_isSrcNode);
+            m_nodeKeys |= 4;
+        }
+        else if (key == "NodeType")
+        {
+            ParseNumber(mark, value, m_node.m_nodeYamlType);
+            m_nodeKeys |= 8;
+        }
+        break;
+    case Role::NodeProperty:
+        if (key == "NodePropertyName")
+        {
+            m_propertyName = value;
+            m_propertyKeys |= 1;
+        }
+        else if (key == "NodePropertyValue")
+        {
+            m_propertyValue = value;
+            m_propertyKeys |= 2;
+        }
+        break;
+    case Role::PruneRule:
+        if (key == "group")
+        {
+            m_pruneRule.m_Group = value;
+            m_pruneRuleKeys |= 1;
+        }
+        else if (key == "type")
+        {
+            m_pruneRule.m_Type = value;
+            m_pruneRuleKeys |= 2;
+        }
+        break;
+    case Role::Position:
+    {
+        float coord = 0.f;
+        ParseNumber(mark, value, coord);
+        m_position.push_back(coord);
+        break;
+    }
+    case Role::SrcPort:
+    case Role::DstPort:
+        if (key == "NodeName")
+        {
+            m_port.m_nodeName = value;
+            m_portKeys |= 1;
+        }
+        else if (key == "NodeId")
+        {
+            ParseNumber(mark, value, m_port.m_nodeYamlId);
+            m_portKeys |= 2;
+        }
+        else if (key == "PortName")
+        {
+            m_port.m_portName = value;
+            m_portKeys |= 4;
+        }
+        else if (key == "PortId")
+        {
+            ParseNumber(mark, value, m_port.m_portYamlId);
+            m_portKeys |= 8;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+} // namespace SimpleNodeEditor
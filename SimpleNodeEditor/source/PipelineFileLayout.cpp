@@ -0,0 +1,386 @@
+#include "PipelineFileLayout.hpp"
+#include <map>
+#include <unordered_map>
+#include "Log.hpp"
+#include "PipelineCache.hpp"
+
+namespace SimpleNodeEditor
+{
+
+// past these the whole file is written again, to keep it from filling up with blanks and patches
+static constexpr double s_maxBlankFraction = 0.25;
+static constexpr int    s_maxPatchSections = 16;
+
+using RecordList = PipelineEmitter::RecordList;
+
+static size_t ListIndex(RecordList list)
+{
+    return static_cast<size_t>(list);
+}
+
+// Sits between an emitter and the file: passes the text on, if there is a file, and cuts it into
+// the node and link entries and the text around them. Only the text since the last entry is kept.
+// An entry runs from the indent of its "-" to its last character, the line breaks between
+// entries belong to none of them, so that the text of an entry does not depend on where it is.
+class RecordingStreamBuffer : public std::streambuf, public PipelineEmitter::RecordObserver
+{
+public:
+    struct Record
+    {
+        RecordList       m_list;
+        size_t           m_offset;
+        std::string_view m_text;
+    };
+    using RecordHandler = std::function<void(const Record&)>;
+
+    RecordingStreamBuffer(std::streambuf* target, RecordHandler onRecord)
+        : m_target(target)
+        , m_onRecord(std::move(onRecord))
+        , m_pending()
+        , m_pendingOffset(0)
+        , m_surroundingHash(0)
+        , m_keyIndent()
+    {
+    }
+
+    void OnRecord(RecordList list, size_t begin, size_t end) override
+    {
+        const std::string_view pending(m_pending);
+        size_t                 recordBegin = begin;
+        if (recordBegin < end && pending[recordBegin - m_pendingOffset] == '\n')
+        {
+            ++recordBegin;
+        }
+        AddSurrounding(pending.substr(0, recordBegin - m_pendingOffset));
+        m_onRecord(Record{list, recordBegin,
+                          pending.substr(recordBegin - m_pendingOffset, end - recordBegin)});
+        m_pending.erase(0, end - m_pendingOffset);
+        m_pendingOffset = end;
+    }
+
+    // once the emitter is done
+    void Finish()
+    {
+        AddSurrounding(m_pending);
+        m_pendingOffset += m_pending.size();
+        m_pending.clear();
+    }
+
+    size_t             GetSize() const { return m_pendingOffset + m_pending.size(); }
+    uint64_t           GetSurroundingHash() const { return m_surroundingHash; }
+    const std::string& GetKeyIndent() const { return m_keyIndent; }
+
+protected:
+    std::streamsize xsputn(const char* text, std::streamsize count) override
+    {
+        if (m_target && m_target->sputn(text, count) != count)
+        {
+            return 0;
+        }
+        m_pending.append(text, static_cast<size_t>(count));
+        return count;
+    }
+
+    int_type overflow(int_type value) override
+    {
+        if (traits_type::eq_int_type(value, traits_type::eof()))
+        {
+            return traits_type::not_eof(value);
+        }
+        const char character = traits_type::to_char_type(value);
+        return xsputn(&character, 1) == 1 ? value : traits_type::eof();
+    }
+
+    int sync() override { return m_target ? m_target->pubsync() : 0; }
+
+private:
+    void AddSurrounding(std::string_view text)
+    {
+        if (text == "\n")
+        {
+            // between two entries of a list
+            return;
+        }
+        m_surroundingHash = m_surroundingHash * 31 + PipelineCache::HashContent(text);
+
+        // the first entry of a list follows the line of its key
+        if (m_keyIndent.empty() && text.ends_with(":\n"))
+        {
+            const std::string_view keyLine = text.substr(text.rfind('\n', text.size() - 2) + 1);
+            m_keyIndent = std::string(keyLine.substr(0, keyLine.find_first_not_of(' ')));
+        }
+    }
+
+    std::streambuf* m_target; // nullptr when the text only is looked at
+    RecordHandler   m_onRecord;
+    std::string     m_pending; // emitted since the last entry
+    size_t          m_pendingOffset;
+    uint64_t        m_surroundingHash;
+    std::string     m_keyIndent;
+};
+
+PipelineFileLayout::PipelineFileLayout()
+    : m_target()
+    , m_slots()
+    , m_fileSize(0)
+    , m_modifiedTime(0)
+    , m_surroundingHash(0)
+    , m_keyIndent()
+    , m_patchSections(0)
+{
+}
+
+bool PipelineFileLayout::IsFor(const std::string& target) const
+{
+    return !m_target.empty() && m_target == target;
+}
+
+void PipelineFileLayout::Reset()
+{
+    m_target.clear();
+    m_slots.clear();
+    m_fileSize        = 0;
+    m_modifiedTime    = 0;
+    m_surroundingHash = 0;
+    m_keyIndent.clear();
+    m_patchSections = 0;
+}
+
+bool PipelineFileLayout::WriteAll(const std::string& target, std::ostream& output,
+                                  const EmitFunction& emit)
+{
+    Reset();
+    if (!output.rdbuf())
+    {
+        return false;
+    }
+
+    std::vector<Patch::Slot> slots;
+    RecordingStreamBuffer    buffer(output.rdbuf(),
+                                    [&slots](const RecordingStreamBuffer::Record& record)
+                                    {
+                                        slots.push_back(Patch::Slot{
+                                            record.m_list, record.m_offset, record.m_text.size(),
+                                            record.m_text.size(),
+                                            PipelineCache::HashContent(record.m_text)});
+                                    });
+    std::ostream    stream(&buffer);
+    PipelineEmitter emitter(stream);
+    emitter.SetRecordObserver(&buffer);
+    emit(emitter);
+    buffer.Finish();
+    output.flush();
+    if (!emitter.GetEmitter().good() || !stream.good() || !output.good())
+    {
+        SNELOG_ERROR("failed to write pipeline [{}]: {}", target,
+                     emitter.GetEmitter().GetLastError());
+        return false;
+    }
+
+    m_target          = target;
+    m_slots           = std::move(slots);
+    m_fileSize        = buffer.GetSize();
+    m_surroundingHash = buffer.GetSurroundingHash();
+    m_keyIndent       = buffer.GetKeyIndent();
+    return true;
+}
+
+std::optional<PipelineFileLayout::Patch> PipelineFileLayout::PlanChanges(
+    const EmitFunction& emit) const
+{
+    if (m_target.empty() || m_keyIndent.empty())
+    {
+        return std::nullopt;
+    }
+
+    // an entry whose text is in a slot already stays there
+    std::unordered_multimap<uint64_t, size_t> filledSlots;
+    for (size_t index = 0; index < m_slots.size(); ++index)
+    {
+        if (m_slots[index].m_length > 0)
+        {
+            filledSlots.emplace(m_slots[index].m_hash, index);
+        }
+    }
+    std::vector<bool> unchanged(m_slots.size(), false);
+
+    struct ChangedRecord
+    {
+        RecordList  m_list;
+        uint64_t    m_hash;
+        std::string m_text;
+    };
+    std::vector<ChangedRecord> changedRecords;
+    RecordingStreamBuffer      buffer(
+        nullptr,
+        [&](const RecordingStreamBuffer::Record& record)
+        {
+            const uint64_t hash = PipelineCache::HashContent(record.m_text);
+            auto [first, last]  = filledSlots.equal_range(hash);
+            for (auto it = first; it != last; ++it)
+            {
+                const Patch::Slot& slot = m_slots[it->second];
+                if (slot.m_list == record.m_list && slot.m_length == record.m_text.size())
+                {
+                    unchanged[it->second] = true;
+                    filledSlots.erase(it);
+                    return;
+                }
+            }
+            changedRecords.push_back(ChangedRecord{record.m_list, hash, std::string(record.m_text)});
+        });
+    std::ostream    stream(&buffer);
+    PipelineEmitter emitter(stream);
+    emitter.SetRecordObserver(&buffer);
+    emit(emitter);
+    buffer.Finish();
+    if (!emitter.GetEmitter().good() || buffer.GetSurroundingHash() != m_surroundingHash)
+    {
+        return std::nullopt;
+    }
+
+    Patch patch;
+    patch.m_slots         = m_slots;
+    patch.m_fileSize      = m_fileSize;
+    patch.m_patchSections = m_patchSections;
+
+    // slots of entries that are gone or changed are free, like those blanked before
+    std::vector<std::string>      slotTexts(m_slots.size());
+    std::vector<bool>             slotWritten(m_slots.size(), false);
+    std::multimap<size_t, size_t> freeSlots[2]; // capacity to index, per list
+    for (size_t index = 0; index < patch.m_slots.size(); ++index)
+    {
+        Patch::Slot& slot = patch.m_slots[index];
+        if (unchanged[index])
+        {
+            continue;
+        }
+        if (slot.m_length > 0)
+        {
+            slot.m_length      = 0;
+            slotWritten[index] = true;
+        }
+        freeSlots[ListIndex(slot.m_list)].emplace(slot.m_capacity, index);
+    }
+
+    std::vector<ChangedRecord> appendedRecords[2];
+    for (ChangedRecord& record : changedRecords)
+    {
+        auto& listSlots = freeSlots[ListIndex(record.m_list)];
+        auto  it        = listSlots.lower_bound(record.m_text.size());
+        if (it == listSlots.end())
+        {
+            appendedRecords[ListIndex(record.m_list)].push_back(std::move(record));
+            continue;
+        }
+        Patch::Slot& slot       = patch.m_slots[it->second];
+        slot.m_length           = record.m_text.size();
+        slot.m_hash             = record.m_hash;
+        slotTexts[it->second]   = std::move(record.m_text);
+        slotWritten[it->second] = true;
+        listSlots.erase(it);
+    }
+
+    for (size_t index = 0; index < patch.m_slots.size(); ++index)
+    {
+        if (slotWritten[index])
+        {
+            std::string& text = slotTexts[index];
+            text.resize(patch.m_slots[index].m_capacity, ' ');
+            patch.m_writes.push_back(
+                Patch::Write{index, patch.m_slots[index].m_offset, std::move(text)});
+        }
+    }
+
+    for (RecordList list : {RecordList::NodeList, RecordList::LinkList})
+    {
+        if (appendedRecords[ListIndex(list)].empty())
+        {
+            continue;
+        }
+        patch.m_appended += "\n" + m_keyIndent +
+                            (list == RecordList::NodeList ? "NodeListPatch" : "LinkListPatch") +
+                            std::to_string(++patch.m_patchSections) + ":";
+        for (ChangedRecord& record : appendedRecords[ListIndex(list)])
+        {
+            patch.m_appended += "\n";
+            patch.m_slots.push_back(Patch::Slot{list, m_fileSize + patch.m_appended.size(),
+                                                record.m_text.size(), record.m_text.size(),
+                                                record.m_hash});
+            patch.m_appended += record.m_text;
+        }
+    }
+    patch.m_fileSize += patch.m_appended.size();
+
+    size_t blankBytes = 0;
+    for (const Patch::Slot& slot : patch.m_slots)
+    {
+        blankBytes += slot.m_capacity - slot.m_length;
+    }
+    if (patch.m_patchSections > s_maxPatchSections ||
+        static_cast<double>(blankBytes) > s_maxBlankFraction * static_cast<double>(patch.m_fileSize))
+    {
+        return std::nullopt;
+    }
+    return patch;
+}
+
+bool PipelineFileLayout::SlotHoldsSaved(const Patch::Slot& slot, std::istream& saved) const
+{
+    std::string text(slot.m_capacity, '\0');
+    saved.seekg(static_cast<std::streamoff>(slot.m_offset));
+    saved.read(text.data(), static_cast<std::streamsize>(text.size()));
+    if (!saved)
+    {
+        return false;
+    }
+    // a free slot is all blank, a filled one holds its text padded with spaces
+    const std::string_view held(text);
+    return (slot.m_length == 0 ||
+            PipelineCache::HashContent(held.substr(0, slot.m_length)) == slot.m_hash) &&
+           held.find_first_not_of(' ', slot.m_length) == std::string_view::npos;
+}
+
+bool PipelineFileLayout::ApplyChanges(Patch patch, std::time_t modifiedTime, int64_t fileSize,
+                                      std::istream& saved, std::ostream& output)
+{
+    // the file may have been changed by something else since it was saved. The file system tells
+    // its time and size, of its content only the slots about to be overwritten are read, a remote
+    // file is not downloaded again on every save
+    bool isSaved = modifiedTime == m_modifiedTime && fileSize >= 0 &&
+                   static_cast<size_t>(fileSize) == m_fileSize;
+    for (size_t index = 0; isSaved && index < patch.m_writes.size(); ++index)
+    {
+        isSaved = SlotHoldsSaved(m_slots[patch.m_writes[index].m_slot], saved);
+    }
+    if (!isSaved)
+    {
+        SNELOG_WARN("[{}] is not the file last saved, it is written again", m_target);
+        Reset();
+        return false;
+    }
+
+    for (const Patch::Write& write : patch.m_writes)
+    {
+        output.seekp(static_cast<std::streamoff>(write.m_offset));
+        output.write(write.m_text.data(), static_cast<std::streamsize>(write.m_text.size()));
+    }
+    output.seekp(static_cast<std::streamoff>(m_fileSize));
+    output.write(patch.m_appended.data(), static_cast<std::streamsize>(patch.m_appended.size()));
+    output.flush();
+    if (!output.good())
+    {
+        SNELOG_ERROR("failed to write the changes to [{}]", m_target);
+        Reset();
+        return false;
+    }
+
+    SNELOG_INFO("saved [{}] by rewriting {} entries and appending {} bytes", m_target,
+                patch.m_writes.size(), patch.m_appended.size());
+    m_slots         = std::move(patch.m_slots);
+    m_fileSize      = patch.m_fileSize;
+    m_patchSections = patch.m_patchSections;
+    return true;
+}
+
+} // namespace SimpleNodeEditor
@@ -0,0 +1,246 @@
+#include "PipelineLoader.hpp"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include "Log.hpp"
+#include "PipelineCache.hpp"
+#include "YamlParser.hpp"
+
+namespace SimpleNodeEditor
+{
+
+// Passes the reads on to another stream buffer and counts the bytes going through
+class ProgressStreamBuffer : public std::streambuf
+{
+public:
+    ProgressStreamBuffer(std::streambuf& source, std::atomic<size_t>& bytesRead)
+        : m_source(source), m_bytesRead(bytesRead), m_buffer(64 * 1024)
+    {
+    }
+
+protected:
+    int_type underflow() override
+    {
+        const std::streamsize count =
+            m_source.sgetn(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+        if (count <= 0)
+        {
+            return traits_type::eof();
+        }
+        m_bytesRead.fetch_add(static_cast<size_t>(count), std::memory_order_relaxed);
+        setg(m_buffer.data(), m_buffer.data(), m_buffer.data() + count);
+        return traits_type::to_int_type(m_buffer[0]);
+    }
+
+private:
+    std::streambuf&      m_source;
+    std::atomic<size_t>& m_bytesRead;
+    std::vector<char>    m_buffer;
+};
+
+static void FillResult(PipelineParser& parser, PipelineLoader::Result& result)
+{
+    result.m_succeeded    = true;
+    result.m_pipelineName = parser.GetPipelineName();
+    result.m_nodes        = parser.ParseNodes();
+    result.m_edges        = parser.ParseEdges();
+}
+
+// also when the load failed, they may tell why
+static void TakeDiagnostics(PipelineParser& parser, PipelineLoader::Result& result)
+{
+    result.m_errors   = parser.TakeErrors();
+    result.m_warnings = parser.TakeWarnings();
+}
+
+PipelineLoader::~PipelineLoader()
+{
+    Cancel();
+}
+
+void PipelineLoader::Load(const std::string& filePath)
+{
+    Request request;
+    request.m_filePath   = filePath;
+    request.m_sourceName = filePath;
+    Enqueue(std::move(request));
+}
+
+void PipelineLoader::Load(std::unique_ptr<std::istream> inputStream, const std::string& sourceName)
+{
+    Request request;
+    request.m_inputStream = std::move(inputStream);
+    request.m_sourceName  = sourceName;
+    Enqueue(std::move(request));
+}
+
+void PipelineLoader::Load(std::unique_ptr<FS::MappedFile> mappedFile, const std::string& filePath)
+{
+    Request request;
+    request.m_filePath   = filePath;
+    request.m_mappedFile = std::move(mappedFile);
+    request.m_sourceName = filePath;
+    Enqueue(std::move(request));
+}
+
+void PipelineLoader::Enqueue(Request request)
+{
+    request.m_cacheDirectory = m_cacheDirectory;
+    if (IsBusy())
+    {
+        // the running load is not wanted anymore, the new one starts once it has stopped
+        m_progress->m_cancelled = true;
+        m_pending               = std::move(request);
+        return;
+    }
+    Launch(std::move(request));
+}
+
+std::optional<PipelineLoader::Result> PipelineLoader::Poll()
+{
+    if (!m_running.valid() ||
+        m_running.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    {
+        return std::nullopt;
+    }
+
+    std::optional<Result> result = m_running.get();
+    if (m_progress->m_cancelled)
+    {
+        SNELOG_INFO("loading [{}] cancelled", result->m_sourceName);
+        result.reset();
+    }
+
+    if (m_pending)
+    {
+        Launch(std::move(*m_pending));
+        m_pending.reset();
+    }
+    return result;
+}
+
+void PipelineLoader::Cancel()
+{
+    m_pending.reset();
+    if (m_running.valid())
+    {
+        m_progress->m_cancelled = true;
+    }
+}
+
+bool PipelineLoader::IsBusy() const
+{
+    return m_running.valid();
+}
+
+std::pair<size_t, size_t> PipelineLoader::GetProgress() const
+{
+    if (!m_progress)
+    {
+        return {0, 0};
+    }
+    return {m_progress->m_bytesRead.load(std::memory_order_relaxed),
+            m_progress->m_bytesTotal.load(std::memory_order_relaxed)};
+}
+
+void PipelineLoader::Launch(Request request)
+{
+    m_progress          = std::make_shared<Progress>();
+    m_runningSourceName = request.m_sourceName;
+    m_running           = std::async(std::launch::async,
+                                     [request = std::move(request), progress = m_progress]() mutable
+                                     { return Run(std::move(request), *progress); });
+}
+
+PipelineLoader::Result PipelineLoader::Run(Request request, Progress& progress)
+{
+    Result result;
+    result.m_sourceName = request.m_sourceName;
+
+    std::unique_ptr<FS::MappedFile> mappedFile = std::move(request.m_mappedFile);
+    if (!mappedFile && !request.m_filePath.empty())
+    {
+        mappedFile = FS::MappedFile::Open(request.m_filePath);
+    }
+    if (mappedFile)
+    {
+        // nothing to wait for but the parser, the kernel reads the pages as they are needed
+        const std::string_view content = mappedFile->GetView();
+        progress.m_bytesTotal          = content.size();
+        progress.m_bytesRead           = content.size();
+
+        const PipelineCache cache(request.m_cacheDirectory);
+        const bool          useCache    = cache.IsEnabled() && !request.m_filePath.empty();
+        const uint64_t      contentHash = useCache ? PipelineCache::HashContent(content) : 0;
+        if (useCache && cache.Load(request.m_filePath, contentHash, result.m_pipelineName,
+                                   result.m_nodes, result.m_edges))
+        {
+            result.m_succeeded = true;
+            return result;
+        }
+
+        PipelineParser parser;
+        if (parser.LoadText(content, &progress.m_cancelled))
+        {
+            FillResult(parser, result);
+            if (useCache)
+            {
+                cache.Store(request.m_filePath, contentHash, result.m_pipelineName,
+                            result.m_nodes, result.m_edges);
+            }
+        }
+        TakeDiagnostics(parser, result);
+        return result;
+    }
+
+    // files that cannot be mapped, and remote ones, are read through a stream
+    std::unique_ptr<std::istream> input = std::move(request.m_inputStream);
+    if (!request.m_filePath.empty())
+    {
+        auto inputFile = std::make_unique<std::ifstream>(request.m_filePath, std::ios::binary);
+        if (!inputFile->is_open())
+        {
+            SNELOG_ERROR("cannot open pipeline file [{}]", request.m_filePath);
+            return result;
+        }
+        std::error_code errorCode;
+        const auto      fileSize = std::filesystem::file_size(request.m_filePath, errorCode);
+        if (!errorCode)
+        {
+            progress.m_bytesTotal = static_cast<size_t>(fileSize);
+        }
+        input = std::move(inputFile);
+    }
+    else if (input)
+    {
+        // remote streams report their size through fstat, streams that cannot seek leave the total unknown
+        const std::streampos begin = input->tellg();
+        if (begin != std::streampos(-1) && input->seekg(0, std::ios::end))
+        {
+            const std::streampos end = input->tellg();
+            if (end != std::streampos(-1) && end >= begin)
+            {
+                progress.m_bytesTotal = static_cast<size_t>(end - begin);
+            }
+            input->seekg(begin);
+        }
+        input->clear();
+    }
+    if (!input || !input->rdbuf())
+    {
+        SNELOG_ERROR("invalid input stream for [{}]", request.m_sourceName);
+        return result;
+    }
+
+    ProgressStreamBuffer progressBuffer(*input->rdbuf(), progress.m_bytesRead);
+    std::istream         progressStream(&progressBuffer);
+    PipelineParser       parser;
+    if (parser.LoadStream(progressStream, &progress.m_cancelled))
+    {
+        FillResult(parser, result);
+    }
+    TakeDiagnostics(parser, result);
+    return result;
+}
+
+} // namespace SimpleNodeEditor
@@ -0,0 +1,88 @@
+#include "RouteWorker.hpp"
+#include <chrono>
+
+namespace SimpleNodeEditor
+{
+
+RouteWorker::RouteWorker() : m_router(std::make_unique<OrthogonalRouter>()) {}
+
+void RouteWorker::Request(OrthogonalRouter::Changes changes)
+{
+    if (IsBusy())
+    {
+        if (m_pending)
+        {
+            m_pending->Merge(std::move(changes));
+        }
+        else
+        {
+            m_pending = std::move(changes);
+        }
+        return;
+    }
+    Launch(std::move(changes));
+}
+
+std::optional<RouteWorker::Result> RouteWorker::Poll()
+{
+    if (!m_running.valid() ||
+        m_running.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    {
+        return std::nullopt;
+    }
+
+    Task                  task = m_running.get();
+    std::optional<Result> result;
+    if (m_dropRunning)
+    {
+        m_router      = std::make_unique<OrthogonalRouter>();
+        m_dropRunning = false;
+    }
+    else
+    {
+        m_router = std::move(task.first);
+        result   = std::move(task.second);
+    }
+
+    if (m_pending)
+    {
+        Launch(std::move(*m_pending));
+        m_pending.reset();
+    }
+    return result;
+}
+
+void RouteWorker::Reset()
+{
+    m_pending.reset();
+    if (m_running.valid())
+    {
+        m_dropRunning = true;
+    }
+    else
+    {
+        m_router->Clear();
+    }
+}
+
+bool RouteWorker::IsBusy() const
+{
+    return m_running.valid();
+}
+
+void RouteWorker::Launch(OrthogonalRouter::Changes changes)
+{
+    m_running = std::async(std::launch::async,
+                           [router = std::move(m_router), changes = std::move(changes)]() mutable
+                           {
+                               Result result;
+                               result.m_removedEdges = changes.m_removedEdges;
+                               for (EdgeUniqueId edgeUid : router->Apply(changes))
+                               {
+                                   result.m_routes.emplace(edgeUid, *router->GetRoute(edgeUid));
+                               }
+                               return Task(std::move(router), std::move(result));
+                           });
+}
+
+} // namespace SimpleNodeEditor
@@ -0,0 +1,648 @@
+#include "TopologicalOrder.hpp"
+#include "Log.hpp"
+#include "Common.hpp"
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <span>
+
+namespace SimpleNodeEditor
+{
+
+TopologicalOrder::TopologicalOrder()
+    : m_slotOfNode(),
+      m_nodeOfSlot(),
+      m_order(),
+      m_levels(),
+      m_slotsOfLevel(),
+      m_indexInLevel(),
+      m_successors(),
+      m_predecessors(),
+      m_freeSlots(),
+      m_untrackedEdges(),
+      m_untrackedSuccessors(),
+      m_nextOrder(0),
+      m_batchUpdating(false),
+      m_revision(0),
+      m_relevelled(),
+      m_relevelledSlots()
+{
+}
+
+int TopologicalOrder::FindSlot(NodeUniqueId nodeUid) const
+{
+    auto iter = m_slotOfNode.find(nodeUid);
+    return iter != m_slotOfNode.end() ? iter->second : -1;
+}
+
+int TopologicalOrder::AllocSlot(NodeUniqueId nodeUid)
+{
+    int slot;
+    if (m_freeSlots.empty())
+    {
+        slot = static_cast<int>(m_nodeOfSlot.size());
+        m_nodeOfSlot.push_back(-1);
+        m_order.push_back(0);
+        m_levels.push_back(0);
+        m_indexInLevel.push_back(0);
+        m_successors.emplace_back();
+        m_predecessors.emplace_back();
+        m_untrackedSuccessors.emplace_back();
+        m_visited.push_back(0);
+        m_relevelled.push_back(0);
+    }
+    else
+    {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+
+    m_nodeOfSlot[slot] = nodeUid;
+    // a node without edges can go anywhere, the end of the order is as good as any place
+    m_order[slot]  = m_nextOrder++;
+    m_levels[slot] = 0;
+    if (m_slotsOfLevel.empty())
+    {
+        m_slotsOfLevel.emplace_back();
+    }
+    m_indexInLevel[slot] = static_cast<int>(m_slotsOfLevel[0].size());
+    m_slotsOfLevel[0].push_back(slot);
+    m_slotOfNode.emplace(nodeUid, slot);
+    return slot;
+}
+
+void TopologicalOrder::AddNode(NodeUniqueId nodeUid)
+{
+    if (m_slotOfNode.contains(nodeUid))
+    {
+        SNELOG_ERROR("node[{}] is already in the topological order, check it!", nodeUid);
+        return;
+    }
+    AllocSlot(nodeUid);
+    ++m_revision;
+}
+
+void TopologicalOrder::RemoveNode(NodeUniqueId nodeUid)
+{
+    const int slot = FindSlot(nodeUid);
+    if (slot == -1)
+    {
+        SNELOG_ERROR("removing node[{}] which is not in the topological order, check it!", nodeUid);
+        return;
+    }
+    SNE_ASSERT(m_successors[slot].empty() && m_predecessors[slot].empty() &&
+                   m_untrackedSuccessors[slot].empty(),
+               "edges of the node should have been removed before the node");
+
+    UnlinkFromLevel(slot);
+    m_slotOfNode.erase(nodeUid);
+    m_nodeOfSlot[slot] = -1;
+    m_freeSlots.push_back(slot);
+    ++m_revision;
+}
+
+// Pearce-Kelly: the order only needs fixing when dst comes before src. The affected region is
+// then made of the nodes reachable from dst that come before src, and of the nodes reaching src
+// that come after dst.
+bool TopologicalOrder::AddEdge(NodeUniqueId srcNodeUid, NodeUniqueId dstNodeUid)
+{
+    if (m_batchUpdating)
+    {
+        ++m_revision;
+        return true;
+    }
+
+    const int srcSlot = FindSlot(srcNodeUid);
+    const int dstSlot = FindSlot(dstNodeUid);
+    if (srcSlot == -1 || dstSlot == -1)
+    {
+        SNELOG_ERROR("edge between nodes not in the topological order, srcNodeUid[{}] dstNodeUid[{}]",
+                     srcNodeUid, dstNodeUid);
+        return true;
+    }
+
+    // the edges inside untracked cycles are not in the tracked graph, a new cycle may go through
+    // them all the same
+    if (!m_untrackedEdges.empty() && ReachesThroughUntracked(dstSlot, srcSlot))
+    {
+        return false;
+    }
+    return TrackEdge(srcSlot, dstSlot);
+}
+
+bool TopologicalOrder::RestoreEdge(NodeUniqueId srcNodeUid, NodeUniqueId dstNodeUid)
+{
+    if (AddEdge(srcNodeUid, dstNodeUid))
+    {
+        return true;
+    }
+    // AddEdge only turns down edges between known nodes
+    KeepUntracked(FindSlot(srcNodeUid), FindSlot(dstNodeUid));
+    ++m_revision;
+    return false;
+}
+
+void TopologicalOrder::KeepUntracked(int srcSlot, int dstSlot)
+{
+    m_untrackedEdges.emplace_back(srcSlot, dstSlot);
+    m_untrackedSuccessors[srcSlot].push_back(dstSlot);
+}
+
+bool TopologicalOrder::TrackEdge(int srcSlot, int dstSlot)
+{
+    if (srcSlot == dstSlot)
+    {
+        return false;
+    }
+
+    if (m_order[dstSlot] < m_order[srcSlot])
+    {
+        if (!CollectForward(dstSlot, m_order[srcSlot]))
+        {
+            return false;
+        }
+        CollectBackward(srcSlot, m_order[dstSlot]);
+        Reorder();
+    }
+
+    m_successors[srcSlot].push_back(dstSlot);
+    m_predecessors[dstSlot].push_back(srcSlot);
+    ++m_revision;
+
+    if (m_levels[dstSlot] < m_levels[srcSlot] + 1)
+    {
+        SetLevel(dstSlot, m_levels[srcSlot] + 1);
+        RaiseLevels(dstSlot);
+    }
+    return true;
+}
+
+void TopologicalOrder::RemoveEdge(NodeUniqueId srcNodeUid, NodeUniqueId dstNodeUid)
+{
+    if (m_batchUpdating)
+    {
+        ++m_revision;
+        return;
+    }
+
+    const int srcSlot = FindSlot(srcNodeUid);
+    const int dstSlot = FindSlot(dstNodeUid);
+    if (srcSlot == -1 || dstSlot == -1)
+    {
+        SNELOG_ERROR("edge between nodes not in the topological order, srcNodeUid[{}] dstNodeUid[{}]",
+                     srcNodeUid, dstNodeUid);
+        return;
+    }
+
+    auto eraseOne = [](std::vector<int>& slots, int slot)
+    {
+        auto iter = std::find(slots.begin(), slots.end(), slot);
+        if (iter == slots.end())
+        {
+            return false;
+        }
+        *iter = slots.back();
+        slots.pop_back();
+        return true;
+    };
+    if (!eraseOne(m_successors[srcSlot], dstSlot) || !eraseOne(m_predecessors[dstSlot], srcSlot))
+    {
+        auto iter = std::find(m_untrackedEdges.begin(), m_untrackedEdges.end(),
+                              std::make_pair(srcSlot, dstSlot));
+        if (iter == m_untrackedEdges.end())
+        {
+            SNELOG_ERROR("removing unknown edge from topological order, srcNodeUid[{}] dstNodeUid[{}]",
+                         srcNodeUid, dstNodeUid);
+            return;
+        }
+        *iter = m_untrackedEdges.back();
+        m_untrackedEdges.pop_back();
+        eraseOne(m_untrackedSuccessors[srcSlot], dstSlot);
+        ++m_revision;
+        RetrackEdges();
+        return;
+    }
+
+    ++m_revision;
+
+    // removing an edge never breaks the order, only levels may go down
+    LowerLevels(std::span<const int>(&dstSlot, 1));
+    // but it may break a cycle
+    RetrackEdges();
+}
+
+// Give the untracked edges another try. Tracking more edges can only close more cycles, so a
+// single pass is enough: an edge rejected here still sits on a cycle.
+// Nodes of a cycle were given the level of the whole cycle, which may be more than what their own
+// predecessors ask for once the cycle is gone, so the levels of the retracked edges' ends are
+// recomputed as well.
+void TopologicalOrder::RetrackEdges()
+{
+    if (m_untrackedEdges.empty())
+    {
+        return;
+    }
+
+    std::vector<std::pair<int, int>> untrackedEdges;
+    std::vector<int>                 retrackedSlots;
+    untrackedEdges.swap(m_untrackedEdges);
+    for (const auto& [srcSlot, _] : untrackedEdges)
+    {
+        m_untrackedSuccessors[srcSlot].clear();
+    }
+    for (const auto& [srcSlot, dstSlot] : untrackedEdges)
+    {
+        if (TrackEdge(srcSlot, dstSlot))
+        {
+            retrackedSlots.push_back(srcSlot);
+            retrackedSlots.push_back(dstSlot);
+        }
+        else
+        {
+            KeepUntracked(srcSlot, dstSlot);
+        }
+    }
+    LowerLevels(retrackedSlots);
+}
+
+// Depth first search from startSlot over both the tracked and the untracked edges. Tracked edges
+// only go forward in the order, so past targetSlot and past the last source of an untracked edge
+// nothing leads back to targetSlot, the search stops there like CollectForward does.
+bool TopologicalOrder::ReachesThroughUntracked(int startSlot, int targetSlot)
+{
+    int upperBound = m_order[targetSlot];
+    for (const auto& [srcSlot, _] : m_untrackedEdges)
+    {
+        upperBound = std::max(upperBound, m_order[srcSlot]);
+    }
+    if (m_order[startSlot] > upperBound)
+    {
+        return false;
+    }
+
+    m_forward.clear();
+    m_stack.clear();
+    m_stack.push_back(startSlot);
+    m_visited[startSlot] = 1;
+
+    bool reached = false;
+    auto visit   = [&](int succ)
+    {
+        if (succ == targetSlot)
+        {
+            reached = true;
+        }
+        else if (!m_visited[succ] && m_order[succ] <= upperBound)
+        {
+            m_visited[succ] = 1;
+            m_stack.push_back(succ);
+        }
+    };
+    while (!m_stack.empty() && !reached)
+    {
+        const int slot = m_stack.back();
+        m_stack.pop_back();
+        m_forward.push_back(slot);
+        for (int succ : m_successors[slot])
+        {
+            visit(succ);
+        }
+        for (int succ : m_untrackedSuccessors[slot])
+        {
+            visit(succ);
+        }
+    }
+
+    for (int slot : m_forward)
+    {
+        m_visited[slot] = 0;
+    }
+    for (int slot : m_stack)
+    {
+        m_visited[slot] = 0;
+    }
+    return reached;
+}
+
+// Depth first search from startSlot over the nodes placed before upperBound. Reaching the node at
+// upperBound means the new edge closes a cycle.
+bool TopologicalOrder::CollectForward(int startSlot, int upperBound)
+{
+    m_forward.clear();
+    m_stack.clear();
+    m_stack.push_back(startSlot);
+    m_visited[startSlot] = 1;
+
+    bool hasCycle = false;
+    while (!m_stack.empty() && !hasCycle)
+    {
+        const int slot = m_stack.back();
+        m_stack.pop_back();
+        m_forward.push_back(slot);
+        for (int succ : m_successors[slot])
+        {
+            if (m_order[succ] == upperBound)
+            {
+                hasCycle = true;
+                break;
+            }
+            if (!m_visited[succ] && m_order[succ] < upperBound)
+            {
+                m_visited[succ] = 1;
+                m_stack.push_back(succ);
+            }
+        }
+    }
+
+    if (hasCycle)
+    {
+        for (int slot : m_forward)
+        {
+            m_visited[slot] = 0;
+        }
+        for (int slot : m_stack)
+        {
+            m_visited[slot] = 0;
+        }
+    }
+    return !hasCycle;
+}
+
+// Depth first search backwards from startSlot over the nodes placed after lowerBound
+void TopologicalOrder::CollectBackward(int startSlot, int lowerBound)
+{
+    m_backward.clear();
+    m_stack.clear();
+    m_stack.push_back(startSlot);
+    m_visited[startSlot] = 1;
+
+    while (!m_stack.empty())
+    {
+        const int slot = m_stack.back();
+        m_stack.pop_back();
+        m_backward.push_back(slot);
+        for (int pred : m_predecessors[slot])
+        {
+            if (!m_visited[pred] && m_order[pred] > lowerBound)
+            {
+                m_visited[pred] = 1;
+                m_stack.push_back(pred);
+            }
+        }
+    }
+}
+
+// Hand the positions held by the affected nodes back out: first to the nodes reaching src, then to
+// the nodes reachable from dst, keeping the relative order inside each group.
+void TopologicalOrder::Reorder()
+{
+    auto byOrder = [this](int lhs, int rhs) { return m_order[lhs] < m_order[rhs]; };
+    std::sort(m_backward.begin(), m_backward.end(), byOrder);
+    std::sort(m_forward.begin(), m_forward.end(), byOrder);
+
+    m_positions.clear();
+    for (int slot : m_backward)
+    {
+        m_positions.push_back(m_order[slot]);
+    }
+    for (int slot : m_forward)
+    {
+        m_positions.push_back(m_order[slot]);
+    }
+    std::sort(m_positions.begin(), m_positions.end());
+
+    size_t index = 0;
+    for (int slot : m_backward)
+    {
+        m_order[slot]   = m_positions[index++];
+        m_visited[slot] = 0;
+    }
+    for (int slot : m_forward)
+    {
+        m_order[slot]   = m_positions[index++];
+        m_visited[slot] = 0;
+    }
+}
+
+void TopologicalOrder::SetLevel(int slot, int level)
+{
+    MoveToLevel(slot, level);
+    if (!m_relevelled[slot])
+    {
+        m_relevelled[slot] = 1;
+        m_relevelledSlots.push_back(slot);
+    }
+}
+
+void TopologicalOrder::MoveToLevel(int slot, int level)
+{
+    UnlinkFromLevel(slot);
+    if (m_slotsOfLevel.size() <= static_cast<size_t>(level))
+    {
+        m_slotsOfLevel.resize(level + 1);
+    }
+    m_levels[slot]       = level;
+    m_indexInLevel[slot] = static_cast<int>(m_slotsOfLevel[level].size());
+    m_slotsOfLevel[level].push_back(slot);
+}
+
+// the last slot of the level takes the place of the removed one
+void TopologicalOrder::UnlinkFromLevel(int slot)
+{
+    std::vector<int>& slots = m_slotsOfLevel[m_levels[slot]];
+    const int         index = m_indexInLevel[slot];
+    slots[index]                 = slots.back();
+    m_indexInLevel[slots[index]] = index;
+    slots.pop_back();
+}
+
+// Levels are propagated in topological order, so every node is settled once all of its
+// predecessors are, and is processed at most once.
+void TopologicalOrder::RaiseLevels(int startSlot)
+{
+    using Entry = std::pair<int, int>; // order, slot
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> pending;
+    pending.emplace(m_order[startSlot], startSlot);
+
+    while (!pending.empty())
+    {
+        const int slot = pending.top().second;
+        pending.pop();
+        for (int succ : m_successors[slot])
+        {
+            if (m_levels[succ] < m_levels[slot] + 1)
+            {
+                if (!m_visited[succ])
+                {
+                    m_visited[succ] = 1;
+                    pending.emplace(m_order[succ], succ);
+                }
+                SetLevel(succ, m_levels[slot] + 1);
+            }
+        }
+        m_visited[slot] = 0;
+    }
+}
+
+void TopologicalOrder::LowerLevels(std::span<const int> startSlots)
+{
+    using Entry = std::pair<int, int>; // order, slot
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> pending;
+    for (int startSlot : startSlots)
+    {
+        if (!m_visited[startSlot])
+        {
+            m_visited[startSlot] = 1;
+            pending.emplace(m_order[startSlot], startSlot);
+        }
+    }
+
+    while (!pending.empty())
+    {
+        const int slot = pending.top().second;
+        pending.pop();
+        m_visited[slot] = 0;
+
+        int level = 0;
+        for (int pred : m_predecessors[slot])
+        {
+            level = std::max(level, m_levels[pred] + 1);
+        }
+        if (level == m_levels[slot])
+        {
+            continue;
+        }
+
+        SetLevel(slot, level);
+        for (int succ : m_successors[slot])
+        {
+            if (!m_visited[succ])
+            {
+                m_visited[succ] = 1;
+                pending.emplace(m_order[succ], succ);
+            }
+        }
+    }
+}
+
+int TopologicalOrder::GetLevel(NodeUniqueId nodeUid) const
+{
+    const int slot = FindSlot(nodeUid);
+    return slot != -1 ? m_levels[slot] : -1;
+}
+
+std::vector<std::vector<NodeUniqueId>> TopologicalOrder::GetLevels() const
+{
+    std::vector<int> slots;
+    slots.reserve(m_slotOfNode.size());
+    for (const auto& [_, slot] : m_slotOfNode)
+    {
+        if (m_levels[slot] >= 0)
+        {
+            slots.push_back(slot);
+        }
+    }
+    std::sort(slots.begin(), slots.end(),
+              [this](int lhs, int rhs) { return m_order[lhs] < m_order[rhs]; });
+
+    std::vector<std::vector<NodeUniqueId>> result;
+    for (int slot : slots)
+    {
+        const size_t level = static_cast<size_t>(m_levels[slot]);
+        if (result.size() <= level)
+        {
+            result.resize(level + 1);
+        }
+        result[level].push_back(m_nodeOfSlot[slot]);
+    }
+    return result;
+}
+
+std::vector<NodeUniqueId> TopologicalOrder::TakeRelevelledNodes()
+{
+    std::vector<NodeUniqueId> result;
+    result.reserve(m_relevelledSlots.size());
+    for (int slot : m_relevelledSlots)
+    {
+        m_relevelled[slot] = 0;
+        // the node may have been removed since, its slot may even hold another node by now
+        if (m_nodeOfSlot[slot] != -1)
+        {
+            result.push_back(m_nodeOfSlot[slot]);
+        }
+    }
+    m_relevelledSlots.clear();
+    return result;
+}
+
+void TopologicalOrder::BeginBatchUpdate()
+{
+    m_batchUpdating = true;
+}
+
+void TopologicalOrder::EndBatchUpdate(const std::unordered_map<NodeUniqueId, Node>& nodesMap,
+                                      const std::unordered_map<EdgeUniqueId, Edge>& edgesMap)
+{
+    m_batchUpdating = false;
+    Rebuild(nodesMap, edgesMap);
+}
+
+void TopologicalOrder::Rebuild(const std::unordered_map<NodeUniqueId, Node>& nodesMap,
+                               const std::unordered_map<EdgeUniqueId, Edge>& edgesMap)
+{
+    Clear();
+
+    // nodes of a cycle share a level, see CondensedTopologicalSort
+    const TopologicalLevels levels = FlatTopologicalSort(nodesMap, edgesMap);
+    for (size_t level = 0; level < levels.GetLevelCount(); ++level)
+    {
+        for (NodeUniqueId nodeUid : levels.GetLevel(level))
+        {
+            MoveToLevel(AllocSlot(nodeUid), static_cast<int>(level));
+        }
+    }
+
+    // only edges going up a level are tracked, which leaves out exactly the edges inside cycles and
+    // keeps the tracked graph acyclic
+    for (const auto& [_, edge] : edgesMap)
+    {
+        const int srcSlot = FindSlot(edge.GetSourceNodeUid());
+        const int dstSlot = FindSlot(edge.GetDestinationNodeUid());
+        if (srcSlot == -1 || dstSlot == -1)
+        {
+            continue;
+        }
+        if (m_levels[srcSlot] < m_levels[dstSlot])
+        {
+            m_successors[srcSlot].push_back(dstSlot);
+            m_predecessors[dstSlot].push_back(srcSlot);
+        }
+        else
+        {
+            KeepUntracked(srcSlot, dstSlot);
+        }
+    }
+}
+
+void TopologicalOrder::Clear()
+{
+    m_slotOfNode.clear();
+    m_nodeOfSlot.clear();
+    m_order.clear();
+    m_levels.clear();
+    m_slotsOfLevel.clear();
+    m_indexInLevel.clear();
+    m_successors.clear();
+    m_predecessors.clear();
+    m_freeSlots.clear();
+    m_untrackedEdges.clear();
+    m_untrackedSuccessors.clear();
+    m_visited.clear();
+    m_relevelled.clear();
+    m_relevelledSlots.clear();
+    m_nextOrder     = 0;
+    m_batchUpdating = false;
+    ++m_revision;
+}
+
+} // namespace SimpleNodeEditor
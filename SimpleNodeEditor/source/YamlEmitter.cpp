@@ -50,12 +50,23 @@ YAML::Emitter& operator<<(YAML::Emitter& out, const SimpleNodeEditor::YamlNode&
     {
         out << YAML::Key << "PruneRule" << YAML::Value << yamlnode.m_PruningRules;
     }
+
+    if (yamlnode.m_position)
+    {
+        out << YAML::Key << "Position" << YAML::Value << YAML::Flow << YAML::BeginSeq
+            << yamlnode.m_position->m_x << yamlnode.m_position->m_y << YAML::EndSeq;
+    }
     return out;
 }
 
 namespace SimpleNodeEditor
 {
-YamlEmitter::YamlEmitter() : m_Emitter(std::make_unique<YAML::Emitter>()) {}
+YamlEmitter::YamlEmitter() : m_stream(nullptr), m_Emitter(std::make_unique<YAML::Emitter>()) {}
+
+YamlEmitter::YamlEmitter(std::ostream& stream)
+    : m_stream(&stream), m_Emitter(std::make_unique<YAML::Emitter>(stream))
+{
+}
 
 void YamlEmitter::BeginMap()
 {
@@ -89,14 +100,29 @@ YAML::Emitter& YamlEmitter::GetEmitter()
 
 void YamlEmitter::Clear()
 {
-    m_Emitter = std::make_unique<YAML::Emitter>();
+    m_Emitter = m_stream ? std::make_unique<YAML::Emitter>(*m_stream)
+                         : std::make_unique<YAML::Emitter>();
 }
 
-PipelineEmitter::PipelineEmitter() : YamlEmitter() {}
+PipelineEmitter::PipelineEmitter() : YamlEmitter(), m_recordObserver(nullptr), m_dstPorts() {}
+
+PipelineEmitter::PipelineEmitter(std::ostream& stream)
+    : YamlEmitter(stream), m_recordObserver(nullptr), m_dstPorts()
+{
+}
+
+void PipelineEmitter::NotifyRecord(RecordList list, size_t begin)
+{
+    if (m_recordObserver)
+    {
+        m_recordObserver->OnRecord(list, begin, GetEmitter().size());
+    }
+}
 
 std::string_view PipelineEmitter::EmitPipeline(const std::string& pipelineName,
                                    const std::unordered_map<NodeUniqueId, Node>& nodesMap,
-                                   const std::unordered_map<EdgeUniqueId, Edge>& egesMap)
+                                   const std::unordered_map<EdgeUniqueId, Edge>& egesMap,
+                                   const LinkGroups&                             linkGroups)
 {
     BeginMap();
     EmitKey("Pipeline");
@@ -107,19 +133,22 @@ std::string_view PipelineEmitter::EmitPipeline(const std::string& pipelineName,
     EmitKeyValue("pipelinename", pipelineName);
 
     EmitNodeList(nodesMap);
-    EmitLinkList(egesMap);
+    EmitLinkList(linkGroups, egesMap);
 
     EndMap();
     EndSequence();
     EndMap();
 
-    return GetEmitter().c_str();
+    // an emitter on a stream has no string of its own, c_str() is null then
+    const char* text = GetEmitter().c_str();
+    return text ? std::string_view(text, GetEmitter().size()) : std::string_view();
 }
 std::string_view PipelineEmitter::EmitPipeline(const std::string&                            pipelineName,
                                    const std::unordered_map<NodeUniqueId, Node>& nodesMap,
                                    const std::unordered_map<NodeUniqueId, Node>& prunedNodesMap,
                                    const std::unordered_map<EdgeUniqueId, Edge>& egesMap,
-                                   const std::unordered_map<NodeUniqueId, Edge>& prunedEdgesMap)
+                                   const std::unordered_map<NodeUniqueId, Edge>& prunedEdgesMap,
+                                   const LinkGroups&                             linkGroups)
 {
     BeginMap();
     EmitKey("Pipeline");
@@ -130,13 +159,15 @@ std::string_view PipelineEmitter::EmitPipeline(const std::string&
     EmitKeyValue("pipelinename", pipelineName);
 
     EmitNodeList(nodesMap, prunedNodesMap);
-    EmitLinkList(egesMap, prunedEdgesMap);
+    EmitLinkList(linkGroups, egesMap, &prunedEdgesMap);
 
     EndMap();
     EndSequence();
     EndMap();
 
-    return GetEmitter().c_str();
+    // an emitter on a stream has no string of its own, c_str() is null then
+    const char* text = GetEmitter().c_str();
+    return text ? std::string_view(text, GetEmitter().size()) : std::string_view();
 }
 
 void PipelineEmitter::EmitYamlNode(const YamlNode& yamlNode)
@@ -153,10 +184,12 @@ void PipelineEmitter::EmitNodeList(const std::unordered_map<NodeUniqueId, Node>&
     // Emit regular nodes
     for (const auto& [_, node] : nodesMap)
     {
+        const size_t begin = GetEmitter().size();
         BeginMap();
         GetEmitter() << YAML::Newline;
         EmitYamlNode(node.GetYamlNode());
         EndMap();
+        NotifyRecord(RecordList::NodeList, begin);
     }
 
     EndSequence();
@@ -172,98 +205,30 @@ void PipelineEmitter::EmitNodeList(const std::unordered_map<NodeUniqueId, Node>&
     // Emit regular nodes
     for (const auto& [_, node] : nodesMap)
     {
+        const size_t begin = GetEmitter().size();
         BeginMap();
         GetEmitter() << YAML::Newline;
         EmitYamlNode(node.GetYamlNode());
         EndMap();
+        NotifyRecord(RecordList::NodeList, begin);
     }
 
     // Emit pruned nodes
     for (const auto& [_, nodePruned] : prunedNodesMap)
     {
+        const size_t begin = GetEmitter().size();
         BeginMap();
         GetEmitter() << YAML::Newline;
         EmitYamlNode(nodePruned.GetYamlNode());
         EndMap();
+        NotifyRecord(RecordList::NodeList, begin);
     }
 
     EndSequence();
 }
 
-// Define equality operator for YamlPort
-bool operator==(const YamlPort& lhs, const YamlPort& rhs)
-{
-    return lhs.m_nodeName == rhs.m_nodeName && lhs.m_nodeYamlId == rhs.m_nodeYamlId &&
-           lhs.m_portName == rhs.m_portName && lhs.m_portYamlId == rhs.m_portYamlId;
-}
-
-struct YamlPortHash
-{
-    size_t operator()(const YamlPort& port) const
-    {
-        // Combine hashes of relevant fields
-        size_t h1 = std::hash<std::string>()(port.m_nodeName);
-        size_t h2 = std::hash<int>()(port.m_nodeYamlId);
-        size_t h3 = std::hash<std::string>()(port.m_portName);
-        size_t h4 = std::hash<int>()(port.m_portYamlId);
-        return h1 ^ (h2 << 8) ^ (h3 << 16) ^ (h4 << 32);
-    }
-};
-
-std::unordered_map<YamlPort, std::vector<YamlPort>, YamlPortHash> GroupEdges(
-    const std::unordered_map<EdgeUniqueId, Edge>& edgesMap,
-    const std::unordered_map<EdgeUniqueId, Edge>& prunedEdgesMap)
-{
-    std::unordered_map<YamlPort, std::vector<YamlPort>, YamlPortHash> result;
-    auto                                                              collect =
-        [](const std::unordered_map<EdgeUniqueId, Edge>&                      edges,
-           std::unordered_map<YamlPort, std::vector<YamlPort>, YamlPortHash>& resContainer)
-    {
-        for (const auto& [_, edge] : edges)
-        {
-            const auto& srcPort = edge.GetYamlEdge().m_yamlSrcPort;
-            const auto& dstPort = edge.GetYamlEdge().m_yamlDstPort;
-            if (resContainer.contains(edge.GetYamlEdge().m_yamlSrcPort))
-            {
-                resContainer.at(srcPort).push_back(dstPort);
-            }
-            else
-            {
-                resContainer.emplace(srcPort, std::vector<YamlPort>{dstPort});
-            }
-        }
-    };
-    collect(edgesMap, result);
-    collect(prunedEdgesMap, result);
-    return result;
-}
-
-std::unordered_map<YamlPort, std::vector<YamlPort>, YamlPortHash> GroupEdges(
-    const std::unordered_map<EdgeUniqueId, Edge>& edgesMap)
-{
-    std::unordered_map<YamlPort, std::vector<YamlPort>, YamlPortHash> result;
-    auto                                                              collect =
-        [](const std::unordered_map<EdgeUniqueId, Edge>&                      edges,
-           std::unordered_map<YamlPort, std::vector<YamlPort>, YamlPortHash>& resContainer)
-    {
-        for (const auto& [_, edge] : edges)
-        {
-            const auto& srcPort = edge.GetYamlEdge().m_yamlSrcPort;
-            const auto& dstPort = edge.GetYamlEdge().m_yamlDstPort;
-            if (resContainer.contains(edge.GetYamlEdge().m_yamlSrcPort))
-            {
-                resContainer.at(srcPort).push_back(dstPort);
-            }
-            else
-            {
-                resContainer.emplace(srcPort, std::vector<YamlPort>{dstPort});
-            }
-        }
-    };
-    collect(edgesMap, result);
-    return result;
-}
-void PipelineEmitter::EmitYamlEdge(const YamlPort& srcPort, const std::vector<YamlPort>& dstPortVec)
+void PipelineEmitter::EmitYamlEdge(const YamlPort&                     srcPort,
+                                   const std::vector<const YamlPort*>& dstPortVec)
 {
     BeginMap();
     GetEmitter() << YAML::Newline;
@@ -278,11 +243,11 @@ void PipelineEmitter::EmitYamlEdge(const YamlPort& srcPort, const std::vector<Ya
     EmitKey("DstPort");
     BeginValue();
     BeginSequence();
-    for (const auto& dstPort : dstPortVec)
+    for (const YamlPort* dstPort : dstPortVec)
     {
         BeginMap();
         GetEmitter() << YAML::Newline;
-        GetEmitter() << dstPort;
+        GetEmitter() << *dstPort;
         EndMap();
     }
     EndSequence();
@@ -290,29 +255,49 @@ void PipelineEmitter::EmitYamlEdge(const YamlPort& srcPort, const std::vector<Ya
     EndMap();
 }
 
-void PipelineEmitter::EmitLinkList(const std::unordered_map<EdgeUniqueId, Edge>& edgesMap)
+static const Edge* FindEdge(EdgeUniqueId edgeUid, const std::unordered_map<EdgeUniqueId, Edge>& edgesMap)
 {
-    auto collecedEdges = GroupEdges(edgesMap);
-    EmitKey("LinkList");
-    BeginValue();
-    BeginSequence();
-    for (const auto& [srcPort, dstPortVec] : collecedEdges)
-    {
-        EmitYamlEdge(srcPort, dstPortVec);
-    }
-    EndSequence();
+    auto edgeIter = edgesMap.find(edgeUid);
+    return edgeIter != edgesMap.end() ? &edgeIter->second : nullptr;
 }
 
-void PipelineEmitter::EmitLinkList(const std::unordered_map<EdgeUniqueId, Edge>& edgesMap,
-                                   const std::unordered_map<EdgeUniqueId, Edge>& prunedEdgesMap)
+void PipelineEmitter::EmitLinkList(const LinkGroups&                             linkGroups,
+                                   const std::unordered_map<EdgeUniqueId, Edge>& edgesMap,
+                                   const std::unordered_map<EdgeUniqueId, Edge>* prunedEdgesMap)
 {
-    auto collecedEdges = GroupEdges(edgesMap, prunedEdgesMap);
     EmitKey("LinkList");
     BeginValue();
     BeginSequence();
-    for (const auto& [srcPort, dstPortVec] : collecedEdges)
+    for (const auto& [srcPortUid, edgeUids] : linkGroups.GetGroups())
     {
-        EmitYamlEdge(srcPort, dstPortVec);
+        // all edges of a group share the source port, the first one found names it
+        const YamlPort* srcPort = nullptr;
+        m_dstPorts.clear();
+        for (const EdgeUniqueId edgeUid : edgeUids)
+        {
+            const Edge* edge = FindEdge(edgeUid, edgesMap);
+            if (!edge && prunedEdgesMap)
+            {
+                edge = FindEdge(edgeUid, *prunedEdgesMap);
+            }
+            if (!edge)
+            {
+                continue;
+            }
+            if (!srcPort)
+            {
+                srcPort = &edge->GetYamlEdge().m_yamlSrcPort;
+            }
+            m_dstPorts.push_back(&edge->GetYamlEdge().m_yamlDstPort);
+        }
+        if (!srcPort)
+        {
+            continue;
+        }
+
+        const size_t begin = GetEmitter().size();
+        EmitYamlEdge(*srcPort, m_dstPorts);
+        NotifyRecord(RecordList::LinkList, begin);
     }
     EndSequence();
 }
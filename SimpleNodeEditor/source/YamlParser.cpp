@@ -1,16 +1,38 @@
 #include "spdlog/spdlog.h"
 #include "YamlParser.hpp"
+#include <algorithm>
 #include <filesystem>
+#include <fstream>
+#include <future>
+#include <thread>
 #include "Log.hpp"
 
 namespace SimpleNodeEditor
 {
 
+// lets YAML::Parser read a string, or a mapped file, without copying it
+class MemoryStreamBuffer : public std::streambuf
+{
+public:
+    explicit MemoryStreamBuffer(std::string_view text)
+    {
+        char* begin = const_cast<char*>(text.data());
+        setg(begin, begin, begin + text.size());
+    }
+};
+
 bool YamlParser::LoadFile(const std::string& filePath)
 {
     if (std::filesystem::is_regular_file(filePath))
     {
-        m_rootNode = YAML::LoadFile(filePath);
+        std::unique_ptr<FS::MappedFile> mappedFile = FS::MappedFile::Open(filePath);
+        if (!mappedFile)
+        {
+            return false;
+        }
+        MemoryStreamBuffer buffer(mappedFile->GetView());
+        std::istream       inputStream(&buffer);
+        m_rootNode = YAML::Load(inputStream);
 
         if (m_rootNode)
         {
@@ -156,184 +178,359 @@ std::vector<NodeDescription> NodeDescriptionParser::ParseNodeDescriptions()
     return ret;
 }
 
-PipelineParser::PipelineParser() : m_pipelineName(), m_nodeListNode(), m_edgeListNode() {}
+// texts smaller than this are parsed on the calling thread
+static constexpr size_t s_minParallelParseBytes = 1024 * 1024;
+// every parsing task gets at least this much of the text
+static constexpr size_t s_minParseChunkBytes = 256 * 1024;
 
-const std::string& PipelineParser::GetPipelineName()
+// the entries of a block sequence, found by looking at the lines of the text
+struct SequenceBlock
 {
-    return m_pipelineName;
+    PipelineEventHandler::Fragment m_fragment;
+    size_t                         m_keyLineEnd = 0; // after the "Key:" of the sequence
+    size_t                         m_end        = 0; // the entries end here
+    std::vector<size_t>            m_entries;        // where every entry starts
+    std::vector<int>               m_entryLines;     // and at which line, counted from 0
+};
+
+static PipelineEventHandler::Result ParseFragment(std::string_view                text,
+                                                  PipelineEventHandler::Fragment fragment,
+                                                  const std::atomic<bool>*        cancelled,
+                                                  int                             lineOffset)
+{
+    MemoryStreamBuffer   buffer(text);
+    std::istream         inputStream(&buffer);
+    PipelineEventHandler handler(cancelled, fragment, lineOffset);
+    YAML::Parser         parser(inputStream);
+    parser.HandleNextDocument(handler);
+    return std::move(handler.GetResult());
 }
 
-// invalid NodeList should trigger an error
-// invalid LinkList or Pipelinename just trigger a warning
-bool PipelineParser::LoadFile(const std::string& filePath)
+// Finds the block sequence under the line "<indent>key:" and where each of its entries starts.
+// Returns false when the key is not there, or on anything a split by lines could get wrong: the
+// key showing up twice, tabs, several documents, or a sequence that is not a block one.
+static bool FindSequenceBlock(std::string_view text, std::string_view key, SequenceBlock& block)
 {
-    bool ret = true;
-    m_rootNode = YAML::LoadFile(filePath);
-    if (m_rootNode && m_rootNode["Pipeline"] && m_rootNode["Pipeline"].IsSequence())
+    constexpr size_t npos        = std::string_view::npos;
+    size_t           keyCount    = 0;
+    size_t           keyIndent   = 0;
+    size_t           entryIndent = npos;
+    bool             inBlock     = false;
+    int              line        = 0;
+    for (size_t begin = 0; begin < text.size(); ++line)
+    {
+        const size_t     end     = std::min(text.find('\n', begin), text.size());
+        std::string_view content = text.substr(begin, end - begin);
+        const size_t     indent  = content.find_first_not_of(' ');
+        const size_t     last    = content.find_last_not_of(" \r");
+        if (indent != npos && content[indent] == '\t')
+        {
+            return false;
+        }
+        if (indent != npos && content[indent] != '#')
+        {
+            const std::string_view trimmed = content.substr(indent, last + 1 - indent);
+            if (indent == 0 && (trimmed.starts_with("---") || trimmed.starts_with("...") ||
+                                trimmed.starts_with("%")))
+            {
+                return false;
+            }
+
+            const bool isDash = trimmed[0] == '-' && (trimmed.size() == 1 || trimmed[1] == ' ');
+            if (inBlock && entryIndent == npos)
+            {
+                // the first entry sets the indent of all of them
+                if (!isDash || indent < keyIndent)
+                {
+                    return false;
+                }
+                entryIndent = indent;
+            }
+            if (inBlock && isDash && indent == entryIndent)
+            {
+                block.m_entries.push_back(begin);
+                block.m_entryLines.push_back(line);
+            }
+            else if (inBlock && indent <= entryIndent)
+            {
+                block.m_end = begin;
+                inBlock     = false;
+            }
+
+            if (trimmed.size() == key.size() + 1 && trimmed.starts_with(key) && trimmed.back() == ':')
+            {
+                if (++keyCount > 1)
+                {
+                    return false;
+                }
+                keyIndent          = indent;
+                block.m_keyLineEnd = begin + last + 1;
+                inBlock            = true;
+            }
+        }
+        begin = end + 1;
+    }
+    if (inBlock)
     {
-        m_filePath = filePath;
-        m_rootNode = m_rootNode["Pipeline"][0];
-        // std::string pipeLineName = m_rootNode["pipelinename"].as<std::string>();
+        block.m_end = text.size();
     }
-    else
+    return keyCount == 1 && !block.m_entries.empty();
+}
+
+// Parses the NodeList and LinkList entries in chunks on up to threadCount threads and the rest of
+// the text on the calling one, then joins the records in file order. Returns false if the text
+// does not split cleanly, it is then up to the caller to parse it as a whole.
+static bool ParseInChunks(std::string_view text, size_t threadCount,
+                          const std::atomic<bool>* cancelled, PipelineEventHandler::Result& result)
+{
+    if (threadCount < 2 || text.size() < s_minParallelParseBytes)
     {
-        SNELOG_ERROR("load file[{}] failed", filePath);
-        ret = false;
+        return false;
     }
 
-    if (ret && m_rootNode["pipelinename"] && m_rootNode["pipelinename"].IsScalar())
+    std::vector<SequenceBlock> blocks;
+    size_t                     blockBytes = 0;
+    for (const auto& [key, fragment] :
+         {std::pair{std::string_view("NodeList"), PipelineEventHandler::Fragment::NodeList},
+          std::pair{std::string_view("LinkList"), PipelineEventHandler::Fragment::LinkList}})
     {
-        m_pipelineName = m_rootNode["pipelinename"].as<std::string>();
+        SequenceBlock block;
+        block.m_fragment = fragment;
+        if (FindSequenceBlock(text, key, block))
+        {
+            blockBytes += block.m_end - block.m_entries.front();
+            blocks.push_back(std::move(block));
+        }
     }
-    else
+    std::sort(blocks.begin(), blocks.end(), [](const SequenceBlock& lhs, const SequenceBlock& rhs)
+              { return lhs.m_keyLineEnd < rhs.m_keyLineEnd; });
+    for (size_t index = 1; index < blocks.size(); ++index)
+    {
+        if (blocks[index - 1].m_end > blocks[index].m_keyLineEnd)
+        {
+            return false;
+        }
+    }
+    if (blocks.empty() || blockBytes < s_minParallelParseBytes)
+    {
+        return false;
+    }
+
+    // cut every sequence into chunks of whole entries
+    struct Chunk
     {
-        SNELOG_WARN("file {} has no valid pipelinename sequence, check it", filePath);
-        // ret = false;
+        std::string_view               m_text;
+        PipelineEventHandler::Fragment m_fragment;
+        int                            m_line;
+    };
+    const size_t       chunkBytes = std::max(s_minParseChunkBytes, blockBytes / threadCount);
+    std::vector<Chunk> chunks;
+    for (const SequenceBlock& block : blocks)
+    {
+        size_t first = 0;
+        for (size_t index = 1; index <= block.m_entries.size(); ++index)
+        {
+            const size_t end =
+                index < block.m_entries.size() ? block.m_entries[index] : block.m_end;
+            const size_t begin = block.m_entries[first];
+            if (end - begin >= chunkBytes || index == block.m_entries.size())
+            {
+                chunks.push_back(Chunk{text.substr(begin, end - begin), block.m_fragment,
+                                       block.m_entryLines[first]});
+                first = index;
+            }
+        }
     }
 
-    if (ret && m_rootNode["NodeList"] && m_rootNode["NodeList"].IsSequence() &&
-        m_rootNode["NodeList"].size() != 0)
+    std::vector<std::future<PipelineEventHandler::Result>> partials;
+    partials.reserve(chunks.size());
+    for (const Chunk& chunk : chunks)
     {
-        m_nodeListNode = m_rootNode["NodeList"];
+        partials.push_back(std::async(std::launch::async, ParseFragment, chunk.m_text,
+                                      chunk.m_fragment, cancelled, chunk.m_line));
     }
-    else
+
+    // what is left has the sequences replaced by empty ones, which also tells whether they are
+    // where the handler reads them
+    std::string rest;
+    size_t      copied = 0;
+    for (const SequenceBlock& block : blocks)
     {
-        SNELOG_ERROR("file {} has no valid Node sequence, check it", filePath);
-        ret = false;
+        rest.append(text.substr(copied, block.m_keyLineEnd - copied));
+        rest.append(" []\n");
+        copied = block.m_end;
     }
+    rest.append(text.substr(copied));
+    result = ParseFragment(rest, PipelineEventHandler::Fragment::Document, cancelled, 0);
 
-    if (ret && m_rootNode["LinkList"] && m_rootNode["LinkList"].IsSequence() &&
-        m_rootNode["LinkList"].size() != 0)
+    for (const SequenceBlock& block : blocks)
     {
-        m_edgeListNode = m_rootNode["LinkList"];
+        const bool isNodeList = block.m_fragment == PipelineEventHandler::Fragment::NodeList;
+        if (!(isNodeList ? result.m_hasNodeList : result.m_hasLinkList))
+        {
+            return false;
+        }
     }
-    else
+    for (auto& partial : partials)
     {
-        SNELOG_WARN("file {} has no valid LinkList sequence, better to check it", filePath);
-        Notifier::Add(Message(Message::Type::WARNING, "", "invalid Linklist, better to check it"));
-        // ret = false;
+        PipelineEventHandler::Result part = partial.get();
+        result.m_nodeListSize += part.m_nodeListSize;
+        result.m_linkListSize += part.m_linkListSize;
+        result.m_nodes.insert(result.m_nodes.end(), std::make_move_iterator(part.m_nodes.begin()),
+                              std::make_move_iterator(part.m_nodes.end()));
+        result.m_edges.insert(result.m_edges.end(), std::make_move_iterator(part.m_edges.begin()),
+                              std::make_move_iterator(part.m_edges.end()));
+        result.m_errors.insert(result.m_errors.end(), std::make_move_iterator(part.m_errors.begin()),
+                               std::make_move_iterator(part.m_errors.end()));
     }
+    return true;
+}
 
-    return ret;
+PipelineParser::PipelineParser()
+    : m_pipelineName(), m_yamlNodes(), m_yamlEdges(), m_errors(), m_warnings(), m_threadCount(0)
+{
 }
 
-// TODO: remove redundant code by combine LoadStream and LoadFile logic
-bool PipelineParser::LoadStream(std::istream& inputStream)
+void PipelineParser::SetThreadCount(size_t threadCount)
 {
-    bool ret   = true;
-    m_rootNode = YAML::Load(inputStream);
-    if (m_rootNode && m_rootNode["Pipeline"] && m_rootNode["Pipeline"].IsSequence())
+    m_threadCount = threadCount;
+}
+
+const std::string& PipelineParser::GetPipelineName()
+{
+    return m_pipelineName;
+}
+
+bool PipelineParser::LoadFile(const std::string& filePath)
+{
+    m_filePath = filePath;
+    if (std::unique_ptr<FS::MappedFile> mappedFile = FS::MappedFile::Open(filePath))
     {
-        m_rootNode = m_rootNode["Pipeline"][0];
-        // std::string pipeLineName = m_rootNode["pipelinename"].as<std::string>();
+        return LoadText(mappedFile->GetView());
     }
-    else
+
+    std::ifstream inputFile(filePath, std::ios::binary);
+    if (!inputFile.is_open())
     {
-        SNELOG_ERROR("parse input stream failed");
-        ret = false;
+        SNELOG_ERROR("load file[{}] failed", filePath);
+        return false;
     }
+    return LoadStream(inputFile);
+}
 
-    if (ret && m_rootNode["pipelinename"] && m_rootNode["pipelinename"].IsScalar())
+// invalid NodeList should trigger an error
+// invalid LinkList or Pipelinename just trigger a warning
+bool PipelineParser::LoadStream(std::istream& inputStream, const std::atomic<bool>* cancelled)
+{
+    // the text is read up front so that it can be split between threads, files that can be
+    // mapped skip this, see LoadText
+    std::string       text;
+    std::vector<char> buffer(64 * 1024);
+    while (inputStream.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) ||
+           inputStream.gcount() > 0)
     {
-        m_pipelineName = m_rootNode["pipelinename"].as<std::string>();
+        text.append(buffer.data(), static_cast<size_t>(inputStream.gcount()));
+        if (cancelled && cancelled->load(std::memory_order_relaxed))
+        {
+            SNELOG_INFO("parsing pipeline file[{}] cancelled", m_filePath);
+            return false;
+        }
     }
-    else
+    if (inputStream.bad())
     {
-        SNELOG_WARN("has no valid pipelinename sequence, check it");
-        // ret = false;
+        SNELOG_ERROR("read pipeline file[{}] failed", m_filePath);
+        return false;
     }
+    return LoadText(text, cancelled);
+}
 
-    if (ret && m_rootNode["NodeList"] && m_rootNode["NodeList"].IsSequence() &&
-        m_rootNode["NodeList"].size() != 0)
+bool PipelineParser::LoadText(std::string_view text, const std::atomic<bool>* cancelled)
+{
+    PipelineEventHandler::Result result;
+    try
     {
-        m_nodeListNode = m_rootNode["NodeList"];
+        bool parsedInChunks = false;
+        try
+        {
+            const size_t threadCount =
+                m_threadCount ? m_threadCount : std::max(1u, std::thread::hardware_concurrency());
+            parsedInChunks = ParseInChunks(text, threadCount, cancelled, result);
+        }
+        catch (const YAML::Exception& e)
+        {
+            // a chunk may fail where the whole text does not, let the second try tell
+            SNELOG_WARN("parse pipeline file[{}] in chunks failed: {}", m_filePath, e.what());
+        }
+        if (!parsedInChunks)
+        {
+            result = ParseFragment(text, PipelineEventHandler::Fragment::Document, cancelled, 0);
+        }
     }
-    else
+    catch (const YAML::Exception& e)
+    {
+        SNELOG_ERROR("parse pipeline file[{}] failed: {}", m_filePath, e.what());
+        return false;
+    }
+    catch (const PipelineEventHandler::Cancelled&)
     {
-        SNELOG_ERROR("file {} has no valid Node sequence, check it");
-        ret = false;
+        SNELOG_INFO("parsing pipeline file[{}] cancelled", m_filePath);
+        return false;
+    }
+
+    m_errors = std::move(result.m_errors);
+    if (!result.m_hasPipeline)
+    {
+        SNELOG_ERROR("parse pipeline file[{}] failed, no Pipeline sequence", m_filePath);
+        return false;
     }
 
-    if (ret && m_rootNode["LinkList"] && m_rootNode["LinkList"].IsSequence() &&
-        m_rootNode["LinkList"].size() != 0)
+    if (result.m_pipelineName)
     {
-        m_edgeListNode = m_rootNode["LinkList"];
+        m_pipelineName = std::move(*result.m_pipelineName);
     }
     else
     {
-        SNELOG_WARN("has no valid LinkList sequence, better to check it");
-        Notifier::Add(Message(Message::Type::WARNING, "", "invalid Linklist, better to check it"));
-        // ret = false;
+        SNELOG_WARN("file {} has no valid pipelinename sequence, check it", m_filePath);
     }
 
-    return ret;
-}
-
-std::vector<YamlNode> PipelineParser::ParseNodes()
-{
-    SNELOG_INFO("start to parse node from file[{}], m_nodeListNode.size() = {}", m_filePath,
-                m_nodeListNode.size());
-    std::vector<YamlNode> result;
-
-    for (YAML::const_iterator iter = m_nodeListNode.begin(); iter != m_nodeListNode.end(); ++iter)
+    if (!result.m_hasNodeList || result.m_nodeListSize == 0)
     {
-        result.push_back(iter->as<YamlNode>());
+        SNELOG_ERROR("file {} has no valid Node sequence, check it", m_filePath);
+        return false;
     }
-    SNELOG_INFO("ParseNodes Dode, collected {} nodes", result.size());
-    return result;
-}
 
-// do we need more syntax check ?
-std::vector<YamlEdge> PipelineParser::ParseEdges()
-{
-    std::vector<YamlEdge> result;
-    if (!m_edgeListNode)
+    if (!result.m_hasLinkList || result.m_linkListSize == 0)
     {
-        SNELOG_ERROR("m_edgeListNode is invalid!");
-        return result;
+        SNELOG_WARN("file {} has no valid LinkList sequence, better to check it", m_filePath);
+        m_warnings.push_back("invalid Linklist, better to check it");
     }
-    SNELOG_INFO("start to parse edges from file[{}], m_edgeListNode.size() = {}", m_filePath,
-                m_edgeListNode.size());
 
-    for (size_t edgeIterIdx = 0; edgeIterIdx < m_edgeListNode.size(); ++edgeIterIdx)
-    {
-        if (m_edgeListNode[edgeIterIdx] && m_edgeListNode[edgeIterIdx].IsMap() &&
-            m_edgeListNode[edgeIterIdx]["SrcPort"])
-        {
-            YamlPort srcPort = m_edgeListNode[edgeIterIdx]["SrcPort"].as<YamlPort>();
+    m_yamlNodes = std::move(result.m_nodes);
+    m_yamlEdges = std::move(result.m_edges);
+    return true;
+}
 
-            YAML::Node dstPortsNode = m_edgeListNode[edgeIterIdx]["DstPort"];
-            if (dstPortsNode && dstPortsNode.IsSequence())
-            {
-                for (size_t portIterIdx = 0; portIterIdx < dstPortsNode.size(); ++portIterIdx)
-                {
-                    result.emplace_back(srcPort, dstPortsNode[portIterIdx].as<YamlPort>(), true);
-                }
-            }
-            else
-            {
-                SNELOG_ERROR("dstPortNode is invalid or dstPortNode is not sequence");
-                SNELOG_ERROR("DstPort node YAML:\n{}", YAML::Dump(dstPortsNode));
-            }
-        }
-        else
-        {
-            SNELOG_ERROR("invalid node, checkinfo : isEdgeNodeValid[{}] | isEdgeNodeMap[{}]",
-                         m_edgeListNode[edgeIterIdx] ? true : false,
-                         m_edgeListNode[edgeIterIdx].IsMap());
-            SNELOG_ERROR("Edge node YAML:\n{}", YAML::Dump(m_edgeListNode[edgeIterIdx]));
-        }
-    }
-    SNELOG_INFO("parseEdges Dode, collected {} edges", result.size());
+std::vector<YamlNode> PipelineParser::ParseNodes()
+{
+    SNELOG_INFO("ParseNodes Dode, collected {} nodes from file[{}]", m_yamlNodes.size(),
+                m_filePath);
+    return std::move(m_yamlNodes);
+}
 
-    return result;
+std::vector<YamlEdge> PipelineParser::ParseEdges()
+{
+    SNELOG_INFO("parseEdges Dode, collected {} edges from file[{}]", m_yamlEdges.size(),
+                m_filePath);
+    return std::move(m_yamlEdges);
 }
 
 void PipelineParser::Clear()
 {
     m_pipelineName = {};
-    m_edgeListNode = YAML::Node();
-    m_nodeListNode = YAML::Node();
+    m_yamlNodes.clear();
+    m_yamlEdges.clear();
+    m_errors.clear();
+    m_warnings.clear();
     YamlParser::Clear();
 }
 
@@ -0,0 +1,458 @@
+// Checks that the entries of the edit journal replayed with EditJournal::Apply give the records a
+// plain model of the edits gives, also after a round trip through the journal file, that a torn
+// or damaged last entry is dropped when the journal is read back and that Restart empties it.
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "EditJournal.hpp"
+#include "Log.hpp"
+#include "TestHelpers.hpp"
+
+using namespace SimpleNodeEditor;
+
+namespace
+{
+
+using Entry = EditJournal::Entry;
+using Type  = EditJournal::Entry::Type;
+
+struct Records
+{
+    std::string           m_pipelineName;
+    std::vector<YamlNode> m_nodes;
+    std::vector<YamlEdge> m_edges;
+};
+
+YamlNode RandomNode(std::mt19937& rng, YamlNode::NodeYamlId id)
+{
+    YamlNode node;
+    node.m_nodeName     = "Node" + std::to_string(id % 7);
+    node.m_nodeYamlId   = id;
+    node.m_isSrcNode    = id % 11 == 0;
+    node.m_nodeYamlType = static_cast<YamlNodeType>(rng() % 5);
+    for (int property = static_cast<int>(rng() % 4); property > 0; --property)
+    {
+        node.m_Properties.Add("property" + std::to_string(property), property,
+                              std::to_string(rng() % 1000));
+    }
+    if (rng() % 3 == 0)
+    {
+        node.m_PruningRules.push_back(YamlPruningRule{"prune" + std::to_string(rng() % 4),
+                                                      "Enable"});
+    }
+    if (rng() % 2 == 0)
+    {
+        node.m_position = YamlNodePosition{static_cast<float>(rng() % 4000) * 0.25f,
+                                           static_cast<float>(rng() % 4000) * -0.5f};
+    }
+    return node;
+}
+
+YamlEdge RandomEdge(std::mt19937& rng, YamlNode::NodeYamlId src, YamlNode::NodeYamlId dst)
+{
+    YamlPort srcPort{"Node" + std::to_string(src % 7), src, "outputport1", 0, {}};
+    YamlPort dstPort{"Node" + std::to_string(dst % 7), dst, "inputport1",
+                     static_cast<YamlPort::PortYamlId>(rng() % 3), {}};
+    if (dstPort.m_portYamlId == 2)
+    {
+        dstPort.m_PruningRules.push_back(YamlPruningRule{"prune1", "Disble"});
+    }
+    return YamlEdge(srcPort, dstPort, true);
+}
+
+bool SameEdgeKey(const YamlEdge& lhs, const YamlEdge& rhs)
+{
+    return lhs.m_yamlSrcPort.m_nodeYamlId == rhs.m_yamlSrcPort.m_nodeYamlId &&
+           lhs.m_yamlSrcPort.m_portYamlId == rhs.m_yamlSrcPort.m_portYamlId &&
+           lhs.m_yamlDstPort.m_nodeYamlId == rhs.m_yamlDstPort.m_nodeYamlId &&
+           lhs.m_yamlDstPort.m_portYamlId == rhs.m_yamlDstPort.m_portYamlId;
+}
+
+// what Apply has to give: records are changed where they are, new ones go to the end, and the
+// links of removed nodes are dropped at the end
+class Model
+{
+public:
+    explicit Model(const Records& base) : m_records(base) {}
+
+    void Play(const Entry& entry)
+    {
+        std::vector<YamlNode>& nodes    = m_records.m_nodes;
+        std::vector<YamlEdge>& edges    = m_records.m_edges;
+        auto                   nodeIter = std::find_if(
+            nodes.begin(), nodes.end(), [&](const YamlNode& node)
+            { return node.m_nodeYamlId == entry.m_node.m_nodeYamlId; });
+        auto edgeIter = std::find_if(edges.begin(), edges.end(), [&](const YamlEdge& edge)
+                                     { return SameEdgeKey(edge, entry.m_edge); });
+        switch (entry.m_type)
+        {
+        case Type::PutNode:
+            if (nodeIter == nodes.end())
+            {
+                nodes.push_back(entry.m_node);
+            }
+            else
+            {
+                *nodeIter = entry.m_node;
+            }
+            break;
+        case Type::RemoveNode:
+            if (nodeIter != nodes.end())
+            {
+                nodes.erase(nodeIter);
+            }
+            break;
+        case Type::PutEdge:
+            if (edgeIter == edges.end())
+            {
+                edges.push_back(entry.m_edge);
+            }
+            else
+            {
+                *edgeIter = entry.m_edge;
+            }
+            break;
+        case Type::RemoveEdge:
+            if (edgeIter != edges.end())
+            {
+                edges.erase(edgeIter);
+            }
+            break;
+        case Type::SetPipelineName:
+            m_records.m_pipelineName = entry.m_first;
+            break;
+        default:
+            break;
+        }
+    }
+
+    Records Result() const
+    {
+        Records result = m_records;
+        auto    exists = [&result](YamlNode::NodeYamlId id)
+        {
+            return std::any_of(result.m_nodes.begin(), result.m_nodes.end(),
+                               [id](const YamlNode& node) { return node.m_nodeYamlId == id; });
+        };
+        std::erase_if(result.m_edges,
+                      [&](const YamlEdge& edge)
+                      {
+                          return !exists(edge.m_yamlSrcPort.m_nodeYamlId) ||
+                                 !exists(edge.m_yamlDstPort.m_nodeYamlId);
+                      });
+        return result;
+    }
+
+private:
+    Records m_records;
+};
+
+// a pipeline of nodeCount nodes and as many links, and entryCount random edits on top of it that
+// add, change and remove nodes and links, node ids are picked so that some come back after
+// they were removed
+void RandomEdits(std::mt19937& rng, int nodeCount, int entryCount, Records& base,
+                 std::vector<Entry>& entries)
+{
+    std::uniform_int_distribution<int> pickNode(0, nodeCount + nodeCount / 4);
+    base.m_pipelineName = "journaled";
+    for (int id = 0; id < nodeCount; ++id)
+    {
+        base.m_nodes.push_back(RandomNode(rng, id));
+    }
+    for (int link = 0; link < nodeCount; ++link)
+    {
+        base.m_edges.push_back(RandomEdge(rng, static_cast<int>(rng() % nodeCount),
+                                          static_cast<int>(rng() % nodeCount)));
+    }
+    // the base file has no duplicate links, as the parser would report them
+    std::vector<YamlEdge> unique;
+    for (const YamlEdge& edge : base.m_edges)
+    {
+        if (std::none_of(unique.begin(), unique.end(),
+                         [&](const YamlEdge& other) { return SameEdgeKey(edge, other); }))
+        {
+            unique.push_back(edge);
+        }
+    }
+    base.m_edges = std::move(unique);
+
+    for (int index = 0; index < entryCount; ++index)
+    {
+        switch (rng() % 10)
+        {
+        case 0:
+        case 1:
+        case 2:
+            entries.push_back(Entry::ForNode(Type::PutNode, RandomNode(rng, pickNode(rng))));
+            break;
+        case 3:
+            entries.push_back(Entry::ForNode(Type::RemoveNode, RandomNode(rng, pickNode(rng))));
+            break;
+        case 4:
+        case 5:
+        case 6:
+            entries.push_back(
+                Entry::ForEdge(Type::PutEdge, RandomEdge(rng, pickNode(rng), pickNode(rng))));
+            break;
+        case 7:
+        case 8:
+        {
+            // mostly links that are there
+            const YamlEdge edge = rng() % 4 != 0 && !base.m_edges.empty()
+                                      ? base.m_edges[rng() % base.m_edges.size()]
+                                      : RandomEdge(rng, pickNode(rng), pickNode(rng));
+            entries.push_back(Entry::ForEdge(Type::RemoveEdge, edge));
+            break;
+        }
+        default:
+            entries.push_back(rng() % 2 == 0
+                                  ? Entry::ForNames(Type::SetPipelineName,
+                                                    "pipeline" + std::to_string(index))
+                                  : Entry::ForNames(Type::AddPruningRule, "prune9", "Enable"));
+            break;
+        }
+    }
+}
+
+Records Applied(const Records& base, const std::vector<Entry>& entries)
+{
+    Records records = base;
+    EditJournal::Apply(entries, records.m_pipelineName, records.m_nodes, records.m_edges);
+    return records;
+}
+
+std::vector<std::tuple<std::string, int32_t, std::string>> PropertiesOf(const YamlNode& node)
+{
+    std::vector<std::tuple<std::string, int32_t, std::string>> properties;
+    node.m_Properties.ForEach([&](std::string_view name, int32_t id, std::string_view value)
+                              { properties.emplace_back(name, id, value); });
+    return properties;
+}
+
+bool SameRules(const std::vector<YamlPruningRule>& lhs, const std::vector<YamlPruningRule>& rhs)
+{
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                      [](const YamlPruningRule& l, const YamlPruningRule& r)
+                      { return l.m_Group == r.m_Group && l.m_Type == r.m_Type; });
+}
+
+bool SamePort(const YamlPort& lhs, const YamlPort& rhs)
+{
+    return lhs.m_nodeName == rhs.m_nodeName && lhs.m_nodeYamlId == rhs.m_nodeYamlId &&
+           lhs.m_portName == rhs.m_portName && lhs.m_portYamlId == rhs.m_portYamlId &&
+           SameRules(lhs.m_PruningRules, rhs.m_PruningRules);
+}
+
+bool SameNode(const YamlNode& lhs, const YamlNode& rhs)
+{
+    const bool samePosition =
+        lhs.m_position.has_value() == rhs.m_position.has_value() &&
+        (!lhs.m_position || (Test::SameBits(lhs.m_position->m_x, rhs.m_position->m_x) &&
+                             Test::SameBits(lhs.m_position->m_y, rhs.m_position->m_y)));
+    return lhs.m_nodeName == rhs.m_nodeName && lhs.m_nodeYamlId == rhs.m_nodeYamlId &&
+           lhs.m_isSrcNode == rhs.m_isSrcNode && lhs.m_nodeYamlType == rhs.m_nodeYamlType &&
+           PropertiesOf(lhs) == PropertiesOf(rhs) &&
+           SameRules(lhs.m_PruningRules, rhs.m_PruningRules) && samePosition;
+}
+
+bool SameRecords(const Records& lhs, const Records& rhs)
+{
+    return lhs.m_pipelineName == rhs.m_pipelineName &&
+           std::equal(lhs.m_nodes.begin(), lhs.m_nodes.end(), rhs.m_nodes.begin(),
+                      rhs.m_nodes.end(), SameNode) &&
+           std::equal(lhs.m_edges.begin(), lhs.m_edges.end(), rhs.m_edges.begin(),
+                      rhs.m_edges.end(),
+                      [](const YamlEdge& l, const YamlEdge& r)
+                      {
+                          return l.m_isValid == r.m_isValid &&
+                                 SamePort(l.m_yamlSrcPort, r.m_yamlSrcPort) &&
+                                 SamePort(l.m_yamlDstPort, r.m_yamlDstPort);
+                      });
+}
+
+// a journal for baseTarget holding entries, as a run that ended cleanly leaves it
+uintmax_t WriteJournal(const std::string& path, const std::string& baseTarget,
+                       const std::vector<Entry>& entries)
+{
+    {
+        EditJournal journal;
+        journal.Open(path);
+        journal.Restart(baseTarget);
+        for (const Entry& entry : entries)
+        {
+            journal.Append(entry);
+        }
+    }
+    return std::filesystem::file_size(path);
+}
+
+std::optional<EditJournal::Recovered> ReadBack(const std::string& path)
+{
+    EditJournal journal;
+    return journal.Open(path);
+}
+
+void Truncate(const std::string& path, uintmax_t size)
+{
+    std::filesystem::resize_file(path, size);
+}
+
+void TestApply(std::mt19937& rng)
+{
+    for (int round = 0; round < 20; ++round)
+    {
+        Records            base;
+        std::vector<Entry> entries;
+        RandomEdits(rng, 40, 200, base, entries);
+
+        Model model(base);
+        for (const Entry& entry : entries)
+        {
+            model.Play(entry);
+        }
+        SNE_CHECK(SameRecords(Applied(base, entries), model.Result()));
+    }
+
+    // no entries, the base records as they are
+    Records            base;
+    std::vector<Entry> entries;
+    RandomEdits(rng, 40, 0, base, entries);
+    SNE_CHECK(SameRecords(Applied(base, {}), base));
+}
+
+void TestRoundTrip(std::mt19937& rng, const std::string& path)
+{
+    Records            base;
+    std::vector<Entry> entries;
+    RandomEdits(rng, 40, 300, base, entries);
+    WriteJournal(path, "local:pipeline.yaml", entries);
+
+    const std::optional<EditJournal::Recovered> recovered = ReadBack(path);
+    SNE_CHECK(recovered.has_value());
+    if (!recovered)
+    {
+        return;
+    }
+    SNE_CHECK(recovered->m_baseTarget == "local:pipeline.yaml");
+    SNE_CHECK(recovered->m_entries.size() == entries.size());
+    SNE_CHECK(SameRecords(Applied(base, recovered->m_entries), Applied(base, entries)));
+
+    // the file is left as it is until the next Restart, so a second crash recovers it again
+    const std::optional<EditJournal::Recovered> again = ReadBack(path);
+    SNE_CHECK(again && again->m_entries.size() == entries.size());
+
+    // a journal that is turned off records nothing
+    EditJournal disabled;
+    SNE_CHECK(!disabled.Open("").has_value());
+    SNE_CHECK(!disabled.IsEnabled());
+}
+
+void TestTornEntry(std::mt19937& rng, const std::string& path)
+{
+    Records            base;
+    std::vector<Entry> entries;
+    RandomEdits(rng, 40, 50, base, entries);
+    const std::vector<Entry> allButLast(entries.begin(), entries.end() - 1);
+    const uintmax_t          wholeSize = WriteJournal(path, "base.yaml", allButLast);
+    const uintmax_t          fullSize  = WriteJournal(path, "base.yaml", entries);
+    SNE_CHECK(fullSize > wholeSize);
+
+    // cut anywhere in the last entry, in its size, its hash or its bytes
+    for (uintmax_t size : {wholeSize + 1, wholeSize + 6, (wholeSize + fullSize) / 2, fullSize - 1})
+    {
+        WriteJournal(path, "base.yaml", entries);
+        Truncate(path, size);
+        const std::optional<EditJournal::Recovered> recovered = ReadBack(path);
+        SNE_CHECK(recovered && recovered->m_entries.size() == allButLast.size());
+        SNE_CHECK(recovered &&
+                  SameRecords(Applied(base, recovered->m_entries), Applied(base, allButLast)));
+    }
+
+    // a damaged last entry is dropped the same way
+    WriteJournal(path, "base.yaml", entries);
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(static_cast<std::streamoff>(fullSize - 1));
+        file.put('\x7f');
+    }
+    const std::optional<EditJournal::Recovered> damaged = ReadBack(path);
+    SNE_CHECK(damaged && damaged->m_entries.size() == allButLast.size());
+
+    // entries appended after a recovery go after the last whole one, not after the torn bytes
+    WriteJournal(path, "base.yaml", entries);
+    Truncate(path, fullSize - 1);
+    {
+        EditJournal journal;
+        SNE_CHECK(journal.Open(path).has_value());
+        journal.Append(entries.back());
+    }
+    const std::optional<EditJournal::Recovered> resumed = ReadBack(path);
+    SNE_CHECK(resumed && resumed->m_entries.size() == entries.size());
+    SNE_CHECK(resumed && SameRecords(Applied(base, resumed->m_entries), Applied(base, entries)));
+    SNE_CHECK(std::filesystem::file_size(path) == fullSize);
+
+    // a file that is not a journal recovers nothing and is started over
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << "not a journal";
+    }
+    SNE_CHECK(!ReadBack(path).has_value());
+    SNE_CHECK(!ReadBack(path).has_value());
+}
+
+void TestRestart(std::mt19937& rng, const std::string& path)
+{
+    Records            base;
+    std::vector<Entry> entries;
+    RandomEdits(rng, 40, 50, base, entries);
+    const uintmax_t emptySize = WriteJournal(path, "saved.yaml", {});
+    const uintmax_t fullSize  = WriteJournal(path, "saved.yaml", entries);
+    SNE_CHECK(fullSize > emptySize);
+
+    // saving restarts the journal, nothing is left to recover
+    {
+        EditJournal journal;
+        SNE_CHECK(journal.Open(path).has_value());
+        journal.Restart("saved.yaml");
+    }
+    SNE_CHECK(std::filesystem::file_size(path) == emptySize);
+    SNE_CHECK(!ReadBack(path).has_value());
+
+    // edits after the restart are recovered on top of the new base, without the ones before it
+    WriteJournal(path, "old.yaml", entries);
+    {
+        EditJournal journal;
+        SNE_CHECK(journal.Open(path).has_value());
+        journal.Restart("saved.yaml");
+        journal.Append(entries.front());
+        journal.Update();
+    }
+    const std::optional<EditJournal::Recovered> recovered = ReadBack(path);
+    SNE_CHECK(recovered && recovered->m_baseTarget == "saved.yaml");
+    SNE_CHECK(recovered && recovered->m_entries.size() == 1);
+}
+
+} // namespace
+
+int main()
+{
+    Log::GetInstance().SetLogLevel(Log::LogLevel::LogError);
+
+    const std::filesystem::path directory =
+        std::filesystem::temp_directory_path() / "sne_edit_journal_test";
+    std::filesystem::remove_all(directory);
+    const std::string path = (directory / "journal.bin").string();
+
+    std::mt19937 rng(20240611);
+    TestApply(rng);
+    TestRoundTrip(rng, path);
+    TestTornEntry(rng, path);
+    TestRestart(rng, path);
+
+    std::filesystem::remove_all(directory);
+    return SimpleNodeEditor::Test::Result();
+}
@@ -0,0 +1,154 @@
+// Checks that FlatTopologicalSort gives the same levels as TopologicalSort, in the same order
+// inside each level, including levels wide enough to be split across threads. Run with
+// --benchmark to time both on large random DAGs.
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+#include "Helpers.hpp"
+#include "Log.hpp"
+#include "TestGraph.hpp"
+#include "TestHelpers.hpp"
+
+using namespace SimpleNodeEditor;
+using SimpleNodeEditor::Test::MeasureMs;
+using SimpleNodeEditor::Test::TestGraph;
+
+namespace
+{
+
+bool SameLevels(const TopologicalLevels& flat, const std::vector<std::vector<NodeUniqueId>>& nested)
+{
+    if (flat.GetLevelCount() != nested.size())
+    {
+        return false;
+    }
+    for (size_t level = 0; level < nested.size(); ++level)
+    {
+        const std::span<const NodeUniqueId> flatLevel = flat.GetLevel(level);
+        if (!std::equal(flatLevel.begin(), flatLevel.end(), nested[level].begin(),
+                        nested[level].end()))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// layerCount layers of layerSize nodes, every node of a layer but the first has a few inputs from
+// the layer before it. The levels are as wide as the layers.
+TestGraph WideDag(int layerCount, int layerSize, std::mt19937& rng)
+{
+    TestGraph                              graph;
+    std::vector<std::vector<NodeUniqueId>> layers(layerCount);
+    for (auto& layer : layers)
+    {
+        for (int node = 0; node < layerSize; ++node)
+        {
+            layer.push_back(graph.AddNode());
+        }
+    }
+    std::uniform_int_distribution<int> pickNode(0, layerSize - 1);
+    std::uniform_int_distribution<int> pickPort(0, TestGraph::s_outputPortCount - 1);
+    for (int layer = 1; layer < layerCount; ++layer)
+    {
+        for (NodeUniqueId dst : layers[layer])
+        {
+            for (int input = 0; input < 3; ++input)
+            {
+                graph.AddEdge(layers[layer - 1][pickNode(rng)], dst, pickPort(rng));
+            }
+        }
+    }
+    return graph;
+}
+
+void CheckSameLevels(const TestGraph& graph)
+{
+    SNE_CHECK(SameLevels(FlatTopologicalSort(graph.GetNodes(), graph.GetEdges()),
+                         TopologicalSort(graph.GetNodes(), graph.GetEdges())));
+}
+
+void TestRandomDags(std::mt19937& rng)
+{
+    for (int nodeCount : {1, 2, 3, 10, 100, 1000})
+    {
+        for (int density : {0, 1, 2, 4})
+        {
+            CheckSameLevels(TestGraph::RandomDag(nodeCount, nodeCount * density / 2, rng));
+        }
+    }
+    SNE_CHECK(FlatTopologicalSort({}, {}).GetLevelCount() == 0);
+}
+
+// levels of 8192 nodes and more are visited on several threads
+void TestWideLevels(std::mt19937& rng)
+{
+    if (std::thread::hardware_concurrency() < 2)
+    {
+        std::printf("single hardware thread, wide levels are visited on one thread only\n");
+    }
+    CheckSameLevels(WideDag(4, 10000, rng));
+    CheckSameLevels(TestGraph::RandomDag(40000, 30000, rng));
+}
+
+// both fall back to the condensed levels
+void TestCycles(std::mt19937& rng)
+{
+    TestGraph                 graph = TestGraph::RandomDag(200, 300, rng);
+    std::vector<NodeUniqueId> nodes;
+    for (const auto& [nodeUid, _] : graph.GetNodes())
+    {
+        nodes.push_back(nodeUid);
+    }
+    std::uniform_int_distribution<size_t> pickNode(0, nodes.size() - 1);
+    for (int edge = 0; edge < 5; ++edge)
+    {
+        const NodeUniqueId src = nodes[pickNode(rng)];
+        const NodeUniqueId dst = nodes[pickNode(rng)];
+        graph.AddEdge(std::max(src, dst), std::min(src, dst));
+    }
+    SNE_CHECK(!FindCycles(graph.GetNodes(), graph.GetEdges()).empty());
+    CheckSameLevels(graph);
+}
+
+void RunBenchmarks(std::mt19937& rng)
+{
+    for (int nodeCount : {10000, 100000, 1000000})
+    {
+        const TestGraph graph = TestGraph::RandomDag(nodeCount, nodeCount * 3 / 2, rng);
+        const TestGraph wide = WideDag(8, nodeCount / 8, rng);
+        for (const TestGraph* dag : {&graph, &wide})
+        {
+            size_t       checksum = 0;
+            const double nestedMs = MeasureMs(
+                [&] { checksum += TopologicalSort(dag->GetNodes(), dag->GetEdges()).size(); });
+            const double flatMs = MeasureMs(
+                [&] {
+                    checksum +=
+                        FlatTopologicalSort(dag->GetNodes(), dag->GetEdges()).GetLevelCount();
+                });
+            std::printf("%d nodes, %s: TopologicalSort %.3f ms, FlatTopologicalSort %.3f ms "
+                        "(%zu)\n",
+                        nodeCount, dag == &graph ? "random" : "8 wide levels", nestedMs, flatMs,
+                        checksum);
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Log::GetInstance().SetLogLevel(Log::LogLevel::LogError);
+
+    std::mt19937 rng(20240611);
+    TestRandomDags(rng);
+    TestWideLevels(rng);
+    TestCycles(rng);
+    if (SimpleNodeEditor::Test::WantsBenchmark(argc, argv))
+    {
+        RunBenchmarks(rng);
+    }
+    return SimpleNodeEditor::Test::Result();
+}
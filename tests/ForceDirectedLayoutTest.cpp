@@ -0,0 +1,204 @@
+// Checks that ForceDirectedLayout settles on a small graph, that it stops after its iteration cap
+// when the step never gets small enough, and that pinned nodes stay where they were pinned.
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "ForceDirectedLayout.hpp"
+#include "Log.hpp"
+#include "TestHelpers.hpp"
+
+using namespace SimpleNodeEditor;
+
+namespace
+{
+
+// long enough for any of the graphs here to settle in one Step
+constexpr std::chrono::microseconds s_unlimited = std::chrono::seconds(60);
+
+struct Graph
+{
+    std::unordered_map<NodeUniqueId, ImVec2>           m_positions;
+    std::unordered_map<NodeUniqueId, ImVec2>           m_sizes;
+    std::vector<std::pair<NodeUniqueId, NodeUniqueId>> m_edges;
+};
+
+// a random tree with a few extra links, nodes scattered over a small area and some of them on the
+// same spot, as nodes that were never placed are
+Graph RandomGraph(std::mt19937& rng, int nodeCount)
+{
+    std::uniform_real_distribution<float> coord(0.f, 600.f);
+    std::uniform_real_distribution<float> width(80.f, 200.f);
+    std::uniform_real_distribution<float> height(40.f, 150.f);
+
+    Graph graph;
+    for (NodeUniqueId nodeUid = 0; nodeUid < nodeCount; ++nodeUid)
+    {
+        graph.m_positions.emplace(nodeUid, nodeUid % 5 == 0 ? ImVec2(0.f, 0.f)
+                                                            : ImVec2(coord(rng), coord(rng)));
+        graph.m_sizes.emplace(nodeUid, ImVec2(width(rng), height(rng)));
+        if (nodeUid > 0)
+        {
+            graph.m_edges.emplace_back(static_cast<NodeUniqueId>(rng() % nodeUid), nodeUid);
+        }
+    }
+    for (int extra = nodeCount / 4; extra > 0; --extra)
+    {
+        graph.m_edges.emplace_back(static_cast<NodeUniqueId>(rng() % nodeCount),
+                                   static_cast<NodeUniqueId>(rng() % nodeCount));
+    }
+    return graph;
+}
+
+bool AllFinite(const ForceDirectedLayout& layout)
+{
+    for (size_t index = 0; index < layout.GetNodeCount(); ++index)
+    {
+        const ImVec2 position = layout.GetPosition(index);
+        if (!std::isfinite(position.x) || !std::isfinite(position.y))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// no two nodes are left on the same spot
+bool AllApart(const ForceDirectedLayout& layout)
+{
+    for (size_t index = 0; index < layout.GetNodeCount(); ++index)
+    {
+        for (size_t other = index + 1; other < layout.GetNodeCount(); ++other)
+        {
+            const float dx = layout.GetPosition(index).x - layout.GetPosition(other).x;
+            const float dy = layout.GetPosition(index).y - layout.GetPosition(other).y;
+            if (dx * dx + dy * dy < 1.f)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void TestSettles(std::mt19937& rng)
+{
+    const ForceDirectedLayout::Options options;
+    for (int round = 0; round < 10; ++round)
+    {
+        const Graph         graph = RandomGraph(rng, 10 + round * 5);
+        ForceDirectedLayout layout(options);
+        layout.Reset(graph.m_positions, graph.m_sizes, graph.m_edges);
+        SNE_CHECK(!layout.IsSettled());
+
+        // by the step getting small, well before the cap
+        SNE_CHECK(layout.Step(s_unlimited));
+        SNE_CHECK(layout.IsSettled());
+        SNE_CHECK(layout.GetIterationCount() < options.m_maxIterations);
+        SNE_CHECK(AllFinite(layout));
+        SNE_CHECK(AllApart(layout));
+
+        // a settled layout is left alone
+        const size_t iterations = layout.GetIterationCount();
+        SNE_CHECK(layout.Step(s_unlimited));
+        SNE_CHECK(layout.GetIterationCount() == iterations);
+    }
+
+    // a budget that is spent at once still runs an iteration per Step
+    const Graph         graph = RandomGraph(rng, 30);
+    ForceDirectedLayout layout(options);
+    layout.Reset(graph.m_positions, graph.m_sizes, graph.m_edges);
+    SNE_CHECK(!layout.Step(std::chrono::microseconds(0)));
+    SNE_CHECK(layout.GetIterationCount() == 1);
+
+    // nothing to lay out, or a single node, is settled from the start
+    ForceDirectedLayout empty(options);
+    empty.Reset({}, {}, {});
+    SNE_CHECK(empty.IsSettled());
+    ForceDirectedLayout single(options);
+    single.Reset({{7, ImVec2(10.f, 20.f)}}, {{7, ImVec2(100.f, 50.f)}}, {{7, 7}});
+    SNE_CHECK(single.Step(s_unlimited));
+    SNE_CHECK(Test::SameBits(single.GetPosition(0).x, 10.f));
+    SNE_CHECK(Test::SameBits(single.GetPosition(0).y, 20.f));
+}
+
+void TestIterationCap(std::mt19937& rng)
+{
+    // a tolerance of zero is never reached, like a step that keeps swinging up and down
+    ForceDirectedLayout::Options options;
+    options.m_tolerance     = 0.f;
+    options.m_maxIterations = 200;
+    const Graph         graph = RandomGraph(rng, 40);
+    ForceDirectedLayout layout(options);
+    layout.Reset(graph.m_positions, graph.m_sizes, graph.m_edges);
+
+    SNE_CHECK(layout.Step(s_unlimited));
+    SNE_CHECK(layout.GetIterationCount() == options.m_maxIterations);
+    SNE_CHECK(AllFinite(layout));
+    SNE_CHECK(layout.Step(s_unlimited));
+    SNE_CHECK(layout.GetIterationCount() == options.m_maxIterations);
+
+    // Reset starts the count over
+    layout.Reset(graph.m_positions, graph.m_sizes, graph.m_edges);
+    SNE_CHECK(layout.GetIterationCount() == 0);
+    SNE_CHECK(!layout.IsSettled());
+}
+
+void TestPinnedNodes(std::mt19937& rng)
+{
+    const Graph         graph = RandomGraph(rng, 40);
+    ForceDirectedLayout layout;
+    layout.Reset(graph.m_positions, graph.m_sizes, graph.m_edges);
+
+    // pinned where they are, and one pinned somewhere else, as after a drag
+    std::unordered_map<NodeUniqueId, ImVec2> pinned = {{3, graph.m_positions.at(3)},
+                                                       {11, graph.m_positions.at(11)},
+                                                       {24, ImVec2(-500.25f, 1234.5f)}};
+    for (const auto& [nodeUid, position] : pinned)
+    {
+        layout.Pin(nodeUid, position);
+    }
+    // an unknown node is ignored
+    layout.Pin(1000, ImVec2(0.f, 0.f));
+
+    // stepped a frame at a time, as the editor does
+    int steps = 0;
+    while (!layout.Step(std::chrono::microseconds(200)) && ++steps < 100000)
+    {
+    }
+    SNE_CHECK(layout.IsSettled());
+
+    size_t moved = 0;
+    for (size_t index = 0; index < layout.GetNodeCount(); ++index)
+    {
+        const NodeUniqueId nodeUid  = layout.GetNodeUid(index);
+        const ImVec2       position = layout.GetPosition(index);
+        auto               iter     = pinned.find(nodeUid);
+        SNE_CHECK(layout.IsPinned(index) == (iter != pinned.end()));
+        if (iter != pinned.end())
+        {
+            SNE_CHECK(Test::SameBits(position.x, iter->second.x));
+            SNE_CHECK(Test::SameBits(position.y, iter->second.y));
+        }
+        else if (position.x != graph.m_positions.at(nodeUid).x ||
+                 position.y != graph.m_positions.at(nodeUid).y)
+        {
+            ++moved;
+        }
+    }
+    SNE_CHECK(moved == layout.GetNodeCount() - pinned.size());
+}
+
+} // namespace
+
+int main()
+{
+    Log::GetInstance().SetLogLevel(Log::LogLevel::LogError);
+
+    std::mt19937 rng(20240611);
+    TestSettles(rng);
+    TestIterationCap(rng);
+    TestPinnedNodes(rng);
+    return SimpleNodeEditor::Test::Result();
+}
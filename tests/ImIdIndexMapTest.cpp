@@ -0,0 +1,178 @@
+// Checks ImIdIndexMap against the ImGuiStorage it replaced, and the object pool built on top of it
+// over a few simulated frames. Run with --benchmark to time the first frame of a large graph.
+#include <imnodes_internal.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <vector>
+#include "TestHelpers.hpp"
+
+using SimpleNodeEditor::Test::MeasureMs;
+
+namespace
+{
+
+void CheckSameContent(const ImIdIndexMap& map, const ImGuiStorage& reference,
+                      const std::vector<ImGuiID>& keys)
+{
+    for (ImGuiID key : keys)
+    {
+        SNE_CHECK(map.GetInt(key, -1) == reference.GetInt(key, -1));
+        SNE_CHECK(map.GetInt(key, 12345) == reference.GetInt(key, 12345));
+    }
+    SNE_CHECK(map.Count * 2 <= map.Slots.Size);
+}
+
+void TestMapMatchesStorage(std::mt19937& rng)
+{
+    // dense ids like the editor hands out, sparse ones, ids sharing their low bits, and negative
+    // ids cast to ImGuiID
+    std::vector<ImGuiID> keys;
+    for (ImGuiID key = 0; key < 300; ++key)
+    {
+        keys.push_back(key);
+    }
+    for (int i = 0; i < 300; ++i)
+    {
+        keys.push_back(static_cast<ImGuiID>(rng()));
+        keys.push_back(static_cast<ImGuiID>(i) << 20);
+        keys.push_back(static_cast<ImGuiID>(-1 - i));
+    }
+    keys.push_back(0xFFFFFFFFu);
+
+    ImIdIndexMap map;
+    ImGuiStorage reference;
+    CheckSameContent(map, reference, keys);
+
+    std::uniform_int_distribution<size_t> pickKey(0, keys.size() - 1);
+    std::uniform_int_distribution<int>    pickValue(-1, 100000);
+    for (int op = 0; op < 20000; ++op)
+    {
+        const ImGuiID key = keys[pickKey(rng)];
+        // unmap a fair share of the entries, the pool does it for every freed object
+        const int value = op % 3 == 0 ? -1 : pickValue(rng);
+        map.SetInt(key, value);
+        reference.SetInt(key, value);
+        SNE_CHECK(map.GetInt(key, 12345) == value);
+        if (op % 1000 == 0)
+        {
+            CheckSameContent(map, reference, keys);
+        }
+    }
+    CheckSameContent(map, reference, keys);
+}
+
+// pins come and go over the frames like in the editor: every frame a random subset of the ids is
+// submitted, the others are freed by ObjectPoolUpdate and their slots reused
+void TestObjectPoolFrames(std::mt19937& rng)
+{
+    ImObjectPool<ImPinData> pins;
+    std::vector<int>        ids(2000);
+    std::iota(ids.begin(), ids.end(), -1000);
+    std::bernoulli_distribution submitted(0.6);
+    std::vector<int>            indexOfId(ids.size(), -1);
+
+    for (int frame = 0; frame < 30; ++frame)
+    {
+        ImNodes::ObjectPoolReset(pins);
+        std::shuffle(ids.begin(), ids.end(), rng);
+        std::fill(indexOfId.begin(), indexOfId.end(), -1);
+        for (int id : ids)
+        {
+            if (!submitted(rng))
+            {
+                continue;
+            }
+            const int index = ImNodes::ObjectPoolFindOrCreateIndex(pins, id);
+            indexOfId[id + 1000] = index;
+            SNE_CHECK(pins.Pool[index].Id == id);
+            SNE_CHECK(ImNodes::ObjectPoolFindOrCreateIndex(pins, id) == index);
+        }
+        ImNodes::ObjectPoolUpdate(pins);
+
+        for (int id : ids)
+        {
+            const int expected = indexOfId[id + 1000];
+            SNE_CHECK(ImNodes::ObjectPoolFind(pins, id) == expected);
+            if (expected != -1)
+            {
+                SNE_CHECK(pins.InUse[expected]);
+            }
+        }
+        // freed slots are reused before the pool grows
+        SNE_CHECK(pins.Pool.Size <= static_cast<int>(ids.size()));
+    }
+}
+
+// the first frame after loading a graph: every pin id is inserted once
+template <typename Map>
+int InsertAll(Map& map, const std::vector<int>& ids)
+{
+    int found = 0;
+    for (int i = 0; i < static_cast<int>(ids.size()); ++i)
+    {
+        const ImGuiID key = static_cast<ImGuiID>(ids[i]);
+        found += map.GetInt(key, -1) != -1;
+        map.SetInt(key, i);
+    }
+    return found;
+}
+
+void RunBenchmarks(std::mt19937& rng)
+{
+    const int        pinCount = 100000;
+    std::vector<int> ascending(pinCount);
+    std::iota(ascending.begin(), ascending.end(), 0);
+    std::vector<int> shuffled = ascending;
+    std::shuffle(shuffled.begin(), shuffled.end(), rng);
+
+    int checksum = 0;
+    for (const std::vector<int>* ids : {&ascending, &shuffled})
+    {
+        const char*  order = ids == &ascending ? "ascending" : "shuffled";
+        const double mapMs = MeasureMs([&] {
+            ImIdIndexMap map;
+            checksum += InsertAll(map, *ids);
+        });
+        const double storageMs = MeasureMs([&] {
+            ImGuiStorage storage;
+            checksum += InsertAll(storage, *ids);
+        });
+        std::printf("%d %s ids: ImIdIndexMap %.3f ms, ImGuiStorage %.3f ms\n", pinCount, order,
+                    mapMs, storageMs);
+    }
+
+    ImObjectPool<ImPinData> pins;
+    const double poolMs = MeasureMs([&] {
+        for (int id : shuffled)
+        {
+            checksum += ImNodes::ObjectPoolFindOrCreateIndex(pins, id);
+        }
+    });
+    const double frameMs = MeasureMs([&] {
+        ImNodes::ObjectPoolReset(pins);
+        for (int id : shuffled)
+        {
+            checksum += ImNodes::ObjectPoolFindOrCreateIndex(pins, id);
+        }
+        ImNodes::ObjectPoolUpdate(pins);
+    });
+    std::printf("%d pins: first frame %.3f ms, next frame %.3f ms (%d)\n", pinCount, poolMs,
+                frameMs, checksum);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::mt19937 rng(20240611);
+    TestMapMatchesStorage(rng);
+    TestObjectPoolFrames(rng);
+    if (SimpleNodeEditor::Test::WantsBenchmark(argc, argv))
+    {
+        RunBenchmarks(rng);
+    }
+    return SimpleNodeEditor::Test::Result();
+}
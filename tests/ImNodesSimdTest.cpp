@@ -0,0 +1,289 @@
+// Checks the vectorized bezier sampling, segment distance and pin hover paths of imnodes against
+// the scalar code they replace. The helpers live in an anonymous namespace, so the imnodes source
+// is compiled into this test directly.
+#include "imnodes.cpp"
+
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "TestHelpers.hpp"
+
+using SimpleNodeEditor::Test::MeasureMs;
+using SimpleNodeEditor::Test::SameBits;
+
+namespace
+{
+
+// the hover loop as it was before vectorizing it
+ImOptionalIndex ResolveHoveredPinScalar(
+    const ImNodesEditorContext& editor,
+    const ImBitVector&          occludedPins)
+{
+    const float hoverRadiusSqr = GImNodes->Style.PinHoverRadius * GImNodes->Style.PinHoverRadius;
+    float       smallestDistance = FLT_MAX;
+    ImOptionalIndex closestPin;
+    for (int idx = 0; idx < editor.Pins.Pool.Size; ++idx)
+    {
+        if (!editor.Pins.InUse[idx] || occludedPins.TestBit(idx))
+        {
+            continue;
+        }
+        const float dx = editor.PinPosX[idx] - GImNodes->MousePos.x;
+        const float dy = editor.PinPosY[idx] - GImNodes->MousePos.y;
+        const float distanceSqr = dx * dx + dy * dy;
+        if (distanceSqr < hoverRadiusSqr && distanceSqr < smallestDistance)
+        {
+            smallestDistance = distanceSqr;
+            closestPin = idx;
+        }
+    }
+    return closestPin;
+}
+
+// the closest point search as it was before sampling in batches
+ImVec2 GetClosestPointOnCubicBezierScalar(int numSegments, const ImVec2& p,
+                                          const ImNodes::CubicBezier& cb)
+{
+    ImVec2 pLast = cb.P0;
+    ImVec2 pClosest;
+    float  pClosestDist = FLT_MAX;
+    float  tStep = 1.0f / (float)numSegments;
+    for (int i = 1; i <= numSegments; ++i)
+    {
+        ImVec2 pCurrent = ImNodes::EvalCubicBezier(tStep * i, cb.P0, cb.P1, cb.P2, cb.P3);
+        ImVec2 pLine = ImLineClosestPoint(pLast, pCurrent, p);
+        float  dist = ImLengthSqr(p - pLine);
+        if (dist < pClosestDist)
+        {
+            pClosest = pLine;
+            pClosestDist = dist;
+        }
+        pLast = pCurrent;
+    }
+    return pClosest;
+}
+
+ImNodes::CubicBezier RandomCurve(std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> coord(-2000.f, 2000.f);
+    ImNodes::CubicBezier                  cb;
+    cb.P0 = ImVec2(coord(rng), coord(rng));
+    cb.P1 = ImVec2(coord(rng), coord(rng));
+    cb.P2 = ImVec2(coord(rng), coord(rng));
+    cb.P3 = ImVec2(coord(rng), coord(rng));
+    cb.NumSegments = 0;
+    return cb;
+}
+
+// pins on an integer grid around the mouse, so that several of them are in hover range and some
+// are exactly as far as each other
+void FillPins(ImNodesEditorContext& editor, ImBitVector& occludedPins, int poolSize,
+              std::mt19937& rng)
+{
+    std::uniform_int_distribution<int> offset(-14, 14);
+    std::bernoulli_distribution        inUse(0.8);
+    std::bernoulli_distribution        occluded(0.3);
+
+    editor.Pins.Pool.clear();
+    editor.Pins.InUse.clear();
+    editor.PinPosX.clear();
+    editor.PinPosY.clear();
+    occludedPins.Create(poolSize);
+    for (int idx = 0; idx < poolSize; ++idx)
+    {
+        editor.Pins.Pool.push_back(ImPinData(idx));
+        editor.Pins.InUse.push_back(inUse(rng));
+        editor.PinPosX.push_back(GImNodes->MousePos.x + (float)offset(rng));
+        editor.PinPosY.push_back(GImNodes->MousePos.y + (float)offset(rng));
+        if (occluded(rng))
+        {
+            occludedPins.SetBit(idx);
+        }
+    }
+}
+
+void TestEvalCubicBezierBatch(std::mt19937& rng)
+{
+    std::uniform_int_distribution<int> segments(1, 200);
+    float xs[ImNodes::BEZIER_BATCH_SIZE], ys[ImNodes::BEZIER_BATCH_SIZE];
+    for (int round = 0; round < 500; ++round)
+    {
+        const ImNodes::CubicBezier cb = RandomCurve(rng);
+        const int                  numSegments = segments(rng);
+        const float                tStep = 1.0f / (float)numSegments;
+        // every count up to the batch size, so that all vector tails are covered
+        const int count = round % (ImNodes::BEZIER_BATCH_SIZE + 1);
+        const int first = std::uniform_int_distribution<int>(0, numSegments)(rng);
+        ImNodes::EvalCubicBezierBatch(cb, tStep, first, count, xs, ys);
+        for (int i = 0; i < count; ++i)
+        {
+            const ImVec2 expected =
+                ImNodes::EvalCubicBezier(tStep * (float)(first + i), cb.P0, cb.P1, cb.P2, cb.P3);
+            SNE_CHECK(SameBits(xs[i], expected.x) && SameBits(ys[i], expected.y));
+        }
+    }
+}
+
+void TestClosestPointOnSegmentsBatch(std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> coord(-500.f, 500.f);
+    float xs[ImNodes::BEZIER_BATCH_SIZE + 1], ys[ImNodes::BEZIER_BATCH_SIZE + 1];
+    float closestX[ImNodes::BEZIER_BATCH_SIZE], closestY[ImNodes::BEZIER_BATCH_SIZE];
+    float distSqr[ImNodes::BEZIER_BATCH_SIZE];
+    for (int round = 0; round < 500; ++round)
+    {
+        const int count = round % (ImNodes::BEZIER_BATCH_SIZE + 1);
+        for (int k = 0; k <= count; ++k)
+        {
+            xs[k] = coord(rng);
+            ys[k] = coord(rng);
+        }
+        const ImVec2 p(coord(rng), coord(rng));
+        ImNodes::ClosestPointOnSegmentsBatch(p, xs, ys, count, closestX, closestY, distSqr);
+        for (int k = 0; k < count; ++k)
+        {
+            const ImVec2 expected =
+                ImLineClosestPoint(ImVec2(xs[k], ys[k]), ImVec2(xs[k + 1], ys[k + 1]), p);
+            SNE_CHECK(SameBits(closestX[k], expected.x) && SameBits(closestY[k], expected.y));
+            SNE_CHECK(SameBits(distSqr[k], ImLengthSqr(p - expected)));
+        }
+    }
+}
+
+void TestGetClosestPointOnCubicBezier(std::mt19937& rng)
+{
+    std::uniform_int_distribution<int>    segments(1, 300);
+    std::uniform_real_distribution<float> coord(-2000.f, 2000.f);
+    for (int round = 0; round < 500; ++round)
+    {
+        const ImNodes::CubicBezier cb = RandomCurve(rng);
+        const int                  numSegments = segments(rng);
+        const ImVec2               p(coord(rng), coord(rng));
+        const ImVec2 batched = ImNodes::GetClosestPointOnCubicBezier(numSegments, p, cb);
+        const ImVec2 scalar = GetClosestPointOnCubicBezierScalar(numSegments, p, cb);
+        SNE_CHECK(SameBits(batched.x, scalar.x) && SameBits(batched.y, scalar.y));
+    }
+}
+
+void TestResolveHoveredPin(std::mt19937& rng)
+{
+    ImNodesEditorContext editor;
+    ImBitVector          occludedPins;
+    // pool sizes around and between multiples of the vector width
+    std::vector<int> poolSizes;
+    for (int size = 0; size <= 33; ++size)
+    {
+        poolSizes.push_back(size);
+    }
+    poolSizes.insert(poolSizes.end(), {63, 64, 65, 66, 127, 1021, 1024, 4099});
+
+    for (int poolSize : poolSizes)
+    {
+        for (int round = 0; round < 50; ++round)
+        {
+            FillPins(editor, occludedPins, poolSize, rng);
+            SNE_CHECK(ImNodes::ResolveHoveredPin(editor, occludedPins) ==
+                      ResolveHoveredPinScalar(editor, occludedPins));
+        }
+    }
+
+    // the closest pin is occluded, the next one over must be picked, even when it sits in the
+    // scalar tail
+    FillPins(editor, occludedPins, 6, rng);
+    for (int idx = 0; idx < 6; ++idx)
+    {
+        editor.Pins.InUse[idx] = true;
+        occludedPins.ClearBit(idx);
+        editor.PinPosX[idx] = GImNodes->MousePos.x + 50.f;
+        editor.PinPosY[idx] = GImNodes->MousePos.y;
+    }
+    editor.PinPosX[1] = GImNodes->MousePos.x + 1.f;
+    editor.PinPosX[5] = GImNodes->MousePos.x + 2.f;
+    SNE_CHECK(ImNodes::ResolveHoveredPin(editor, occludedPins) == 1);
+    occludedPins.SetBit(1);
+    SNE_CHECK(ImNodes::ResolveHoveredPin(editor, occludedPins) == 5);
+    occludedPins.SetBit(5);
+    SNE_CHECK(!ImNodes::ResolveHoveredPin(editor, occludedPins).HasValue());
+
+    // ties go to the lowest index, across lanes and across vector chunks
+    for (int idx = 0; idx < 6; ++idx)
+    {
+        occludedPins.ClearBit(idx);
+        editor.PinPosX[idx] = GImNodes->MousePos.x + 3.f;
+    }
+    occludedPins.SetBit(0);
+    SNE_CHECK(ImNodes::ResolveHoveredPin(editor, occludedPins) == 1);
+}
+
+void RunBenchmarks(std::mt19937& rng)
+{
+    ImNodesEditorContext editor;
+    ImBitVector          occludedPins;
+    const int            poolSize = 100003;
+    const int            frames = 200;
+    FillPins(editor, occludedPins, poolSize, rng);
+    int checksum = 0;
+    const double simdMs = MeasureMs([&] {
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            checksum += ImNodes::ResolveHoveredPin(editor, occludedPins).HasValue();
+        }
+    });
+    const double scalarMs = MeasureMs([&] {
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            checksum += ResolveHoveredPinScalar(editor, occludedPins).HasValue();
+        }
+    });
+    std::printf("ResolveHoveredPin, %d pins: %.3f ms/frame, scalar %.3f ms/frame (%d)\n",
+                poolSize, simdMs / frames, scalarMs / frames, checksum);
+
+    const int                         curves = 20000;
+    std::vector<ImNodes::CubicBezier> links;
+    std::uniform_real_distribution<float> coord(-2000.f, 2000.f);
+    std::vector<ImVec2>                   mouse;
+    for (int i = 0; i < curves; ++i)
+    {
+        links.push_back(RandomCurve(rng));
+        mouse.push_back(ImVec2(coord(rng), coord(rng)));
+    }
+    float sum = 0.f;
+    const double batchedMs = MeasureMs([&] {
+        for (int i = 0; i < curves; ++i)
+        {
+            sum += ImNodes::GetClosestPointOnCubicBezier(100, mouse[i], links[i]).x;
+        }
+    });
+    const double scalarCurveMs = MeasureMs([&] {
+        for (int i = 0; i < curves; ++i)
+        {
+            sum += GetClosestPointOnCubicBezierScalar(100, mouse[i], links[i]).x;
+        }
+    });
+    std::printf("GetClosestPointOnCubicBezier, %d links x 100 segments: %.3f ms, scalar %.3f ms "
+                "(%g)\n",
+                curves, batchedMs, scalarCurveMs, sum);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    ImGui::CreateContext();
+    ImNodes::CreateContext();
+    GImNodes->MousePos = ImVec2(100.f, 200.f);
+
+    std::mt19937 rng(20240611);
+    TestEvalCubicBezierBatch(rng);
+    TestClosestPointOnSegmentsBatch(rng);
+    TestGetClosestPointOnCubicBezier(rng);
+    TestResolveHoveredPin(rng);
+    if (SimpleNodeEditor::Test::WantsBenchmark(argc, argv))
+    {
+        RunBenchmarks(rng);
+    }
+
+    ImNodes::DestroyContext();
+    ImGui::DestroyContext();
+    return SimpleNodeEditor::Test::Result();
+}
@@ -0,0 +1,346 @@
+// Checks the spatially indexed pin occlusion and box selection of imnodes against brute force, and
+// that the state they keep between frames survives panning but not moving a node. The helpers live in an anonymous
+// namespace, so the imnodes source is compiled into this test directly.
+#include "imnodes.cpp"
+
+#include <cstring>
+#include <random>
+#include "TestHelpers.hpp"
+
+namespace
+{
+
+// a node in screen space with pins on its left and right edges, added on top of the depth order
+void AddNode(ImNodesEditorContext& editor, const ImRect& rect, int pinCount)
+{
+    const int nodeIdx = editor.Nodes.Pool.Size;
+    editor.Nodes.Pool.push_back(ImNodeData(nodeIdx));
+    editor.Nodes.InUse.push_back(true);
+    editor.NodeDepthOrder.push_back(nodeIdx);
+    ImNodeData& node = editor.Nodes.Pool.back();
+    node.Rect = rect;
+    for (int pin = 0; pin < pinCount; ++pin)
+    {
+        const int pinIdx = editor.Pins.Pool.Size;
+        editor.Pins.Pool.push_back(ImPinData(pinIdx));
+        editor.Pins.InUse.push_back(true);
+        ImPinData& pinData = editor.Pins.Pool.back();
+        pinData.ParentNodeIdx = nodeIdx;
+        pinData.Pos = ImVec2(pin % 2 == 0 ? rect.Min.x : rect.Max.x,
+                             rect.Min.y + rect.GetHeight() * (float)(pin / 2 + 1) /
+                                              (float)(pinCount / 2 + 2));
+        node.PinIndices.push_back(pinIdx);
+    }
+}
+
+// overlapping nodes, so that many pins are covered by the ones above them
+void FillNodes(ImNodesEditorContext& editor, int nodeCount, std::mt19937& rng)
+{
+    std::uniform_int_distribution<int> coord(0, 3000);
+    std::uniform_int_distribution<int> size(60, 300);
+    std::uniform_int_distribution<int> pins(0, 6);
+    for (int node = 0; node < nodeCount; ++node)
+    {
+        const ImVec2 min((float)coord(rng), (float)coord(rng));
+        AddNode(editor, ImRect(min, min + ImVec2((float)size(rng), (float)size(rng))), pins(rng));
+    }
+}
+
+void MoveNode(ImNodesEditorContext& editor, int nodeIdx, const ImVec2& delta)
+{
+    ImNodeData& node = editor.Nodes.Pool[nodeIdx];
+    node.Rect.Translate(delta);
+    for (int idx = 0; idx < node.PinIndices.Size; ++idx)
+    {
+        editor.Pins.Pool[node.PinIndices[idx]].Pos += delta;
+    }
+}
+
+// everything is laid out again at its new screen position, as on the frame after a pan
+void Pan(ImNodesEditorContext& editor, const ImVec2& delta)
+{
+    editor.Panning += delta;
+    for (int nodeIdx = 0; nodeIdx < editor.Nodes.Pool.Size; ++nodeIdx)
+    {
+        MoveNode(editor, nodeIdx, delta);
+    }
+}
+
+bool IsOccludedBruteForce(const ImNodesEditorContext& editor, int pinIdx)
+{
+    const ImPinData& pin = editor.Pins.Pool[pinIdx];
+    bool             above = false;
+    for (int depth = 0; depth < editor.NodeDepthOrder.Size; ++depth)
+    {
+        const int nodeIdx = editor.NodeDepthOrder[depth];
+        if (above && editor.Nodes.Pool[nodeIdx].Rect.Contains(pin.Pos))
+        {
+            return true;
+        }
+        above = above || nodeIdx == pin.ParentNodeIdx;
+    }
+    return false;
+}
+
+void CheckOcclusion(ImNodesEditorContext& editor)
+{
+    const ImBitVector& occluded = ImNodes::ResolveOccludedPins(editor);
+    int                mismatches = 0;
+    for (int pinIdx = 0; pinIdx < editor.Pins.Pool.Size; ++pinIdx)
+    {
+        mismatches += occluded.TestBit(pinIdx) != IsOccludedBruteForce(editor, pinIdx);
+    }
+    SNE_CHECK(mismatches == 0);
+}
+
+// a bit the cache cannot have computed, it is gone once the cache is rebuilt
+int MarkCache(ImNodesEditorContext& editor)
+{
+    for (int pinIdx = 0; pinIdx < editor.Pins.Pool.Size; ++pinIdx)
+    {
+        if (!editor.PinOcclusion.OccludedPins.TestBit(pinIdx))
+        {
+            editor.PinOcclusion.OccludedPins.SetBit(pinIdx);
+            return pinIdx;
+        }
+    }
+    SNE_CHECK(!"every pin is occluded");
+    return 0;
+}
+
+void TestPinOcclusion(std::mt19937& rng)
+{
+    ImNodesEditorContext editor;
+    FillNodes(editor, 300, rng);
+    CheckOcclusion(editor);
+
+    // panning and zooming move every rect and pin alike, the cached result stays
+    int marked = MarkCache(editor);
+    for (const ImVec2 delta : {ImVec2(37.f, -12.f), ImVec2(-400.f, 250.f), ImVec2(0.5f, 0.25f)})
+    {
+        Pan(editor, delta);
+        SNE_CHECK(ImNodes::ResolveOccludedPins(editor).TestBit(marked));
+    }
+
+    // moving a node does not, the marked pin is moved clear of every other node
+    MoveNode(editor, editor.Pins.Pool[marked].ParentNodeIdx, ImVec2(5000.f, 5000.f));
+    SNE_CHECK(!ImNodes::ResolveOccludedPins(editor).TestBit(marked));
+    CheckOcclusion(editor);
+
+    // nor does raising one to the top
+    marked = MarkCache(editor);
+    const int bottom = editor.NodeDepthOrder[0];
+    editor.NodeDepthOrder.erase(editor.NodeDepthOrder.begin());
+    editor.NodeDepthOrder.push_back(bottom);
+    SNE_CHECK(!ImNodes::ResolveOccludedPins(editor).TestBit(marked) ||
+              IsOccludedBruteForce(editor, marked));
+    CheckOcclusion(editor);
+}
+
+// pins on the left edge are inputs and those on the right outputs, their rows are the attribute
+// rects
+void SetPinAttributes(ImNodesEditorContext& editor)
+{
+    for (int pinIdx = 0; pinIdx < editor.Pins.Pool.Size; ++pinIdx)
+    {
+        ImPinData&        pin = editor.Pins.Pool[pinIdx];
+        const ImNodeData& node = editor.Nodes.Pool[pin.ParentNodeIdx];
+        pin.Type = pin.Pos.x == node.Rect.Min.x ? ImNodesAttributeType_Input
+                                                : ImNodesAttributeType_Output;
+        pin.AttributeRect =
+            ImRect(node.Rect.Min.x, pin.Pos.y - 5.f, node.Rect.Max.x, pin.Pos.y + 5.f);
+    }
+}
+
+void AddLink(ImNodesEditorContext& editor, int startPinIdx, int endPinIdx)
+{
+    const int linkIdx = editor.Links.Pool.Size;
+    editor.Links.Pool.push_back(ImLinkData(linkIdx));
+    editor.Links.InUse.push_back(true);
+    editor.Links.Pool.back().StartPinIdx = startPinIdx;
+    editor.Links.Pool.back().EndPinIdx = endPinIdx;
+}
+
+// random links from outputs to inputs, which run backward whenever the input is left of the
+// output, loops from a node back to itself, and links routed through a path
+void FillLinks(ImNodesEditorContext& editor, int linkCount, std::mt19937& rng)
+{
+    ImVector<int> inputs, outputs;
+    for (int pinIdx = 0; pinIdx < editor.Pins.Pool.Size; ++pinIdx)
+    {
+        (editor.Pins.Pool[pinIdx].Type == ImNodesAttributeType_Input ? inputs : outputs)
+            .push_back(pinIdx);
+    }
+    std::uniform_int_distribution<int> pickInput(0, inputs.Size - 1);
+    std::uniform_int_distribution<int> pickOutput(0, outputs.Size - 1);
+    std::uniform_int_distribution<int> coord(0, 3000);
+    for (int link = 0; link < linkCount; ++link)
+    {
+        const int output = outputs[pickOutput(rng)];
+        int       input = inputs[pickInput(rng)];
+        if (link % 10 == 0)
+        {
+            // a loop, when the node has an input
+            const ImNodeData& node = editor.Nodes.Pool[editor.Pins.Pool[output].ParentNodeIdx];
+            for (int idx = 0; idx < node.PinIndices.Size; ++idx)
+            {
+                if (editor.Pins.Pool[node.PinIndices[idx]].Type == ImNodesAttributeType_Input)
+                {
+                    input = node.PinIndices[idx];
+                }
+            }
+        }
+        AddLink(editor, output, input);
+        if (link % 7 == 0)
+        {
+            ImLinkData& added = editor.Links.Pool.back();
+            for (int corner = 0; corner < 1 + link % 3; ++corner)
+            {
+                added.Path.push_back(ImVec2((float)coord(rng), (float)coord(rng)) - editor.Panning);
+            }
+        }
+    }
+}
+
+// the selection BoxSelectorUpdateSelection makes, with every node and link tested
+void SelectBruteForce(ImNodesEditorContext& editor, ImRect box, ImVector<int>& nodes,
+                      ImVector<int>& links)
+{
+    if (box.Min.x > box.Max.x) ImSwap(box.Min.x, box.Max.x);
+    if (box.Min.y > box.Max.y) ImSwap(box.Min.y, box.Max.y);
+
+    nodes.resize(0);
+    for (int nodeIdx = 0; nodeIdx < editor.Nodes.Pool.Size; ++nodeIdx)
+    {
+        if (editor.Nodes.InUse[nodeIdx] && box.Overlaps(editor.Nodes.Pool[nodeIdx].Rect))
+        {
+            nodes.push_back(nodeIdx);
+        }
+    }
+
+    links.resize(0);
+    for (int linkIdx = 0; linkIdx < editor.Links.Pool.Size; ++linkIdx)
+    {
+        if (!editor.Links.InUse[linkIdx])
+        {
+            continue;
+        }
+        const ImLinkData& link = editor.Links.Pool[linkIdx];
+        const ImPinData&  pinStart = editor.Pins.Pool[link.StartPinIdx];
+        const ImVec2      start = ImNodes::GetScreenSpacePinCoordinates(editor, pinStart);
+        const ImVec2      end =
+            ImNodes::GetScreenSpacePinCoordinates(editor, editor.Pins.Pool[link.EndPinIdx]);
+        bool overlaps = false;
+        if (link.Path.empty())
+        {
+            const ImNodes::CubicBezier curve = ImNodes::GetCubicBezier(
+                start, end, pinStart.Type, GImNodes->Style.LinkLineSegmentsPerLength);
+            overlaps = box.Contains(ImNodes::GetCubicBezierHull(curve)) ||
+                       ImNodes::RectangleOverlapsLink(box, start, end, pinStart.Type);
+        }
+        else
+        {
+            ImVector<ImVec2> points;
+            ImNodes::GetLinkPolyline(editor, link, start, end, points);
+            overlaps = box.Contains(ImNodes::GetPolylineBounds(points)) ||
+                       ImNodes::RectangleOverlapsPolyline(box, points);
+        }
+        if (overlaps)
+        {
+            links.push_back(linkIdx);
+        }
+    }
+}
+
+bool SameIndices(const ImVector<int>& lhs, const ImVector<int>& rhs)
+{
+    return lhs.Size == rhs.Size &&
+           (lhs.Size == 0 || memcmp(lhs.Data, rhs.Data, lhs.size_in_bytes()) == 0);
+}
+
+// one frame of a box selection: every node and link is submitted, then the selection is updated
+void BoxSelectFrame(ImNodesEditorContext& editor, const ImRect& box)
+{
+    for (int nodeIdx = 0; nodeIdx < editor.Nodes.Pool.Size; ++nodeIdx)
+    {
+        ImNodes::BoxSelectorIndexCheckNode(editor, nodeIdx);
+    }
+    for (int linkIdx = 0; linkIdx < editor.Links.Pool.Size; ++linkIdx)
+    {
+        ImNodes::BoxSelectorIndexCheckLink(editor, linkIdx);
+    }
+    ImNodes::BoxSelectorUpdateSelection(editor, box);
+
+    ImVector<int> nodes, links;
+    SelectBruteForce(editor, box, nodes, links);
+    SNE_CHECK(SameIndices(editor.SelectedNodeIndices, nodes));
+    SNE_CHECK(SameIndices(editor.SelectedLinkIndices, links));
+}
+
+ImRect RandomBox(std::mt19937& rng)
+{
+    std::uniform_int_distribution<int> coord(-200, 3200);
+    std::uniform_int_distribution<int> size(-800, 800);
+    const ImVec2 corner((float)coord(rng), (float)coord(rng));
+    return ImRect(corner, corner + ImVec2((float)size(rng), (float)size(rng)));
+}
+
+void TestBoxSelection(std::mt19937& rng)
+{
+    ImNodesEditorContext editor;
+    FillNodes(editor, 300, rng);
+    SetPinAttributes(editor);
+    FillLinks(editor, 600, rng);
+
+    ImNodes::BoxSelectorIndexBuild(editor);
+    for (int box = 0; box < 200; ++box)
+    {
+        BoxSelectFrame(editor, RandomBox(rng));
+    }
+
+    // the index is kept while panning
+    Pan(editor, ImVec2(-250.f, 130.f));
+    for (int box = 0; box < 20; ++box)
+    {
+        BoxSelectFrame(editor, RandomBox(rng));
+        SNE_CHECK(editor.BoxSelectorIndex.Valid);
+    }
+
+    // but not once a link runs out of its bounds, because one of its pins or a corner of its
+    // path moved
+    const ImLinkData& link = editor.Links.Pool[1];
+    MoveNode(editor, editor.Pins.Pool[link.EndPinIdx].ParentNodeIdx, ImVec2(-2000.f, 900.f));
+    ImNodes::BoxSelectorIndexCheckLink(editor, 1);
+    SNE_CHECK(!editor.BoxSelectorIndex.Valid);
+    for (int box = 0; box < 20; ++box)
+    {
+        BoxSelectFrame(editor, RandomBox(rng));
+    }
+
+    ImNodes::BoxSelectorIndexBuild(editor);
+    ImLinkData& routed = editor.Links.Pool[0];
+    SNE_CHECK(!routed.Path.empty());
+    routed.Path.back() += ImVec2(1500.f, -700.f);
+    ImNodes::BoxSelectorIndexCheckLink(editor, 0);
+    SNE_CHECK(!editor.BoxSelectorIndex.Valid);
+    for (int box = 0; box < 20; ++box)
+    {
+        BoxSelectFrame(editor, RandomBox(rng));
+    }
+}
+
+} // namespace
+
+int main()
+{
+    ImGui::CreateContext();
+    ImNodes::CreateContext();
+
+    std::mt19937 rng(20240611);
+    TestPinOcclusion(rng);
+    TestBoxSelection(rng);
+
+    ImNodes::DestroyContext();
+    ImGui::DestroyContext();
+    return SimpleNodeEditor::Test::Result();
+}
@@ -0,0 +1,246 @@
+// Checks that LayeredLayout keeps the layers as columns, never overlaps the nodes of a layer and
+// reports the crossings it leaves. Run with --benchmark to time it on a 20k node graph.
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "LayeredLayout.hpp"
+#include "Log.hpp"
+#include "TestHelpers.hpp"
+
+using namespace SimpleNodeEditor;
+using SimpleNodeEditor::Test::MeasureMs;
+
+namespace
+{
+
+// positions are floats a long way from the origin on big graphs
+constexpr float s_tolerance = 0.5f;
+
+struct LayeredGraph
+{
+    std::vector<std::vector<NodeUniqueId>>            m_layers;
+    std::vector<std::pair<NodeUniqueId, NodeUniqueId>> m_edges;
+    std::unordered_map<NodeUniqueId, ImVec2>           m_sizes;
+};
+
+// layerCount layers of random width. Every node past the first layer gets inputs from the layers
+// before it, at most maxSpan layers back, so maxSpan 1 gives a proper layering without dummies.
+LayeredGraph RandomLayeredGraph(int layerCount, int maxLayerSize, int maxSpan, std::mt19937& rng)
+{
+    std::uniform_int_distribution<int>    layerSize(1, maxLayerSize);
+    std::uniform_int_distribution<int>    inputs(1, 3);
+    std::uniform_real_distribution<float> width(80.f, 200.f);
+    std::uniform_real_distribution<float> height(40.f, 150.f);
+
+    LayeredGraph graph;
+    NodeUniqueId nextUid = 0;
+    graph.m_layers.resize(layerCount);
+    for (int layer = 0; layer < layerCount; ++layer)
+    {
+        for (int count = layerSize(rng); count > 0; --count)
+        {
+            const NodeUniqueId nodeUid = nextUid++;
+            graph.m_layers[layer].push_back(nodeUid);
+            graph.m_sizes.emplace(nodeUid, ImVec2(width(rng), height(rng)));
+            if (layer == 0)
+            {
+                continue;
+            }
+            const int firstLayer = std::max(0, layer - maxSpan);
+            for (int input = inputs(rng); input > 0; --input)
+            {
+                std::uniform_int_distribution<int> pickLayer(firstLayer, layer - 1);
+                const std::vector<NodeUniqueId>&   srcLayer = graph.m_layers[pickLayer(rng)];
+                std::uniform_int_distribution<size_t> pickNode(0, srcLayer.size() - 1);
+                graph.m_edges.emplace_back(srcLayer[pickNode(rng)], nodeUid);
+            }
+        }
+    }
+    return graph;
+}
+
+// crossings between edges joining adjacent layers, for the vertical order of the positions
+size_t CountCrossings(const LayeredGraph& graph,
+                      const std::unordered_map<NodeUniqueId, ImVec2>& positions)
+{
+    std::unordered_map<NodeUniqueId, int> layerOf;
+    for (size_t layer = 0; layer < graph.m_layers.size(); ++layer)
+    {
+        for (NodeUniqueId nodeUid : graph.m_layers[layer])
+        {
+            layerOf.emplace(nodeUid, static_cast<int>(layer));
+        }
+    }
+    std::vector<std::vector<std::pair<NodeUniqueId, NodeUniqueId>>> edgesOfLayer(
+        graph.m_layers.size());
+    for (const auto& edge : graph.m_edges)
+    {
+        edgesOfLayer[layerOf.at(edge.first)].push_back(edge);
+    }
+
+    size_t crossings = 0;
+    for (const auto& edges : edgesOfLayer)
+    {
+        for (size_t i = 0; i < edges.size(); ++i)
+        {
+            for (size_t j = i + 1; j < edges.size(); ++j)
+            {
+                const float srcDelta =
+                    positions.at(edges[i].first).y - positions.at(edges[j].first).y;
+                const float dstDelta =
+                    positions.at(edges[i].second).y - positions.at(edges[j].second).y;
+                if ((srcDelta < 0.f && dstDelta > 0.f) || (srcDelta > 0.f && dstDelta < 0.f))
+                {
+                    ++crossings;
+                }
+            }
+        }
+    }
+    return crossings;
+}
+
+// initial order of the layers, as if every node of a layer was stacked in it
+std::unordered_map<NodeUniqueId, ImVec2> StackedPositions(const LayeredGraph& graph)
+{
+    std::unordered_map<NodeUniqueId, ImVec2> positions;
+    for (size_t layer = 0; layer < graph.m_layers.size(); ++layer)
+    {
+        for (size_t pos = 0; pos < graph.m_layers[layer].size(); ++pos)
+        {
+            positions.emplace(graph.m_layers[layer][pos],
+                              ImVec2(static_cast<float>(layer), static_cast<float>(pos)));
+        }
+    }
+    return positions;
+}
+
+void CheckLayout(const LayeredGraph& graph, const LayeredLayout::Options& options,
+                 const std::unordered_map<NodeUniqueId, ImVec2>& positions)
+{
+    size_t nodeCount = 0;
+    float  previousRight = 0.f;
+    for (size_t layer = 0; layer < graph.m_layers.size(); ++layer)
+    {
+        const std::vector<NodeUniqueId>& nodes = graph.m_layers[layer];
+        nodeCount += nodes.size();
+
+        // every layer is a column, right of the previous one
+        const float x = positions.at(nodes.front()).x;
+        float       right = x;
+        for (NodeUniqueId nodeUid : nodes)
+        {
+            SNE_CHECK(positions.at(nodeUid).x == x);
+            right = std::max(right, x + graph.m_sizes.at(nodeUid).x);
+        }
+        if (layer > 0)
+        {
+            SNE_CHECK(x + s_tolerance >= previousRight + options.m_layerSpacing);
+        }
+        previousRight = right;
+
+        // nodes of a layer keep the node spacing between them
+        std::vector<NodeUniqueId> byY = nodes;
+        std::sort(byY.begin(), byY.end(), [&](NodeUniqueId lhs, NodeUniqueId rhs)
+                  { return positions.at(lhs).y < positions.at(rhs).y; });
+        for (size_t i = 1; i < byY.size(); ++i)
+        {
+            const float bottom = positions.at(byY[i - 1]).y + graph.m_sizes.at(byY[i - 1]).y;
+            SNE_CHECK(bottom + options.m_nodeSpacing <= positions.at(byY[i]).y + s_tolerance);
+        }
+    }
+    SNE_CHECK(positions.size() == nodeCount);
+}
+
+void TestRandomGraphs(std::mt19937& rng)
+{
+    const LayeredLayout::Options options;
+    for (int round = 0; round < 40; ++round)
+    {
+        const int          maxSpan = 1 + round % 4;
+        const LayeredGraph graph = RandomLayeredGraph(2 + round % 9, 1 + round % 13, maxSpan, rng);
+        LayeredLayout      layout(options);
+        const auto         positions = layout.Compute(graph.m_layers, graph.m_edges, graph.m_sizes);
+        CheckLayout(graph, options, positions);
+
+        // without dummies the crossings can be counted on the real nodes alone, and are never
+        // more than in the initial order
+        if (maxSpan == 1)
+        {
+            SNE_CHECK(layout.GetCrossingCount() == CountCrossings(graph, positions));
+            SNE_CHECK(layout.GetCrossingCount() <= CountCrossings(graph, StackedPositions(graph)));
+        }
+    }
+}
+
+void TestUntangles()
+{
+    // two chains given crossed, they can be drawn without crossing
+    LayeredGraph graph;
+    graph.m_layers = {{0, 1}, {3, 2}, {4, 5}};
+    graph.m_edges = {{0, 2}, {1, 3}, {2, 4}, {3, 5}};
+    for (NodeUniqueId nodeUid = 0; nodeUid < 6; ++nodeUid)
+    {
+        graph.m_sizes.emplace(nodeUid, ImVec2(100.f, 50.f));
+    }
+    SNE_CHECK(CountCrossings(graph, StackedPositions(graph)) == 2);
+
+    const LayeredLayout::Options options;
+    LayeredLayout                layout(options);
+    const auto positions = layout.Compute(graph.m_layers, graph.m_edges, graph.m_sizes);
+    CheckLayout(graph, options, positions);
+    SNE_CHECK(layout.GetCrossingCount() == 0);
+    SNE_CHECK(CountCrossings(graph, positions) == 0);
+
+    // a chain runs straight
+    SNE_CHECK(positions.at(0).y == positions.at(2).y && positions.at(2).y == positions.at(4).y);
+
+    // edges not going to a higher layer are ignored
+    graph.m_edges.emplace_back(5, 0);
+    graph.m_edges.emplace_back(2, 3);
+    CheckLayout(graph, options, layout.Compute(graph.m_layers, graph.m_edges, graph.m_sizes));
+    SNE_CHECK(layout.Compute({}, {}, {}).empty());
+}
+
+void RunBenchmarks(std::mt19937& rng)
+{
+    const LayeredLayout::Options options;
+    for (int maxSpan : {1, 4})
+    {
+        // about 20k nodes
+        const LayeredGraph graph = RandomLayeredGraph(200, 200, maxSpan, rng);
+        size_t             nodeCount = 0;
+        for (const auto& layer : graph.m_layers)
+        {
+            nodeCount += layer.size();
+        }
+        LayeredLayout                            layout(options);
+        std::unordered_map<NodeUniqueId, ImVec2> positions;
+        const double                             ms = MeasureMs(
+            [&] { positions = layout.Compute(graph.m_layers, graph.m_edges, graph.m_sizes); });
+        std::printf("%zu nodes, %zu edges spanning up to %d layers: %.3f ms, %zu crossings",
+                    nodeCount, graph.m_edges.size(), maxSpan, ms, layout.GetCrossingCount());
+        if (maxSpan == 1)
+        {
+            std::printf(", %zu in the initial order",
+                        CountCrossings(graph, StackedPositions(graph)));
+        }
+        std::printf("\n");
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Log::GetInstance().SetLogLevel(Log::LogLevel::LogError);
+
+    std::mt19937 rng(20240611);
+    TestRandomGraphs(rng);
+    TestUntangles();
+    if (SimpleNodeEditor::Test::WantsBenchmark(argc, argv))
+    {
+        RunBenchmarks(rng);
+    }
+    return SimpleNodeEditor::Test::Result();
+}
@@ -0,0 +1,236 @@
+// Checks that NodeSizeEstimator predicts the size imnodes gives a node laid out as
+// NodeEditor::ShowNodes lays it out, for nodes with up to eight ports on either side, labels and
+// titles of many widths, and with unlinked ports hidden and shown. Runs imnodes on a headless
+// ImGui context with the default font.
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+#include <imgui.h>
+#include <imnodes.h>
+#include "DataStructureEditor.hpp"
+#include "Log.hpp"
+#include "NodeSizeEstimator.hpp"
+#include "TestHelpers.hpp"
+
+using namespace SimpleNodeEditor;
+
+namespace
+{
+
+// a label of length characters, of narrow and wide glyphs
+std::string RandomLabel(std::mt19937& rng, int length)
+{
+    static constexpr char s_glyphs[] = "iIlWMm_0123456789abcdefghijklmnopqrstuvwxyz";
+    std::string           label;
+    for (int index = 0; index < length; ++index)
+    {
+        label += s_glyphs[rng() % (sizeof(s_glyphs) - 1)];
+    }
+    return label;
+}
+
+// nodes with random ports, about half of them linked. Port uids are unique over all nodes, as
+// imnodes wants its attribute ids
+std::vector<Node> RandomNodes(std::mt19937& rng, int nodeCount, ImNodesStyle& nodeStyle)
+{
+    std::uniform_int_distribution<int> pickPorts(0, 8);
+    std::uniform_int_distribution<int> pickLength(1, 24);
+    std::vector<Node>                  nodes;
+    PortUniqueId                       portUid = 1000;
+    EdgeUniqueId                       edgeUid = 0;
+    for (int nodeUid = 0; nodeUid < nodeCount; ++nodeUid)
+    {
+        YamlNode yamlNode;
+        yamlNode.m_nodeName   = "Node";
+        yamlNode.m_nodeYamlId = nodeUid;
+        Node& node = nodes.emplace_back(nodeUid, Node::NodeType::NormalNode, yamlNode, nodeStyle);
+        // every fourth title is wider than the ports below it
+        node.SetNodeTitle(RandomLabel(rng, nodeUid % 4 == 0 ? 40 : pickLength(rng)));
+        for (int port = pickPorts(rng) - 1; port >= 0; --port)
+        {
+            InputPort inPort(portUid++, port, RandomLabel(rng, pickLength(rng)), nodeUid, port);
+            if (rng() % 2 == 0)
+            {
+                inPort.SetEdgeUid(edgeUid++);
+            }
+            node.AddInputPort(inPort);
+        }
+        for (int port = pickPorts(rng) - 1; port >= 0; --port)
+        {
+            OutputPort outPort(portUid++, port, RandomLabel(rng, pickLength(rng)), nodeUid, port);
+            if (rng() % 2 == 0)
+            {
+                outPort.PushEdge(edgeUid++);
+            }
+            node.AddOutputPort(outPort);
+        }
+    }
+    return nodes;
+}
+
+// the body of NodeEditor::ShowNodes, without the colors
+void ShowNode(const Node& node, bool hideUnlinkedPorts)
+{
+    ImNodes::BeginNode(node.GetNodeUniqueId());
+    ImNodes::BeginNodeTitleBar();
+    ImGui::TextUnformatted(node.GetNodeTitle().data());
+    ImNodes::EndNodeTitleBar();
+
+    std::vector<const InputPort*>  visibleInPorts;
+    std::vector<const OutputPort*> visibleOutPorts;
+    for (const InputPort& inPort : node.GetInputPorts())
+    {
+        if (!hideUnlinkedPorts || !inPort.HasNoEdgeLinked())
+        {
+            visibleInPorts.push_back(&inPort);
+        }
+    }
+    for (const OutputPort& outPort : node.GetOutputPorts())
+    {
+        if (!hideUnlinkedPorts || !outPort.HasNoEdgeLinked())
+        {
+            visibleOutPorts.push_back(&outPort);
+        }
+    }
+
+    float maxInLabelWidth  = 0.f;
+    float maxOutLabelWidth = 0.f;
+    for (const InputPort* inPort : visibleInPorts)
+    {
+        const std::string_view name = inPort->GetPortname();
+        maxInLabelWidth = std::max(maxInLabelWidth,
+                                   ImGui::CalcTextSize(name.data(), name.data() + name.size()).x);
+    }
+    for (const OutputPort* outPort : visibleOutPorts)
+    {
+        const std::string_view name = outPort->GetPortname();
+        maxOutLabelWidth = std::max(maxOutLabelWidth,
+                                    ImGui::CalcTextSize(name.data(), name.data() + name.size()).x);
+    }
+
+    const float  outColumnX = ImGui::GetCursorPosX() + maxInLabelWidth +
+                             NodeSizeEstimator::s_portColumnGap;
+    const size_t rows = std::max(visibleInPorts.size(), visibleOutPorts.size());
+    for (size_t row = 0; row < rows; ++row)
+    {
+        if (row < visibleInPorts.size())
+        {
+            ImNodes::BeginInputAttribute(visibleInPorts[row]->GetPortUniqueId());
+            ImGui::TextUnformatted(visibleInPorts[row]->GetPortname().data());
+            ImNodes::EndInputAttribute();
+        }
+        else
+        {
+            ImGui::Dummy(ImVec2(maxInLabelWidth, ImGui::GetTextLineHeight()));
+        }
+
+        ImGui::SameLine();
+        ImGui::SetCursorPosX(outColumnX);
+
+        if (row < visibleOutPorts.size())
+        {
+            const std::string_view name = visibleOutPorts[row]->GetPortname();
+            const float textWidth = ImGui::CalcTextSize(name.data(), name.data() + name.size()).x;
+            ImNodes::BeginOutputAttribute(visibleOutPorts[row]->GetPortUniqueId());
+            ImGui::SetCursorPosX(outColumnX + (maxOutLabelWidth - textWidth));
+            ImGui::TextUnformatted(name.data());
+            ImNodes::EndOutputAttribute();
+        }
+        else
+        {
+            ImGui::Dummy(ImVec2(maxOutLabelWidth, ImGui::GetTextLineHeight()));
+        }
+    }
+    ImNodes::EndNode();
+}
+
+bool NearlyEqual(const ImVec2& lhs, const ImVec2& rhs, float tolerance)
+{
+    return std::abs(lhs.x - rhs.x) <= tolerance && std::abs(lhs.y - rhs.y) <= tolerance;
+}
+
+// draws the nodes in one frame and compares what imnodes made of them with the estimates, from
+// the current style and, while the metrics are the default ones, from the monospace approximation.
+// ImGui sums the glyph advances of a label in floats, a long one can come out a pixel wider than
+// the monospace approximation has it
+void CheckFrame(const std::vector<Node>& nodes, bool hideUnlinkedPorts, bool defaultMetrics)
+{
+    ImGui::NewFrame();
+    ImGui::SetNextWindowPos(ImVec2(0.f, 0.f));
+    ImGui::SetNextWindowSize(ImGui::GetIO().DisplaySize);
+    ImGui::Begin("editor");
+    NodeSizeEstimator estimator = NodeSizeEstimator::FromCurrentStyle();
+    SNE_CHECK(estimator.IsCurrent());
+    ImNodes::BeginNodeEditor();
+    for (const Node& node : nodes)
+    {
+        ShowNode(node, hideUnlinkedPorts);
+    }
+    ImNodes::EndNodeEditor();
+    ImGui::End();
+    ImGui::Render();
+
+    NodeSizeEstimator monospace;
+    int               mismatches = 0;
+    for (const Node& node : nodes)
+    {
+        const ImVec2 drawn = ImNodes::GetNodeDimensions(node.GetNodeUniqueId());
+        if (!NearlyEqual(estimator.Estimate(node, hideUnlinkedPorts), drawn, 0.f))
+        {
+            ++mismatches;
+        }
+        if (defaultMetrics &&
+            !NearlyEqual(monospace.Estimate(node, hideUnlinkedPorts), drawn, 1.f))
+        {
+            ++mismatches;
+        }
+    }
+    SNE_CHECK(mismatches == 0);
+}
+
+void TestEstimates(std::mt19937& rng)
+{
+    std::vector<Node> nodes = RandomNodes(rng, 80, ImNodes::GetStyle());
+    CheckFrame(nodes, false, true);
+    CheckFrame(nodes, true, true);
+
+    // a node without any port is only its title bar
+    YamlNode yamlNode;
+    yamlNode.m_nodeYamlId = 1;
+    nodes.clear();
+    nodes.emplace_back(200, Node::NodeType::SourceNode, yamlNode, ImNodes::GetStyle());
+    CheckFrame(nodes, false, true);
+
+    // other spacing and padding, which FromCurrentStyle picks up
+    ImGui::GetStyle().ItemSpacing  = ImVec2(6.f, 7.f);
+    ImNodes::GetStyle().NodePadding = ImVec2(5.f, 3.f);
+    nodes = RandomNodes(rng, 80, ImNodes::GetStyle());
+    CheckFrame(nodes, false, false);
+    CheckFrame(nodes, true, false);
+}
+
+} // namespace
+
+int main()
+{
+    Log::GetInstance().SetLogLevel(Log::LogLevel::LogError);
+
+    ImGui::CreateContext();
+    ImNodes::CreateContext();
+    ImGuiIO& io    = ImGui::GetIO();
+    io.DisplaySize = ImVec2(1920.f, 1080.f);
+    io.DeltaTime   = 1.f / 60.f;
+    io.IniFilename = nullptr;
+    unsigned char* pixels = nullptr;
+    int            width  = 0;
+    int            height = 0;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+    std::mt19937 rng(20240611);
+    TestEstimates(rng);
+
+    ImNodes::DestroyContext();
+    ImGui::DestroyContext();
+    return SimpleNodeEditor::Test::Result();
+}
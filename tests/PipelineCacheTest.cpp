@@ -0,0 +1,365 @@
+// Checks that a pipeline read back from the pipeline cache is the one the parser gave when it was
+// stored, that a snapshot is not used once the size, the modification time or the content of the
+// pipeline file changed, and that a corrupted or truncated snapshot is rejected without crashing.
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "Log.hpp"
+#include "PipelineCache.hpp"
+#include "TestHelpers.hpp"
+#include "YamlParser.hpp"
+
+using namespace SimpleNodeEditor;
+
+namespace
+{
+
+// a pipeline with properties, pruning rules on nodes and ports, and positions on every other node
+std::string BuildPipeline(std::mt19937& rng, int nodeCount, int linkCount)
+{
+    std::uniform_int_distribution<int> pickNode(0, nodeCount - 1);
+    std::uniform_int_distribution<int> pickCount(0, 3);
+
+    std::string text = "Pipeline:\n-\n  pipelinename : cached\n  NodeList:\n";
+    for (int node = 0; node < nodeCount; ++node)
+    {
+        text += "    - \n      NodeName: Node" + std::to_string(node % 7) +
+                "\n      NodeId : " + std::to_string(node) + "\n      IsSrcNode: " +
+                std::to_string(node % 11 == 0 ? 1 : 0) + "\n      NodeType: " +
+                std::to_string(node % 5) + "\n";
+        if (const int propertyCount = pickCount(rng))
+        {
+            text += "      NodeProperty:\n";
+            for (int property = 0; property < propertyCount; ++property)
+            {
+                // an empty value now and then, strings of no length are kept too
+                const std::string value = property == 2 ? "" : std::to_string(rng() % 1000);
+                text += "      -\n        NodePropertyName: property" + std::to_string(property) +
+                        "\n        NodePropertyValue: \"" + value + "\"\n";
+            }
+        }
+        if (node % 3 == 0)
+        {
+            text += "      PruneRule:\n      - \n          group: prune" +
+                    std::to_string(node % 4) + "\n          type: Enable\n";
+        }
+        if (node % 2 == 0)
+        {
+            text += "      Position: [" + std::to_string(node * 10) + ".25, -" +
+                    std::to_string(node % 100) + ".5]\n";
+        }
+    }
+
+    text += "\n  LinkList:\n";
+    for (int link = 0; link < linkCount; ++link)
+    {
+        const int src = pickNode(rng);
+        text += "    - \n      SrcPort:\n        NodeName: Node" + std::to_string(src % 7) +
+                "\n        NodeId: " + std::to_string(src) +
+                "\n        PortName: outputport1\n        PortId: 0\n      DstPort:\n";
+        for (int dst = pickCount(rng); dst >= 0; --dst)
+        {
+            const int dstNode = pickNode(rng);
+            text += "      - \n        NodeName: Node" + std::to_string(dstNode % 7) +
+                    "\n        NodeId: " + std::to_string(dstNode) + "\n        PortId: " +
+                    std::to_string(dst) + "\n        PortName: inputport1\n";
+            if (dst == 2)
+            {
+                text += "        PruneRule:\n        - \n          group: prune1\n"
+                        "          type: Disble\n";
+            }
+        }
+    }
+    return text;
+}
+
+struct Pipeline
+{
+    std::string           m_name;
+    std::vector<YamlNode> m_nodes;
+    std::vector<YamlEdge> m_edges;
+};
+
+Pipeline Parse(const std::string& text)
+{
+    PipelineParser parser;
+    parser.SetThreadCount(1);
+    Pipeline pipeline;
+    SNE_CHECK(parser.LoadText(text));
+    pipeline.m_name  = parser.GetPipelineName();
+    pipeline.m_nodes = parser.ParseNodes();
+    pipeline.m_edges = parser.ParseEdges();
+    return pipeline;
+}
+
+std::vector<std::tuple<std::string, int32_t, std::string>> PropertiesOf(const YamlNode& node)
+{
+    std::vector<std::tuple<std::string, int32_t, std::string>> properties;
+    node.m_Properties.ForEach([&](std::string_view name, int32_t id, std::string_view value)
+                              { properties.emplace_back(name, id, value); });
+    return properties;
+}
+
+bool SameRules(const std::vector<YamlPruningRule>& lhs, const std::vector<YamlPruningRule>& rhs)
+{
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                      [](const YamlPruningRule& l, const YamlPruningRule& r)
+                      { return l.m_Group == r.m_Group && l.m_Type == r.m_Type; });
+}
+
+bool SamePort(const YamlPort& lhs, const YamlPort& rhs)
+{
+    return lhs.m_nodeName == rhs.m_nodeName && lhs.m_nodeYamlId == rhs.m_nodeYamlId &&
+           lhs.m_portName == rhs.m_portName && lhs.m_portYamlId == rhs.m_portYamlId &&
+           SameRules(lhs.m_PruningRules, rhs.m_PruningRules);
+}
+
+bool SameNode(const YamlNode& lhs, const YamlNode& rhs)
+{
+    // the positions are stored as floats, they come back with the same bits
+    const bool samePosition =
+        lhs.m_position.has_value() == rhs.m_position.has_value() &&
+        (!lhs.m_position || (Test::SameBits(lhs.m_position->m_x, rhs.m_position->m_x) &&
+                             Test::SameBits(lhs.m_position->m_y, rhs.m_position->m_y)));
+    return lhs.m_nodeName == rhs.m_nodeName && lhs.m_nodeYamlId == rhs.m_nodeYamlId &&
+           lhs.m_isSrcNode == rhs.m_isSrcNode && lhs.m_nodeYamlType == rhs.m_nodeYamlType &&
+           PropertiesOf(lhs) == PropertiesOf(rhs) &&
+           SameRules(lhs.m_PruningRules, rhs.m_PruningRules) && samePosition;
+}
+
+bool SamePipeline(const Pipeline& lhs, const Pipeline& rhs)
+{
+    return lhs.m_name == rhs.m_name &&
+           std::equal(lhs.m_nodes.begin(), lhs.m_nodes.end(), rhs.m_nodes.begin(),
+                      rhs.m_nodes.end(), SameNode) &&
+           std::equal(lhs.m_edges.begin(), lhs.m_edges.end(), rhs.m_edges.begin(),
+                      rhs.m_edges.end(),
+                      [](const YamlEdge& l, const YamlEdge& r)
+                      {
+                          return l.m_isValid == r.m_isValid &&
+                                 SamePort(l.m_yamlSrcPort, r.m_yamlSrcPort) &&
+                                 SamePort(l.m_yamlDstPort, r.m_yamlDstPort);
+                      });
+}
+
+std::string ReadFile(const std::filesystem::path& path)
+{
+    std::ifstream input(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+}
+
+void WriteFile(const std::filesystem::path& path, const std::string& content)
+{
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    output.write(content.data(), static_cast<std::streamsize>(content.size()));
+}
+
+// a pipeline file and the cache next to it, in a directory of their own
+struct Fixture
+{
+    std::filesystem::path m_directory;
+    std::filesystem::path m_cacheDirectory;
+    std::string           m_filePath;
+    std::string           m_text;
+    uint64_t              m_hash = 0;
+    Pipeline              m_parsed;
+
+    Fixture(const char* name, std::mt19937& rng)
+        : m_directory(std::filesystem::temp_directory_path() / name),
+          m_cacheDirectory(m_directory / "cache"),
+          m_filePath((m_directory / "pipeline.yaml").string())
+    {
+        std::filesystem::remove_all(m_directory);
+        std::filesystem::create_directories(m_directory);
+        m_text   = BuildPipeline(rng, 300, 300);
+        m_hash   = PipelineCache::HashContent(m_text);
+        m_parsed = Parse(m_text);
+        WriteFile(m_filePath, m_text);
+        PipelineCache(m_cacheDirectory.string())
+            .Store(m_filePath, m_hash, m_parsed.m_name, m_parsed.m_nodes, m_parsed.m_edges);
+    }
+
+    ~Fixture() { std::filesystem::remove_all(m_directory); }
+
+    bool Load(Pipeline& loaded, uint64_t hash) const
+    {
+        return PipelineCache(m_cacheDirectory.string())
+            .Load(m_filePath, hash, loaded.m_name, loaded.m_nodes, loaded.m_edges);
+    }
+
+    bool Load() const
+    {
+        Pipeline loaded;
+        return Load(loaded, m_hash);
+    }
+
+    std::filesystem::path SnapshotPath() const
+    {
+        for (const auto& entry : std::filesystem::directory_iterator(m_cacheDirectory))
+        {
+            if (entry.path().extension() == ".snecache")
+            {
+                return entry.path();
+            }
+        }
+        return {};
+    }
+};
+
+void TestRoundTrip(std::mt19937& rng)
+{
+    Fixture fixture("sne_pipeline_cache_round_trip", rng);
+    SNE_CHECK(!fixture.SnapshotPath().empty());
+    SNE_CHECK(fixture.m_parsed.m_nodes.size() == 300);
+
+    Pipeline loaded;
+    SNE_CHECK(fixture.Load(loaded, fixture.m_hash));
+    SNE_CHECK(SamePipeline(loaded, fixture.m_parsed));
+
+    // an empty pipeline has every section empty
+    const Pipeline empty;
+    PipelineCache(fixture.m_cacheDirectory.string())
+        .Store(fixture.m_filePath, fixture.m_hash, empty.m_name, empty.m_nodes, empty.m_edges);
+    Pipeline loadedEmpty;
+    SNE_CHECK(fixture.Load(loadedEmpty, fixture.m_hash));
+    SNE_CHECK(SamePipeline(loadedEmpty, empty));
+
+    // a cache without a directory neither stores nor loads
+    PipelineCache disabled("");
+    SNE_CHECK(!disabled.IsEnabled());
+    SNE_CHECK(!disabled.Load(fixture.m_filePath, fixture.m_hash, loaded.m_name, loaded.m_nodes,
+                             loaded.m_edges));
+}
+
+void TestStaleSource(std::mt19937& rng)
+{
+    Fixture fixture("sne_pipeline_cache_stale", rng);
+    SNE_CHECK(fixture.Load());
+    const auto modifiedTime = std::filesystem::last_write_time(fixture.m_filePath);
+
+    // the content changed, found by the hash the caller passes in
+    Pipeline loaded;
+    SNE_CHECK(!fixture.Load(loaded, fixture.m_hash + 1));
+
+    // touched, same content
+    std::filesystem::last_write_time(fixture.m_filePath, modifiedTime + std::chrono::seconds(1));
+    SNE_CHECK(!fixture.Load());
+    std::filesystem::last_write_time(fixture.m_filePath, modifiedTime);
+    SNE_CHECK(fixture.Load());
+
+    // grown while the modification time was put back
+    WriteFile(fixture.m_filePath, fixture.m_text + "\n");
+    std::filesystem::last_write_time(fixture.m_filePath, modifiedTime);
+    SNE_CHECK(!fixture.Load());
+    WriteFile(fixture.m_filePath, fixture.m_text);
+    std::filesystem::last_write_time(fixture.m_filePath, modifiedTime);
+    SNE_CHECK(fixture.Load());
+
+    // the pipeline file is gone
+    std::filesystem::remove(fixture.m_filePath);
+    SNE_CHECK(!fixture.Load());
+}
+
+// Load must fail and hand back no records, whatever was done to the snapshot
+void CheckRejected(const Fixture& fixture, const std::string& snapshot)
+{
+    WriteFile(fixture.SnapshotPath(), snapshot);
+    Pipeline loaded;
+    SNE_CHECK(!fixture.Load(loaded, fixture.m_hash));
+    SNE_CHECK(loaded.m_nodes.empty() && loaded.m_edges.empty());
+}
+
+void TestDamagedSnapshot(std::mt19937& rng)
+{
+    Fixture           fixture("sne_pipeline_cache_damaged", rng);
+    const std::string snapshot = fixture.SnapshotPath().empty()
+                                     ? std::string()
+                                     : ReadFile(fixture.SnapshotPath());
+    SNE_CHECK(snapshot.size() > 256);
+    if (snapshot.size() <= 256)
+    {
+        return;
+    }
+
+    // truncated anywhere, in the header or in the records
+    for (size_t size : {size_t(0), size_t(7), size_t(100), snapshot.size() / 2,
+                        snapshot.size() - 1})
+    {
+        CheckRejected(fixture, snapshot.substr(0, size));
+    }
+
+    // a flipped byte, caught by the magic, the version, the record sizes or the records hash
+    std::uniform_int_distribution<size_t> pickByte(0, snapshot.size() - 1);
+    for (int round = 0; round < 50; ++round)
+    {
+        std::string corrupted = snapshot;
+        corrupted[round < 10 ? static_cast<size_t>(round) * 7 : pickByte(rng)] ^= 0x5a;
+        CheckRejected(fixture, corrupted);
+    }
+
+    // records that are garbage but hash right, so every index has to be checked on the way. The
+    // records hash is found in the header as the eight bytes equal to the hash of the records, the
+    // header size follows the magic and the version
+    uint32_t headerSize = 0;
+    std::memcpy(&headerSize, snapshot.data() + 12, sizeof(headerSize));
+    const uint64_t recordsHash = PipelineCache::HashContent(snapshot.substr(headerSize));
+    size_t         hashOffset  = 0;
+    for (size_t offset = 0; offset + sizeof(uint64_t) <= headerSize; offset += sizeof(uint64_t))
+    {
+        if (std::memcmp(snapshot.data() + offset, &recordsHash, sizeof(recordsHash)) == 0)
+        {
+            hashOffset = offset;
+        }
+    }
+    SNE_CHECK(hashOffset != 0);
+    for (int round = 0; round < 50 && hashOffset != 0; ++round)
+    {
+        std::string forged = snapshot;
+        for (size_t index = headerSize; index < forged.size(); ++index)
+        {
+            // keep most bytes, an index here and there points anywhere
+            if (rng() % 16 == 0)
+            {
+                forged[index] = static_cast<char>(rng());
+            }
+        }
+        const uint64_t forgedHash = PipelineCache::HashContent(forged.substr(headerSize));
+        std::memcpy(forged.data() + hashOffset, &forgedHash, sizeof(forgedHash));
+
+        WriteFile(fixture.SnapshotPath(), forged);
+        Pipeline loaded;
+        if (fixture.Load(loaded, fixture.m_hash))
+        {
+            // only the strings or positions were hit, the records still line up
+            SNE_CHECK(loaded.m_nodes.size() == fixture.m_parsed.m_nodes.size());
+            SNE_CHECK(loaded.m_edges.size() == fixture.m_parsed.m_edges.size());
+        }
+        else
+        {
+            SNE_CHECK(loaded.m_nodes.empty() && loaded.m_edges.empty());
+        }
+    }
+
+    // the intact snapshot still loads after all that
+    WriteFile(fixture.SnapshotPath(), snapshot);
+    SNE_CHECK(fixture.Load());
+}
+
+} // namespace
+
+int main()
+{
+    Log::GetInstance().SetLogLevel(Log::LogLevel::LogError);
+
+    std::mt19937 rng(20240611);
+    TestRoundTrip(rng);
+    TestStaleSource(rng);
+    TestDamagedSnapshot(rng);
+    return SimpleNodeEditor::Test::Result();
+}
@@ -0,0 +1,409 @@
+// Checks that saving a pipeline by rewriting only the entries that changed gives a file that
+// parses to the same nodes and links as saving the whole pipeline again, through random edits,
+// patch sections and lists whose entries were all blanked, and that a file changed since it was
+// saved is written again instead.
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+#include "LinkGroups.hpp"
+#include "Log.hpp"
+#include "PipelineFileLayout.hpp"
+#include "TestHelpers.hpp"
+#include "YamlParser.hpp"
+#include "imnodes.h"
+
+using namespace SimpleNodeEditor;
+
+namespace
+{
+
+// a graph the way the editor holds it when saving. Every node has two output ports, whose uids
+// are 2 * node uid and 2 * node uid + 1
+struct Graph
+{
+    std::string                            m_name = "layout";
+    std::unordered_map<NodeUniqueId, Node> m_nodes;
+    std::unordered_map<EdgeUniqueId, Edge> m_edges;
+    LinkGroups                             m_linkGroups;
+    ImNodesStyle                           m_style;
+    int32_t                                m_nextUid = 1;
+
+    NodeUniqueId AddNode(std::mt19937& rng)
+    {
+        const NodeUniqueId nodeUid = m_nextUid++;
+        YamlNode           yamlNode;
+        yamlNode.m_nodeName     = "Node";
+        yamlNode.m_nodeName    += std::to_string(rng() % 100);
+        yamlNode.m_nodeYamlId   = nodeUid;
+        yamlNode.m_nodeYamlType = static_cast<YamlNodeType>(rng() % 5);
+        if (rng() % 3 == 0)
+        {
+            yamlNode.m_PruningRules.push_back(YamlPruningRule{"prune1", "Enable"});
+        }
+        if (rng() % 2 == 0)
+        {
+            yamlNode.m_position =
+                YamlNodePosition{static_cast<float>(rng() % 5000), static_cast<float>(rng() % 500)};
+        }
+        m_nodes.emplace(nodeUid, Node(nodeUid, Node::NodeType::NormalNode, yamlNode, m_style));
+        return nodeUid;
+    }
+
+    void AddEdge(NodeUniqueId srcNodeUid, int32_t srcPort, NodeUniqueId dstNodeUid,
+                 int32_t dstPort)
+    {
+        const YamlNode& src = m_nodes.at(srcNodeUid).GetYamlNode();
+        const YamlNode& dst = m_nodes.at(dstNodeUid).GetYamlNode();
+        const YamlPort  srcYamlPort{src.m_nodeName, src.m_nodeYamlId, "outputport", srcPort, {}};
+        const YamlPort  dstYamlPort{dst.m_nodeName, dst.m_nodeYamlId, "inputport", dstPort, {}};
+        const YamlEdge  yamlEdge(srcYamlPort, dstYamlPort, true);
+        const EdgeUniqueId edgeUid    = m_nextUid++;
+        const PortUniqueId srcPortUid = 2 * srcNodeUid + srcPort;
+        m_edges.emplace(edgeUid, Edge(srcPortUid, srcNodeUid, -1, dstNodeUid, edgeUid, yamlEdge));
+        m_linkGroups.AddEdge(srcPortUid, edgeUid);
+    }
+
+    void RemoveEdge(EdgeUniqueId edgeUid)
+    {
+        m_linkGroups.RemoveEdge(m_edges.at(edgeUid).GetSourcePortUid(), edgeUid);
+        m_edges.erase(edgeUid);
+    }
+
+    void RemoveNode(NodeUniqueId nodeUid)
+    {
+        std::vector<EdgeUniqueId> linked;
+        for (const auto& [edgeUid, edge] : m_edges)
+        {
+            if (edge.GetSourceNodeUid() == nodeUid || edge.GetDestinationNodeUid() == nodeUid)
+            {
+                linked.push_back(edgeUid);
+            }
+        }
+        for (EdgeUniqueId edgeUid : linked)
+        {
+            RemoveEdge(edgeUid);
+        }
+        m_nodes.erase(nodeUid);
+    }
+
+    template <typename Map>
+    static typename Map::key_type PickKey(const Map& map, std::mt19937& rng)
+    {
+        return std::next(map.begin(), static_cast<long>(rng() % map.size()))->first;
+    }
+
+    void AddRandomEdge(std::mt19937& rng)
+    {
+        AddEdge(PickKey(m_nodes, rng), static_cast<int32_t>(rng() % 2), PickKey(m_nodes, rng),
+                static_cast<int32_t>(rng() % 3));
+    }
+
+    void AddRandom(std::mt19937& rng, int nodeCount, int edgeCount)
+    {
+        for (int node = 0; node < nodeCount; ++node)
+        {
+            AddNode(rng);
+        }
+        for (int edge = 0; edge < edgeCount; ++edge)
+        {
+            AddRandomEdge(rng);
+        }
+    }
+
+    // one of the edits the editor makes, some keep the length of an entry and some do not
+    void Edit(std::mt19937& rng)
+    {
+        switch (rng() % 7)
+        {
+        case 0:
+            AddNode(rng);
+            break;
+        case 1:
+            if (m_nodes.size() > 2)
+            {
+                RemoveNode(PickKey(m_nodes, rng));
+            }
+            break;
+        case 2:
+        {
+            YamlNode& yamlNode = m_nodes.at(PickKey(m_nodes, rng)).GetYamlNode();
+            yamlNode.m_position =
+                YamlNodePosition{static_cast<float>(rng() % 5000), static_cast<float>(rng() % 500)};
+            break;
+        }
+        case 3:
+            m_nodes.at(PickKey(m_nodes, rng)).GetYamlNode().m_nodeName += "x";
+            break;
+        case 4:
+        case 5:
+            AddRandomEdge(rng);
+            break;
+        default:
+            if (!m_edges.empty())
+            {
+                RemoveEdge(PickKey(m_edges, rng));
+            }
+            break;
+        }
+    }
+
+    PipelineFileLayout::EmitFunction Emit() const
+    {
+        return [this](PipelineEmitter& emitter)
+        { emitter.EmitPipeline(m_name, m_nodes, m_edges, m_linkGroups); };
+    }
+};
+
+std::string FullSaveText(const Graph& graph)
+{
+    std::ostringstream output;
+    PipelineFileLayout layout;
+    SNE_CHECK(layout.WriteAll("full", output, graph.Emit()));
+    return std::move(output).str();
+}
+
+// a saved file held in memory, with the modification time a file system would tell
+struct SavedFile
+{
+    static constexpr std::time_t s_modifiedTime = 7;
+
+    std::stringstream  m_file;
+    PipelineFileLayout m_layout;
+    int                m_rewrites = 0;
+
+    void SaveAll(const Graph& graph)
+    {
+        m_file.str("");
+        m_file.clear();
+        SNE_CHECK(m_layout.WriteAll("file", m_file, graph.Emit()));
+        m_layout.SetModifiedTime(s_modifiedTime);
+        ++m_rewrites;
+    }
+
+    int64_t Size() const { return static_cast<int64_t>(m_file.str().size()); }
+
+    // saves the way NodeEditor::SaveToDialogFile does, returns whether only the changes were
+    // written
+    bool Save(const Graph& graph)
+    {
+        std::optional<PipelineFileLayout::Patch> patch = m_layout.PlanChanges(graph.Emit());
+        if (patch &&
+            m_layout.ApplyChanges(std::move(*patch), s_modifiedTime, Size(), m_file, m_file))
+        {
+            m_layout.SetModifiedTime(s_modifiedTime);
+            return true;
+        }
+        SaveAll(graph);
+        return false;
+    }
+};
+
+using NodeKey = std::tuple<int32_t, std::string, int, int32_t, std::string, bool, float, float>;
+using EdgeKey = std::tuple<std::string, int32_t, std::string, int32_t, std::string, int32_t,
+                           std::string, int32_t>;
+
+// the records a file parses to, in an order that does not depend on where they are in it
+struct Parsed
+{
+    bool                     m_succeeded = false;
+    std::string              m_pipelineName;
+    std::vector<NodeKey>     m_nodes;
+    std::vector<EdgeKey>     m_edges;
+    std::vector<std::string> m_errors;
+
+    bool operator==(const Parsed&) const = default;
+};
+
+Parsed Parse(const std::string& text)
+{
+    PipelineParser parser;
+    Parsed parsed;
+    parsed.m_succeeded    = parser.LoadText(text);
+    parsed.m_pipelineName = parser.GetPipelineName();
+    for (const YamlNode& node : parser.ParseNodes())
+    {
+        std::string rules;
+        for (const YamlPruningRule& rule : node.m_PruningRules)
+        {
+            rules += rule.m_Group + "/" + rule.m_Type + ";";
+        }
+        parsed.m_nodes.emplace_back(node.m_nodeYamlId, node.m_nodeName, node.m_isSrcNode,
+                                    node.m_nodeYamlType, rules, node.m_position.has_value(),
+                                    node.m_position ? node.m_position->m_x : 0.f,
+                                    node.m_position ? node.m_position->m_y : 0.f);
+    }
+    for (const YamlEdge& edge : parser.ParseEdges())
+    {
+        const YamlPort& src = edge.m_yamlSrcPort;
+        const YamlPort& dst = edge.m_yamlDstPort;
+        parsed.m_edges.emplace_back(src.m_nodeName, src.m_nodeYamlId, src.m_portName,
+                                    src.m_portYamlId, dst.m_nodeName, dst.m_nodeYamlId,
+                                    dst.m_portName, dst.m_portYamlId);
+    }
+    std::sort(parsed.m_nodes.begin(), parsed.m_nodes.end());
+    std::sort(parsed.m_edges.begin(), parsed.m_edges.end());
+    parsed.m_errors = parser.TakeErrors();
+    return parsed;
+}
+
+void CheckSameAsFullSave(const SavedFile& saved, const Graph& graph)
+{
+    const Parsed expected = Parse(FullSaveText(graph));
+    SNE_CHECK(expected.m_succeeded);
+    SNE_CHECK(expected.m_nodes.size() == graph.m_nodes.size());
+    SNE_CHECK(expected.m_errors.empty());
+    SNE_CHECK(Parse(saved.m_file.str()) == expected);
+}
+
+void TestRandomEdits(std::mt19937& rng)
+{
+    Graph graph;
+    graph.AddRandom(rng, 200, 250);
+    SavedFile saved;
+    saved.SaveAll(graph);
+
+    int incremental = 0;
+    for (int round = 0; round < 40; ++round)
+    {
+        for (int edit = rng() % 6; edit >= 0; --edit)
+        {
+            graph.Edit(rng);
+        }
+        incremental += saved.Save(graph) ? 1 : 0;
+        CheckSameAsFullSave(saved, graph);
+    }
+    // most saves only write the changes, the others when the file filled up with blanks
+    SNE_CHECK(incremental > 30);
+    SNE_CHECK(saved.m_file.str().find("ListPatch") != std::string::npos || saved.m_rewrites > 1);
+
+    // saving the same graph again writes nothing
+    const std::string before = saved.m_file.str();
+    SNE_CHECK(saved.Save(graph));
+    SNE_CHECK(saved.m_file.str() == before);
+}
+
+// entries that no longer fit a free slot go to patch sections after the lists
+void TestPatchSections(std::mt19937& rng)
+{
+    Graph graph;
+    graph.AddRandom(rng, 100, 100);
+    SavedFile saved;
+    saved.SaveAll(graph);
+
+    for (int round = 0; round < 3; ++round)
+    {
+        auto& name = graph.m_nodes.at(Graph::PickKey(graph.m_nodes, rng)).GetYamlNode().m_nodeName;
+        name += std::string(200, 'n');
+        const EdgeUniqueId edgeUid = Graph::PickKey(graph.m_edges, rng);
+        graph.m_edges.at(edgeUid).GetYamlEdge().m_yamlDstPort.m_portName += std::string(200, 'p');
+
+        SNE_CHECK(saved.Save(graph));
+        CheckSameAsFullSave(saved, graph);
+    }
+    const std::string text = saved.m_file.str();
+    SNE_CHECK(text.find("NodeListPatch1:") != std::string::npos);
+    SNE_CHECK(text.find("LinkListPatch2:") != std::string::npos);
+    SNE_CHECK(text.find("LinkListPatch6:") != std::string::npos);
+}
+
+// every entry of the LinkList grows out of its slot, the list is left with blanks only and its
+// entries are all in a patch section
+void TestAllEntriesBlanked(std::mt19937& rng)
+{
+    Graph graph;
+    graph.AddRandom(rng, 100, 4);
+    SavedFile saved;
+    saved.SaveAll(graph);
+
+    for (auto& [_, edge] : graph.m_edges)
+    {
+        edge.GetYamlEdge().m_yamlSrcPort.m_portName += "_renamed_port";
+        edge.GetYamlEdge().m_yamlDstPort.m_portName += "_renamed_port";
+    }
+    SNE_CHECK(saved.Save(graph));
+    CheckSameAsFullSave(saved, graph);
+
+    const std::string text      = saved.m_file.str();
+    const size_t      linkList  = text.find("LinkList:");
+    const size_t      patchList = text.find("LinkListPatch1:");
+    SNE_CHECK(linkList != std::string::npos && patchList != std::string::npos);
+    SNE_CHECK(text.find_first_not_of(" \n", linkList + 9) == patchList);
+
+    // and the list can be filled again
+    graph.AddRandomEdge(rng);
+    SNE_CHECK(saved.Save(graph));
+    CheckSameAsFullSave(saved, graph);
+}
+
+// a file changed by something else since it was saved is written again as a whole
+void TestStaleFile(std::mt19937& rng)
+{
+    Graph graph;
+    graph.AddRandom(rng, 100, 100);
+    auto  changeNode = [&]
+    { graph.m_nodes.at(Graph::PickKey(graph.m_nodes, rng)).GetYamlNode().m_nodeYamlType += 10; };
+
+    // a different modification time or size
+    for (int check = 0; check < 2; ++check)
+    {
+        SavedFile saved;
+        saved.SaveAll(graph);
+        changeNode();
+        std::optional<PipelineFileLayout::Patch> patch = saved.m_layout.PlanChanges(graph.Emit());
+        SNE_CHECK(patch.has_value() && !patch->m_writes.empty());
+        const std::time_t modifiedTime = SavedFile::s_modifiedTime + (check == 0 ? 1 : 0);
+        const int64_t     size         = saved.Size() + (check == 1 ? 1 : 0);
+        const std::string before       = saved.m_file.str();
+        SNE_CHECK(!saved.m_layout.ApplyChanges(std::move(*patch), modifiedTime, size, saved.m_file,
+                                               saved.m_file));
+        SNE_CHECK(!saved.m_layout.IsFor("file"));
+        SNE_CHECK(saved.m_file.str() == before);
+    }
+
+    // the same time and size, but a slot about to be overwritten holds something else
+    SavedFile saved;
+    saved.SaveAll(graph);
+    changeNode();
+    std::optional<PipelineFileLayout::Patch> patch = saved.m_layout.PlanChanges(graph.Emit());
+    SNE_CHECK(patch.has_value() && !patch->m_writes.empty());
+    saved.m_file.seekp(static_cast<std::streamoff>(patch->m_writes.front().m_offset + 6));
+    saved.m_file.put('#');
+    SNE_CHECK(!saved.m_layout.ApplyChanges(std::move(*patch), SavedFile::s_modifiedTime,
+                                           saved.Size(), saved.m_file, saved.m_file));
+    SNE_CHECK(!saved.m_layout.IsFor("file"));
+
+    // the same for a slot blanked before
+    saved.SaveAll(graph);
+    const NodeUniqueId removed  = Graph::PickKey(graph.m_nodes, rng);
+    const YamlNode     yamlNode = graph.m_nodes.at(removed).GetYamlNode();
+    graph.RemoveNode(removed);
+    SNE_CHECK(saved.Save(graph));
+    // as long as the removed one, so it is written to its blanked slot
+    const NodeUniqueId added = graph.m_nextUid++;
+    graph.m_nodes.emplace(added, Node(added, Node::NodeType::NormalNode, yamlNode, graph.m_style));
+    patch = saved.m_layout.PlanChanges(graph.Emit());
+    SNE_CHECK(patch.has_value() && !patch->m_writes.empty());
+    saved.m_file.seekp(static_cast<std::streamoff>(patch->m_writes.front().m_offset + 6));
+    saved.m_file.put('#');
+    SNE_CHECK(!saved.m_layout.ApplyChanges(std::move(*patch), SavedFile::s_modifiedTime,
+                                           saved.Size(), saved.m_file, saved.m_file));
+}
+
+} // namespace
+
+int main()
+{
+    Log::GetInstance().SetLogLevel(Log::LogLevel::LogError);
+
+    std::mt19937 rng(20240611);
+    TestRandomEdits(rng);
+    TestPatchSections(rng);
+    TestAllEntriesBlanked(rng);
+    TestStaleFile(rng);
+    return SimpleNodeEditor::Test::Result();
+}
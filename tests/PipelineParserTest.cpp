@@ -0,0 +1,288 @@
+// Checks that parsing the NodeList and LinkList of a pipeline in chunks on several threads gives
+// the same records and the same errors as parsing it on one thread. Run with --benchmark to time
+// the parse of a large pipeline on 1 to 16 threads.
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "Log.hpp"
+#include "TestHelpers.hpp"
+#include "YamlParser.hpp"
+
+using namespace SimpleNodeEditor;
+using SimpleNodeEditor::Test::MeasureMs;
+
+namespace
+{
+
+// what a load gives back
+struct Parsed
+{
+    bool                     m_succeeded = false;
+    std::string              m_pipelineName;
+    std::vector<YamlNode>    m_nodes;
+    std::vector<YamlEdge>    m_edges;
+    std::vector<std::string> m_errors;
+    std::vector<std::string> m_warnings;
+};
+
+Parsed Parse(const std::string& text, size_t threadCount,
+             const std::atomic<bool>* cancelled = nullptr)
+{
+    PipelineParser parser;
+    parser.SetThreadCount(threadCount);
+    Parsed parsed;
+    parsed.m_succeeded = parser.LoadText(text, cancelled);
+    parsed.m_pipelineName = parser.GetPipelineName();
+    parsed.m_nodes = parser.ParseNodes();
+    parsed.m_edges = parser.ParseEdges();
+    parsed.m_errors = parser.TakeErrors();
+    parsed.m_warnings = parser.TakeWarnings();
+    return parsed;
+}
+
+// a pipeline file with nodeCount nodes and linkCount links, every entry a few hundred bytes
+// like the ones the editor saves. Entries listed in the bad* sets are written broken.
+struct PipelineText
+{
+    int              m_nodeCount = 0;
+    int              m_linkCount = 0;
+    std::vector<int> m_badNumberNodes;  // NodeId is not a number
+    std::vector<int> m_missingKeyNodes; // NodeType is left out
+    std::vector<int> m_missingKeyLinks; // PortId of the source port is left out
+    int              m_unclosedQuoteNode = -1;
+
+    std::string Build(std::mt19937& rng) const
+    {
+        std::uniform_int_distribution<int> pickNode(0, std::max(0, m_nodeCount - 1));
+        std::uniform_int_distribution<int> pickCount(0, 3);
+        auto has = [](const std::vector<int>& entries, int entry)
+        { return std::find(entries.begin(), entries.end(), entry) != entries.end(); };
+
+        std::string text = "Pipeline:\n-\n  pipelinename : bench\n  NodeList:\n";
+        for (int node = 0; node < m_nodeCount; ++node)
+        {
+            text += "    - \n      NodeName: ";
+            text += node == m_unclosedQuoteNode ? "\"Node" : "Node";
+            text += std::to_string(node % 7);
+            text += "\n      NodeId : ";
+            text += has(m_badNumberNodes, node) ? "x" : "";
+            text += std::to_string(node);
+            text += "\n      IsSrcNode: 0\n";
+            if (!has(m_missingKeyNodes, node))
+            {
+                text += "      NodeType: " + std::to_string(node % 5) + "\n";
+            }
+            if (const int propertyCount = pickCount(rng))
+            {
+                text += "      NodeProperty:\n";
+                for (int property = 0; property < propertyCount; ++property)
+                {
+                    text += "      -\n        NodePropertyName: property" +
+                            std::to_string(property) + "\n        NodePropertyValue: \"" +
+                            std::to_string(rng() % 1000) + "\"\n";
+                }
+            }
+            if (node % 3 == 0)
+            {
+                text += "      PruneRule:\n      - \n          group: prune" +
+                        std::to_string(node % 4) + "\n          type: Enable\n";
+            }
+            if (node % 2 == 0)
+            {
+                text += "      Position: [" + std::to_string(node * 10) + ".5, " +
+                        std::to_string(node % 100) + "]\n";
+            }
+        }
+
+        text += "\n  LinkList:\n";
+        for (int link = 0; link < m_linkCount; ++link)
+        {
+            const int src = pickNode(rng);
+            text += "    - \n      SrcPort:\n        NodeName: Node" + std::to_string(src % 7) +
+                    "\n        NodeId: " + std::to_string(src) +
+                    "\n        PortName: outputport1\n";
+            if (!has(m_missingKeyLinks, link))
+            {
+                text += "        PortId: 0\n";
+            }
+            text += "      DstPort:\n";
+            for (int dst = pickCount(rng); dst >= 0; --dst)
+            {
+                const int dstNode = pickNode(rng);
+                text += "      - \n        NodeName: Node" + std::to_string(dstNode % 7) +
+                        "\n        NodeId: " + std::to_string(dstNode) + "\n        PortId: " +
+                        std::to_string(dst) + "\n        PortName: inputport1\n";
+                if (dst == 2)
+                {
+                    text += "        PruneRule:\n        - \n          group: prune1\n"
+                            "          type: Disble\n";
+                }
+            }
+        }
+        return text;
+    }
+};
+
+std::vector<std::tuple<std::string, int32_t, std::string>> PropertiesOf(const YamlNode& node)
+{
+    std::vector<std::tuple<std::string, int32_t, std::string>> properties;
+    node.m_Properties.ForEach([&](std::string_view name, int32_t id, std::string_view value)
+                              { properties.emplace_back(name, id, value); });
+    return properties;
+}
+
+bool SameRules(const std::vector<YamlPruningRule>& lhs, const std::vector<YamlPruningRule>& rhs)
+{
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                      [](const YamlPruningRule& l, const YamlPruningRule& r)
+                      { return l.m_Group == r.m_Group && l.m_Type == r.m_Type; });
+}
+
+bool SamePort(const YamlPort& lhs, const YamlPort& rhs)
+{
+    return lhs.m_nodeName == rhs.m_nodeName && lhs.m_nodeYamlId == rhs.m_nodeYamlId &&
+           lhs.m_portName == rhs.m_portName && lhs.m_portYamlId == rhs.m_portYamlId &&
+           SameRules(lhs.m_PruningRules, rhs.m_PruningRules);
+}
+
+bool SameNode(const YamlNode& lhs, const YamlNode& rhs)
+{
+    const bool samePosition =
+        lhs.m_position.has_value() == rhs.m_position.has_value() &&
+        (!lhs.m_position || (lhs.m_position->m_x == rhs.m_position->m_x &&
+                             lhs.m_position->m_y == rhs.m_position->m_y));
+    return lhs.m_nodeName == rhs.m_nodeName && lhs.m_nodeYamlId == rhs.m_nodeYamlId &&
+           lhs.m_isSrcNode == rhs.m_isSrcNode && lhs.m_nodeYamlType == rhs.m_nodeYamlType &&
+           PropertiesOf(lhs) == PropertiesOf(rhs) &&
+           SameRules(lhs.m_PruningRules, rhs.m_PruningRules) && samePosition;
+}
+
+void CheckSameParse(const Parsed& parsed, const Parsed& expected)
+{
+    SNE_CHECK(parsed.m_succeeded == expected.m_succeeded);
+    SNE_CHECK(parsed.m_pipelineName == expected.m_pipelineName);
+    SNE_CHECK(std::equal(parsed.m_nodes.begin(), parsed.m_nodes.end(), expected.m_nodes.begin(),
+                         expected.m_nodes.end(), SameNode));
+    SNE_CHECK(std::equal(parsed.m_edges.begin(), parsed.m_edges.end(), expected.m_edges.begin(),
+                         expected.m_edges.end(),
+                         [](const YamlEdge& lhs, const YamlEdge& rhs)
+                         {
+                             return lhs.m_isValid == rhs.m_isValid &&
+                                    SamePort(lhs.m_yamlSrcPort, rhs.m_yamlSrcPort) &&
+                                    SamePort(lhs.m_yamlDstPort, rhs.m_yamlDstPort);
+                         }));
+    SNE_CHECK(parsed.m_errors == expected.m_errors);
+    SNE_CHECK(parsed.m_warnings == expected.m_warnings);
+}
+
+// thread counts that do and do not divide the number of chunks
+constexpr size_t s_threadCounts[] = {2, 3, 7, 16};
+
+// large enough to be split, 1.7 MB or so
+void TestSameRecords(std::mt19937& rng)
+{
+    PipelineText pipeline;
+    pipeline.m_nodeCount = 2500;
+    pipeline.m_linkCount = 2500;
+    const std::string text = pipeline.Build(rng);
+
+    const Parsed expected = Parse(text, 1);
+    SNE_CHECK(expected.m_succeeded);
+    SNE_CHECK(expected.m_nodes.size() == 2500);
+    SNE_CHECK(expected.m_errors.empty());
+    for (size_t threadCount : s_threadCounts)
+    {
+        CheckSameParse(Parse(text, threadCount), expected);
+    }
+
+    // below the size worth splitting, parsed on the calling thread whatever the thread count
+    pipeline.m_nodeCount = 50;
+    pipeline.m_linkCount = 50;
+    const std::string small = pipeline.Build(rng);
+    CheckSameParse(Parse(small, 16), Parse(small, 1));
+}
+
+// broken entries spread over the chunks are reported as on one thread, in file order
+void TestSameErrors(std::mt19937& rng)
+{
+    PipelineText pipeline;
+    pipeline.m_nodeCount = 2500;
+    pipeline.m_linkCount = 2500;
+    pipeline.m_badNumberNodes = {0, 1249, 2499};
+    pipeline.m_missingKeyNodes = {1, 1900};
+    pipeline.m_missingKeyLinks = {10, 1250, 2499};
+    const std::string text = pipeline.Build(rng);
+
+    const Parsed expected = Parse(text, 1);
+    SNE_CHECK(expected.m_succeeded);
+    SNE_CHECK(expected.m_errors.size() == 8);
+    for (size_t threadCount : s_threadCounts)
+    {
+        CheckSameParse(Parse(text, threadCount), expected);
+    }
+
+    // a syntax error inside a chunk fails the load, as it does on one thread
+    pipeline.m_badNumberNodes.clear();
+    pipeline.m_missingKeyNodes.clear();
+    pipeline.m_missingKeyLinks.clear();
+    pipeline.m_unclosedQuoteNode = 1250;
+    const std::string broken = pipeline.Build(rng);
+    SNE_CHECK(!Parse(broken, 1).m_succeeded);
+    for (size_t threadCount : s_threadCounts)
+    {
+        SNE_CHECK(!Parse(broken, threadCount).m_succeeded);
+    }
+
+    // so does cancelling it
+    const std::atomic<bool> cancelled(true);
+    SNE_CHECK(!Parse(text, 1, &cancelled).m_succeeded);
+    SNE_CHECK(!Parse(text, 4, &cancelled).m_succeeded);
+}
+
+void RunBenchmarks(std::mt19937& rng)
+{
+    // about 20 MB
+    PipelineText pipeline;
+    pipeline.m_nodeCount = 20000;
+    pipeline.m_linkCount = 40000;
+    const std::string text = pipeline.Build(rng);
+
+    double oneThreadMs = 0.;
+    for (size_t threadCount : {1, 2, 4, 8, 16})
+    {
+        size_t       checksum = 0;
+        const double ms = MeasureMs(
+            [&]
+            {
+                const Parsed parsed = Parse(text, threadCount);
+                checksum += parsed.m_nodes.size() + parsed.m_edges.size();
+            });
+        if (threadCount == 1)
+        {
+            oneThreadMs = ms;
+        }
+        std::printf("%.1f MB, %zu thread(s): %.3f ms, %.2fx (%zu records)\n",
+                    static_cast<double>(text.size()) / (1024. * 1024.), threadCount, ms,
+                    oneThreadMs / ms, checksum);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Log::GetInstance().SetLogLevel(Log::LogLevel::LogError);
+
+    std::mt19937 rng(20240611);
+    TestSameRecords(rng);
+    TestSameErrors(rng);
+    if (SimpleNodeEditor::Test::WantsBenchmark(argc, argv))
+    {
+        RunBenchmarks(rng);
+    }
+    return SimpleNodeEditor::Test::Result();
+}
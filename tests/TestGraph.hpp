@@ -0,0 +1,105 @@
+#ifndef TESTGRAPH_H
+#define TESTGRAPH_H
+#include <algorithm>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include <imnodes.h>
+#include "DataStructureEditor.hpp"
+
+namespace SimpleNodeEditor::Test
+{
+
+// Node and edge maps wired like the editor wires them: every node has two output ports, each
+// edge gets an input port of its own on the destination node.
+class TestGraph
+{
+public:
+    static constexpr int s_outputPortCount = 2;
+
+    NodeUniqueId AddNode()
+    {
+        const NodeUniqueId nodeUid = m_nextUid++;
+        Node node(nodeUid, Node::NodeType::NormalNode, YamlNode(), GetStyle());
+        for (int port = 0; port < s_outputPortCount; ++port)
+        {
+            node.AddOutputPort(OutputPort(m_nextUid++, port, "out", nodeUid));
+        }
+        m_nodes.emplace(nodeUid, std::move(node));
+        return nodeUid;
+    }
+
+    // all edges of the node must have been removed before
+    void RemoveNode(NodeUniqueId nodeUid) { m_nodes.erase(nodeUid); }
+
+    EdgeUniqueId AddEdge(NodeUniqueId srcNodeUid, NodeUniqueId dstNodeUid, int outputPort = 0)
+    {
+        Node&              dstNode = m_nodes.at(dstNodeUid);
+        OutputPort&        outPort = m_nodes.at(srcNodeUid).GetOutputPorts()[outputPort];
+        const EdgeUniqueId edgeUid = m_nextUid++;
+        const PortId       inPortId = static_cast<PortId>(dstNode.GetInputPorts().size());
+        InputPort          inPort(m_nextUid++, inPortId, "in", dstNodeUid);
+        inPort.SetEdgeUid(edgeUid);
+        dstNode.AddInputPort(inPort);
+        outPort.PushEdge(edgeUid);
+        m_edges.emplace(edgeUid, Edge(outPort.GetPortUniqueId(), srcNodeUid,
+                                      inPort.GetPortUniqueId(), dstNodeUid, edgeUid, YamlEdge()));
+        return edgeUid;
+    }
+
+    void RemoveEdge(EdgeUniqueId edgeUid)
+    {
+        const Edge& edge = m_edges.at(edgeUid);
+        m_nodes.at(edge.GetSourceNodeUid())
+            .GetOutputPort(edge.GetSourcePortUid())
+            ->DeletEdge(edgeUid);
+        m_nodes.at(edge.GetDestinationNodeUid())
+            .GetInputPort(edge.GetDestinationPortUid())
+            ->SetEdgeUid(-1);
+        m_edges.erase(edgeUid);
+    }
+
+    const std::unordered_map<NodeUniqueId, Node>& GetNodes() const { return m_nodes; }
+    const std::unordered_map<EdgeUniqueId, Edge>& GetEdges() const { return m_edges; }
+
+    // edgeCount random edges, each going from a lower to a higher node index so there is no cycle
+    static TestGraph RandomDag(int nodeCount, int edgeCount, std::mt19937& rng)
+    {
+        TestGraph                 graph;
+        std::vector<NodeUniqueId> nodeUids;
+        for (int node = 0; node < nodeCount; ++node)
+        {
+            nodeUids.push_back(graph.AddNode());
+        }
+        std::uniform_int_distribution<int> pickNode(0, nodeCount - 1);
+        std::uniform_int_distribution<int> pickPort(0, s_outputPortCount - 1);
+        for (int edge = 0; nodeCount > 1 && edge < edgeCount; ++edge)
+        {
+            int src = pickNode(rng);
+            int dst = pickNode(rng);
+            while (src == dst)
+            {
+                dst = pickNode(rng);
+            }
+            graph.AddEdge(nodeUids[std::min(src, dst)], nodeUids[std::max(src, dst)],
+                          pickPort(rng));
+        }
+        return graph;
+    }
+
+private:
+    // nodes keep a pointer to their style, it has to outlive the graphs
+    static ImNodesStyle& GetStyle()
+    {
+        static ImNodesStyle s_style;
+        return s_style;
+    }
+
+    std::unordered_map<NodeUniqueId, Node> m_nodes;
+    std::unordered_map<EdgeUniqueId, Edge> m_edges;
+    NodeUniqueId                           m_nextUid = 0;
+};
+
+} // namespace SimpleNodeEditor::Test
+
+#endif // TESTGRAPH_H
@@ -0,0 +1,61 @@
+#ifndef TESTHELPERS_H
+#define TESTHELPERS_H
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+// Minimal helpers shared by the test executables. Each test is a plain executable that returns
+// non zero when a check failed, passing --benchmark also runs its timings.
+namespace SimpleNodeEditor::Test
+{
+
+inline int g_failedChecks = 0;
+
+inline int Result()
+{
+    if (g_failedChecks != 0)
+    {
+        std::fprintf(stderr, "%d check(s) failed\n", g_failedChecks);
+        return 1;
+    }
+    return 0;
+}
+
+inline bool WantsBenchmark(int argc, char** argv)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--benchmark") == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// run func once and return the elapsed time in milliseconds
+template <typename Func>
+double MeasureMs(Func&& func)
+{
+    const auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+// true when both floats have the same bit pattern
+inline bool SameBits(float lhs, float rhs) { return std::memcmp(&lhs, &rhs, sizeof(float)) == 0; }
+
+} // namespace SimpleNodeEditor::Test
+
+#define SNE_CHECK(expr)                                                                  \
+    do                                                                                   \
+    {                                                                                    \
+        if (!(expr))                                                                     \
+        {                                                                                \
+            ++SimpleNodeEditor::Test::g_failedChecks;                                    \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr); \
+        }                                                                                \
+    } while (0)
+
+#endif // TESTHELPERS_H
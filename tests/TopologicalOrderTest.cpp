@@ -0,0 +1,406 @@
+// Checks the incrementally maintained TopologicalOrder against TopologicalSort run on the whole
+// graph, over random edits. Run with --benchmark to time edits on a large DAG.
+#include <cstdio>
+#include <optional>
+#include <random>
+#include <vector>
+#include "Helpers.hpp"
+#include "Log.hpp"
+#include "TestGraph.hpp"
+#include "TestHelpers.hpp"
+#include "TopologicalOrder.hpp"
+
+using namespace SimpleNodeEditor;
+using SimpleNodeEditor::Test::MeasureMs;
+using SimpleNodeEditor::Test::TestGraph;
+
+namespace
+{
+
+std::unordered_map<NodeUniqueId, int> LevelOfNodes(
+    const std::vector<std::vector<NodeUniqueId>>& levels)
+{
+    std::unordered_map<NodeUniqueId, int> result;
+    for (size_t level = 0; level < levels.size(); ++level)
+    {
+        for (NodeUniqueId nodeUid : levels[level])
+        {
+            result.emplace(nodeUid, static_cast<int>(level));
+        }
+    }
+    return result;
+}
+
+// true when dst can be reached from src
+bool Reaches(const TestGraph& graph, NodeUniqueId src, NodeUniqueId dst)
+{
+    std::vector<NodeUniqueId>              stack{src};
+    std::unordered_map<NodeUniqueId, bool> visited{{src, true}};
+    while (!stack.empty())
+    {
+        const NodeUniqueId nodeUid = stack.back();
+        stack.pop_back();
+        if (nodeUid == dst)
+        {
+            return true;
+        }
+        for (const OutputPort& outPort : graph.GetNodes().at(nodeUid).GetOutputPorts())
+        {
+            for (EdgeUniqueId edgeUid : outPort.GetEdgeUids())
+            {
+                const NodeUniqueId succ = graph.GetEdges().at(edgeUid).GetDestinationNodeUid();
+                if (visited.emplace(succ, true).second)
+                {
+                    stack.push_back(succ);
+                }
+            }
+        }
+    }
+    return false;
+}
+
+// levels as TopologicalSort gives them, cycles condensed
+void CheckSameLevels(const TopologicalOrder& order, const TestGraph& graph)
+{
+    const std::unordered_map<NodeUniqueId, int> expected =
+        LevelOfNodes(TopologicalSort(graph.GetNodes(), graph.GetEdges()));
+    for (const auto& [nodeUid, _] : graph.GetNodes())
+    {
+        SNE_CHECK(order.GetLevel(nodeUid) == expected.at(nodeUid));
+    }
+
+    // the per level node lists agree with the levels
+    size_t visited = 0;
+    order.ForEachNodeInLevels(0, static_cast<int>(graph.GetNodes().size()),
+                              [&](NodeUniqueId nodeUid)
+                              {
+                                  ++visited;
+                                  SNE_CHECK(expected.contains(nodeUid));
+                              });
+    SNE_CHECK(visited == graph.GetNodes().size());
+    const std::vector<std::vector<NodeUniqueId>> levels = order.GetLevels();
+    for (size_t level = 0; level < levels.size(); ++level)
+    {
+        for (NodeUniqueId nodeUid : levels[level])
+        {
+            SNE_CHECK(expected.at(nodeUid) == static_cast<int>(level));
+        }
+    }
+}
+
+// while cycles are left untracked, their nodes may not share a level any more, but edges between
+// cycles still go up a level
+void CheckCyclicLevels(const TopologicalOrder& order, const TestGraph& graph)
+{
+    std::unordered_map<NodeUniqueId, int> componentOfNode;
+    int                                   component = 0;
+    for (const auto& nodeUids : StronglyConnectedComponents(graph.GetNodes(), graph.GetEdges()))
+    {
+        for (NodeUniqueId nodeUid : nodeUids)
+        {
+            componentOfNode.emplace(nodeUid, component);
+        }
+        ++component;
+    }
+    for (const auto& [_, edge] : graph.GetEdges())
+    {
+        const NodeUniqueId src = edge.GetSourceNodeUid();
+        const NodeUniqueId dst = edge.GetDestinationNodeUid();
+        if (componentOfNode.at(src) != componentOfNode.at(dst))
+        {
+            SNE_CHECK(order.GetLevel(src) < order.GetLevel(dst));
+        }
+    }
+}
+
+void CheckLevels(const TopologicalOrder& order, const TestGraph& graph)
+{
+    const bool hasCycles = !FindCycles(graph.GetNodes(), graph.GetEdges()).empty();
+    SNE_CHECK(order.HasCycles() == hasCycles);
+    if (hasCycles)
+    {
+        CheckCyclicLevels(order, graph);
+    }
+    else
+    {
+        CheckSameLevels(order, graph);
+    }
+}
+
+// edits on a loaded graph, whose back edges close cycles, and undo bringing removed edges back
+void TestRandomEdits(std::mt19937& rng, int backEdgeCount)
+{
+    TestGraph                 graph = TestGraph::RandomDag(60, 90, rng);
+    TopologicalOrder          order;
+    std::vector<NodeUniqueId> nodes;
+    std::vector<EdgeUniqueId> edges;
+    int                       rejected = 0;
+    // the last edge removed on its own, undo may bring it back
+    std::optional<std::pair<NodeUniqueId, NodeUniqueId>> removed;
+    for (const auto& [nodeUid, _] : graph.GetNodes())
+    {
+        nodes.push_back(nodeUid);
+    }
+    std::uniform_int_distribution<size_t> pickLoaded(0, nodes.size() - 1);
+    for (int edge = 0; edge < backEdgeCount; ++edge)
+    {
+        const NodeUniqueId src = nodes[pickLoaded(rng)];
+        const NodeUniqueId dst = nodes[pickLoaded(rng)];
+        graph.AddEdge(std::max(src, dst), std::min(src, dst));
+    }
+    for (const auto& [edgeUid, _] : graph.GetEdges())
+    {
+        edges.push_back(edgeUid);
+    }
+    order.BeginBatchUpdate();
+    for (NodeUniqueId nodeUid : nodes)
+    {
+        order.AddNode(nodeUid);
+    }
+    order.EndBatchUpdate(graph.GetNodes(), graph.GetEdges());
+    CheckSameLevels(order, graph);
+
+    for (int edit = 0; edit < 6000; ++edit)
+    {
+        const int op = std::uniform_int_distribution<int>(0, 9)(rng);
+        if (op == 0 || nodes.size() < 2)
+        {
+            nodes.push_back(graph.AddNode());
+            order.AddNode(nodes.back());
+        }
+        else if (op == 1 && nodes.size() > 20)
+        {
+            // drop a node with its edges
+            std::uniform_int_distribution<size_t> pickNode(0, nodes.size() - 1);
+            const size_t                          index = pickNode(rng);
+            const NodeUniqueId                    nodeUid = nodes[index];
+            for (size_t edge = 0; edge < edges.size();)
+            {
+                const Edge& e = graph.GetEdges().at(edges[edge]);
+                if (e.GetSourceNodeUid() == nodeUid || e.GetDestinationNodeUid() == nodeUid)
+                {
+                    order.RemoveEdge(e.GetSourceNodeUid(), e.GetDestinationNodeUid());
+                    graph.RemoveEdge(edges[edge]);
+                    edges[edge] = edges.back();
+                    edges.pop_back();
+                }
+                else
+                {
+                    ++edge;
+                }
+            }
+            order.RemoveNode(nodeUid);
+            graph.RemoveNode(nodeUid);
+            nodes[index] = nodes.back();
+            nodes.pop_back();
+            removed.reset();
+        }
+        else if (op == 2 && removed)
+        {
+            // undo puts the edge back whatever cycle it closes
+            const bool closesCycle = Reaches(graph, removed->second, removed->first);
+            SNE_CHECK(order.RestoreEdge(removed->first, removed->second) == !closesCycle);
+            edges.push_back(graph.AddEdge(removed->first, removed->second));
+            removed.reset();
+        }
+        else if (op <= 6)
+        {
+            std::uniform_int_distribution<size_t> pickNode(0, nodes.size() - 1);
+            const NodeUniqueId                    src = nodes[pickNode(rng)];
+            const NodeUniqueId                    dst = nodes[pickNode(rng)];
+            const bool closesCycle = Reaches(graph, dst, src);
+            const bool added = order.AddEdge(src, dst);
+            SNE_CHECK(added == !closesCycle);
+            if (added)
+            {
+                edges.push_back(graph.AddEdge(src, dst));
+            }
+            else
+            {
+                ++rejected;
+            }
+        }
+        else if (!edges.empty())
+        {
+            const size_t index = std::uniform_int_distribution<size_t>(0, edges.size() - 1)(rng);
+            const Edge&  edge = graph.GetEdges().at(edges[index]);
+            removed.emplace(edge.GetSourceNodeUid(), edge.GetDestinationNodeUid());
+            order.RemoveEdge(edge.GetSourceNodeUid(), edge.GetDestinationNodeUid());
+            graph.RemoveEdge(edges[index]);
+            edges[index] = edges.back();
+            edges.pop_back();
+        }
+
+        if (edit % 25 == 0)
+        {
+            CheckLevels(order, graph);
+        }
+    }
+    CheckLevels(order, graph);
+    // make sure the cycle check has been exercised
+    SNE_CHECK(rejected > 0);
+}
+
+// a loaded pipeline may come with cycles, they are condensed and their edges left untracked until
+// removing an edge breaks them
+void TestLoadedCycles()
+{
+    TestGraph                 graph;
+    std::vector<NodeUniqueId> nodes;
+    for (int node = 0; node < 6; ++node)
+    {
+        nodes.push_back(graph.AddNode());
+    }
+    graph.AddEdge(nodes[0], nodes[1]);
+    const EdgeUniqueId back = graph.AddEdge(nodes[3], nodes[1]);
+    graph.AddEdge(nodes[1], nodes[2]);
+    graph.AddEdge(nodes[2], nodes[3]);
+    graph.AddEdge(nodes[3], nodes[4]);
+    graph.AddEdge(nodes[5], nodes[4]);
+
+    TopologicalOrder order;
+    order.BeginBatchUpdate();
+    for (NodeUniqueId nodeUid : nodes)
+    {
+        order.AddNode(nodeUid);
+    }
+    order.EndBatchUpdate(graph.GetNodes(), graph.GetEdges());
+    SNE_CHECK(order.HasCycles());
+    const std::unordered_map<NodeUniqueId, int> condensed =
+        LevelOfNodes(CondensedTopologicalSort(graph.GetNodes(), graph.GetEdges()));
+    for (NodeUniqueId nodeUid : nodes)
+    {
+        SNE_CHECK(order.GetLevel(nodeUid) == condensed.at(nodeUid));
+    }
+    SNE_CHECK(order.GetLevel(nodes[1]) == order.GetLevel(nodes[3]));
+
+    // closing another cycle through tracked edges is still rejected
+    SNE_CHECK(!order.AddEdge(nodes[4], nodes[0]));
+
+    order.RemoveEdge(nodes[3], nodes[1]);
+    graph.RemoveEdge(back);
+    SNE_CHECK(!order.HasCycles());
+    CheckSameLevels(order, graph);
+}
+
+// deleting an edge of a loaded cycle then undoing it brings the cycle back, redoing breaks it again
+void TestUndoCycleEdge()
+{
+    for (int undone = 0; undone < 3; ++undone)
+    {
+        TestGraph                 graph;
+        std::vector<NodeUniqueId> nodes;
+        for (int node = 0; node < 5; ++node)
+        {
+            nodes.push_back(graph.AddNode());
+        }
+        graph.AddEdge(nodes[0], nodes[1]);
+        std::vector<EdgeUniqueId> cycle = {graph.AddEdge(nodes[1], nodes[2]),
+                                           graph.AddEdge(nodes[2], nodes[3]),
+                                           graph.AddEdge(nodes[3], nodes[1])};
+        graph.AddEdge(nodes[3], nodes[4]);
+
+        TopologicalOrder order;
+        order.Rebuild(graph.GetNodes(), graph.GetEdges());
+        SNE_CHECK(order.HasCycles());
+
+        const NodeUniqueId src = graph.GetEdges().at(cycle[undone]).GetSourceNodeUid();
+        const NodeUniqueId dst = graph.GetEdges().at(cycle[undone]).GetDestinationNodeUid();
+        order.RemoveEdge(src, dst);
+        graph.RemoveEdge(cycle[undone]);
+        SNE_CHECK(!order.HasCycles());
+        CheckSameLevels(order, graph);
+
+        // undo
+        SNE_CHECK(!order.RestoreEdge(src, dst));
+        const EdgeUniqueId restored = graph.AddEdge(src, dst);
+        SNE_CHECK(order.HasCycles());
+        CheckCyclicLevels(order, graph);
+        // the restored cycle still turns down new ones
+        SNE_CHECK(!order.AddEdge(nodes[4], nodes[0]));
+
+        // redo
+        order.RemoveEdge(src, dst);
+        graph.RemoveEdge(restored);
+        SNE_CHECK(!order.HasCycles());
+        CheckSameLevels(order, graph);
+    }
+}
+
+void RunBenchmarks(std::mt19937& rng)
+{
+    const int nodeCount = 50000;
+    const int edits = 20000;
+    for (int cycleCount : {0, 4})
+    {
+        TestGraph                 graph = TestGraph::RandomDag(nodeCount, nodeCount * 3 / 2, rng);
+        std::vector<NodeUniqueId> nodeUids;
+        for (const auto& [nodeUid, _] : graph.GetNodes())
+        {
+            nodeUids.push_back(nodeUid);
+        }
+        std::uniform_int_distribution<size_t> pickNode(0, nodeUids.size() - 1);
+        // a few loaded two node cycles, every edit then also searches the untracked edges
+        for (int cycle = 0; cycle < cycleCount; ++cycle)
+        {
+            const NodeUniqueId src = nodeUids[pickNode(rng)];
+            const NodeUniqueId dst = nodeUids[pickNode(rng)];
+            graph.AddEdge(src, dst);
+            graph.AddEdge(dst, src);
+        }
+
+        TopologicalOrder order;
+        const double     rebuildMs =
+            MeasureMs([&] { order.Rebuild(graph.GetNodes(), graph.GetEdges()); });
+        const double sortMs =
+            MeasureMs([&] { TopologicalSort(graph.GetNodes(), graph.GetEdges()); });
+
+        // random edge insertions, some of them rejected, each followed by removing an edge
+        std::vector<std::pair<NodeUniqueId, NodeUniqueId>> added;
+        int                                                rejected = 0;
+        const double                                       editMs = MeasureMs(
+            [&]
+            {
+                for (int edit = 0; edit < edits; ++edit)
+                {
+                    const NodeUniqueId src = nodeUids[pickNode(rng)];
+                    const NodeUniqueId dst = nodeUids[pickNode(rng)];
+                    if (order.AddEdge(src, dst))
+                    {
+                        added.emplace_back(src, dst);
+                    }
+                    else
+                    {
+                        ++rejected;
+                    }
+                    if (edit % 2 == 1 && !added.empty())
+                    {
+                        order.RemoveEdge(added.back().first, added.back().second);
+                        added.pop_back();
+                    }
+                }
+            });
+        std::printf("%d nodes, %d cycles: Rebuild %.3f ms, TopologicalSort %.3f ms, %d edits "
+                    "%.3f ms (%.4f ms/edit, %d rejected)\n",
+                    nodeCount, cycleCount, rebuildMs, sortMs, edits, editMs, editMs / edits,
+                    rejected);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Log::GetInstance().SetLogLevel(Log::LogLevel::LogError);
+
+    std::mt19937 rng(20240611);
+    TestRandomEdits(rng, 0);
+    TestRandomEdits(rng, 8);
+    TestLoadedCycles();
+    TestUndoCycleEdge();
+    if (SimpleNodeEditor::Test::WantsBenchmark(argc, argv))
+    {
+        RunBenchmarks(rng);
+    }
+    return SimpleNodeEditor::Test::Result();
+}